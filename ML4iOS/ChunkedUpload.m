@@ -0,0 +1,164 @@
+/**
+ *
+ * ChunkedUpload.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ChunkedUpload.h"
+
+#define DEFAULT_MAX_CONCURRENT_UPLOADS 4
+#define DEFAULT_MAX_ATTEMPTS_PER_CHUNK 3
+
+@implementation ChunkedUpload
+
+@synthesize maxConcurrentUploads;
+@synthesize maxAttemptsPerChunk;
+@synthesize name;
+@synthesize filePath;
+
+-(ChunkedUpload*)initWithName:(NSString*)aName filePath:(NSString*)aFilePath chunkSize:(NSUInteger)aChunkSize
+{
+    self = [super init];
+
+    if(self)
+    {
+        //The file is mapped instead of loaded, so only the pages touched while looking for line breaks are read
+        NSData* fileData = [NSData dataWithContentsOfFile:aFilePath options:NSDataReadingMappedIfSafe error:nil];
+
+        if(fileData == nil)
+            return nil;
+
+        name = aName;
+        filePath = aFilePath;
+        chunkSize = MAX(aChunkSize, 1);
+        maxConcurrentUploads = DEFAULT_MAX_CONCURRENT_UPLOADS;
+        maxAttemptsPerChunk = DEFAULT_MAX_ATTEMPTS_PER_CHUNK;
+
+        const char* bytes = [fileData bytes];
+        NSUInteger length = [fileData length];
+
+        //The header row is repeated at the beginning of every chunk
+        const char* headerEnd = length > 0 ? memchr(bytes, '\n', length) : NULL;
+        NSUInteger headerLength = headerEnd != NULL ? (headerEnd - bytes) + 1 : length;
+        headerRow = [fileData subdataWithRange:NSMakeRange(0, headerLength)];
+
+        //Split the rest of the file in chunks, moving every boundary forward to the next line break
+        NSMutableArray* ranges = [[NSMutableArray alloc]init];
+        NSUInteger offset = headerLength;
+
+        while(offset < length)
+        {
+            NSUInteger end = MIN(offset + chunkSize, length);
+
+            if(end < length)
+            {
+                const char* lineEnd = memchr(bytes + end - 1, '\n', length - end + 1);
+                end = lineEnd != NULL ? (lineEnd - bytes) + 1 : length;
+            }
+
+            [ranges addObject:[NSValue valueWithRange:NSMakeRange(offset, end - offset)]];
+            offset = end;
+        }
+
+        chunkRanges = ranges;
+
+        dataSources = [[NSMutableArray alloc]initWithCapacity:[chunkRanges count]];
+
+        for(NSUInteger i = 0; i < [chunkRanges count]; i++)
+            [dataSources addObject:[NSNull null]];
+    }
+
+    return self;
+}
+
+-(NSUInteger)numberOfChunks
+{
+    return [chunkRanges count];
+}
+
+-(NSUInteger)numberOfAcknowledgedChunks
+{
+    NSUInteger acknowledged = 0;
+
+    @synchronized(dataSources)
+    {
+        for(NSObject* dataSource in dataSources)
+        {
+            if(dataSource != [NSNull null])
+                acknowledged++;
+        }
+    }
+
+    return acknowledged;
+}
+
+-(BOOL)isComplete
+{
+    return [self numberOfAcknowledgedChunks] == [self numberOfChunks];
+}
+
+-(NSArray*)dataSources
+{
+    @synchronized(dataSources)
+    {
+        return [dataSources copy];
+    }
+}
+
+-(BOOL)isChunkAcknowledgedAtIndex:(NSUInteger)index
+{
+    @synchronized(dataSources)
+    {
+        return dataSources[index] != [NSNull null];
+    }
+}
+
+-(NSData*)dataForChunkAtIndex:(NSUInteger)index
+{
+    NSData* fileData = [NSData dataWithContentsOfFile:filePath options:NSDataReadingMappedIfSafe error:nil];
+    NSRange range = [chunkRanges[index] rangeValue];
+
+    if(fileData == nil || NSMaxRange(range) > [fileData length])
+        return nil;
+
+    NSMutableData* chunk = [NSMutableData dataWithCapacity:[headerRow length] + range.length];
+    [chunk appendData:headerRow];
+    [chunk appendData:[fileData subdataWithRange:range]];
+
+    return chunk;
+}
+
+-(NSString*)nameForChunkAtIndex:(NSUInteger)index
+{
+    NSString* baseName = [name length] > 0 ? name : [filePath lastPathComponent];
+
+    return [NSString stringWithFormat:@"%@_%lu", baseName, (unsigned long)index];
+}
+
+-(void)acknowledgeChunkAtIndex:(NSUInteger)index dataSource:(NSDictionary*)dataSource
+{
+    if(dataSource == nil)
+        return;
+
+    @synchronized(dataSources)
+    {
+        dataSources[index] = dataSource;
+    }
+}
+
+@end
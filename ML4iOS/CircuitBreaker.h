@@ -0,0 +1,77 @@
+/**
+ *
+ * CircuitBreaker.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Per endpoint circuit breaker. After a number of consecutive failures of an endpoint the circuit opens and its
+ * requests fail fast without reaching BigML. Once the open interval elapses a single trial request is allowed: if it
+ * succeeds the circuit closes again, else it stays open for another interval.
+ */
+@interface CircuitBreaker : NSObject
+{
+    NSUInteger failureThreshold;
+    NSTimeInterval openInterval;
+    
+    /**
+     * State of every endpoint keyed by endpoint name: consecutive "failures", "openedAt" date and "trial" in flight
+     */
+    NSMutableDictionary* endpoints;
+    
+    //Statistics
+    NSUInteger rejectedRequests;
+}
+
+/**
+ * Initializes the circuit breaker
+ * @param aFailureThreshold The number of consecutive failures that opens the circuit of an endpoint. 0 disables the breaker.
+ * @param aOpenInterval The time in seconds the circuit stays open before allowing a trial request
+ */
+-(CircuitBreaker*)initWithFailureThreshold:(NSUInteger)aFailureThreshold openInterval:(NSTimeInterval)aOpenInterval;
+
+/**
+ * Checks if a request to an endpoint can be sent
+ * @param endpoint The name of the endpoint (ej: model)
+ * @return true if the circuit is closed, or it is the trial request of an open circuit, else false
+ */
+-(BOOL)allowRequestToEndpoint:(NSString*)endpoint;
+
+/**
+ * Records the result of a request allowed by allowRequestToEndpoint
+ * @param success false if the request failed because of a network error or a server error, else true
+ * @param endpoint The name of the endpoint
+ */
+-(void)recordSuccess:(BOOL)success forEndpoint:(NSString*)endpoint;
+
+/**
+ * Releases a request allowed by allowRequestToEndpoint that ended without a result (ej: it was cancelled), so that
+ * the trial of an open circuit can be sent again without counting as a success or a failure
+ * @param endpoint The name of the endpoint
+ */
+-(void)releaseTrialForEndpoint:(NSString*)endpoint;
+
+/**
+ * @return The statistics of the breaker: the names of the "openEndpoints" and the number of "rejectedRequests"
+ */
+-(NSDictionary*)statistics;
+
+@end
@@ -0,0 +1,131 @@
+/**
+ *
+ * CircuitBreaker.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "CircuitBreaker.h"
+
+@implementation CircuitBreaker
+
+-(CircuitBreaker*)initWithFailureThreshold:(NSUInteger)aFailureThreshold openInterval:(NSTimeInterval)aOpenInterval
+{
+    self = [super init];
+    
+    if(self)
+    {
+        failureThreshold = aFailureThreshold;
+        openInterval = aOpenInterval;
+        endpoints = [[NSMutableDictionary alloc]init];
+    }
+    
+    return self;
+}
+
+-(BOOL)allowRequestToEndpoint:(NSString*)endpoint
+{
+    if(failureThreshold == 0 || endpoint == nil)
+        return YES;
+    
+    @synchronized(self)
+    {
+        NSMutableDictionary* state = endpoints[endpoint];
+        NSDate* openedAt = state[@"openedAt"];
+        
+        if(openedAt == nil)
+            return YES;
+        
+        //Only one trial request at a time once the open interval elapses
+        if(-[openedAt timeIntervalSinceNow] >= openInterval && ![state[@"trial"]boolValue])
+        {
+            state[@"trial"] = @YES;
+            return YES;
+        }
+        
+        rejectedRequests++;
+        
+        return NO;
+    }
+}
+
+-(void)recordSuccess:(BOOL)success forEndpoint:(NSString*)endpoint
+{
+    if(failureThreshold == 0 || endpoint == nil)
+        return;
+    
+    @synchronized(self)
+    {
+        NSMutableDictionary* state = endpoints[endpoint];
+        
+        if(success)
+        {
+            [endpoints removeObjectForKey:endpoint];
+            return;
+        }
+        
+        if(state == nil)
+        {
+            state = [NSMutableDictionary dictionaryWithCapacity:3];
+            endpoints[endpoint] = state;
+        }
+        
+        NSUInteger failures = [state[@"failures"]unsignedIntegerValue] + 1;
+        state[@"failures"] = @(failures);
+        
+        //A failed trial opens the circuit for another interval
+        if(failures >= failureThreshold)
+        {
+            state[@"openedAt"] = [NSDate date];
+            state[@"trial"] = @NO;
+        }
+    }
+}
+
+-(void)releaseTrialForEndpoint:(NSString*)endpoint
+{
+    if(failureThreshold == 0 || endpoint == nil)
+        return;
+    
+    @synchronized(self)
+    {
+        NSMutableDictionary* state = endpoints[endpoint];
+        
+        if(state != nil)
+            state[@"trial"] = @NO;
+    }
+}
+
+-(NSDictionary*)statistics
+{
+    @synchronized(self)
+    {
+        NSMutableArray* openEndpoints = [NSMutableArray array];
+        
+        for(NSString* endpoint in endpoints)
+        {
+            if(endpoints[endpoint][@"openedAt"] != nil)
+                [openEndpoints addObject:endpoint];
+        }
+        
+        return @{@"openEndpoints": openEndpoints,
+                 @"rejectedRequests": @(rejectedRequests)};
+    }
+}
+
+@end
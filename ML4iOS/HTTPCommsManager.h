@@ -21,6 +21,12 @@
 
 #import <Foundation/Foundation.h>
 
+@class ChunkedUpload;
+@class ResourceCache;
+@class CircuitBreaker;
+@protocol ML4iOSMetrics;
+@protocol ML4iOSTransport;
+
 /**
  * This class implements the logic to handle HTTP requests to BigML.io API
  */
@@ -51,8 +57,47 @@
      * Token created from apiUsername and apiKey and used to authenticate any HTTP requests
      */
     NSString* authToken;
+    
+    /**
+     * On-disk cache of models, datasets and clusters. nil if the cache is disabled.
+     */
+    ResourceCache* resourceCache;
+    
+    /**
+     * Retry policy of idempotent requests (GET, PUT and DELETE)
+     */
+    NSUInteger maxRetries;
+    NSTimeInterval retryBaseDelay;
+    NSTimeInterval retryMaxDelay;
+    NSUInteger retries;
+    
+    /**
+     * Fails fast the requests to endpoints that keep failing
+     */
+    CircuitBreaker* circuitBreaker;
+    
+    /**
+     * GET requests in flight keyed by url, shared by concurrent identical requests
+     */
+    NSMutableDictionary* inFlightRequests;
+    NSUInteger coalescedRequests;
+    
+    /**
+     * Receives the measures of the requests, nil if the metrics are disabled
+     */
+    id<ML4iOSMetrics> metrics;
+    
+    /**
+     * Sends the requests
+     */
+    id<ML4iOSTransport> transport;
 }
 
+/**
+ * Receives the measures of the requests. nil disables the metrics, no measure is taken then.
+ */
+@property (nonatomic, strong) id<ML4iOSMetrics> metrics;
+
 //*******************************************************************************
 //*******************************  INITIALIZER  *********************************
 //*******************************************************************************
@@ -68,6 +113,92 @@
  */
 -(HTTPCommsManager*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode;
 
+/**
+ * Initializes the object with the BigML username and API key and the transport that sends the requests
+ * @param username The BigML username
+ * @param key The BigML.io API key
+ * @param devMode true if we are working on development mode, else false
+ * @param aTransport The transport that sends the requests, nil to send them to BigML with URLSessionTransport
+ * @return The created BigMLCommsManager object
+ */
+-(HTTPCommsManager*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode transport:(id<ML4iOSTransport>)aTransport;
+
+//*******************************************************************************
+//*****************************  CANCELLATION  **********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Cancellation
+
+/**
+ * Runs a block in the caller thread binding the requests it makes to an operation. When the operation is cancelled,
+ * the request in flight is cancelled, releasing its connection, and the next requests are not sent. These requests
+ * return HTTP_CLIENT_CLOSED_REQUEST and are neither retried nor counted by the circuit breaker.
+ * The batch of predictions and the chunked uploads launched inside the block are bound to the operation too.
+ * @param operation The operation that owns the requests
+ * @param block The block that makes the requests
+ */
++(void)performRequestsOfOperation:(NSOperation*)operation block:(void (^)(void))block;
+
+/**
+ * @return The operation the requests of the caller thread are bound to, nil if there is none
+ */
++(NSOperation*)currentOperation;
+
+//*******************************************************************************
+//*****************************  RESOURCE CACHE  ********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Resource Cache
+
+/**
+ * Enables the on-disk cache of models, datasets and clusters. The entries are stored in the caches directory of the
+ * application, in a folder per BigML user.
+ * @param timeToLive The time in seconds a FINISHED resource is served from disk without any request. Once expired,
+ * or if the resource is not FINISHED, the entry is revalidated with a conditional request.
+ */
+-(void)enableResourceCacheWithTimeToLive:(NSTimeInterval)timeToLive;
+
+/**
+ * @return The statistics of the resource cache, nil if the cache is disabled
+ * @see ResourceCache statistics
+ */
+-(NSDictionary*)resourceCacheStatistics;
+
+//*******************************************************************************
+//******************************  RELIABILITY  **********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Reliability
+
+/**
+ * Sets the retry policy of idempotent requests (GET, PUT and DELETE). Requests that fail because of a network error,
+ * a timeout, a server error or HTTP_TOO_MANY_REQUESTS are retried after a random delay between 0 and an exponential
+ * backoff, or after the delay of the Retry-After header if it is longer. Creations are never retried.
+ * By default 2 retries are made with a base delay of 0.25 seconds and a maximum delay of 8 seconds.
+ * @param aMaxRetries The maximum number of retries per request, 0 disables the retries
+ * @param baseDelay The backoff of the first retry in seconds, doubled on every retry
+ * @param maxDelay The maximum backoff in seconds
+ */
+-(void)setRetryPolicyWithMaxRetries:(NSUInteger)aMaxRetries baseDelay:(NSTimeInterval)baseDelay maxDelay:(NSTimeInterval)maxDelay;
+
+/**
+ * Sets the circuit breaker applied to every endpoint (source, dataset, model, cluster and prediction). After a number of
+ * consecutive failures the requests to the endpoint fail fast with HTTP_SERVICE_UNAVAILABLE without reaching BigML,
+ * until a trial request succeeds. By default the circuit opens after 5 failures and allows a trial every 30 seconds.
+ * @param failureThreshold The number of consecutive failures that opens the circuit, 0 disables the breaker
+ * @param openInterval The time in seconds before allowing a trial request to an open endpoint
+ */
+-(void)setCircuitBreakerWithFailureThreshold:(NSUInteger)failureThreshold openInterval:(NSTimeInterval)openInterval;
+
+/**
+ * @return The number of "retries" made, the names of the "openEndpoints", the number of "rejectedRequests" that
+ * failed fast and the number of "coalescedRequests" that shared the response of an identical GET request in flight
+ */
+-(NSDictionary*)reliabilityStatistics;
+
 //*******************************************************************************
 //******************************  DATA SOURCES  *********************************
 //*******************************************************************************
@@ -84,6 +215,27 @@
  */
 -(NSDictionary*)createDataSourceWithName:(NSString*)name filePath:(NSString*)filePath statusCode:(NSInteger*)code;
 
+/**
+ * Creates a data source from the .csv content passed as parameter.
+ * @param name This optional parameter provides the name of the data source to be created
+ * @param data The .csv content
+ * @param code The HTTP status code returned
+ * @return The data source created if success, else nil
+ */
+-(NSDictionary*)createDataSourceWithName:(NSString*)name data:(NSData*)data statusCode:(NSInteger*)code;
+
+/**
+ * Uploads the pending chunks of a chunked upload in parallel, creating a data source per chunk.
+ * Chunks acknowledged in previous calls are not uploaded again, so a failed upload is resumed calling this method again.
+ * Within a call a chunk is only sent again after a 429 or 503, or if it never reached BigML, waiting the Retry-After
+ * delay or the backoff of the retry policy. A chunk that failed after reaching BigML (ej: a timeout) may have created its
+ * data source anyway, so resuming the upload can create a duplicate of it.
+ * @param upload The chunked upload
+ * @param code The HTTP status code returned. HTTP_CREATED if all chunks are acknowledged, else the status code of the last failed chunk.
+ * @return The data sources created sorted by chunk index if all chunks are acknowledged, else nil
+ */
+-(NSArray*)createDataSourcesWithUpload:(ChunkedUpload*)upload statusCode:(NSInteger*)code;
+
 /**
  * Updates the name of a given data source. 
  * @param identifier The identifier of the data source to update 
@@ -221,6 +373,16 @@
  */
 -(NSDictionary*)getModelWithId:(NSString*)identifier statusCode:(NSInteger*)code;
 
+/**
+ * Get a model, asking the server whether it changed even if the resource cache holds a fresh copy of it.
+ * @param identifier The identifier of the model to get
+ * @param revalidate If true a conditional request is always sent, so a new version is seen before the cached copy
+ * expires
+ * @param code The HTTP status code returned
+ * @return The model if success, else nil
+ */
+-(NSDictionary*)getModelWithId:(NSString*)identifier revalidate:(BOOL)revalidate statusCode:(NSInteger*)code;
+
 //*******************************************************************************
 //********************************  CLUSTERS  ***********************************
 //*******************************************************************************
@@ -291,6 +453,19 @@
  */
 -(NSDictionary*)createPredictionWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData statusCode:(NSInteger*)code;
 
+/**
+ * Creates a prediction per input row from a given model, sending the requests in parallel.
+ * Requests rejected with HTTP_TOO_MANY_REQUESTS or HTTP_SERVICE_UNAVAILABLE are retried once the delay of the
+ * Retry-After header has elapsed, and no new request of the batch is sent during that delay.
+ * @param modelId The identifier of the model
+ * @param name This optional parameter provides the name of the predictions to be created
+ * @param inputDataList The input data of every prediction, a JSON object per row as in createPredictionWithModelId
+ * @param maxConcurrentRequests The maximum number of requests in flight
+ * @param codes Returns the HTTP status code of every row, in the same order than inputDataList
+ * @return The predictions created in the same order than inputDataList, NSNull for the rows that failed
+ */
+-(NSArray*)createPredictionsWithModelId:(NSString*)modelId name:(NSString*)name inputDataList:(NSArray*)inputDataList maxConcurrentRequests:(NSInteger)maxConcurrentRequests statusCodes:(NSArray**)codes;
+
 /**
  * Updates the name of a given prediction. 
  * @param identifier The identifier of the prediction to update 
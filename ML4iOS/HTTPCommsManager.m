@@ -21,6 +21,12 @@
 
 #import "HTTPCommsManager.h"
 #import "Constants.h"
+#import "ChunkedUpload.h"
+#import "ResourceCache.h"
+#import "CircuitBreaker.h"
+#import "ML4iOSMetrics.h"
+#import "TraceRecorder.h"
+#import "URLSessionTransport.h"
 
 #pragma mark URL Definitions
 
@@ -31,6 +37,124 @@
 #define BIGML_IO_CLUSTER_URL [NSString stringWithFormat:@"%@/cluster", apiBaseURL]
 #define BIGML_IO_PREDICTION_URL [NSString stringWithFormat:@"%@/prediction", apiBaseURL]
 
+//Batch predictions
+#define BATCH_MAX_ATTEMPTS_PER_ROW 5
+#define BATCH_DEFAULT_RETRY_DELAY 1.0
+
+//Reliability
+#define DEFAULT_MAX_RETRIES 2
+#define DEFAULT_RETRY_BASE_DELAY 0.25
+#define DEFAULT_RETRY_MAX_DELAY 8.0
+#define DEFAULT_BREAKER_FAILURE_THRESHOLD 5
+#define DEFAULT_BREAKER_OPEN_INTERVAL 30.0
+
+//Cancellation
+#define CURRENT_OPERATION_KEY @"ML4iOSCurrentOperation"
+#define CANCELLATION_SLICE 0.1
+
+#pragma mark -
+
+/**
+ * @param error The error of a request that got no response
+ * @return true if the error proves that the request never reached the server, so it can be sent again without the
+ * risk of repeating its effects
+ */
+static BOOL RequestWasNotSent(NSError* error)
+{
+    if(![[error domain] isEqualToString:NSURLErrorDomain])
+        return NO;
+    
+    switch([error code])
+    {
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorDNSLookupFailed:
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorInternationalRoamingOff:
+        case NSURLErrorDataNotAllowed:
+        case NSURLErrorAppTransportSecurityRequiresSecureConnection:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+/**
+ * A GET request in flight shared by concurrent identical requests
+ */
+@interface InFlightRequest : NSObject
+
+@property (nonatomic, strong) dispatch_group_t group;
+@property (nonatomic, strong) NSDictionary* item;
+@property (nonatomic, assign) NSInteger statusCode;
+@property (nonatomic, assign) NSUInteger followers;
+
+@end
+
+@implementation InFlightRequest
+
+@end
+
+/**
+ * Wakes up a thread waiting for an interval when the operation bound to it is cancelled
+ */
+@interface CancellationObserver : NSObject
+
+@property (nonatomic, strong) dispatch_semaphore_t semaphore;
+
+@end
+
+@implementation CancellationObserver
+
+-(instancetype)init
+{
+    self = [super init];
+    
+    if(self)
+        _semaphore = dispatch_semaphore_create(0);
+    
+    return self;
+}
+
+-(void)observeValueForKeyPath:(NSString*)keyPath ofObject:(id)object change:(NSDictionary*)change context:(void*)context
+{
+    if([object isCancelled])
+        dispatch_semaphore_signal(self.semaphore);
+}
+
+@end
+
+/**
+ * Copies a JSON object parsed with mutable containers, so every caller that shares a response can modify its own copy
+ * @param object The JSON object
+ * @return The copy, with mutable containers at every level
+ */
+static id MutableCopyOfJSONObject(id object)
+{
+    if([object isKindOfClass:[NSDictionary class]])
+    {
+        NSMutableDictionary* copy = [NSMutableDictionary dictionaryWithCapacity:[object count]];
+        
+        for(id key in object)
+            copy[key] = MutableCopyOfJSONObject(object[key]);
+        
+        return copy;
+    }
+    
+    if([object isKindOfClass:[NSArray class]])
+    {
+        NSMutableArray* copy = [NSMutableArray arrayWithCapacity:[object count]];
+        
+        for(id element in object)
+            [copy addObject:MutableCopyOfJSONObject(element)];
+        
+        return copy;
+    }
+    
+    //Strings, numbers and nulls are immutable
+    return object;
+}
+
 #pragma mark -
 
 /**
@@ -50,6 +174,16 @@
  */
 -(NSDictionary*)createItemWithURL:(NSString*)url body:(NSString*)body statusCode:(NSInteger*)code;
 
+/**
+ * Makes a HTTP POST request to create a generic item
+ * @param url The endpoint url
+ * @param body The HTTP body in JSON format
+ * @param code The HTTP status code returned
+ * @param retryAfter Returns the delay in seconds of the Retry-After header, 0 if the response didn't include it
+ * @return The created item if success, else nil
+ */
+-(NSDictionary*)createItemWithURL:(NSString*)url body:(NSString*)body statusCode:(NSInteger*)code retryAfter:(NSTimeInterval*)retryAfter;
+
 /**
  * Makes a HTTP PUT request to update a generic item
  * @param url The endpoint url
@@ -82,14 +216,144 @@
  */
 -(NSDictionary*)listItemsWithURL:(NSString*)url statusCode:(NSInteger*)code;
 
+/**
+ * Makes a HTTP GET request to retrieve a generic item, using the resource cache if it is enabled
+ * @param url The endpoint url
+ * @param key The key of the item in the resource cache
+ * @param revalidate If true a fresh cached copy isn't served without asking the server, a conditional request is
+ * always sent
+ * @param code The HTTP status code returned
+ * @return The item retrieved if success, else nil
+ */
+-(NSDictionary*)getItemWithURL:(NSString*)url cacheKey:(NSString*)key revalidate:(BOOL)revalidate statusCode:(NSInteger*)code;
+
+/**
+ * Makes the HTTP GET request of getItemWithURL:statusCode:, without coalescing it
+ */
+-(NSDictionary*)fetchItemWithURL:(NSString*)url statusCode:(NSInteger*)code;
+
+/**
+ * Makes the HTTP GET request of getItemWithURL:cacheKey:revalidate:statusCode:, without coalescing it
+ */
+-(NSDictionary*)fetchItemWithURL:(NSString*)url cacheKey:(NSString*)key revalidate:(BOOL)revalidate statusCode:(NSInteger*)code;
+
+/**
+ * Coalesces concurrent identical requests: the first caller runs the fetch block, and the callers that arrive while it is
+ * in flight wait for it and share its result instead of sending their own request
+ * @param key The key that identifies identical requests, the endpoint url
+ * @param code The HTTP status code returned
+ * @param fetch The block that sends the request
+ * @return The item retrieved if success, else nil. When the request is shared, every caller receives its own copy.
+ */
+-(NSDictionary*)coalesceRequestWithKey:(NSString*)key statusCode:(NSInteger*)code fetch:(NSDictionary* (^)(NSInteger* fetchCode))fetch;
+
+/**
+ * Makes the HTTP POST request that creates a data source from the content of a .csv
+ * @param name The name of the data source
+ * @param data The .csv content
+ * @param code The HTTP status code returned, 0 if no response was received
+ * @param retryAfter Returns the delay in seconds of the Retry-After header, 0 if the response didn't include it
+ * @param error Returns the error of the transport if no response was received
+ * @return The data source created if success, else nil
+ */
+-(NSDictionary*)createDataSourceWithName:(NSString*)name data:(NSData*)data statusCode:(NSInteger*)code retryAfter:(NSTimeInterval*)retryAfter error:(NSError**)error;
+
+/**
+ * @param attempt The number of the failed attempt, starting at 0
+ * @param retryAfter The delay in seconds of the Retry-After header of the failed attempt, 0 if none
+ * @return The delay before the next attempt: a random delay up to the exponential backoff of the attempt, or the
+ * Retry-After delay if it is longer, bounded by the maximum delay of the retry policy
+ */
+-(NSTimeInterval)retryDelayOfAttempt:(NSUInteger)attempt retryAfter:(NSTimeInterval)retryAfter;
+
+/**
+ * Blocks the caller thread until the interval elapses or the group is left, waking up as soon as the operation bound to
+ * the thread is cancelled
+ * @param interval The maximum time to wait in seconds, DBL_MAX to wait without limit
+ * @param group The group to wait for, nil to only wait for the interval
+ * @return false if the operation bound to the thread was cancelled, else true
+ */
+-(BOOL)waitForInterval:(NSTimeInterval)interval group:(dispatch_group_t)group;
+
+/**
+ * Sends a request applying the circuit breaker of its endpoint and, if it is idempotent, the retry policy.
+ * If the circuit of the endpoint is open the request is not sent, and a HTTP_SERVICE_UNAVAILABLE response is returned.
+ */
 - (NSData *)sendSynchronousRequest:(NSURLRequest*)request returningResponse:(NSURLResponse**)response error:(NSError **)error;
 
+/**
+ * Sends a request once through the transport, blocking the caller thread until the response is received
+ */
+- (NSData *)sendRequest:(NSURLRequest*)request returningResponse:(NSURLResponse**)response error:(NSError **)error;
+
+/**
+ * @param url The url of a request to BigML
+ * @return The name of the endpoint of the request (ej: model)
+ */
+-(NSString*)endpointForURL:(NSString*)url;
+
+/**
+ * Parses the JSON data of a response, recording the duration of the parsing if the metrics are enabled
+ * @param data The JSON data
+ * @param url The url of the request
+ * @return The parsed JSON object, nil if the data is not valid JSON
+ */
+-(id)JSONObjectWithData:(NSData*)data url:(NSString*)url;
+
+/**
+ * @param taskMetrics The metrics collected by the URL loading system for a request
+ * @return The duration of every phase of the request, as defined in ML4iOSMetrics
+ */
+-(NSDictionary*)phasesFromTaskMetrics:(NSURLSessionTaskMetrics*)taskMetrics;
+
+#pragma mark -
+#pragma mark Predictions
+
+/**
+ * @param modelId The identifier of the model
+ * @param name The name of the prediction, nil to use the default one
+ * @param inputData The input data of the prediction, nil for no input data
+ * @return The HTTP body of the request that creates the prediction
+ */
+-(NSString*)predictionBodyWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData;
+
 @end
 
 #pragma mark -
 
 @implementation HTTPCommsManager
 
+@synthesize metrics;
+
+//*******************************************************************************
+//*****************************  CANCELLATION  **********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Cancellation
+
++(void)performRequestsOfOperation:(NSOperation*)operation block:(void (^)(void))block
+{
+    NSMutableDictionary* threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSOperation* previousOperation = threadDictionary[CURRENT_OPERATION_KEY];
+    
+    if(operation != nil)
+        threadDictionary[CURRENT_OPERATION_KEY] = operation;
+    
+    block();
+    
+    //Restored, so nested blocks don't unbind the requests of the outer one
+    if(previousOperation != nil)
+        threadDictionary[CURRENT_OPERATION_KEY] = previousOperation;
+    else
+        [threadDictionary removeObjectForKey:CURRENT_OPERATION_KEY];
+}
+
++(NSOperation*)currentOperation
+{
+    return [[NSThread currentThread] threadDictionary][CURRENT_OPERATION_KEY];
+}
+
 //*******************************************************************************
 //*****************************  PRIVATE METHODS  *******************************
 //*******************************************************************************
@@ -97,21 +361,61 @@
 #pragma mark -
 #pragma mark Helper Methods
 
-- (NSData *)sendSynchronousRequest:(NSURLRequest *)request returningResponse:(NSURLResponse **)response error:(NSError **)error {
-    NSError __block *err = NULL;
-    NSData __block *data;
-    BOOL __block reqProcessed = false;
-    NSURLResponse __block *resp;
-
-    [[[NSURLSession sharedSession] dataTaskWithRequest:request completionHandler:^(NSData * _Nullable _data, NSURLResponse * _Nullable _response, NSError * _Nullable _error) {
-        resp = _response;
-        err = _error;
-        data = _data;
-        reqProcessed = true;
-    }] resume];
-
-    while (!reqProcessed) {
-        [NSThread sleepForTimeInterval:0.02];
+- (NSData *)sendSynchronousRequest:(NSURLRequest *)request returningResponse:(NSURLResponse **)response error:(NSError **)error
+{
+    NSString* endpoint = [self endpointForURL:[[request URL] absoluteString]];
+    
+    NSString* method = [request HTTPMethod];
+    BOOL idempotent = [method isEqualToString:@"GET"] || [method isEqualToString:@"PUT"] || [method isEqualToString:@"DELETE"];
+    
+    NSData* data = nil;
+    NSHTTPURLResponse* resp = nil;
+    NSError* err = nil;
+    
+    for(NSUInteger attempt = 0; ; attempt++)
+    {
+        if(![circuitBreaker allowRequestToEndpoint:endpoint])
+        {
+            data = nil;
+            err = nil;
+            resp = [[NSHTTPURLResponse alloc]initWithURL:[request URL] statusCode:HTTP_SERVICE_UNAVAILABLE HTTPVersion:@"HTTP/1.1" headerFields:nil];
+            break;
+        }
+        
+        resp = nil;
+        err = nil;
+        data = [self sendRequest:request returningResponse:&resp error:&err];
+        
+        NSInteger statusCode = [resp statusCode];
+        
+        //A cancelled request says nothing about the health of the endpoint, but frees the trial of an open circuit
+        if(statusCode == HTTP_CLIENT_CLOSED_REQUEST)
+        {
+            [circuitBreaker releaseTrialForEndpoint:endpoint];
+            break;
+        }
+        
+        BOOL serverError = err != nil || resp == nil || (statusCode >= HTTP_INTERNAL_SERVER_ERROR && statusCode != HTTP_NOT_IMPLEMENTED);
+        
+        [circuitBreaker recordSuccess:!serverError forEndpoint:endpoint];
+        
+        if((!serverError && statusCode != HTTP_TOO_MANY_REQUESTS) || !idempotent || attempt >= maxRetries)
+            break;
+        
+        NSTimeInterval retryAfter = [[resp allHeaderFields][@"Retry-After"]doubleValue];
+        
+        if(![self waitForInterval:[self retryDelayOfAttempt:attempt retryAfter:retryAfter] group:nil])
+        {
+            data = nil;
+            err = nil;
+            resp = [[NSHTTPURLResponse alloc]initWithURL:[request URL] statusCode:HTTP_CLIENT_CLOSED_REQUEST HTTPVersion:@"HTTP/1.1" headerFields:nil];
+            break;
+        }
+        
+        @synchronized(self)
+        {
+            retries++;
+        }
     }
     
     if (response != nil)
@@ -121,10 +425,157 @@
     return data;
 }
 
+-(NSTimeInterval)retryDelayOfAttempt:(NSUInteger)attempt retryAfter:(NSTimeInterval)retryAfter
+{
+    //Full jitter, so clients that failed at the same time don't retry at the same time
+    NSTimeInterval backoff = MIN(retryBaseDelay * (1 << MIN(attempt, 30)), retryMaxDelay);
+    NSTimeInterval delay = backoff * arc4random_uniform(1001) / 1000.0;
+    
+    return MAX(delay, MIN(retryAfter, retryMaxDelay));
+}
+
+-(BOOL)waitForInterval:(NSTimeInterval)interval group:(dispatch_group_t)group
+{
+    NSOperation* operation = [HTTPCommsManager currentOperation];
+    CancellationObserver* observer = [[CancellationObserver alloc]init];
+    dispatch_semaphore_t semaphore = observer.semaphore;
+    
+    if(group != nil)
+    {
+        dispatch_group_notify(group, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+            dispatch_semaphore_signal(semaphore);
+        });
+    }
+    
+    //Observed before checking, so a cancellation in between still wakes up the thread
+    [operation addObserver:observer forKeyPath:@"isCancelled" options:0 context:NULL];
+    
+    NSTimeInterval deadline = interval == DBL_MAX ? DBL_MAX : [[NSProcessInfo processInfo] systemUptime] + interval;
+    
+    //In slices, so an operation that doesn't notify its cancellation is still noticed
+    for(NSTimeInterval now = [[NSProcessInfo processInfo] systemUptime]; now < deadline && ![operation isCancelled] && (group == nil || dispatch_group_wait(group, DISPATCH_TIME_NOW) != 0); now = [[NSProcessInfo processInfo] systemUptime])
+        dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(MIN(deadline - now, CANCELLATION_SLICE) * NSEC_PER_SEC)));
+    
+    [operation removeObserver:observer forKeyPath:@"isCancelled"];
+    
+    return ![operation isCancelled];
+}
+
+-(NSString*)endpointForURL:(NSString*)url
+{
+    if(![url hasPrefix:apiBaseURL])
+        return nil;
+    
+    //The first path component after the base URL (ej: model in https://bigml.io/andromeda/model/IDENTIFIER)
+    NSString* path = [[url substringFromIndex:[apiBaseURL length]] componentsSeparatedByString:@"?"][0];
+    NSArray* components = [path componentsSeparatedByString:@"/"];
+    
+    return [components count] > 1 ? components[1] : nil;
+}
+
+- (NSData *)sendRequest:(NSURLRequest *)request returningResponse:(NSURLResponse **)response error:(NSError **)error {
+    NSOperation* operation = [HTTPCommsManager currentOperation];
+    
+    //A request of a cancelled operation is not sent
+    if ([operation isCancelled]) {
+        if (response != nil)
+            *response = [[NSHTTPURLResponse alloc]initWithURL:[request URL] statusCode:HTTP_CLIENT_CLOSED_REQUEST HTTPVersion:@"HTTP/1.1" headerFields:nil];
+        if (error != nil)
+            *error = nil;
+        return nil;
+    }
+    
+    id<ML4iOSMetrics> requestMetrics = metrics;
+    NSURLSessionTaskMetrics* taskMetrics = nil;
+    NSHTTPURLResponse* resp = nil;
+    NSError* err = nil;
+    
+    uint64_t traceStart = TraceTimestamp();
+    
+    NSData* data = [transport sendRequest:request operation:operation returningResponse:&resp metrics:(requestMetrics != nil ? &taskMetrics : NULL) error:&err];
+    
+    if ([operation isCancelled] || ([err code] == NSURLErrorCancelled && [[err domain] isEqualToString:NSURLErrorDomain])) {
+        data = nil;
+        resp = [[NSHTTPURLResponse alloc]initWithURL:[request URL] statusCode:HTTP_CLIENT_CLOSED_REQUEST HTTPVersion:@"HTTP/1.1" headerFields:nil];
+    }
+    
+    TraceSpan("http.request", "http", traceStart, 0);
+    
+    if(requestMetrics != nil)
+    {
+        //Transports without URL loading system metrics report the length of the bodies
+        NSURLSessionTaskTransactionMetrics* transaction = [[taskMetrics transactionMetrics] lastObject];
+        int64_t bytesSent = transaction != nil ? [transaction countOfRequestBodyBytesSent] : (int64_t)[[request HTTPBody] length];
+        int64_t bytesReceived = transaction != nil ? [transaction countOfResponseBodyBytesReceived] : (int64_t)[data length];
+        
+        [requestMetrics recordRequestWithEndpoint:[self endpointForURL:[[request URL] absoluteString]]
+                                           method:[request HTTPMethod]
+                                       statusCode:[resp statusCode]
+                                           phases:[self phasesFromTaskMetrics:taskMetrics]
+                                        bytesSent:bytesSent
+                                    bytesReceived:bytesReceived];
+    }
+    
+    if (response != nil)
+        *response = resp;
+    if (error != nil)
+        *error = err;
+    return data;
+}
+
+-(NSDictionary*)phasesFromTaskMetrics:(NSURLSessionTaskMetrics*)taskMetrics
+{
+    NSMutableDictionary* phases = [NSMutableDictionary dictionaryWithCapacity:7];
+    
+    if(taskMetrics == nil)
+        return phases;
+    
+    phases[@"total"] = @([[taskMetrics taskInterval] duration]);
+    
+    //The last transaction is the one that returned the response, previous ones are redirections
+    NSURLSessionTaskTransactionMetrics* transaction = [[taskMetrics transactionMetrics] lastObject];
+    
+    NSDate* starts[] = {[transaction domainLookupStartDate], [transaction connectStartDate], [transaction secureConnectionStartDate], [transaction requestStartDate], [transaction requestEndDate], [transaction responseStartDate]};
+    NSDate* ends[] = {[transaction domainLookupEndDate], [transaction connectEndDate], [transaction secureConnectionEndDate], [transaction requestEndDate], [transaction responseStartDate], [transaction responseEndDate]};
+    NSString* names[] = {@"dns", @"connect", @"tls", @"send", @"server", @"receive"};
+    
+    for(NSUInteger i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if(starts[i] != nil && ends[i] != nil)
+            phases[names[i]] = @([ends[i] timeIntervalSinceDate:starts[i]]);
+    }
+    
+    return phases;
+}
+
+-(id)JSONObjectWithData:(NSData*)data url:(NSString*)url
+{
+    id<ML4iOSMetrics> parsingMetrics = metrics;
+    
+    NSTimeInterval start = parsingMetrics != nil ? [[NSProcessInfo processInfo] systemUptime] : 0;
+    uint64_t traceStart = TraceTimestamp();
+    
+    id object = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+    
+    TraceSpan("json.parse", "json", traceStart, 0);
+    
+    if(parsingMetrics != nil)
+        [parsingMetrics recordParsingWithEndpoint:[self endpointForURL:url] duration:[[NSProcessInfo processInfo] systemUptime] - start bytes:[data length]];
+    
+    return object;
+}
+
 #pragma mark -
 #pragma mark Generic Methods
 
 -(NSDictionary*)createItemWithURL:(NSString*)url body:(NSString*)body statusCode:(NSInteger*)code
+{
+    NSTimeInterval retryAfter = 0;
+    
+    return [self createItemWithURL:url body:body statusCode:code retryAfter:&retryAfter];
+}
+
+-(NSDictionary*)createItemWithURL:(NSString*)url body:(NSString*)body statusCode:(NSInteger*)code retryAfter:(NSTimeInterval*)retryAfter
 {
     NSDictionary* item = nil;
     
@@ -140,9 +591,10 @@
     NSData* responseData = [self sendSynchronousRequest:request returningResponse:&response error:&error];
     
     *code = [response statusCode];
+    *retryAfter = MAX([[response allHeaderFields][@"Retry-After"]doubleValue], 0);
     
     if(*code == HTTP_CREATED && responseData != nil)
-        item = [NSJSONSerialization JSONObjectWithData:responseData options:NSJSONReadingMutableContainers error:&error];
+        item = [self JSONObjectWithData:responseData url:url];
     
     return item;
 }
@@ -165,7 +617,7 @@
     *code = [response statusCode];
     
     if(*code == HTTP_ACCEPTED && responseData != nil)
-        item = [NSJSONSerialization JSONObjectWithData:responseData options:NSJSONReadingMutableContainers error:&error];
+        item = [self JSONObjectWithData:responseData url:url];
     
     return item;
 }
@@ -184,7 +636,7 @@
     return [response statusCode];
 }
 
--(NSDictionary*)getItemWithURL:(NSString*)url statusCode:(NSInteger*)code
+-(NSDictionary*)fetchItemWithURL:(NSString*)url statusCode:(NSInteger*)code
 {
     NSDictionary* item = nil;
     
@@ -198,11 +650,167 @@
     *code = [response statusCode];
     
     if(*code == HTTP_OK && responseData != nil)
-        item = [NSJSONSerialization JSONObjectWithData:responseData options:NSJSONReadingMutableContainers error:&error];
+        item = [self JSONObjectWithData:responseData url:url];
     
     return item;
 }
 
+-(NSDictionary*)fetchItemWithURL:(NSString*)url cacheKey:(NSString*)key revalidate:(BOOL)revalidate statusCode:(NSInteger*)code
+{
+    if(resourceCache == nil)
+        return [self fetchItemWithURL:url statusCode:code];
+    
+    NSDictionary* item = nil;
+    
+    NSString* etag = nil;
+    BOOL fresh = NO;
+    NSData* cachedData = [resourceCache dataForKey:key etag:&etag fresh:&fresh];
+    
+    //FINISHED resources are served from disk without any request while they are fresh, unless the caller revalidates
+    if(cachedData != nil && fresh && !revalidate)
+    {
+        item = [self JSONObjectWithData:cachedData url:url];
+        
+        if(item != nil)
+        {
+            [resourceCache recordHitWithLength:[cachedData length]];
+            *code = HTTP_OK;
+            return item;
+        }
+    }
+    
+    NSError *error = nil;
+    NSHTTPURLResponse *response = nil;
+    
+    //The URL loading system cache is skipped, so the conditional request and its response reach this method
+    NSMutableURLRequest* request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:url] cachePolicy:NSURLRequestReloadIgnoringLocalCacheData timeoutInterval:60];
+    
+    if(cachedData != nil && etag != nil)
+        [request setValue:etag forHTTPHeaderField:@"If-None-Match"];
+    
+    NSData* responseData = [self sendSynchronousRequest:request returningResponse:&response error:&error];
+    
+    *code = [response statusCode];
+    
+    if(*code == HTTP_NOT_MODIFIED && cachedData != nil)
+    {
+        item = [self JSONObjectWithData:cachedData url:url];
+        
+        [resourceCache revalidateDataForKey:key];
+        [resourceCache recordRevalidationWithLength:[cachedData length]];
+        
+        *code = HTTP_OK;
+    }
+    else if(*code == HTTP_OK && responseData != nil)
+    {
+        item = [self JSONObjectWithData:responseData url:url];
+        
+        if(item != nil)
+        {
+            BOOL finished = [item[@"status"][@"code"]intValue] == FINISHED;
+            
+            [resourceCache storeData:responseData etag:[response allHeaderFields][@"ETag"] finished:finished forKey:key];
+            [resourceCache recordMiss];
+        }
+    }
+    else if(*code == HTTP_NOT_FOUND)
+    {
+        [resourceCache removeDataForKey:key];
+    }
+    
+    return item;
+}
+
+-(NSDictionary*)getItemWithURL:(NSString*)url statusCode:(NSInteger*)code
+{
+    return [self coalesceRequestWithKey:url statusCode:code fetch:^NSDictionary*(NSInteger* fetchCode) {
+        return [self fetchItemWithURL:url statusCode:fetchCode];
+    }];
+}
+
+-(NSDictionary*)getItemWithURL:(NSString*)url cacheKey:(NSString*)key revalidate:(BOOL)revalidate statusCode:(NSInteger*)code
+{
+    //A revalidating caller can't share the result of a request that was served from the cache
+    NSString* coalescingKey = revalidate ? [@"revalidate:" stringByAppendingString:url] : url;
+    
+    return [self coalesceRequestWithKey:coalescingKey statusCode:code fetch:^NSDictionary*(NSInteger* fetchCode) {
+        return [self fetchItemWithURL:url cacheKey:key revalidate:revalidate statusCode:fetchCode];
+    }];
+}
+
+-(NSDictionary*)coalesceRequestWithKey:(NSString*)key statusCode:(NSInteger*)code fetch:(NSDictionary* (^)(NSInteger* fetchCode))fetch
+{
+    InFlightRequest* request = nil;
+    BOOL leader = NO;
+    
+    @synchronized(inFlightRequests)
+    {
+        request = inFlightRequests[key];
+        
+        if(request == nil)
+        {
+            request = [[InFlightRequest alloc]init];
+            request.group = dispatch_group_create();
+            dispatch_group_enter(request.group);
+            
+            inFlightRequests[key] = request;
+            leader = YES;
+        }
+        else
+        {
+            request.followers++;
+            coalescedRequests++;
+        }
+    }
+    
+    if(leader)
+    {
+        NSInteger statusCode = 0;
+        NSDictionary* item = fetch(&statusCode);
+        NSUInteger followers = 0;
+        
+        request.item = item;
+        request.statusCode = statusCode;
+        
+        //Removed before waking up the followers, so a later request is sent again and gets fresh data
+        @synchronized(inFlightRequests)
+        {
+            [inFlightRequests removeObjectForKey:key];
+            followers = request.followers;
+        }
+        
+        dispatch_group_leave(request.group);
+        
+        //The followers copy the shared item once it is published, so the first caller can't modify it either
+        *code = statusCode;
+        
+        return followers > 0 ? MutableCopyOfJSONObject(item) : item;
+    }
+    else
+    {
+        //A cancelled follower stops waiting, the first caller still sends the request for the others
+        if(![self waitForInterval:DBL_MAX group:request.group])
+        {
+            @synchronized(inFlightRequests)
+            {
+                request.followers--;
+            }
+            
+            *code = HTTP_CLIENT_CLOSED_REQUEST;
+            
+            return nil;
+        }
+        
+        //The first caller was cancelled, a follower that is still alive sends the request again
+        if(request.statusCode == HTTP_CLIENT_CLOSED_REQUEST && ![[HTTPCommsManager currentOperation] isCancelled])
+            return [self coalesceRequestWithKey:key statusCode:code fetch:fetch];
+    }
+    
+    *code = request.statusCode;
+    
+    return MutableCopyOfJSONObject(request.item);
+}
+
 -(NSDictionary*)listItemsWithURL:(NSString*)url statusCode:(NSInteger*)code
 {
     NSDictionary* items = nil;
@@ -217,7 +825,7 @@
     *code = [response statusCode];
     
     if(*code == HTTP_OK && responseData != nil)
-        items = [NSJSONSerialization JSONObjectWithData:responseData options:NSJSONReadingMutableContainers error:&error];
+        items = [self JSONObjectWithData:responseData url:url];
     
     return items;
 }
@@ -229,6 +837,11 @@
 #pragma mark -
 
 -(HTTPCommsManager*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode
+{
+    return [self initWithUsername:username key:key developmentMode:devMode transport:nil];
+}
+
+-(HTTPCommsManager*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode transport:(id<ML4iOSTransport>)aTransport
 {
     if([username length] > 0 && [key length] > 0)
     {
@@ -245,12 +858,77 @@
                 apiBaseURL = @"https://bigml.io/andromeda";
                 
             authToken = [[NSString alloc]initWithFormat:@"?username=%@;api_key=%@;", apiUsername, apiKey];
+            
+            maxRetries = DEFAULT_MAX_RETRIES;
+            retryBaseDelay = DEFAULT_RETRY_BASE_DELAY;
+            retryMaxDelay = DEFAULT_RETRY_MAX_DELAY;
+            circuitBreaker = [[CircuitBreaker alloc]initWithFailureThreshold:DEFAULT_BREAKER_FAILURE_THRESHOLD openInterval:DEFAULT_BREAKER_OPEN_INTERVAL];
+            
+            inFlightRequests = [[NSMutableDictionary alloc]init];
+            
+            transport = aTransport != nil ? aTransport : [[URLSessionTransport alloc]init];
         }
     }
     
     return self;
 }
 
+//*******************************************************************************
+//*****************************  RESOURCE CACHE  ********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Resource Cache
+
+-(void)enableResourceCacheWithTimeToLive:(NSTimeInterval)timeToLive
+{
+    NSString* cachesDirectory = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    NSString* directory = [[cachesDirectory stringByAppendingPathComponent:@"ML4iOS"] stringByAppendingPathComponent:apiUsername];
+    
+    resourceCache = [[ResourceCache alloc]initWithDirectory:directory timeToLive:timeToLive];
+}
+
+-(NSDictionary*)resourceCacheStatistics
+{
+    return [resourceCache statistics];
+}
+
+//*******************************************************************************
+//******************************  RELIABILITY  **********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Reliability
+
+-(void)setRetryPolicyWithMaxRetries:(NSUInteger)aMaxRetries baseDelay:(NSTimeInterval)baseDelay maxDelay:(NSTimeInterval)maxDelay
+{
+    maxRetries = aMaxRetries;
+    retryBaseDelay = MAX(baseDelay, 0);
+    retryMaxDelay = MAX(maxDelay, retryBaseDelay);
+}
+
+-(void)setCircuitBreakerWithFailureThreshold:(NSUInteger)failureThreshold openInterval:(NSTimeInterval)openInterval
+{
+    circuitBreaker = [[CircuitBreaker alloc]initWithFailureThreshold:failureThreshold openInterval:openInterval];
+}
+
+-(NSDictionary*)reliabilityStatistics
+{
+    NSMutableDictionary* statistics = [NSMutableDictionary dictionaryWithDictionary:[circuitBreaker statistics]];
+    
+    @synchronized(self)
+    {
+        statistics[@"retries"] = @(retries);
+    }
+    
+    @synchronized(inFlightRequests)
+    {
+        statistics[@"coalescedRequests"] = @(coalescedRequests);
+    }
+    
+    return statistics;
+}
+
 //*******************************************************************************
 //******************************  DATA SOURCES  *********************************
 //*******************************************************************************
@@ -259,6 +937,18 @@
 #pragma mark DataSources
 
 -(NSDictionary*)createDataSourceWithName:(NSString*)name filePath:(NSString*)filePath statusCode:(NSInteger*)code
+{
+    return [self createDataSourceWithName:name data:[NSData dataWithContentsOfFile:filePath] statusCode:code];
+}
+
+-(NSDictionary*)createDataSourceWithName:(NSString*)name data:(NSData*)data statusCode:(NSInteger*)code
+{
+    NSTimeInterval retryAfter = 0;
+    
+    return [self createDataSourceWithName:name data:data statusCode:code retryAfter:&retryAfter error:NULL];
+}
+
+-(NSDictionary*)createDataSourceWithName:(NSString*)name data:(NSData*)data statusCode:(NSInteger*)code retryAfter:(NSTimeInterval*)retryAfter error:(NSError**)requestError
 {
     NSDictionary* createdDataSource = nil;
     
@@ -275,7 +965,7 @@
     [postbody appendData:[[NSString stringWithFormat:@"\r\n--%@\r\n",boundary] dataUsingEncoding:NSUTF8StringEncoding]];
     [postbody appendData:[[NSString stringWithFormat:@"Content-Disposition: form-data; name=\"userfile\"; filename=\"%@\"\r\n", name] dataUsingEncoding:NSUTF8StringEncoding]];
     [postbody appendData:[@"Content-Type: application/octet-stream\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding]];
-    [postbody appendData:[NSData dataWithContentsOfFile:filePath]];
+    [postbody appendData:data];
     [postbody appendData:[[NSString stringWithFormat:@"\r\n--%@--\r\n",boundary] dataUsingEncoding:NSUTF8StringEncoding]];
     [request setHTTPBody:postbody];
     
@@ -285,13 +975,91 @@
     NSData *responseData = [self sendSynchronousRequest:request returningResponse:&response error:&error];
     
     *code = [response statusCode];
+    *retryAfter = MAX([[response allHeaderFields][@"Retry-After"]doubleValue], 0);
+    
+    if(requestError != NULL)
+        *requestError = error;
     
     if((*code == HTTP_CREATED) && responseData != nil)
-        createdDataSource = [NSJSONSerialization JSONObjectWithData:responseData options:NSJSONReadingMutableContainers error:&error];
+        createdDataSource = [self JSONObjectWithData:responseData url:urlString];
     
     return createdDataSource;
 }
 
+-(NSArray*)createDataSourcesWithUpload:(ChunkedUpload*)upload statusCode:(NSInteger*)code
+{
+    NSInteger __block lastFailedStatusCode = 0;
+    
+    //Only the chunks not acknowledged in previous passes are uploaded
+    NSOperationQueue* uploadQueue = [[NSOperationQueue alloc]init];
+    [uploadQueue setMaxConcurrentOperationCount:MAX([upload maxConcurrentUploads], 1)];
+    
+    //The chunks are uploaded in other threads, bound to the operation of the caller
+    NSOperation* operation = [HTTPCommsManager currentOperation];
+    
+    for(NSUInteger i = 0; i < [upload numberOfChunks]; i++)
+    {
+        if([upload isChunkAcknowledgedAtIndex:i])
+            continue;
+        
+        [uploadQueue addOperationWithBlock:^{
+            [HTTPCommsManager performRequestsOfOperation:operation block:^{
+                NSData* chunk = [upload dataForChunkAtIndex:i];
+                NSInteger statusCode = 0;
+                NSInteger maxAttempts = MAX([upload maxAttemptsPerChunk], 1);
+                
+                for(NSInteger attempt = 0; chunk != nil && attempt < maxAttempts; attempt++)
+                {
+                    NSTimeInterval retryAfter = 0;
+                    NSError* error = nil;
+                    NSDictionary* dataSource = [self createDataSourceWithName:[upload nameForChunkAtIndex:i] data:chunk statusCode:&statusCode retryAfter:&retryAfter error:&error];
+                    
+                    if(dataSource != nil && statusCode == HTTP_CREATED)
+                    {
+                        [upload acknowledgeChunkAtIndex:i dataSource:dataSource];
+                        return;
+                    }
+                    
+                    //A creation that may have reached the server is never sent again, it could create a duplicate. Only
+                    //the chunks rejected before being processed (429, 503) or that never left the device are retried.
+                    BOOL throttled = statusCode == HTTP_TOO_MANY_REQUESTS || statusCode == HTTP_SERVICE_UNAVAILABLE;
+                    BOOL notSent = statusCode == 0 && RequestWasNotSent(error);
+                    
+                    if((!throttled && !notSent) || attempt + 1 >= maxAttempts)
+                        break;
+                    
+                    if(![self waitForInterval:[self retryDelayOfAttempt:attempt retryAfter:retryAfter] group:nil])
+                    {
+                        statusCode = HTTP_CLIENT_CLOSED_REQUEST;
+                        break;
+                    }
+                    
+                    @synchronized(self)
+                    {
+                        retries++;
+                    }
+                }
+                
+                @synchronized(upload)
+                {
+                    lastFailedStatusCode = statusCode;
+                }
+            }];
+        }];
+    }
+    
+    [uploadQueue waitUntilAllOperationsAreFinished];
+    
+    if([upload isComplete])
+    {
+        *code = HTTP_CREATED;
+        return [upload dataSources];
+    }
+    
+    *code = lastFailedStatusCode;
+    return nil;
+}
+
 -(NSDictionary*)updateDataSourceNameWithId:(NSString*)identifier name:(NSString*)name statusCode:(NSInteger*)code
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_DATASOURCE_URL, identifier, authToken];
@@ -360,6 +1128,8 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_DATASET_URL, identifier, authToken];
     
+    [resourceCache removeDataForKey:[NSString stringWithFormat:@"dataset_%@", identifier]];
+    
     NSMutableString* bodyString = [NSMutableString stringWithCapacity:30];
     [bodyString appendFormat:@"{\"name\":\"%@\"}", name];
     
@@ -370,6 +1140,8 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_DATASET_URL, identifier, authToken];
     
+    [resourceCache removeDataForKey:[NSString stringWithFormat:@"dataset_%@", identifier]];
+    
     return [self deleteItemWithURL:urlString];
 }
 
@@ -394,7 +1166,7 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_DATASET_URL, identifier, authToken];
     
-    return [self getItemWithURL:urlString statusCode:code];
+    return [self getItemWithURL:urlString cacheKey:[NSString stringWithFormat:@"dataset_%@", identifier] revalidate:NO statusCode:code];
 }
 
 //*******************************************************************************
@@ -424,6 +1196,8 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_MODEL_URL, identifier, authToken];
     
+    [resourceCache removeDataForKey:[NSString stringWithFormat:@"model_%@", identifier]];
+    
     NSMutableString* bodyString = [NSMutableString stringWithCapacity:30];
     [bodyString appendFormat:@"{\"name\":\"%@\"}", name];
     
@@ -434,6 +1208,8 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_MODEL_URL, identifier, authToken];
     
+    [resourceCache removeDataForKey:[NSString stringWithFormat:@"model_%@", identifier]];
+    
     return [self deleteItemWithURL:urlString];
 }
 
@@ -455,10 +1231,15 @@
 }
 
 -(NSDictionary*)getModelWithId:(NSString*)identifier statusCode:(NSInteger*)code
+{
+    return [self getModelWithId:identifier revalidate:NO statusCode:code];
+}
+
+-(NSDictionary*)getModelWithId:(NSString*)identifier revalidate:(BOOL)revalidate statusCode:(NSInteger*)code
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_MODEL_URL, identifier, authToken];
     
-    return [self getItemWithURL:urlString statusCode:code];
+    return [self getItemWithURL:urlString cacheKey:[NSString stringWithFormat:@"model_%@", identifier] revalidate:revalidate statusCode:code];
 }
 
 //*******************************************************************************
@@ -489,6 +1270,8 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_CLUSTER_URL, identifier, authToken];
     
+    [resourceCache removeDataForKey:[NSString stringWithFormat:@"cluster_%@", identifier]];
+    
     NSMutableString* bodyString = [NSMutableString stringWithCapacity:30];
     [bodyString appendFormat:@"{\"name\":\"%@\"}", name];
     
@@ -499,6 +1282,8 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_CLUSTER_URL, identifier, authToken];
     
+    [resourceCache removeDataForKey:[NSString stringWithFormat:@"cluster_%@", identifier]];
+    
     return [self deleteItemWithURL:urlString];
 }
 
@@ -523,7 +1308,7 @@
 {
     NSString* urlString = [NSString stringWithFormat:@"%@/%@%@", BIGML_IO_CLUSTER_URL, identifier, authToken];
     
-    return [self getItemWithURL:urlString statusCode:code];
+    return [self getItemWithURL:urlString cacheKey:[NSString stringWithFormat:@"cluster_%@", identifier] revalidate:NO statusCode:code];
 }
 
 //*******************************************************************************
@@ -533,10 +1318,8 @@
 #pragma mark -
 #pragma mark Predictions
 
--(NSDictionary*)createPredictionWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData statusCode:(NSInteger*)code
+-(NSString*)predictionBodyWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData
 {
-    NSString* urlString = [NSString stringWithFormat:@"%@%@", BIGML_IO_PREDICTION_URL, authToken];
-    
     NSMutableString* bodyString = [NSMutableString stringWithCapacity:30];
     [bodyString appendFormat:@"{\"model\":\"model/%@\"", modelId];
     
@@ -550,7 +1333,97 @@
         
     [bodyString appendString:@"}"];
     
-    return [self createItemWithURL:urlString body:bodyString statusCode:code];
+    return bodyString;
+}
+
+-(NSDictionary*)createPredictionWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData statusCode:(NSInteger*)code
+{
+    NSString* urlString = [NSString stringWithFormat:@"%@%@", BIGML_IO_PREDICTION_URL, authToken];
+    
+    return [self createItemWithURL:urlString body:[self predictionBodyWithModelId:modelId name:name inputData:inputData] statusCode:code];
+}
+
+-(NSArray*)createPredictionsWithModelId:(NSString*)modelId name:(NSString*)name inputDataList:(NSArray*)inputDataList maxConcurrentRequests:(NSInteger)maxConcurrentRequests statusCodes:(NSArray**)codes
+{
+    NSString* urlString = [NSString stringWithFormat:@"%@%@", BIGML_IO_PREDICTION_URL, authToken];
+    NSUInteger count = [inputDataList count];
+    
+    //Every row writes only its own slot, so the results keep the order of the input
+    NSMutableArray* predictions = [NSMutableArray arrayWithCapacity:count];
+    NSMutableArray* statusCodes = [NSMutableArray arrayWithCapacity:count];
+    
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        [predictions addObject:[NSNull null]];
+        [statusCodes addObject:@0];
+    }
+    
+    //Date before which no request of the batch is sent, moved forward when BigML asks to slow down
+    NSDate* __block resumeDate = [NSDate distantPast];
+    NSObject* lock = [[NSObject alloc]init];
+    
+    //The requests share the connections of the session, so the queue only bounds the requests in flight
+    NSOperationQueue* batchQueue = [[NSOperationQueue alloc]init];
+    [batchQueue setMaxConcurrentOperationCount:MAX(maxConcurrentRequests, 1)];
+    
+    //The rows are sent in other threads, bound to the operation of the caller
+    NSOperation* operation = [HTTPCommsManager currentOperation];
+    
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        NSObject* row = inputDataList[i];
+        NSString* body = [self predictionBodyWithModelId:modelId name:name inputData:(row != [NSNull null] ? (NSString*)row : nil)];
+        
+        [batchQueue addOperationWithBlock:^{
+            [HTTPCommsManager performRequestsOfOperation:operation block:^{
+                NSDictionary* prediction = nil;
+                NSInteger statusCode = 0;
+                
+                for(NSInteger attempt = 0; attempt < BATCH_MAX_ATTEMPTS_PER_ROW; attempt++)
+                {
+                    NSDate* notBefore = nil;
+                    
+                    @synchronized(lock)
+                    {
+                        notBefore = resumeDate;
+                    }
+                    
+                    //Cancelling the batch wakes up the rows waiting, their next request isn't sent
+                    if([notBefore timeIntervalSinceNow] > 0)
+                        [self waitForInterval:[notBefore timeIntervalSinceNow] group:nil];
+                    
+                    NSTimeInterval retryAfter = 0;
+                    prediction = [self createItemWithURL:urlString body:body statusCode:&statusCode retryAfter:&retryAfter];
+                    
+                    if(statusCode != HTTP_TOO_MANY_REQUESTS && statusCode != HTTP_SERVICE_UNAVAILABLE)
+                        break;
+                    
+                    //Without Retry-After the delay doubles on every attempt of the row
+                    if(retryAfter <= 0)
+                        retryAfter = BATCH_DEFAULT_RETRY_DELAY * (1 << attempt);
+                    
+                    @synchronized(lock)
+                    {
+                        resumeDate = [resumeDate laterDate:[NSDate dateWithTimeIntervalSinceNow:retryAfter]];
+                    }
+                }
+                
+                @synchronized(lock)
+                {
+                    if(prediction != nil && statusCode == HTTP_CREATED)
+                        predictions[i] = prediction;
+                    
+                    statusCodes[i] = @(statusCode);
+                }
+            }];
+        }];
+    }
+    
+    [batchQueue waitUntilAllOperationsAreFinished];
+    
+    *codes = statusCodes;
+    
+    return predictions;
 }
 
 -(NSDictionary*)updatePredictionWithId:(NSString*)identifier name:(NSString*)name statusCode:(NSInteger*)code
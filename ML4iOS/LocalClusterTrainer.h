@@ -0,0 +1,69 @@
+/**
+ *
+ * LocalClusterTrainer.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+@class LocalDataSet;
+
+/**
+ * Trains k-means clusters locally, without uploading the data to BigML.
+ * The numeric fields are scaled by their standard deviation, as BigML does by default, and missing values are replaced
+ * by the mean of the field. The centers are initialized with k-means++ and refined with Lloyd iterations until no
+ * instance changes of cluster. Distances are computed with SIMD vectors and the instances are assigned in parallel.
+ * The clusters have the same format as the ones retrieved from BigML, so local and remote clusters can be used
+ * interchangeably.
+ * A trainer must not be used from several threads at the same time.
+ */
+@interface LocalClusterTrainer : NSObject
+{
+    LocalDataSet* dataSet;
+    uint64_t seed;
+    NSUInteger maximumIterations;
+    
+    uint64_t randomState;
+}
+
+/**
+ * The seed of the generator used to choose the initial centers, 1 by default. The same seed and data always produce the
+ * same clusters.
+ */
+@property (nonatomic) uint64_t seed;
+
+/**
+ * The maximum number of Lloyd iterations, 100 by default
+ */
+@property (nonatomic) NSUInteger maximumIterations;
+
+/**
+ * Initializes the trainer
+ * @param aDataSet The data to train the clusters with
+ */
+-(LocalClusterTrainer*)initWithDataSet:(LocalDataSet*)aDataSet;
+
+/**
+ * Trains a cluster
+ * @param name The name of the cluster
+ * @param k The number of clusters, limited to the number of rows
+ * @return The cluster in the same format as the clusters retrieved from BigML, with a FINISHED status, nil if the data
+ * has no numeric fields or k is lower than 1
+ */
+-(NSDictionary*)trainClusterWithName:(NSString*)name numberOfClusters:(NSInteger)k;
+
+@end
@@ -0,0 +1,383 @@
+/**
+ *
+ * LocalClusterTrainer.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalClusterTrainer.h"
+#import "LocalDataSet.h"
+#import "Constants.h"
+#import <simd/simd.h>
+
+#define DEFAULT_SEED 1
+#define DEFAULT_MAXIMUM_ITERATIONS 100
+
+//Minimum number of rows assigned by every parallel task
+#define MIN_ROWS_PER_CHUNK 1024
+
+static inline double SquaredDistance(const double* point, const double* center, NSUInteger dimensions)
+{
+    simd_double4 sum = 0;
+    NSUInteger i = 0;
+    
+    for(; i + 4 <= dimensions; i += 4)
+    {
+        simd_double4 difference = *(const simd_packed_double4*)(point + i) - *(const simd_packed_double4*)(center + i);
+        sum += difference * difference;
+    }
+    
+    double distance = simd_reduce_add(sum);
+    
+    for(; i < dimensions; i++)
+        distance += (point[i] - center[i]) * (point[i] - center[i]);
+    
+    return distance;
+}
+
+static inline uint32_t NearestCenter(const double* point, const double* centers, NSUInteger k, NSUInteger dimensions, double* squaredDistance)
+{
+    uint32_t nearest = 0;
+    double nearestDistance = INFINITY;
+    
+    for(NSUInteger c = 0; c < k; c++)
+    {
+        double distance = SquaredDistance(point, centers + c * dimensions, dimensions);
+        
+        if(distance < nearestDistance)
+        {
+            nearest = (uint32_t)c;
+            nearestDistance = distance;
+        }
+    }
+    
+    *squaredDistance = nearestDistance;
+    return nearest;
+}
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalClusterTrainer()
+
+/**
+ * @return A random number uniformly distributed in [0, 1), drawn from the seeded generator
+ */
+-(double)nextRandom;
+
+@end
+
+#pragma mark -
+
+@implementation LocalClusterTrainer
+
+@synthesize seed;
+@synthesize maximumIterations;
+
+-(LocalClusterTrainer*)initWithDataSet:(LocalDataSet*)aDataSet
+{
+    self = [super init];
+    
+    if(self)
+    {
+        dataSet = aDataSet;
+        seed = DEFAULT_SEED;
+        maximumIterations = DEFAULT_MAXIMUM_ITERATIONS;
+    }
+    
+    return self;
+}
+
+-(NSDictionary*)trainClusterWithName:(NSString*)name numberOfClusters:(NSInteger)k
+{
+    NSArray* fieldIds = [dataSet fieldIds];
+    NSMutableArray* inputColumns = [NSMutableArray array];
+    
+    for(NSUInteger column = 0; column < [fieldIds count]; column++)
+        if([dataSet isNumericColumn:column])
+            [inputColumns addObject:@(column)];
+    
+    NSUInteger rows = [dataSet rows];
+    NSUInteger dimensions = [inputColumns count];
+    
+    if(dimensions == 0 || rows == 0 || k < 1)
+        return nil;
+    
+    NSUInteger clusterCount = MIN((NSUInteger)k, rows);
+    
+    //Row major matrix of the scaled values
+    double* points = malloc(rows * dimensions * sizeof(double));
+    double* scales = malloc(dimensions * sizeof(double));
+    
+    for(NSUInteger j = 0; j < dimensions; j++)
+    {
+        const double* values = [dataSet numericColumn:[inputColumns[j] unsignedIntegerValue]];
+        double sum = 0;
+        double squares = 0;
+        NSUInteger count = 0;
+        
+        for(NSUInteger i = 0; i < rows; i++)
+        {
+            if(isnan(values[i]))
+                continue;
+            
+            sum += values[i];
+            squares += values[i] * values[i];
+            count++;
+        }
+        
+        double mean = sum / count;
+        double deviation = sqrt(MAX(squares / count - mean * mean, 0));
+        
+        scales[j] = deviation > 0 ? 1 / deviation : 1;
+        
+        for(NSUInteger i = 0; i < rows; i++)
+            points[i * dimensions + j] = (isnan(values[i]) ? mean : values[i]) * scales[j];
+    }
+    
+    //The rows are split in chunks, assigned in parallel, with the partial sums of the centers of every chunk
+    NSUInteger chunkCount = MAX(MIN((rows + MIN_ROWS_PER_CHUNK - 1) / MIN_ROWS_PER_CHUNK, [[NSProcessInfo processInfo] activeProcessorCount] * 4), 1);
+    NSUInteger rowsPerChunk = (rows + chunkCount - 1) / chunkCount;
+    
+    double* centers = malloc(clusterCount * dimensions * sizeof(double));
+    double* distances = malloc(rows * sizeof(double));
+    uint32_t* assignments = malloc(rows * sizeof(uint32_t));
+    double* partialSums = malloc(chunkCount * clusterCount * dimensions * sizeof(double));
+    NSUInteger* partialCounts = malloc(chunkCount * clusterCount * sizeof(NSUInteger));
+    NSUInteger* partialChanges = malloc(chunkCount * sizeof(NSUInteger));
+    
+    randomState = seed != 0 ? seed : 0x9E3779B97F4A7C15ULL;
+    
+    //k-means++: every center is chosen with probability proportional to its squared distance to the nearest center
+    NSUInteger first = MIN((NSUInteger)([self nextRandom] * rows), rows - 1);
+    memcpy(centers, points + first * dimensions, dimensions * sizeof(double));
+    
+    for(NSUInteger c = 0; c < clusterCount; c++)
+    {
+        const double* center = centers + c * dimensions;
+        
+        dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunk) {
+            for(NSUInteger i = chunk * rowsPerChunk; i < MIN((chunk + 1) * rowsPerChunk, rows); i++)
+            {
+                double distance = SquaredDistance(points + i * dimensions, center, dimensions);
+                distances[i] = c == 0 ? distance : MIN(distances[i], distance);
+            }
+        });
+        
+        if(c + 1 == clusterCount)
+            break;
+        
+        double total = 0;
+        
+        for(NSUInteger i = 0; i < rows; i++)
+            total += distances[i];
+        
+        double target = [self nextRandom] * total;
+        NSUInteger next = rows - 1;
+        
+        //If every instance is on a center, any instance is chosen
+        for(NSUInteger i = 0; i < rows && total > 0; i++)
+        {
+            target -= distances[i];
+            
+            if(target < 0)
+            {
+                next = i;
+                break;
+            }
+        }
+        
+        if(total == 0)
+            next = MIN((NSUInteger)([self nextRandom] * rows), rows - 1);
+        
+        memcpy(centers + (c + 1) * dimensions, points + next * dimensions, dimensions * sizeof(double));
+    }
+    
+    //Lloyd iterations
+    NSUInteger iterations = 0;
+    
+    for(NSUInteger i = 0; i < rows; i++)
+        assignments[i] = UINT32_MAX;
+    
+    while(iterations < maximumIterations)
+    {
+        memset(partialSums, 0, chunkCount * clusterCount * dimensions * sizeof(double));
+        memset(partialCounts, 0, chunkCount * clusterCount * sizeof(NSUInteger));
+        
+        dispatch_apply(chunkCount, DISPATCH_APPLY_AUTO, ^(size_t chunk) {
+            double* sums = partialSums + chunk * clusterCount * dimensions;
+            NSUInteger* counts = partialCounts + chunk * clusterCount;
+            NSUInteger changes = 0;
+            
+            for(NSUInteger i = chunk * rowsPerChunk; i < MIN((chunk + 1) * rowsPerChunk, rows); i++)
+            {
+                const double* point = points + i * dimensions;
+                uint32_t nearest = NearestCenter(point, centers, clusterCount, dimensions, &distances[i]);
+                
+                if(nearest != assignments[i])
+                {
+                    assignments[i] = nearest;
+                    changes++;
+                }
+                
+                for(NSUInteger j = 0; j < dimensions; j++)
+                    sums[nearest * dimensions + j] += point[j];
+                
+                counts[nearest]++;
+            }
+            
+            partialChanges[chunk] = changes;
+        });
+        
+        iterations++;
+        
+        NSUInteger changes = 0;
+        
+        for(NSUInteger chunk = 0; chunk < chunkCount; chunk++)
+            changes += partialChanges[chunk];
+        
+        if(changes == 0)
+            break;
+        
+        for(NSUInteger c = 0; c < clusterCount; c++)
+        {
+            NSUInteger count = 0;
+            double* center = centers + c * dimensions;
+            
+            memset(center, 0, dimensions * sizeof(double));
+            
+            for(NSUInteger chunk = 0; chunk < chunkCount; chunk++)
+            {
+                count += partialCounts[chunk * clusterCount + c];
+                
+                for(NSUInteger j = 0; j < dimensions; j++)
+                    center[j] += partialSums[(chunk * clusterCount + c) * dimensions + j];
+            }
+            
+            if(count > 0)
+            {
+                for(NSUInteger j = 0; j < dimensions; j++)
+                    center[j] /= count;
+                
+                continue;
+            }
+            
+            //An empty cluster is moved to the instance farthest from its center
+            NSUInteger farthest = 0;
+            
+            for(NSUInteger i = 1; i < rows; i++)
+                if(distances[i] > distances[farthest])
+                    farthest = i;
+            
+            memcpy(center, points + farthest * dimensions, dimensions * sizeof(double));
+            distances[farthest] = 0;
+        }
+    }
+    
+    //The distances of the instances to their centers, and the centers in the units of the fields
+    NSMutableArray* clusters = [NSMutableArray arrayWithCapacity:clusterCount];
+    
+    for(NSUInteger c = 0; c < clusterCount; c++)
+    {
+        NSUInteger count = 0;
+        double sum = 0;
+        double squares = 0;
+        double minimum = INFINITY;
+        double maximum = 0;
+        
+        for(NSUInteger i = 0; i < rows; i++)
+        {
+            if(assignments[i] != c)
+                continue;
+            
+            double distance = sqrt(SquaredDistance(points + i * dimensions, centers + c * dimensions, dimensions));
+            
+            sum += distance;
+            squares += distance * distance;
+            minimum = MIN(minimum, distance);
+            maximum = MAX(maximum, distance);
+            count++;
+        }
+        
+        NSMutableDictionary* center = [NSMutableDictionary dictionaryWithCapacity:dimensions];
+        
+        for(NSUInteger j = 0; j < dimensions; j++)
+            center[fieldIds[[inputColumns[j] unsignedIntegerValue]]] = @(centers[c * dimensions + j] / scales[j]);
+        
+        double mean = count > 0 ? sum / count : 0;
+        
+        [clusters addObject:@{@"id": [NSString stringWithFormat:@"%06lx", (unsigned long)c],
+                              @"name": [NSString stringWithFormat:@"Cluster %lu", (unsigned long)c],
+                              @"center": center,
+                              @"count": @(count),
+                              @"distance": @{@"population": @(count),
+                                             @"sum": @(sum),
+                                             @"sum_squares": @(squares),
+                                             @"mean": @(mean),
+                                             @"minimum": @(count > 0 ? minimum : 0),
+                                             @"maximum": @(maximum),
+                                             @"standard_deviation": @(count > 0 ? sqrt(MAX(squares / count - mean * mean, 0)) : 0)}}];
+    }
+    
+    NSMutableArray* inputFields = [NSMutableArray arrayWithCapacity:dimensions];
+    NSMutableDictionary* fields = [NSMutableDictionary dictionaryWithCapacity:dimensions];
+    NSMutableDictionary* fieldScales = [NSMutableDictionary dictionaryWithCapacity:dimensions];
+    
+    for(NSUInteger j = 0; j < dimensions; j++)
+    {
+        NSString* fieldId = fieldIds[[inputColumns[j] unsignedIntegerValue]];
+        
+        [inputFields addObject:fieldId];
+        fields[fieldId] = [dataSet fields][fieldId];
+        fieldScales[fieldId] = @(scales[j]);
+    }
+    
+    free(points);
+    free(scales);
+    free(centers);
+    free(distances);
+    free(assignments);
+    free(partialSums);
+    free(partialCounts);
+    free(partialChanges);
+    
+    NSString* identifier = [[[[NSUUID UUID]UUIDString]stringByReplacingOccurrencesOfString:@"-" withString:@""]lowercaseString];
+    
+    return @{@"resource": [NSString stringWithFormat:@"cluster/%@", [identifier substringToIndex:24]],
+             @"name": name != nil ? name : @"Cluster",
+             @"k": @(clusterCount),
+             @"rows": @(rows),
+             @"input_fields": inputFields,
+             @"scales": fieldScales,
+             @"status": @{@"code": @(FINISHED), @"message": @"The cluster has been created"},
+             @"clusters": @{@"clusters": clusters,
+                            @"fields": fields}};
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(double)nextRandom
+{
+    //xorshift64*
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    
+    return ((randomState * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+@end
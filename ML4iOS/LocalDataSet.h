@@ -0,0 +1,99 @@
+/**
+ *
+ * LocalDataSet.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * The code of a missing value in a categorical column
+ */
+#define MISSING_CATEGORY -1
+
+/**
+ * A CSV file loaded in memory in columnar storage, used to train models and clusters locally.
+ * The first row of the file contains the names of the fields. The type of every field is inferred as in BigML: a
+ * column whose values are all finite decimal numbers is numeric, and any other column is categorical. Every numeric
+ * column is stored as an array of doubles, with NaN for the missing values, and every categorical column as an array
+ * of integer codes of its categories, with MISSING_CATEGORY for the missing values.
+ */
+@interface LocalDataSet : NSObject
+{
+    NSUInteger rows;
+    NSMutableArray* fieldIds;
+    NSMutableDictionary* fields;
+    
+    /**
+     * NSData with the values of every column
+     */
+    NSMutableArray* columns;
+    
+    /**
+     * The categories of every column, in the order of their codes, or NSNull for numeric columns
+     */
+    NSMutableArray* categories;
+}
+
+/**
+ * Loads a CSV file
+ * @param filePath The path of the file
+ * @return The created LocalDataSet object, nil if the file can't be read or it has no rows
+ */
+-(LocalDataSet*)initWithContentsOfCSVFile:(NSString*)filePath;
+
+/**
+ * @return The number of rows, without the header
+ */
+-(NSUInteger)rows;
+
+/**
+ * @return The identifiers of the fields in column order (ej: 000000, 000001, etc)
+ */
+-(NSArray*)fieldIds;
+
+/**
+ * @return The fields in the same format of the fields of a BigML dataset, keyed by field id, with the "name",
+ * "optype", "column_number" and "summary" of every field
+ */
+-(NSDictionary*)fields;
+
+/**
+ * @param column The column number
+ * @return true if the column is numeric, else false
+ */
+-(BOOL)isNumericColumn:(NSUInteger)column;
+
+/**
+ * @param column The column number of a numeric column
+ * @return The values of the column, NaN if missing
+ */
+-(const double*)numericColumn:(NSUInteger)column;
+
+/**
+ * @param column The column number of a categorical column
+ * @return The codes of the values of the column, MISSING_CATEGORY if missing
+ */
+-(const int32_t*)categoricalColumn:(NSUInteger)column;
+
+/**
+ * @param column The column number of a categorical column
+ * @return The categories of the column, in the order of their codes
+ */
+-(NSArray*)categoriesOfColumn:(NSUInteger)column;
+
+@end
@@ -0,0 +1,336 @@
+/**
+ *
+ * LocalDataSet.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalDataSet.h"
+#import "LocalNumberParser.h"
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalDataSet()
+
+/**
+ * Splits a CSV file in records. Fields can be quoted, with quotes escaped by doubling them.
+ * @param data The contents of the file
+ * @return An array with the array of values of every record, without the empty lines
+ */
++(NSArray*)recordsOfCSVData:(NSData*)data;
+
+/**
+ * @param value A value of the CSV file
+ * @return true if the value is any of the tokens BigML considers missing, else false
+ */
++(BOOL)isMissingValue:(NSString*)value;
+
+/**
+ * @param value A value of the CSV file
+ * @param number Returns the value as a number
+ * @return true if the whole value is a number, else false
+ */
++(BOOL)parseNumber:(NSString*)value number:(double*)number;
+
+@end
+
+#pragma mark -
+
+@implementation LocalDataSet
+
+-(LocalDataSet*)initWithContentsOfCSVFile:(NSString*)filePath
+{
+    NSData* data = [NSData dataWithContentsOfFile:filePath];
+    NSArray* records = data != nil ? [LocalDataSet recordsOfCSVData:data] : nil;
+    
+    if([records count] < 2)
+        return nil;
+    
+    self = [super init];
+    
+    if(self)
+    {
+        NSArray* header = records[0];
+        
+        rows = [records count] - 1;
+        fieldIds = [NSMutableArray arrayWithCapacity:[header count]];
+        fields = [NSMutableDictionary dictionaryWithCapacity:[header count]];
+        columns = [NSMutableArray arrayWithCapacity:[header count]];
+        categories = [NSMutableArray arrayWithCapacity:[header count]];
+        
+        for(NSUInteger column = 0; column < [header count]; column++)
+        {
+            NSMutableData* numbers = [NSMutableData dataWithLength:rows * sizeof(double)];
+            double* values = [numbers mutableBytes];
+            BOOL numeric = YES;
+            NSUInteger missing = 0;
+            
+            //The column is numeric if all its values are numbers
+            for(NSUInteger row = 0; row < rows; row++)
+            {
+                NSArray* record = records[row + 1];
+                NSString* value = column < [record count] ? record[column] : @"";
+                
+                if([LocalDataSet isMissingValue:value])
+                {
+                    values[row] = NAN;
+                    missing++;
+                }
+                else if(numeric && ![LocalDataSet parseNumber:value number:&values[row]])
+                    numeric = NO;
+            }
+            
+            NSString* fieldId = [NSString stringWithFormat:@"%06lx", (unsigned long)column];
+            NSMutableDictionary* field = [NSMutableDictionary dictionaryWithCapacity:4];
+            
+            field[@"name"] = header[column];
+            field[@"column_number"] = @(column);
+            
+            if(numeric && missing < rows)
+            {
+                double minimum = INFINITY;
+                double maximum = -INFINITY;
+                double sum = 0;
+                
+                for(NSUInteger row = 0; row < rows; row++)
+                {
+                    if(isnan(values[row]))
+                        continue;
+                    
+                    minimum = MIN(minimum, values[row]);
+                    maximum = MAX(maximum, values[row]);
+                    sum += values[row];
+                }
+                
+                field[@"optype"] = @"numeric";
+                field[@"summary"] = @{@"minimum": @(minimum), @"maximum": @(maximum), @"mean": @(sum / (rows - missing)), @"missing_count": @(missing)};
+                
+                [columns addObject:numbers];
+                [categories addObject:[NSNull null]];
+            }
+            else
+            {
+                NSMutableData* codes = [NSMutableData dataWithLength:rows * sizeof(int32_t)];
+                int32_t* columnCodes = [codes mutableBytes];
+                NSMutableDictionary* codesByCategory = [NSMutableDictionary dictionary];
+                NSMutableArray* columnCategories = [NSMutableArray array];
+                NSMutableArray* categoryCounts = [NSMutableArray array];
+                
+                //The codes are given in order of appearance
+                for(NSUInteger row = 0; row < rows; row++)
+                {
+                    NSArray* record = records[row + 1];
+                    NSString* value = column < [record count] ? record[column] : @"";
+                    
+                    if([LocalDataSet isMissingValue:value])
+                    {
+                        columnCodes[row] = MISSING_CATEGORY;
+                        continue;
+                    }
+                    
+                    NSNumber* code = codesByCategory[value];
+                    
+                    if(code == nil)
+                    {
+                        code = @([columnCategories count]);
+                        codesByCategory[value] = code;
+                        
+                        [columnCategories addObject:value];
+                        [categoryCounts addObject:@0];
+                    }
+                    
+                    columnCodes[row] = [code intValue];
+                    categoryCounts[[code integerValue]] = @([categoryCounts[[code integerValue]]integerValue] + 1);
+                }
+                
+                //The summary lists the categories from the most to the least frequent, as in BigML
+                NSMutableArray* summaryCategories = [NSMutableArray arrayWithCapacity:[columnCategories count]];
+                
+                for(NSUInteger i = 0; i < [columnCategories count]; i++)
+                    [summaryCategories addObject:@[columnCategories[i], categoryCounts[i]]];
+                
+                [summaryCategories sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSArray* category, NSArray* other) {
+                    return [other[1] compare:category[1]];
+                }];
+                
+                field[@"optype"] = @"categorical";
+                field[@"summary"] = @{@"categories": summaryCategories, @"missing_count": @(missing)};
+                
+                [columns addObject:codes];
+                [categories addObject:columnCategories];
+            }
+            
+            fields[fieldId] = field;
+            [fieldIds addObject:fieldId];
+        }
+    }
+    
+    return self;
+}
+
+-(NSUInteger)rows
+{
+    return rows;
+}
+
+-(NSArray*)fieldIds
+{
+    return fieldIds;
+}
+
+-(NSDictionary*)fields
+{
+    return fields;
+}
+
+-(BOOL)isNumericColumn:(NSUInteger)column
+{
+    return categories[column] == [NSNull null];
+}
+
+-(const double*)numericColumn:(NSUInteger)column
+{
+    return [columns[column] bytes];
+}
+
+-(const int32_t*)categoricalColumn:(NSUInteger)column
+{
+    return [columns[column] bytes];
+}
+
+-(NSArray*)categoriesOfColumn:(NSUInteger)column
+{
+    return categories[column] != [NSNull null] ? categories[column] : nil;
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
++(NSArray*)recordsOfCSVData:(NSData*)data
+{
+    const char* bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSUInteger i = 0;
+    
+    NSMutableArray* records = [NSMutableArray array];
+    NSMutableArray* record = [NSMutableArray array];
+    
+    //Skip the UTF-8 byte order mark
+    if(length >= 3 && memcmp(bytes, "\xEF\xBB\xBF", 3) == 0)
+        i = 3;
+    
+    while(i < length)
+    {
+        NSString* value = nil;
+        
+        if(bytes[i] == '"')
+        {
+            NSMutableData* buffer = [NSMutableData data];
+            i++;
+            
+            while(i < length)
+            {
+                const char* quote = memchr(bytes + i, '"', length - i);
+                NSUInteger end = quote != NULL ? quote - bytes : length;
+                
+                [buffer appendBytes:bytes + i length:end - i];
+                i = end + 1;
+                
+                //A doubled quote is an escaped quote, any other one closes the value
+                if(i < length && bytes[i] == '"')
+                {
+                    [buffer appendBytes:"\"" length:1];
+                    i++;
+                }
+                else
+                    break;
+            }
+            
+            //The characters between the closing quote and the separator are ignored
+            while(i < length && bytes[i] != ',' && bytes[i] != '\n' && bytes[i] != '\r')
+                i++;
+            
+            value = [[NSString alloc]initWithData:buffer encoding:NSUTF8StringEncoding];
+        }
+        else
+        {
+            NSUInteger start = i;
+            
+            while(i < length && bytes[i] != ',' && bytes[i] != '\n' && bytes[i] != '\r')
+                i++;
+            
+            value = [[[NSString alloc]initWithBytes:bytes + start length:i - start encoding:NSUTF8StringEncoding] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        }
+        
+        [record addObject:value != nil ? value : @""];
+        
+        if(i < length && bytes[i] == ',')
+        {
+            i++;
+            
+            //A separator at the end of the line is followed by an empty value
+            if(i == length || bytes[i] == '\n' || bytes[i] == '\r')
+                [record addObject:@""];
+            
+            if(i < length && bytes[i] != '\n' && bytes[i] != '\r')
+                continue;
+        }
+        
+        //End of line
+        if(i < length && bytes[i] == '\r')
+            i++;
+        
+        if(i < length && bytes[i] == '\n')
+            i++;
+        
+        if([record count] > 1 || [record[0] length] > 0)
+            [records addObject:record];
+        
+        record = [NSMutableArray array];
+    }
+    
+    return records;
+}
+
++(BOOL)isMissingValue:(NSString*)value
+{
+    static NSSet* missingTokens = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        missingTokens = [NSSet setWithObjects:@"", @"NaN", @"NULL", @"null", @"N/A", @"n/a", @"NA", @"na", @"#N/A", @"-", @"?", @"NIL", @"nil", @"#NULL!", @"#REF!", @"#VALUE!", @"#NUM!", @"#DIV/0", @"#NAME?", nil];
+    });
+    
+    return [missingTokens containsObject:value];
+}
+
++(BOOL)parseNumber:(NSString*)value number:(double*)number
+{
+    const char* string = [value UTF8String];
+    NSUInteger length = strlen(string);
+    
+    //Hexadecimal, infinite and NaN values, which strtod accepts, aren't numbers
+    if(length == 0 || [LocalNumberParser lengthOfUTF8Decimal:string length:length] != length)
+        return NO;
+    
+    *number = [LocalNumberParser valueOfUTF8Decimal:string length:length];
+    
+    //A number too large for a double (ej: 1e999) isn't a finite number either
+    return isfinite(*number);
+}
+
+@end
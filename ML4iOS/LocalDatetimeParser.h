@@ -0,0 +1,45 @@
+/**
+ *
+ * LocalDatetimeParser.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * Parses the values of datetime fields into seconds since 1970, so they can be compared as numbers whatever their
+ * format. ISO 8601 dates and times (ej: 2013-04-21, 2013-04-21T10:30:00.500Z, 2013-04-21 10:30:00+02:00) are parsed by
+ * a fixed format parser without allocating any object. Any other value is parsed with the common date formats
+ * supported by BigML. Values without time zone are in UTC.
+ */
+@interface LocalDatetimeParser : NSObject
+
+/**
+ * @param datetime The value of a datetime field
+ * @return The seconds since 1970 of the value, NaN if it isn't a valid datetime
+ */
++(double)timeIntervalSince1970OfDatetime:(NSString*)datetime;
+
+/**
+ * @param datetime The value of a datetime field encoded in UTF-8, not necessarily null terminated
+ * @param length The length in bytes of the value
+ * @return The seconds since 1970 of the value, NaN if it isn't a valid datetime. An object is only created if the value
+ * isn't an ISO 8601 date.
+ */
++(double)timeIntervalSince1970OfUTF8Datetime:(const char*)datetime length:(NSUInteger)length;
+
+@end
@@ -0,0 +1,242 @@
+/**
+ *
+ * LocalDatetimeParser.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalDatetimeParser.h"
+
+//Maximum length of a datetime parsed by the fixed format parser
+#define MAX_FIXED_LENGTH 64
+
+static inline BOOL ParseDigits(const char* string, NSUInteger count, NSInteger* value)
+{
+    NSInteger result = 0;
+    
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        if(string[i] < '0' || string[i] > '9')
+            return NO;
+        
+        result = result * 10 + (string[i] - '0');
+    }
+    
+    *value = result;
+    return YES;
+}
+
+static inline NSInteger DaysInMonth(NSInteger year, NSInteger month)
+{
+    static const NSInteger days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    BOOL leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+/**
+ * @return The days since 1970-01-01 of a date of the proleptic Gregorian calendar
+ */
+static inline int64_t DaysFromCivil(int64_t year, int64_t month, int64_t day)
+{
+    year -= month <= 2;
+    
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    
+    return era * 146097 + dayOfEra - 719468;
+}
+
+/**
+ * Parses an ISO 8601 date with optional time, fraction of seconds and time zone
+ * @return The seconds since 1970, NaN if the string doesn't have the format
+ */
+static double ParseFixedFormat(const char* string, NSUInteger length)
+{
+    NSInteger year, month, day;
+    NSInteger hour = 0;
+    NSInteger minute = 0;
+    NSInteger offset = 0;
+    double second = 0;
+    
+    if(length < 10 || string[4] != '-' || string[7] != '-' || !ParseDigits(string, 4, &year) || !ParseDigits(string + 5, 2, &month) || !ParseDigits(string + 8, 2, &day))
+        return NAN;
+    
+    if(month < 1 || month > 12 || day < 1 || day > DaysInMonth(year, month))
+        return NAN;
+    
+    NSUInteger i = 10;
+    
+    if(i < length && (string[i] == 'T' || string[i] == ' '))
+    {
+        if(length < i + 6 || string[i + 3] != ':' || !ParseDigits(string + i + 1, 2, &hour) || !ParseDigits(string + i + 4, 2, &minute))
+            return NAN;
+        
+        i += 6;
+        
+        if(i < length && string[i] == ':')
+        {
+            NSInteger wholeSecond;
+            
+            if(length < i + 3 || !ParseDigits(string + i + 1, 2, &wholeSecond))
+                return NAN;
+            
+            second = wholeSecond;
+            i += 3;
+            
+            if(i < length && (string[i] == '.' || string[i] == ','))
+            {
+                NSUInteger start = ++i;
+                double scale = 0.1;
+                
+                for(; i < length && string[i] >= '0' && string[i] <= '9'; i++, scale /= 10)
+                    second += (string[i] - '0') * scale;
+                
+                if(i == start)
+                    return NAN;
+            }
+        }
+        
+        if(hour > 23 || minute > 59 || second >= 61)
+            return NAN;
+        
+        if(i < length && string[i] == 'Z')
+            i++;
+        else if(i < length && (string[i] == '+' || string[i] == '-'))
+        {
+            NSInteger sign = string[i] == '-' ? -1 : 1;
+            NSInteger offsetHours;
+            NSInteger offsetMinutes = 0;
+            
+            if(length < i + 3 || !ParseDigits(string + i + 1, 2, &offsetHours))
+                return NAN;
+            
+            i += 3;
+            
+            if(i < length && string[i] == ':')
+                i++;
+            
+            if(i + 2 <= length && ParseDigits(string + i, 2, &offsetMinutes))
+                i += 2;
+            
+            offset = sign * (offsetHours * 3600 + offsetMinutes * 60);
+        }
+    }
+    
+    if(i != length)
+        return NAN;
+    
+    return DaysFromCivil(year, month, day) * 86400.0 + hour * 3600 + minute * 60 + second - offset;
+}
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalDatetimeParser()
+
+/**
+ * @param datetime The value of a datetime field
+ * @return The seconds since 1970 of the value parsed with the common date formats, NaN if it has none of them
+ */
++(double)timeIntervalSince1970OfFormattedDatetime:(NSString*)datetime;
+
+@end
+
+#pragma mark -
+
+@implementation LocalDatetimeParser
+
++(double)timeIntervalSince1970OfDatetime:(NSString*)datetime
+{
+    if(![datetime isKindOfClass:[NSString class]])
+        return NAN;
+    
+    char buffer[MAX_FIXED_LENGTH];
+    
+    if([datetime getCString:buffer maxLength:sizeof(buffer) encoding:NSASCIIStringEncoding])
+    {
+        double interval = ParseFixedFormat(buffer, strlen(buffer));
+        
+        if(!isnan(interval))
+            return interval;
+    }
+    
+    return [self timeIntervalSince1970OfFormattedDatetime:datetime];
+}
+
++(double)timeIntervalSince1970OfUTF8Datetime:(const char*)datetime length:(NSUInteger)length
+{
+    if(length < MAX_FIXED_LENGTH)
+    {
+        char buffer[MAX_FIXED_LENGTH];
+        
+        memcpy(buffer, datetime, length);
+        buffer[length] = '\0';
+        
+        double interval = ParseFixedFormat(buffer, length);
+        
+        if(!isnan(interval))
+            return interval;
+    }
+    
+    NSString* string = [[NSString alloc]initWithBytes:datetime length:length encoding:NSUTF8StringEncoding];
+    
+    return string != nil ? [self timeIntervalSince1970OfFormattedDatetime:string] : NAN;
+}
+
++(double)timeIntervalSince1970OfFormattedDatetime:(NSString*)datetime
+{
+    //The formatters are thread safe, so they are shared by all the parsers
+    static NSArray* formatters = nil;
+    static dispatch_once_t onceToken;
+    
+    dispatch_once(&onceToken, ^{
+        NSArray* formats = @[@"yyyy-MM-dd'T'HH:mm:ss.SSSZZZZZ", @"yyyy-MM-dd'T'HH:mm:ssZZZZZ", @"yyyy-MM-dd HH:mm:ss.SSS",
+                             @"yyyy/MM/dd HH:mm:ss", @"yyyy/MM/dd", @"MM/dd/yyyy HH:mm:ss", @"MM/dd/yyyy", @"MM/dd/yy",
+                             @"dd-MM-yyyy", @"yyyyMMdd", @"EEE, dd MMM yyyy HH:mm:ss Z", @"EEE MMM dd HH:mm:ss Z yyyy",
+                             @"MMMM dd, yyyy", @"MMM dd, yyyy", @"dd MMMM yyyy", @"dd MMM yyyy"];
+        NSMutableArray* parsers = [NSMutableArray arrayWithCapacity:[formats count]];
+        
+        for(NSString* format in formats)
+        {
+            NSDateFormatter* formatter = [[NSDateFormatter alloc]init];
+            
+            [formatter setLocale:[NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"]];
+            [formatter setTimeZone:[NSTimeZone timeZoneForSecondsFromGMT:0]];
+            [formatter setDateFormat:format];
+            
+            [parsers addObject:formatter];
+        }
+        
+        formatters = parsers;
+    });
+    
+    NSString* trimmed = [datetime stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+    
+    for(NSDateFormatter* formatter in formatters)
+    {
+        NSDate* date = [formatter dateFromString:trimmed];
+        
+        if(date != nil)
+            return [date timeIntervalSince1970];
+    }
+    
+    return NAN;
+}
+
+@end
@@ -0,0 +1,79 @@
+/**
+ *
+ * LocalModelTrainer.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+@class LocalDataSet;
+
+/**
+ * Trains decision tree models locally, without uploading the data to BigML.
+ * The tree is grown splitting every node by the field and threshold, or category, that most reduce the Gini impurity
+ * of the objective field for classifications or its squared error for regressions. Numeric fields are bucketized once
+ * in up to 256 bins by quantiles, so every split is found with one histogram per field and node, and the fields are
+ * searched in parallel. Instances with a missing value in the field of a split stop in the node, as the local
+ * predictions of inputs without the field do.
+ * The models have the same format as the ones created by BigML, so they can be used by LocalPredictiveModel.
+ * A trainer must not be used from several threads at the same time.
+ */
+@interface LocalModelTrainer : NSObject
+{
+    LocalDataSet* dataSet;
+    NSUInteger maximumDepth;
+    NSUInteger minimumSplitInstances;
+    
+    //Training state
+    NSUInteger objectiveColumn;
+    BOOL regression;
+    NSUInteger classCount;
+    NSMutableArray* featureColumns;
+    
+    /**
+     * The bins of every instance and the upper values of the bins of every numeric feature, NSNull for categorical ones
+     */
+    NSMutableArray* featureBins;
+    NSMutableArray* featureEdges;
+}
+
+/**
+ * The maximum depth of the tree, 20 by default
+ */
+@property (nonatomic) NSUInteger maximumDepth;
+
+/**
+ * The minimum number of instances of a node to be split, 2 by default
+ */
+@property (nonatomic) NSUInteger minimumSplitInstances;
+
+/**
+ * Initializes the trainer
+ * @param aDataSet The data to train the models with
+ */
+-(LocalModelTrainer*)initWithDataSet:(LocalDataSet*)aDataSet;
+
+/**
+ * Trains a model
+ * @param name The name of the model
+ * @param objectiveFieldId The identifier of the field to predict, nil to predict the last field as BigML does
+ * @return The model in the same format as the models retrieved from BigML, with a FINISHED status, nil if the
+ * objective field doesn't exist or it has no values
+ */
+-(NSDictionary*)trainModelWithName:(NSString*)name objectiveFieldId:(NSString*)objectiveFieldId;
+
+@end
@@ -0,0 +1,533 @@
+/**
+ *
+ * LocalModelTrainer.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalModelTrainer.h"
+#import "LocalDataSet.h"
+#import "Constants.h"
+
+#define DEFAULT_MAXIMUM_DEPTH 20
+#define DEFAULT_MINIMUM_SPLIT_INSTANCES 2
+
+//Maximum number of bins of a numeric field, and bin of the missing values
+#define MAX_BINS 256
+#define MISSING_BIN UINT16_MAX
+
+//Nodes with fewer instances times fields are searched serially
+#define MIN_PARALLEL_SEARCH 4096
+
+//Minimum reduction of impurity of a split
+#define MIN_GAIN 1e-9
+
+//Normal quantile of the confidence of the predictions, as in BigML
+#define CONFIDENCE_Z 1.96
+
+/**
+ * The best split of a feature in a node
+ */
+typedef struct
+{
+    double gain;
+    int32_t split;            //Last bin of the instances that go to the first child, or category of the first child
+} SplitCandidate;
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalModelTrainer()
+
+/**
+ * Bucketizes the numeric features by quantiles
+ */
+-(void)bucketizeFeatures;
+
+/**
+ * Grows a node of the tree, and its children recursively
+ * @param instances The rows of the instances of the node
+ * @param count The number of instances of the node
+ * @param predicate The predicate of the node, as in the JSON of the model
+ * @param depth The depth of the node
+ * @return The node, as in the JSON of the model
+ */
+-(NSDictionary*)growNodeWithInstances:(uint32_t*)instances count:(NSUInteger)count predicate:(id)predicate depth:(NSUInteger)depth;
+
+/**
+ * Finds the best split of a feature in a node
+ * @param feature The index of the feature
+ * @param instances The rows of the instances of the node
+ * @param count The number of instances of the node
+ * @return The gain and split, with a gain of 0 if the feature can't split the node
+ */
+-(SplitCandidate)bestSplitOfFeature:(NSUInteger)feature instances:(const uint32_t*)instances count:(NSUInteger)count;
+
+/**
+ * @param feature The index of the feature
+ * @param split The split of the feature
+ * @param row The row of an instance
+ * @return 1 if the instance goes to the first child, 0 if it goes to the second one, -1 if its value is missing
+ */
+-(int)sideOfFeature:(NSUInteger)feature split:(int32_t)split row:(uint32_t)row;
+
+@end
+
+#pragma mark -
+
+@implementation LocalModelTrainer
+
+@synthesize maximumDepth;
+@synthesize minimumSplitInstances;
+
+-(LocalModelTrainer*)initWithDataSet:(LocalDataSet*)aDataSet
+{
+    self = [super init];
+    
+    if(self)
+    {
+        dataSet = aDataSet;
+        maximumDepth = DEFAULT_MAXIMUM_DEPTH;
+        minimumSplitInstances = DEFAULT_MINIMUM_SPLIT_INSTANCES;
+    }
+    
+    return self;
+}
+
+-(NSDictionary*)trainModelWithName:(NSString*)name objectiveFieldId:(NSString*)objectiveFieldId
+{
+    NSArray* fieldIds = [dataSet fieldIds];
+    
+    if(objectiveFieldId == nil)
+        objectiveFieldId = [fieldIds lastObject];
+    
+    objectiveColumn = [fieldIds indexOfObject:objectiveFieldId];
+    
+    if(objectiveColumn == NSNotFound)
+        return nil;
+    
+    regression = [dataSet isNumericColumn:objectiveColumn];
+    classCount = [[dataSet categoriesOfColumn:objectiveColumn] count];
+    
+    //Every field but the objective one is used, if it has any value
+    featureColumns = [NSMutableArray array];
+    
+    for(NSUInteger column = 0; column < [fieldIds count]; column++)
+    {
+        BOOL empty = ![dataSet isNumericColumn:column] && [[dataSet categoriesOfColumn:column] count] == 0;
+        
+        if(column != objectiveColumn && !empty)
+            [featureColumns addObject:@(column)];
+    }
+    
+    [self bucketizeFeatures];
+    
+    //The instances without objective value are not used
+    NSUInteger rows = [dataSet rows];
+    uint32_t* instances = malloc(MAX(rows, 1) * sizeof(uint32_t));
+    NSUInteger count = 0;
+    
+    for(NSUInteger row = 0; row < rows; row++)
+    {
+        BOOL missing = regression ? isnan([dataSet numericColumn:objectiveColumn][row]) : [dataSet categoricalColumn:objectiveColumn][row] == MISSING_CATEGORY;
+        
+        if(!missing)
+            instances[count++] = (uint32_t)row;
+    }
+    
+    NSDictionary* root = count > 0 ? [self growNodeWithInstances:instances count:count predicate:@YES depth:0] : nil;
+    
+    free(instances);
+    featureBins = nil;
+    featureEdges = nil;
+    
+    if(root == nil)
+        return nil;
+    
+    NSMutableArray* inputFields = [NSMutableArray arrayWithCapacity:[featureColumns count]];
+    
+    for(NSNumber* column in featureColumns)
+        [inputFields addObject:fieldIds[[column unsignedIntegerValue]]];
+    
+    NSString* identifier = [[[[NSUUID UUID]UUIDString]stringByReplacingOccurrencesOfString:@"-" withString:@""]lowercaseString];
+    
+    return @{@"resource": [NSString stringWithFormat:@"model/%@", [identifier substringToIndex:24]],
+             @"name": name != nil ? name : @"Model",
+             @"rows": @(count),
+             @"objective_field": objectiveFieldId,
+             @"objective_fields": @[objectiveFieldId],
+             @"input_fields": inputFields,
+             @"status": @{@"code": @(FINISHED), @"message": @"The model has been created"},
+             @"model": @{@"fields": [dataSet fields],
+                         @"root": root,
+                         @"depth_threshold": @(maximumDepth)}};
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(void)bucketizeFeatures
+{
+    NSUInteger rows = [dataSet rows];
+    
+    featureBins = [NSMutableArray arrayWithCapacity:[featureColumns count]];
+    featureEdges = [NSMutableArray arrayWithCapacity:[featureColumns count]];
+    
+    for(NSNumber* column in featureColumns)
+    {
+        if(![dataSet isNumericColumn:[column unsignedIntegerValue]])
+        {
+            [featureBins addObject:[NSNull null]];
+            [featureEdges addObject:[NSNull null]];
+            continue;
+        }
+        
+        const double* values = [dataSet numericColumn:[column unsignedIntegerValue]];
+        double* sorted = malloc(MAX(rows, 1) * sizeof(double));
+        NSUInteger count = 0;
+        
+        for(NSUInteger row = 0; row < rows; row++)
+            if(!isnan(values[row]))
+                sorted[count++] = values[row];
+        
+        qsort_b(sorted, count, sizeof(double), ^int(const void* value, const void* other) {
+            double difference = *(const double*)value - *(const double*)other;
+            return difference < 0 ? -1 : (difference > 0 ? 1 : 0);
+        });
+        
+        NSUInteger distinctCount = 0;
+        
+        for(NSUInteger i = 0; i < count; i++)
+            if(i == 0 || sorted[i] > sorted[i - 1])
+                distinctCount++;
+        
+        //The upper value of every bin: one bin per distinct value if there are few of them, else quantiles
+        NSMutableData* edgesData = [NSMutableData dataWithLength:MAX_BINS * sizeof(double)];
+        double* edges = [edgesData mutableBytes];
+        NSUInteger edgeCount = 0;
+        
+        for(NSUInteger i = 0; i < count && distinctCount <= MAX_BINS; i++)
+            if(i == 0 || sorted[i] > sorted[i - 1])
+                edges[edgeCount++] = sorted[i];
+        
+        for(NSUInteger bin = 1; bin <= MAX_BINS && distinctCount > MAX_BINS; bin++)
+        {
+            double edge = sorted[(bin * count - 1) / MAX_BINS];
+            
+            if(edgeCount == 0 || edge > edges[edgeCount - 1])
+                edges[edgeCount++] = edge;
+        }
+        
+        free(sorted);
+        [edgesData setLength:edgeCount * sizeof(double)];
+        
+        NSMutableData* binsData = [NSMutableData dataWithLength:rows * sizeof(uint16_t)];
+        uint16_t* bins = [binsData mutableBytes];
+        
+        for(NSUInteger row = 0; row < rows; row++)
+        {
+            if(isnan(values[row]))
+            {
+                bins[row] = MISSING_BIN;
+                continue;
+            }
+            
+            //The bin of a value is the first one whose upper value is not lower than it
+            NSUInteger low = 0;
+            NSUInteger high = edgeCount - 1;
+            
+            while(low < high)
+            {
+                NSUInteger middle = (low + high) / 2;
+                
+                if(edges[middle] < values[row])
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            
+            bins[row] = (uint16_t)low;
+        }
+        
+        [featureBins addObject:binsData];
+        [featureEdges addObject:edgesData];
+    }
+}
+
+-(NSDictionary*)growNodeWithInstances:(uint32_t*)instances count:(NSUInteger)count predicate:(id)predicate depth:(NSUInteger)depth
+{
+    NSMutableDictionary* node = [NSMutableDictionary dictionaryWithCapacity:6];
+    BOOL pure = NO;
+    
+    node[@"predicate"] = predicate;
+    node[@"count"] = @(count);
+    
+    //The output is the most frequent class, or the mean of the objective field
+    if(regression)
+    {
+        const double* targets = [dataSet numericColumn:objectiveColumn];
+        double sum = 0;
+        double squares = 0;
+        
+        for(NSUInteger i = 0; i < count; i++)
+        {
+            sum += targets[instances[i]];
+            squares += targets[instances[i]] * targets[instances[i]];
+        }
+        
+        double mean = sum / count;
+        double variance = MAX(squares / count - mean * mean, 0);
+        
+        //The confidence of a regression is the error expected for the prediction
+        node[@"output"] = @(mean);
+        node[@"confidence"] = @(CONFIDENCE_Z * sqrt(variance));
+        pure = variance == 0;
+    }
+    else
+    {
+        const int32_t* classes = [dataSet categoricalColumn:objectiveColumn];
+        NSArray* classNames = [dataSet categoriesOfColumn:objectiveColumn];
+        NSUInteger* classCounts = calloc(classCount, sizeof(NSUInteger));
+        NSUInteger best = 0;
+        
+        for(NSUInteger i = 0; i < count; i++)
+            classCounts[classes[instances[i]]]++;
+        
+        NSMutableArray* summary = [NSMutableArray arrayWithCapacity:classCount];
+        
+        for(NSUInteger i = 0; i < classCount; i++)
+        {
+            if(classCounts[i] > classCounts[best])
+                best = i;
+            
+            if(classCounts[i] > 0)
+                [summary addObject:@[classNames[i], @(classCounts[i])]];
+        }
+        
+        [summary sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSArray* category, NSArray* other) {
+            return [other[1] compare:category[1]];
+        }];
+        
+        //The confidence of a classification is the lower bound of the Wilson score interval of the most frequent class
+        double p = (double)classCounts[best] / count;
+        double z2 = CONFIDENCE_Z * CONFIDENCE_Z;
+        double confidence = (p + z2 / (2 * count) - CONFIDENCE_Z * sqrt((p * (1 - p) + z2 / (4 * count)) / count)) / (1 + z2 / count);
+        
+        node[@"output"] = classNames[best];
+        node[@"confidence"] = @(confidence);
+        node[@"objective_summary"] = @{@"categories": summary};
+        pure = classCounts[best] == count;
+        
+        free(classCounts);
+    }
+    
+    if(pure || depth >= maximumDepth || count < MAX(minimumSplitInstances, 2))
+        return node;
+    
+    //The fields are searched in parallel if the node is large enough
+    NSUInteger featureCount = [featureColumns count];
+    SplitCandidate* candidates = calloc(MAX(featureCount, 1), sizeof(SplitCandidate));
+    
+    void (^search)(size_t) = ^(size_t feature) {
+        candidates[feature] = [self bestSplitOfFeature:feature instances:instances count:count];
+    };
+    
+    if(count * featureCount >= MIN_PARALLEL_SEARCH)
+        dispatch_apply(featureCount, DISPATCH_APPLY_AUTO, search);
+    else
+    {
+        for(NSUInteger feature = 0; feature < featureCount; feature++)
+            search(feature);
+    }
+    
+    NSUInteger bestFeature = NSNotFound;
+    
+    for(NSUInteger feature = 0; feature < featureCount; feature++)
+        if(candidates[feature].gain > MIN_GAIN && (bestFeature == NSNotFound || candidates[feature].gain > candidates[bestFeature].gain))
+            bestFeature = feature;
+    
+    int32_t split = bestFeature != NSNotFound ? candidates[bestFeature].split : 0;
+    free(candidates);
+    
+    if(bestFeature == NSNotFound)
+        return node;
+    
+    //The instances are partitioned in place, the ones with missing values stay at the end
+    NSUInteger firstCount = 0;
+    NSUInteger secondEnd = count;
+    
+    for(NSUInteger i = 0; i < secondEnd;)
+    {
+        int side = [self sideOfFeature:bestFeature split:split row:instances[i]];
+        uint32_t instance = instances[i];
+        
+        if(side == 1)
+        {
+            instances[i] = instances[firstCount];
+            instances[firstCount++] = instance;
+            i++;
+        }
+        else if(side == 0)
+            i++;
+        else
+        {
+            instances[i] = instances[--secondEnd];
+            instances[secondEnd] = instance;
+        }
+    }
+    
+    NSUInteger column = [featureColumns[bestFeature] unsignedIntegerValue];
+    NSString* fieldId = [dataSet fieldIds][column];
+    NSDictionary* firstPredicate = nil;
+    NSDictionary* secondPredicate = nil;
+    
+    if([dataSet isNumericColumn:column])
+    {
+        NSNumber* threshold = @(((const double*)[featureEdges[bestFeature] bytes])[split]);
+        
+        firstPredicate = @{@"field": fieldId, @"operator": @"<=", @"value": threshold};
+        secondPredicate = @{@"field": fieldId, @"operator": @">", @"value": threshold};
+    }
+    else
+    {
+        NSString* category = [dataSet categoriesOfColumn:column][split];
+        
+        firstPredicate = @{@"field": fieldId, @"operator": @"=", @"value": category};
+        secondPredicate = @{@"field": fieldId, @"operator": @"!=", @"value": category};
+    }
+    
+    node[@"children"] = @[[self growNodeWithInstances:instances count:firstCount predicate:firstPredicate depth:depth + 1],
+                          [self growNodeWithInstances:instances + firstCount count:secondEnd - firstCount predicate:secondPredicate depth:depth + 1]];
+    
+    return node;
+}
+
+-(SplitCandidate)bestSplitOfFeature:(NSUInteger)feature instances:(const uint32_t*)instances count:(NSUInteger)count
+{
+    SplitCandidate best = {0, 0};
+    NSUInteger column = [featureColumns[feature] unsignedIntegerValue];
+    BOOL numeric = [dataSet isNumericColumn:column];
+    
+    //Histogram of the objective field by bin or category
+    NSUInteger binCount = numeric ? [featureEdges[feature] length] / sizeof(double) : [[dataSet categoriesOfColumn:column] count];
+    const uint16_t* bins = numeric ? [featureBins[feature] bytes] : NULL;
+    const int32_t* codes = numeric ? NULL : [dataSet categoricalColumn:column];
+    
+    NSUInteger width = regression ? 3 : classCount;
+    double* histogram = calloc(binCount * width, sizeof(double));
+    double* totals = calloc(width, sizeof(double));
+    double* first = calloc(width, sizeof(double));
+    double* second = calloc(width, sizeof(double));
+    
+    const double* targets = regression ? [dataSet numericColumn:objectiveColumn] : NULL;
+    const int32_t* classes = regression ? NULL : [dataSet categoricalColumn:objectiveColumn];
+    
+    for(NSUInteger i = 0; i < count; i++)
+    {
+        uint32_t row = instances[i];
+        NSInteger bin = numeric ? (bins[row] != MISSING_BIN ? bins[row] : -1) : codes[row];
+        
+        if(bin < 0)
+            continue;
+        
+        double* cell = &histogram[bin * width];
+        
+        if(regression)
+        {
+            cell[0] += 1;
+            cell[1] += targets[row];
+            cell[2] += targets[row] * targets[row];
+        }
+        else
+            cell[classes[row]] += 1;
+    }
+    
+    for(NSUInteger bin = 0; bin < binCount; bin++)
+        for(NSUInteger k = 0; k < width; k++)
+            totals[k] += histogram[bin * width + k];
+    
+    //Impurity of a set of instances: squared error for regressions, n times the Gini index for classifications
+    double (^impurity)(const double*) = ^double(const double* cell) {
+        if(self->regression)
+            return cell[0] > 0 ? cell[2] - cell[1] * cell[1] / cell[0] : 0;
+        
+        double n = 0;
+        double squares = 0;
+        
+        for(NSUInteger k = 0; k < width; k++)
+        {
+            n += cell[k];
+            squares += cell[k] * cell[k];
+        }
+        
+        return n > 0 ? n - squares / n : 0;
+    };
+    
+    double totalImpurity = impurity(totals);
+    
+    for(NSUInteger bin = 0; bin < binCount; bin++)
+    {
+        //Numeric splits accumulate the bins up to the threshold, categorical ones take one category
+        for(NSUInteger k = 0; k < width; k++)
+        {
+            first[k] = numeric ? first[k] + histogram[bin * width + k] : histogram[bin * width + k];
+            second[k] = totals[k] - first[k];
+        }
+        
+        double firstCount = 0;
+        double secondCount = 0;
+        
+        for(NSUInteger k = 0; k < (regression ? 1 : width); k++)
+        {
+            firstCount += first[k];
+            secondCount += second[k];
+        }
+        
+        if(firstCount == 0 || secondCount == 0)
+            continue;
+        
+        double gain = totalImpurity - impurity(first) - impurity(second);
+        
+        if(gain > best.gain)
+        {
+            best.gain = gain;
+            best.split = (int32_t)bin;
+        }
+    }
+    
+    free(histogram);
+    free(totals);
+    free(first);
+    free(second);
+    
+    return best;
+}
+
+-(int)sideOfFeature:(NSUInteger)feature split:(int32_t)split row:(uint32_t)row
+{
+    NSUInteger column = [featureColumns[feature] unsignedIntegerValue];
+    
+    if([dataSet isNumericColumn:column])
+    {
+        uint16_t bin = ((const uint16_t*)[featureBins[feature] bytes])[row];
+        return bin == MISSING_BIN ? -1 : bin <= split;
+    }
+    
+    int32_t code = [dataSet categoricalColumn:column][row];
+    return code == MISSING_CATEGORY ? -1 : code == split;
+}
+
+@end
@@ -0,0 +1,43 @@
+/**
+ *
+ * LocalNumberParser.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * Parses decimal numbers as NSString doubleValue does: an optional sign, digits with an optional fraction (ej: 07, +1,
+ * .5, 2.) and an optional exponent. Unlike strtod, hexadecimal, infinite and NaN values aren't numbers.
+ */
+@interface LocalNumberParser : NSObject
+
+/**
+ * @param decimal A string encoded in UTF-8, not necessarily null terminated
+ * @param length The length in bytes of the string
+ * @return The length of the decimal number at the start of the string, 0 if it doesn't start with a number
+ */
++(NSUInteger)lengthOfUTF8Decimal:(const char*)decimal length:(NSUInteger)length;
+
+/**
+ * @param decimal A string encoded in UTF-8, not necessarily null terminated
+ * @param length The length in bytes of the string
+ * @return The decimal number at the start of the string after any whitespace, 0 if it doesn't start with a number
+ */
++(double)valueOfUTF8Decimal:(const char*)decimal length:(NSUInteger)length;
+
+@end
@@ -0,0 +1,106 @@
+/**
+ *
+ * LocalNumberParser.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalNumberParser.h"
+
+static inline const char* SkipDigits(const char* p, const char* end)
+{
+    while(p < end && *p >= '0' && *p <= '9')
+        p++;
+    
+    return p;
+}
+
+@implementation LocalNumberParser
+
++(NSUInteger)lengthOfUTF8Decimal:(const char*)decimal length:(NSUInteger)length
+{
+    const char* end = decimal + length;
+    const char* p = decimal;
+    
+    if(p < end && (*p == '-' || *p == '+'))
+        p++;
+    
+    //Leading zeros are allowed, and the integer part can be empty if the fraction isn't
+    const char* digits = p;
+    p = SkipDigits(p, end);
+    
+    BOOL integer = p > digits;
+    BOOL fraction = NO;
+    
+    if(p < end && *p == '.')
+    {
+        const char* fractionDigits = p + 1;
+        const char* fractionEnd = SkipDigits(fractionDigits, end);
+        
+        fraction = fractionEnd > fractionDigits;
+        
+        if(integer || fraction)
+            p = fractionEnd;
+    }
+    
+    if(!integer && !fraction)
+        return 0;
+    
+    //The exponent is only part of the number if it has digits
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* exponent = p + 1;
+        
+        if(exponent < end && (*exponent == '+' || *exponent == '-'))
+            exponent++;
+        
+        const char* exponentEnd = SkipDigits(exponent, end);
+        
+        if(exponentEnd > exponent)
+            p = exponentEnd;
+    }
+    
+    return p - decimal;
+}
+
++(double)valueOfUTF8Decimal:(const char*)decimal length:(NSUInteger)length
+{
+    const char* end = decimal + length;
+    
+    while(decimal < end && (*decimal == ' ' || *decimal == '\t' || *decimal == '\n' || *decimal == '\r'))
+        decimal++;
+    
+    NSUInteger count = [LocalNumberParser lengthOfUTF8Decimal:decimal length:end - decimal];
+    
+    if(count == 0)
+        return 0;
+    
+    //strtod reads up to the end of the copy, which only holds the number
+    char stackBuffer[64];
+    char* buffer = count < sizeof(stackBuffer) ? stackBuffer : malloc(count + 1);
+    
+    memcpy(buffer, decimal, count);
+    buffer[count] = '\0';
+    
+    double number = strtod(buffer, NULL);
+    
+    if(buffer != stackBuffer)
+        free(buffer);
+    
+    return number;
+}
+
+@end
@@ -20,26 +20,131 @@
  */
 #import <Foundation/Foundation.h>
 
-@class Predicate;
+/**
+ * A node of the compiled tree. The nodes are stored in depth first order, so the first child of a node is always the
+ * next one in memory, and the rest of children are linked with nextSibling.
+ */
+typedef struct
+{
+    uint32_t nextSibling;
+    int32_t code;             //Categorical code of the value for = and !=, or slot of the term for text comparisons
+    uint16_t field;           //Index of the field in the tested fields
+    uint8_t predicateOperator;
+    uint8_t hasChildren;
+    double threshold;         //Value for numeric comparisons, seconds since 1970 for datetime ones and count for text ones
+} CompiledNode;
+
+/**
+ * A node of the compact encoding of the tree, 8 bytes long. The thresholds of the comparisons are replaced by their
+ * position in the sorted thresholds of the field, and the input values by the bucket they fall in, so the predicates
+ * compare small integers.
+ */
+typedef struct
+{
+    uint32_t nextSibling : 24;
+    uint32_t predicateOperator : 7;
+    uint32_t hasChildren : 1;
+    uint16_t field;
+    uint16_t value;           //Bucket of the threshold, categorical code for = and !=, or index of the term comparison
+} CompactNode;
+
+/**
+ * An entry of the hash tables used to parse the arguments of the predictions, keyed by UTF-8 strings
+ */
+typedef struct
+{
+    uint64_t hash;
+    uint32_t offset;          //Position of the key in the bytes of the table
+    uint32_t length;          //Length of the key, 0 if the entry is empty
+    int32_t value;
+} ArgumentEntry;
 
 /**
- * A tree that represents a node in the predictive model
+ * The tree of a predictive model compiled into a flat array of nodes.
+ * The children of a node are tested in the order of the model, but if their predicates are mutually exclusive the
+ * order doesn't change the prediction and they are sorted by the number of training instances they received, so the
+ * most probable branch is tested first and laid out right after its parent. The hot path of the tree is contiguous in
+ * memory and, on average, fewer predicates are tested per prediction.
+ * Categorical values are compared as integer codes, datetime values as seconds since 1970, and every input value is
+ * read once per prediction. Texts are tokenized once per prediction, so every text predicate reads the count of its term.
+ * Optionally, large trees can be compiled with the compact encoding, so many more nodes fit in the processor caches.
+ * The arguments of a prediction can be parsed from JSON straight into the values of the tested fields, without
+ * creating a dictionary or any string for numeric, categorical or ISO 8601 datetime values.
  */
 @interface LocalPredictionTree : NSObject
 {
-    NSDictionary* root;
     NSDictionary* fields;
     NSString* objectiveField;
     
-    NSObject* output;
-    NSObject* confidence;
-    BOOL isPredicate;
-    Predicate* predicate;
-    NSMutableArray* children; //LocalPredictionTree Array
+    CompiledNode* nodes;
+    NSUInteger nodeCount;
+    
+    /**
+     * The nodes with the compact encoding, NULL if the tree uses the compiled nodes
+     */
+    CompactNode* compactNodes;
+    
+    /**
+     * The sorted thresholds of the comparisons on every tested field: NSData with doubles for numeric and datetime
+     * fields, or NSNull if the field is not compared
+     */
+    NSMutableArray* fieldThresholds;
+    
+    /**
+     * The result of the prediction of every node, in the same order as the nodes
+     */
+    NSArray* predictions;
+    
+    /**
+     * The names of the tested fields, the kinds of comparisons done on them and the codes of their categorical values
+     */
+    NSMutableArray* fieldNames;
+    uint8_t* fieldKinds;
+    NSMutableArray* fieldCodes;
+    
+    /**
+     * The tokenizers of the text fields, or NSNull, and the number of terms counted on all of them
+     */
+    NSMutableArray* fieldTokenizers;
+    uint32_t termCount;
+    
+    /**
+     * The comparisons of the counts of terms referenced by the compact nodes, as TermTest structs
+     */
+    NSData* termTests;
+    
+    /**
+     * The hash tables that map the ids and the names of the tested fields to their index, and the categorical values of
+     * every tested field to their code, used to parse the arguments. The keys of all of them are kept in argumentBytes.
+     */
+    ArgumentEntry* argumentIds;
+    NSUInteger argumentIdMask;
+    ArgumentEntry* argumentNames;
+    NSUInteger argumentNameMask;
+    ArgumentEntry** argumentCodes;
+    NSUInteger* argumentCodeMasks;
+    NSData* argumentBytes;
+    
+    /**
+     * The position of every node in the preorder of the root the tree was built from, so the profile is independent of
+     * the layout
+     */
+    uint32_t* modelOrder;
+    
+    /**
+     * The visit counters of every thread that walked the tree while profiling, as NSMutableData with the generation of
+     * the profile followed by the visits of every node. The generation is 0 when profiling is disabled.
+     */
+    NSMutableArray* profileCounters;
+    volatile uint64_t profileGeneration;
+    uint64_t profileGenerations;
+    
+    //Statistics
+    NSUInteger reorderedNodes;
+    double testsPerPrediction;
+    double testsPerPredictionInModelOrder;
 }
 
-@property (nonatomic, strong) Predicate* predicate;
-
 /**
  * Initializes a LocalPredictionTree object
  * @param aRoot A json object that acts as root of this tree
@@ -48,6 +153,16 @@
  */
 -(LocalPredictionTree*)initWithRoot:(NSDictionary*)aRoot fields:(NSDictionary*)aFields objectiveField:(NSString*)aObjectiveField;
 
+/**
+ * Initializes a LocalPredictionTree object
+ * @param aRoot A json object that acts as root of this tree
+ * @param aFields The fields of the predictive model
+ * @param aObjectiveField The objective field id (ej: 0000001, 0000002, etc)
+ * @param compact true to use the compact encoding of the nodes, else false. The compiled nodes are kept if the tree
+ * exceeds the limits of the encoding: 16M nodes, 64K tested fields and 32K thresholds or categorical values per field.
+ */
+-(LocalPredictionTree*)initWithRoot:(NSDictionary*)aRoot fields:(NSDictionary*)aFields objectiveField:(NSString*)aObjectiveField compactEncoding:(BOOL)compact;
+
 /**
  * Create the prediction with current model and input data passed as parameter
  * @param inputData The input data to create the prediction
@@ -55,4 +170,58 @@
  */
 -(NSDictionary*)predict:(NSDictionary*)inputData;
 
+/**
+ * Create the prediction with current model and the arguments passed as parameter
+ * @param args A JSON object with the input data keyed by field id or by field name. The fields that aren't tested by
+ * the tree are skipped, and a repeated field keeps its first value.
+ * @param byName true if the arguments are keyed by field name, false if they are keyed by field id. The keys of the
+ * other kind are skipped.
+ * @return A NSDictionary with the result of the prediction keyed with "value" string and the confidence of the
+ * prediction keyed with "confidence" string. If args isn't a valid JSON object, the prediction is done without input
+ * data.
+ */
+-(NSDictionary*)predictWithArguments:(NSString*)args argsByName:(BOOL)byName;
+
+/**
+ * @return The statistics of the layout of the tree: number of "nodes", number of nodes whose children were sorted by
+ * frequency ("reorderedNodes"), and the average number of predicates tested per prediction, weighted by the training
+ * instances of every node, with the compiled order ("testsPerPrediction") and the order of the model
+ * ("testsPerPredictionInModelOrder"), whether the tree uses the "compactEncoding" and the "bytesPerNode"
+ */
+-(NSDictionary*)layoutStatistics;
+
+/**
+ * @return The estimated bytes taken by the compiled tree: the nodes, the results of their predictions and the tables
+ * of the tested fields
+ */
+-(NSUInteger)footprint;
+
+/**
+ * Enables or disables the profiling of the predictions. While enabled, every thread counts the visits of every node
+ * in its own counters, which are merged when the profile is requested. Enabling it again starts a new profile.
+ * @param enabled true to count the visits of the nodes, else false. The profile is kept when it is disabled.
+ */
+-(void)setProfilingEnabled:(BOOL)enabled;
+
+/**
+ * @return The profile of the predictions: number of "predictions", "averageDepth" of the nodes of the predictions,
+ * "hotPath" from the root following the most visited child (with the "node", its "visits", the "share" of the visits
+ * of its parent and its "output"), "deadBranches" never taken from a visited node, number of "deadNodes", and the
+ * "visits" of every node. The nodes are identified by their position in the preorder of the root the tree was built
+ * from, which for a LocalPredictiveModel is the root compacted by LocalTreeCompactor, not the root of the JSON model.
+ * The profile can be serialized to JSON and used to compile the model again.
+ * @see root:withProfile:
+ */
+-(NSDictionary*)profile;
+
+/**
+ * Replaces the counts of the nodes of a tree with the visits of a profile, so the tree is laid out by the frequency
+ * of the branches in the profiled predictions instead of in the training data
+ * @param root The root the profiled tree was built from, as in the JSON of the model. For a profile of a
+ * LocalPredictiveModel, the root compacted by LocalTreeCompactor.
+ * @param profile The profile of the tree
+ * @return The root with the counts of the profile, nil if the profile doesn't have the "visits" of every node of root
+ */
++(NSDictionary*)root:(NSDictionary*)root withProfile:(NSDictionary*)profile;
+
 @end
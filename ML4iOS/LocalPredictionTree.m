@@ -19,8 +19,11 @@
  * limitations under the License.
  */
 #import "LocalPredictionTree.h"
-#import "Predicate.h"
+#import "LocalDatetimeParser.h"
+#import "LocalNumberParser.h"
+#import "LocalTermTokenizer.h"
 #import "Constants.h"
+#import <objc/runtime.h>
 
 // OP_TYPE
 #define OPTYPE_NUMERIC @"numeric"
@@ -37,143 +40,1851 @@
 #define OPERATOR_GE @">="
 #define OPERATOR_GT @">"
 
+#define NO_NODE UINT32_MAX
+
+//Code of an input value that isn't any of the categorical values of the tree
+#define NO_CODE -1
+
+//Code of a predicate value that no input value can be equal to
+#define NEVER_CODE -2
+
+//The values of the fields are kept in the stack when the tree tests up to this number of fields
+#define MAX_STACK_FIELDS 64
+
+//The counts of the terms are kept in the stack when the tree tests up to this number of terms
+#define MAX_STACK_TERMS 256
+
+//Kinds of comparisons done on a field
+#define FIELD_KIND_NUMERIC 0x01
+#define FIELD_KIND_CATEGORICAL 0x02
+#define FIELD_KIND_DATETIME 0x04
+#define FIELD_KIND_TEXT 0x08
+
+//Limits of the compact encoding
+#define COMPACT_NO_NODE 0xFFFFFF
+#define COMPACT_NO_CODE 0xFFFE
+#define COMPACT_NEVER_CODE 0xFFFF
+#define MAX_FIELD_THRESHOLDS 32767
+
+//Bucket of an input value that can't be compared, as NaN
+#define NO_BUCKET UINT32_MAX
+
+//Arguments up to this length in UTF-8 are parsed in the stack, as strings with escape sequences up to MAX_STACK_STRING
+#define MAX_STACK_ARGUMENTS 1024
+#define MAX_STACK_STRING 256
+
+//Estimated bytes of the immutable dictionary with the result of the prediction of a node
+#define PREDICTION_FOOTPRINT 64
+
+//Key of the profile counters in the dictionaries of the threads
+#define PROFILE_THREAD_KEY @"LocalPredictionTreeProfile"
+
+//FNV-1a hash of the keys of the argument tables
+#define ARGUMENT_HASH_OFFSET 14695981039346656037ULL
+#define ARGUMENT_HASH_PRIME 1099511628211ULL
+
+/**
+ * The operators of the compiled nodes
+ */
+enum
+{
+    CompiledOperatorNone = 0, //Never matches
+    CompiledOperatorLT,
+    CompiledOperatorLE,
+    CompiledOperatorGE,
+    CompiledOperatorGT,
+    CompiledOperatorEQ,
+    CompiledOperatorNE,
+    CompiledOperatorTermLT,   //The term operators compare the number of occurrences of a term
+    CompiledOperatorTermLE,
+    CompiledOperatorTermGE,
+    CompiledOperatorTermGT,
+    CompiledOperatorTermEQ,
+    CompiledOperatorTermNE
+};
+
+/**
+ * A comparison of the count of a term, referenced by the compact nodes
+ */
+typedef struct
+{
+    uint32_t slot;
+    double threshold;
+} TermTest;
+
+/**
+ * The value of a tested field in the input data, read the first time the field is tested in a prediction
+ */
+typedef struct
+{
+    BOOL loaded;
+    BOOL present;
+    int32_t code;
+    double number;
+} FieldValue;
+
+static inline FieldValue* LoadFieldValue(FieldValue* values, uint32_t field, NSDictionary* inputData, NSArray* names, const uint8_t* kinds, NSArray* codes, NSArray* tokenizers, uint32_t* termCounts)
+{
+    FieldValue* fieldValue = &values[field];
+    
+    if(!fieldValue->loaded)
+    {
+        id value = inputData[names[field]];
+        
+        if(value == [NSNull null])
+            value = nil;
+        
+        fieldValue->loaded = YES;
+        fieldValue->present = value != nil;
+        
+        if(value != nil && (kinds[field] & FIELD_KIND_NUMERIC))
+            fieldValue->number = [value doubleValue];
+        
+        //Datetime values are parsed once per prediction and compared as seconds since 1970
+        if(value != nil && (kinds[field] & FIELD_KIND_DATETIME))
+            fieldValue->number = [LocalDatetimeParser timeIntervalSince1970OfDatetime:value];
+        
+        if(value != nil && (kinds[field] & FIELD_KIND_CATEGORICAL))
+        {
+            NSNumber* code = codes[field][value];
+            fieldValue->code = code != nil ? [code intValue] : NO_CODE;
+        }
+        
+        //Texts are tokenized once per prediction, counting all the terms of the field tested by the tree
+        if(value != nil && (kinds[field] & FIELD_KIND_TEXT))
+            [tokenizers[field] countTermsOfText:value counts:termCounts];
+    }
+    
+    return fieldValue;
+}
+
+static inline BOOL NodeMatches(const CompiledNode* node, const FieldValue* fieldValue, const uint32_t* termCounts)
+{
+    switch(node->predicateOperator)
+    {
+        case CompiledOperatorLT:
+            return fieldValue->number < node->threshold;
+        case CompiledOperatorLE:
+            return fieldValue->number <= node->threshold;
+        case CompiledOperatorGE:
+            return fieldValue->number >= node->threshold;
+        case CompiledOperatorGT:
+            return fieldValue->number > node->threshold;
+        case CompiledOperatorEQ:
+            return fieldValue->code == node->code;
+        case CompiledOperatorNE:
+            return fieldValue->code != node->code;
+        case CompiledOperatorTermLT:
+            return termCounts[node->code] < node->threshold;
+        case CompiledOperatorTermLE:
+            return termCounts[node->code] <= node->threshold;
+        case CompiledOperatorTermGE:
+            return termCounts[node->code] >= node->threshold;
+        case CompiledOperatorTermGT:
+            return termCounts[node->code] > node->threshold;
+        case CompiledOperatorTermEQ:
+            return termCounts[node->code] == node->threshold;
+        case CompiledOperatorTermNE:
+            return termCounts[node->code] != node->threshold;
+        default:
+            return NO;
+    }
+}
+
+/**
+ * The value of a tested field in the input data for the compact encoding. For N thresholds of the field, the bucket of
+ * a value is 2i + 1 if it is equal to the threshold i, and 2i if it is between the thresholds i - 1 and i.
+ */
+typedef struct
+{
+    BOOL loaded;
+    BOOL present;
+    uint16_t code;
+    uint32_t bucket;
+} CompactFieldValue;
+
+static inline uint32_t BucketOfNumber(double number, const double* thresholds, NSUInteger count)
+{
+    if(isnan(number))
+        return NO_BUCKET;
+    
+    NSUInteger low = 0;
+    NSUInteger high = count;
+    
+    while(low < high)
+    {
+        NSUInteger middle = (low + high) / 2;
+        
+        if(thresholds[middle] < number)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    
+    return (uint32_t)(2 * low + (low < count && thresholds[low] == number));
+}
+
+static inline CompactFieldValue* LoadCompactFieldValue(CompactFieldValue* values, uint16_t field, NSDictionary* inputData, NSArray* names, const uint8_t* kinds, NSArray* codes, NSArray* thresholds, NSArray* tokenizers, uint32_t* termCounts)
+{
+    CompactFieldValue* fieldValue = &values[field];
+    
+    if(!fieldValue->loaded)
+    {
+        id value = inputData[names[field]];
+        
+        if(value == [NSNull null])
+            value = nil;
+        
+        fieldValue->loaded = YES;
+        fieldValue->present = value != nil;
+        
+        if(value != nil && (kinds[field] & (FIELD_KIND_NUMERIC | FIELD_KIND_DATETIME)))
+        {
+            NSData* fieldThresholds = thresholds[field];
+            double number = (kinds[field] & FIELD_KIND_DATETIME) ? [LocalDatetimeParser timeIntervalSince1970OfDatetime:value] : [value doubleValue];
+            
+            fieldValue->bucket = BucketOfNumber(number, [fieldThresholds bytes], [fieldThresholds length] / sizeof(double));
+        }
+        
+        if(value != nil && (kinds[field] & FIELD_KIND_CATEGORICAL))
+        {
+            NSNumber* code = codes[field][value];
+            fieldValue->code = code != nil ? [code unsignedShortValue] : COMPACT_NO_CODE;
+        }
+        
+        if(value != nil && (kinds[field] & FIELD_KIND_TEXT))
+            [tokenizers[field] countTermsOfText:value counts:termCounts];
+    }
+    
+    return fieldValue;
+}
+
+static inline BOOL CompactNodeMatches(const CompactNode* node, const CompactFieldValue* fieldValue, const TermTest* termTests, const uint32_t* termCounts)
+{
+    switch(node->predicateOperator)
+    {
+        case CompiledOperatorLT:
+            return fieldValue->bucket < node->value;
+        case CompiledOperatorLE:
+            return fieldValue->bucket <= node->value;
+        case CompiledOperatorGE:
+            return fieldValue->bucket >= node->value && fieldValue->bucket != NO_BUCKET;
+        case CompiledOperatorGT:
+            return fieldValue->bucket > node->value && fieldValue->bucket != NO_BUCKET;
+        case CompiledOperatorEQ:
+            return fieldValue->code == node->value;
+        case CompiledOperatorNE:
+            return fieldValue->code != node->value;
+        case CompiledOperatorTermLT:
+            return termCounts[termTests[node->value].slot] < termTests[node->value].threshold;
+        case CompiledOperatorTermLE:
+            return termCounts[termTests[node->value].slot] <= termTests[node->value].threshold;
+        case CompiledOperatorTermGE:
+            return termCounts[termTests[node->value].slot] >= termTests[node->value].threshold;
+        case CompiledOperatorTermGT:
+            return termCounts[termTests[node->value].slot] > termTests[node->value].threshold;
+        case CompiledOperatorTermEQ:
+            return termCounts[termTests[node->value].slot] == termTests[node->value].threshold;
+        case CompiledOperatorTermNE:
+            return termCounts[termTests[node->value].slot] != termTests[node->value].threshold;
+        default:
+            return NO;
+    }
+}
+
+static inline uint64_t HashBytes(const char* bytes, NSUInteger length)
+{
+    uint64_t hash = ARGUMENT_HASH_OFFSET;
+    
+    for(NSUInteger i = 0; i < length; i++)
+        hash = (hash ^ (uint8_t)bytes[i]) * ARGUMENT_HASH_PRIME;
+    
+    return hash;
+}
+
+/**
+ * Builds an argument table
+ * @param keys The values of the table keyed by string, the empty string is skipped
+ * @param bytes The data where the keys are appended
+ * @param mask Returns the mask of the positions of the table
+ * @return The entries of the table
+ */
+static ArgumentEntry* BuildArgumentTable(NSDictionary* keys, NSMutableData* bytes, NSUInteger* mask)
+{
+    NSUInteger capacity = 8;
+    
+    while(capacity < 2 * [keys count])
+        capacity *= 2;
+    
+    ArgumentEntry* entries = calloc(capacity, sizeof(ArgumentEntry));
+    
+    for(NSString* key in keys)
+    {
+        const char* utf8 = [key UTF8String];
+        NSUInteger length = strlen(utf8);
+        
+        if(length == 0)
+            continue;
+        
+        uint64_t hash = HashBytes(utf8, length);
+        NSUInteger i = hash & (capacity - 1);
+        
+        while(entries[i].length != 0)
+            i = (i + 1) & (capacity - 1);
+        
+        entries[i].hash = hash;
+        entries[i].offset = (uint32_t)[bytes length];
+        entries[i].length = (uint32_t)length;
+        entries[i].value = [keys[key] intValue];
+        
+        [bytes appendBytes:utf8 length:length];
+    }
+    
+    *mask = capacity - 1;
+    
+    return entries;
+}
+
+static inline int32_t LookupArgument(const ArgumentEntry* entries, NSUInteger mask, const char* keyBytes, const char* bytes, NSUInteger length, int32_t missing)
+{
+    if(entries == NULL || length == 0)
+        return missing;
+    
+    uint64_t hash = HashBytes(bytes, length);
+    
+    for(NSUInteger i = hash & mask; entries[i].length != 0; i = (i + 1) & mask)
+    {
+        if(entries[i].hash == hash && entries[i].length == length && memcmp(keyBytes + entries[i].offset, bytes, length) == 0)
+            return entries[i].value;
+    }
+    
+    return missing;
+}
+
+static inline const char* SkipWhitespace(const char* p, const char* end)
+{
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+        p++;
+    
+    return p;
+}
+
+/**
+ * Scans a JSON string, without decoding its escape sequences
+ * @param p The position after the opening quote
+ * @param string Returns the start of the contents
+ * @param length Returns the length of the contents
+ * @param escaped Returns true if the contents have escape sequences, else false
+ * @return The position after the closing quote, NULL if the string isn't closed
+ */
+static inline const char* ScanString(const char* p, const char* end, const char** string, NSUInteger* length, BOOL* escaped)
+{
+    const char* start = p;
+    BOOL escapes = NO;
+    
+    while(p < end && *p != '"')
+    {
+        if(*p == '\\')
+        {
+            escapes = YES;
+            p++;
+        }
+        
+        p++;
+    }
+    
+    if(p >= end)
+        return NULL;
+    
+    *string = start;
+    *length = p - start;
+    *escaped = escapes;
+    
+    return p + 1;
+}
+
+static inline BOOL ParseHex(const char* p, NSUInteger available, uint32_t* code)
+{
+    if(available < 4)
+        return NO;
+    
+    uint32_t result = 0;
+    
+    for(NSUInteger i = 0; i < 4; i++)
+    {
+        char c = p[i];
+        uint32_t digit = c >= '0' && c <= '9' ? c - '0' : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : (c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16));
+        
+        if(digit == 16)
+            return NO;
+        
+        result = result * 16 + digit;
+    }
+    
+    *code = result;
+    return YES;
+}
+
+/**
+ * Decodes the escape sequences of the contents of a JSON string into UTF-8, which is never longer than the contents
+ * @param buffer The buffer where the string is decoded and null terminated, of length + 1 bytes at least
+ * @return The length of the decoded string, NSNotFound if an escape sequence isn't valid
+ */
+static NSUInteger UnescapeString(const char* string, NSUInteger length, char* buffer)
+{
+    NSUInteger j = 0;
+    
+    for(NSUInteger i = 0; i < length; i++)
+    {
+        if(string[i] != '\\')
+        {
+            buffer[j++] = string[i];
+            continue;
+        }
+        
+        if(++i == length)
+            return NSNotFound;
+        
+        switch(string[i])
+        {
+            case '"':
+            case '\\':
+            case '/':
+                buffer[j++] = string[i];
+                break;
+            case 'b':
+                buffer[j++] = '\b';
+                break;
+            case 'f':
+                buffer[j++] = '\f';
+                break;
+            case 'n':
+                buffer[j++] = '\n';
+                break;
+            case 'r':
+                buffer[j++] = '\r';
+                break;
+            case 't':
+                buffer[j++] = '\t';
+                break;
+            case 'u':
+            {
+                uint32_t code, low;
+                
+                if(!ParseHex(string + i + 1, length - i - 1, &code))
+                    return NSNotFound;
+                
+                i += 4;
+                
+                //A surrogate pair encodes a character out of the basic multilingual plane
+                if(code >= 0xD800 && code < 0xDC00 && i + 2 < length && string[i + 1] == '\\' && string[i + 2] == 'u' &&
+                   ParseHex(string + i + 3, length - i - 3, &low) && low >= 0xDC00 && low < 0xE000)
+                {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                
+                if(code < 0x80)
+                    buffer[j++] = (char)code;
+                else if(code < 0x800)
+                {
+                    buffer[j++] = (char)(0xC0 | (code >> 6));
+                    buffer[j++] = (char)(0x80 | (code & 0x3F));
+                }
+                else if(code < 0x10000)
+                {
+                    buffer[j++] = (char)(0xE0 | (code >> 12));
+                    buffer[j++] = (char)(0x80 | ((code >> 6) & 0x3F));
+                    buffer[j++] = (char)(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    buffer[j++] = (char)(0xF0 | (code >> 18));
+                    buffer[j++] = (char)(0x80 | ((code >> 12) & 0x3F));
+                    buffer[j++] = (char)(0x80 | ((code >> 6) & 0x3F));
+                    buffer[j++] = (char)(0x80 | (code & 0x3F));
+                }
+                
+                break;
+            }
+            default:
+                return NSNotFound;
+        }
+    }
+    
+    buffer[j] = '\0';
+    
+    return j;
+}
+
+/**
+ * @return The length of the number at the start of a string, following the grammar of the JSON numbers (no hexadecimal,
+ * infinite or NaN values), 0 if it doesn't start with a number
+ */
+static NSUInteger LengthOfNumber(const char* p, const char* end)
+{
+    const char* start = p;
+    
+    if(p < end && *p == '-')
+        p++;
+    
+    if(p == end || *p < '0' || *p > '9')
+        return 0;
+    
+    //A leading zero can't be followed by other digits
+    if(*p == '0')
+        p++;
+    else
+        while(p < end && *p >= '0' && *p <= '9')
+            p++;
+    
+    if(p + 1 < end && *p == '.' && p[1] >= '0' && p[1] <= '9')
+        for(p++; p < end && *p >= '0' && *p <= '9'; p++);
+    
+    if(p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char* exponent = p + 1;
+        
+        if(exponent < end && (*exponent == '+' || *exponent == '-'))
+            exponent++;
+        
+        if(exponent < end && *exponent >= '0' && *exponent <= '9')
+            for(p = exponent; p < end && *p >= '0' && *p <= '9'; p++);
+    }
+    
+    return p - start;
+}
+
+/**
+ * Skips a JSON value of any type
+ * @return The position after the value, NULL if it isn't valid
+ */
+static const char* SkipValue(const char* p, const char* end)
+{
+    NSUInteger depth = 0;
+    
+    do
+    {
+        p = SkipWhitespace(p, end);
+        
+        if(p >= end)
+            return NULL;
+        
+        if(*p == '"')
+        {
+            const char* string;
+            NSUInteger length;
+            BOOL escaped;
+            
+            p = ScanString(p + 1, end, &string, &length, &escaped);
+            
+            if(p == NULL)
+                return NULL;
+        }
+        else if(*p == '{' || *p == '[')
+        {
+            depth++;
+            p++;
+        }
+        else if(*p == '}' || *p == ']')
+        {
+            if(depth == 0)
+                return NULL;
+            
+            depth--;
+            p++;
+        }
+        else if(depth > 0 && (*p == ',' || *p == ':'))
+            p++;
+        else if(end - p >= 4 && (strncmp(p, "true", 4) == 0 || strncmp(p, "null", 4) == 0))
+            p += 4;
+        else if(end - p >= 5 && strncmp(p, "false", 5) == 0)
+            p += 5;
+        else
+        {
+            NSUInteger length = LengthOfNumber(p, end);
+            
+            if(length == 0)
+                return NULL;
+            
+            p += length;
+        }
+    }
+    while(depth > 0);
+    
+    return p;
+}
+
+/**
+ * @return The number at the start of a string after any whitespace, 0 if it doesn't start with a number, as NSString
+ * doubleValue. Leading zeros, a sign and a leading point are allowed (ej: 07, +1, .5), hexadecimal, infinite and NaN
+ * values of strtod are 0.
+ */
+static inline double ParseNumber(const char* string, NSUInteger length)
+{
+    return [LocalNumberParser valueOfUTF8Decimal:string length:length];
+}
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalPredictionTree()
+
+/**
+ * @param node A node of the tree, as in the JSON of the model
+ * @return The number of nodes of the subtree
+ */
+-(NSUInteger)countNodes:(NSDictionary*)node;
+
+/**
+ * Compiles a subtree in depth first order after the last compiled node
+ * @param node The root node of the subtree, as in the JSON of the model
+ * @param modelIndex The position of the node in the preorder of the tree of the model
+ * @param nodePredictions The array where the results of the predictions of the nodes are added
+ * @return The index of the compiled node
+ */
+-(uint32_t)appendNode:(NSDictionary*)node modelIndex:(uint32_t)modelIndex predictions:(NSMutableArray*)nodePredictions;
+
+/**
+ * Compiles the predicate of a node
+ * @param predicate The predicate, as in the JSON of the model
+ * @param compiledNode The node where the operator, field and value are set
+ */
+-(void)compilePredicate:(NSObject*)predicate intoNode:(CompiledNode*)compiledNode;
+
+/**
+ * @param field The field id
+ * @param kind The kind of comparison done on the field
+ * @return The index of the field in the tested fields, added if it wasn't tested yet
+ */
+-(uint32_t)indexOfField:(NSString*)field kind:(uint8_t)kind;
+
+/**
+ * Walks the compiled nodes from the root
+ * @param values The values of the tested fields, loaded from inputData the first time they are tested if they aren't
+ * @param termCounts The counts of the terms of the text fields
+ * @param inputData The input data of the prediction, nil if all the values are loaded
+ * @param visits The visit counters where the nodes walked are counted, NULL if profiling is disabled
+ * @return The index of the node of the prediction
+ */
+-(uint32_t)leafOfValues:(FieldValue*)values termCounts:(uint32_t*)termCounts inputData:(NSDictionary*)inputData visits:(uint64_t*)visits;
+
+/**
+ * Walks the nodes with the compact encoding from the root
+ * @see leafOfValues:termCounts:inputData:visits:
+ */
+-(uint32_t)compactLeafOfValues:(CompactFieldValue*)values termCounts:(uint32_t*)termCounts inputData:(NSDictionary*)inputData visits:(uint64_t*)visits;
+
+/**
+ * @return The first child of a node, NO_NODE if it has no children
+ */
+-(uint32_t)firstChildOfNode:(uint32_t)index;
+
+/**
+ * @return The next sibling of a node, NO_NODE if it is the last child
+ */
+-(uint32_t)nextSiblingOfNode:(uint32_t)index;
+
+/**
+ * @return The visit counters of the nodes for the current thread, created the first time the thread walks the tree
+ * while profiling, NULL if profiling is disabled
+ */
+-(uint64_t*)profileCountersOfCurrentThread;
+
+/**
+ * Copies a subtree of the JSON of a model with the visits of a profile as counts
+ * @param node The root node of the subtree
+ * @param visits The visits of the nodes in preorder
+ * @param position The position of the node in visits, incremented for every node copied
+ * @return The copy, nil if the profile has less nodes than the tree
+ */
++(NSDictionary*)profiledNode:(NSDictionary*)node visits:(NSArray*)visits position:(NSUInteger*)position;
+
+/**
+ * Builds the hash tables of the names, ids and categorical values of the tested fields
+ */
+-(void)buildArgumentTables;
+
+/**
+ * Parses the arguments of a prediction, as a JSON object
+ * @param bytes The arguments in UTF-8, null terminated
+ * @param length The length of the arguments
+ * @param byName true if the arguments are keyed by field name, false if they are keyed by field id
+ * @param values The values of the tested fields, where the arguments found are set as present
+ * @param termCounts The counts of the terms, where the terms of the text arguments are added
+ * @return true if the arguments are a valid JSON object followed by nothing but whitespace, else false
+ */
+-(BOOL)parseArguments:(const char*)bytes length:(NSUInteger)length byName:(BOOL)byName values:(FieldValue*)values termCounts:(uint32_t*)termCounts;
+
+/**
+ * Parses the value of an argument
+ * @param p The position of the value in the arguments
+ * @param end The end of the arguments
+ * @param field The index of the tested field
+ * @return The position after the value, NULL if it isn't valid
+ */
+-(const char*)parseValue:(const char*)p end:(const char*)end field:(uint32_t)field values:(FieldValue*)values termCounts:(uint32_t*)termCounts;
+
+/**
+ * Encodes the compiled nodes with the compact encoding, releasing them
+ * @return true if the tree fits in the limits of the encoding, else false and the compiled nodes are kept
+ */
+-(BOOL)encodeCompactNodes;
+
+/**
+ * Create the prediction walking the nodes with the compact encoding
+ * @param inputData The input data to create the prediction
+ * @return The result of the prediction
+ */
+-(NSDictionary*)predictWithCompactNodes:(NSDictionary*)inputData;
+
+/**
+ * Sorts the children of a node by number of instances, if their predicates are mutually exclusive, and accumulates
+ * the predicates tested to choose among them
+ * @param children The children of the node
+ * @param node The node
+ * @return The children in the order they must be tested
+ */
+-(NSArray*)orderChildren:(NSArray*)children ofNode:(NSDictionary*)node;
+
+/**
+ * @return true if the predicates can't be true at the same time for any input, else false
+ */
+-(BOOL)predicate:(NSDictionary*)predicate excludesPredicate:(NSDictionary*)other;
+
+/**
+ * @param children The children of a node in the order they are tested
+ * @param count The number of instances of the node
+ * @return The number of predicates tested to choose among the children, added for every instance of the node
+ */
++(double)testsToChooseAmongChildren:(NSArray*)children count:(double)count;
+
+@end
+
+#pragma mark -
+
 @implementation LocalPredictionTree
 
-@synthesize predicate;
+-(LocalPredictionTree*)initWithRoot:(NSDictionary*)aRoot fields:(NSDictionary*)aFields objectiveField:(NSString*)aObjectiveField
+{
+    return [self initWithRoot:aRoot fields:aFields objectiveField:aObjectiveField compactEncoding:NO];
+}
+
+-(LocalPredictionTree*)initWithRoot:(NSDictionary*)aRoot fields:(NSDictionary*)aFields objectiveField:(NSString*)aObjectiveField compactEncoding:(BOOL)compact
+{
+    self = [super init];
+    
+    if(self)
+    {
+        fields = aFields;
+        objectiveField = aObjectiveField;
+        
+        fieldNames = [NSMutableArray array];
+        fieldKinds = calloc([fields count] + 1, sizeof(uint8_t));
+        fieldCodes = [NSMutableArray array];
+        fieldTokenizers = [NSMutableArray array];
+        
+        nodeCount = [self countNodes:aRoot];
+        nodes = calloc(nodeCount, sizeof(CompiledNode));
+        modelOrder = calloc(nodeCount, sizeof(uint32_t));
+        
+        NSMutableArray* nodePredictions = [NSMutableArray arrayWithCapacity:nodeCount];
+        nodeCount = 0;
+        
+        [self appendNode:aRoot modelIndex:0 predictions:nodePredictions];
+        predictions = nodePredictions;
+        
+        for(LocalTermTokenizer* tokenizer in fieldTokenizers)
+            if(tokenizer != (id)[NSNull null])
+                [tokenizer buildTermTable];
+        
+        [self buildArgumentTables];
+        
+        //The tests are accumulated once per instance that reaches every node
+        double rootCount = [aRoot[@"count"]doubleValue];
+        
+        testsPerPrediction = rootCount > 0 ? testsPerPrediction / rootCount : 0;
+        testsPerPredictionInModelOrder = rootCount > 0 ? testsPerPredictionInModelOrder / rootCount : 0;
+        
+        if(compact)
+            [self encodeCompactNodes];
+    }
+    
+    return self;
+}
+
+-(void)dealloc
+{
+    free(nodes);
+    free(compactNodes);
+    free(modelOrder);
+    free(fieldKinds);
+    free(argumentIds);
+    free(argumentNames);
+    
+    for(NSUInteger i = 0; argumentCodes != NULL && i < [fieldNames count]; i++)
+        free(argumentCodes[i]);
+    
+    free(argumentCodes);
+    free(argumentCodeMasks);
+}
+
+-(NSDictionary*)predict:(NSDictionary*)inputData
+{
+    if(compactNodes != NULL)
+        return [self predictWithCompactNodes:inputData];
+    
+    NSUInteger fieldCount = [fieldNames count];
+    FieldValue stackValues[MAX_STACK_FIELDS];
+    FieldValue* values = fieldCount <= MAX_STACK_FIELDS ? stackValues : malloc(fieldCount * sizeof(FieldValue));
+    uint32_t stackCounts[MAX_STACK_TERMS];
+    uint32_t* termCounts = termCount <= MAX_STACK_TERMS ? stackCounts : malloc(termCount * sizeof(uint32_t));
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+        values[i].loaded = NO;
+    
+    memset(termCounts, 0, termCount * sizeof(uint32_t));
+    
+    uint32_t index = [self leafOfValues:values termCounts:termCounts inputData:inputData visits:[self profileCountersOfCurrentThread]];
+    
+    if(values != stackValues)
+        free(values);
+    
+    if(termCounts != stackCounts)
+        free(termCounts);
+    
+    return predictions[index];
+}
+
+-(NSDictionary*)predictWithArguments:(NSString*)args argsByName:(BOOL)byName
+{
+    NSUInteger fieldCount = [fieldNames count];
+    FieldValue stackValues[MAX_STACK_FIELDS];
+    FieldValue* values = fieldCount <= MAX_STACK_FIELDS ? stackValues : malloc(fieldCount * sizeof(FieldValue));
+    uint32_t stackCounts[MAX_STACK_TERMS];
+    uint32_t* termCounts = termCount <= MAX_STACK_TERMS ? stackCounts : malloc(termCount * sizeof(uint32_t));
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+    {
+        values[i].loaded = YES;
+        values[i].present = NO;
+    }
+    
+    memset(termCounts, 0, termCount * sizeof(uint32_t));
+    
+    //The arguments are read in place if the string keeps them in UTF-8, else they are copied
+    const char* bytes = args != nil ? CFStringGetCStringPtr((__bridge CFStringRef)args, kCFStringEncodingUTF8) : NULL;
+    char stackBytes[MAX_STACK_ARGUMENTS];
+    char* copiedBytes = NULL;
+    NSUInteger length = 0;
+    
+    if(bytes != NULL)
+        length = strlen(bytes);
+    else if(args != nil)
+    {
+        NSUInteger maximumLength = [args maximumLengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        
+        copiedBytes = maximumLength < MAX_STACK_ARGUMENTS ? stackBytes : malloc(maximumLength + 1);
+        [args getBytes:copiedBytes maxLength:maximumLength usedLength:&length encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, [args length]) remainingRange:NULL];
+        copiedBytes[length] = '\0';
+        
+        bytes = copiedBytes;
+    }
+    
+    //Without valid arguments the prediction is done without input data
+    if(bytes == NULL || ![self parseArguments:bytes length:length byName:byName values:values termCounts:termCounts])
+    {
+        for(NSUInteger i = 0; i < fieldCount; i++)
+            values[i].present = NO;
+        
+        memset(termCounts, 0, termCount * sizeof(uint32_t));
+    }
+    
+    if(copiedBytes != stackBytes)
+        free(copiedBytes);
+    
+    uint32_t index;
+    
+    if(compactNodes != NULL)
+    {
+        CompactFieldValue stackCompactValues[MAX_STACK_FIELDS];
+        CompactFieldValue* compactValues = fieldCount <= MAX_STACK_FIELDS ? stackCompactValues : malloc(fieldCount * sizeof(CompactFieldValue));
+        
+        //The values are converted to the buckets and codes of the compact nodes
+        for(NSUInteger i = 0; i < fieldCount; i++)
+        {
+            CompactFieldValue* compactValue = &compactValues[i];
+            
+            compactValue->loaded = YES;
+            compactValue->present = values[i].present;
+            
+            if(values[i].present && (fieldKinds[i] & (FIELD_KIND_NUMERIC | FIELD_KIND_DATETIME)))
+            {
+                NSData* thresholds = fieldThresholds[i];
+                compactValue->bucket = BucketOfNumber(values[i].number, [thresholds bytes], [thresholds length] / sizeof(double));
+            }
+            
+            if(values[i].present && (fieldKinds[i] & FIELD_KIND_CATEGORICAL))
+                compactValue->code = values[i].code != NO_CODE ? (uint16_t)values[i].code : COMPACT_NO_CODE;
+        }
+        
+        index = [self compactLeafOfValues:compactValues termCounts:termCounts inputData:nil visits:[self profileCountersOfCurrentThread]];
+        
+        if(compactValues != stackCompactValues)
+            free(compactValues);
+    }
+    else
+        index = [self leafOfValues:values termCounts:termCounts inputData:nil visits:[self profileCountersOfCurrentThread]];
+    
+    if(values != stackValues)
+        free(values);
+    
+    if(termCounts != stackCounts)
+        free(termCounts);
+    
+    return predictions[index];
+}
+
+-(NSDictionary*)layoutStatistics
+{
+    return @{@"nodes": @(nodeCount),
+             @"reorderedNodes": @(reorderedNodes),
+             @"testsPerPrediction": @(testsPerPrediction),
+             @"testsPerPredictionInModelOrder": @(testsPerPredictionInModelOrder),
+             @"compactEncoding": @(compactNodes != NULL),
+             @"bytesPerNode": @(compactNodes != NULL ? sizeof(CompactNode) : sizeof(CompiledNode))};
+}
+
+-(NSUInteger)footprint
+{
+    NSUInteger fieldCount = [fieldNames count];
+    NSUInteger bytes = class_getInstanceSize([self class]);
+    
+    bytes += nodeCount * (compactNodes != NULL ? sizeof(CompactNode) : sizeof(CompiledNode));
+    bytes += nodeCount * (sizeof(uint32_t) + PREDICTION_FOOTPRINT);
+    bytes += [termTests length] + [argumentBytes length] + (argumentIdMask + argumentNameMask + 2) * sizeof(ArgumentEntry);
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+    {
+        if(argumentCodes[i] != NULL)
+            bytes += (argumentCodeMasks[i] + 1) * sizeof(ArgumentEntry);
+        
+        if([fieldThresholds[i] isKindOfClass:[NSData class]])
+            bytes += [fieldThresholds[i] length];
+        
+        if([fieldTokenizers[i] isKindOfClass:[LocalTermTokenizer class]])
+            bytes += [fieldTokenizers[i] footprint];
+    }
+    
+    return bytes;
+}
+
+-(void)setProfilingEnabled:(BOOL)enabled
+{
+    @synchronized(self)
+    {
+        //The counters of a previous profile are left behind, and the threads create new ones for the new generation
+        if(enabled)
+        {
+            profileCounters = [NSMutableArray array];
+            profileGeneration = ++profileGenerations;
+        }
+        else
+            profileGeneration = 0;
+    }
+}
+
+-(NSDictionary*)profile
+{
+    uint64_t* visits = calloc(nodeCount, sizeof(uint64_t));
+    
+    //The counters of all the threads are merged, the ones still profiling may be a few visits behind
+    @synchronized(self)
+    {
+        for(NSData* counters in profileCounters)
+        {
+            const uint64_t* threadVisits = (const uint64_t*)[counters bytes] + 1;
+            
+            for(NSUInteger i = 0; i < nodeCount; i++)
+                visits[i] += threadVisits[i];
+        }
+    }
+    
+    NSMutableArray* modelVisits = [NSMutableArray arrayWithCapacity:nodeCount];
+    NSMutableArray* deadBranches = [NSMutableArray array];
+    NSUInteger deadNodes = 0;
+    uint64_t nodeVisits = 0;
+    
+    for(NSUInteger i = 0; i < nodeCount; i++)
+        [modelVisits addObject:@0];
+    
+    for(uint32_t i = 0; i < nodeCount; i++)
+    {
+        modelVisits[modelOrder[i]] = @(visits[i]);
+        
+        if(visits[i] == 0)
+            deadNodes++;
+        
+        if(i > 0)
+            nodeVisits += visits[i];
+        
+        //A dead branch is a child never taken of a node that is visited
+        for(uint32_t child = [self firstChildOfNode:i]; child != NO_NODE && visits[i] > 0; child = [self nextSiblingOfNode:child])
+            if(visits[child] == 0)
+                [deadBranches addObject:@(modelOrder[child])];
+    }
+    
+    //The hot path follows the most visited child from the root
+    NSMutableArray* hotPath = [NSMutableArray array];
+    uint32_t index = 0;
+    
+    while(visits[index] > 0)
+    {
+        uint32_t hottest = NO_NODE;
+        
+        for(uint32_t child = [self firstChildOfNode:index]; child != NO_NODE; child = [self nextSiblingOfNode:child])
+            if(visits[child] > 0 && (hottest == NO_NODE || visits[child] > visits[hottest]))
+                hottest = child;
+        
+        if(hottest == NO_NODE)
+            break;
+        
+        [hotPath addObject:@{@"node": @(modelOrder[hottest]),
+                             @"visits": @(visits[hottest]),
+                             @"share": @((double)visits[hottest] / visits[index]),
+                             @"output": predictions[hottest][@"value"] ?: [NSNull null]}];
+        
+        index = hottest;
+    }
+    
+    [deadBranches sortUsingSelector:@selector(compare:)];
+    
+    uint64_t predictionCount = nodeCount > 0 ? visits[0] : 0;
+    
+    free(visits);
+    
+    return @{@"predictions": @(predictionCount),
+             @"averageDepth": @(predictionCount > 0 ? (double)nodeVisits / predictionCount : 0),
+             @"hotPath": hotPath,
+             @"deadBranches": deadBranches,
+             @"deadNodes": @(deadNodes),
+             @"nodes": @(nodeCount),
+             @"visits": modelVisits};
+}
+
++(NSDictionary*)root:(NSDictionary*)root withProfile:(NSDictionary*)profile
+{
+    NSArray* visits = profile[@"visits"];
+    
+    if(![visits isKindOfClass:[NSArray class]] || [profile[@"nodes"]unsignedIntegerValue] != [visits count])
+        return nil;
+    
+    NSUInteger position = 0;
+    NSDictionary* profiledRoot = [LocalPredictionTree profiledNode:root visits:visits position:&position];
+    
+    //The profile must come from a tree with the same nodes, else its ids point to other nodes
+    return profiledRoot != nil && position == [visits count] ? profiledRoot : nil;
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(NSUInteger)countNodes:(NSDictionary*)node
+{
+    NSUInteger count = 1;
+    
+    for(NSDictionary* child in node[@"children"])
+        count += [self countNodes:child];
+    
+    return count;
+}
+
+-(uint32_t)appendNode:(NSDictionary*)node modelIndex:(uint32_t)modelIndex predictions:(NSMutableArray*)nodePredictions
+{
+    uint32_t index = (uint32_t)nodeCount++;
+    CompiledNode* compiledNode = &nodes[index];
+    
+    modelOrder[index] = modelIndex;
+    
+    compiledNode->nextSibling = NO_NODE;
+    [self compilePredicate:node[@"predicate"] intoNode:compiledNode];
+    
+    //The result of a prediction is the output of the node and the confidence
+    NSMutableDictionary* prediction = [[NSMutableDictionary alloc]initWithCapacity:2];
+    
+    if(node[@"output"] != nil)
+        prediction[@"value"] = node[@"output"];
+    
+    if(node[@"confidence"] != nil)
+        prediction[@"confidence"] = node[@"confidence"];
+    
+    [nodePredictions addObject:[prediction copy]];
+    
+    NSArray* modelChildren = node[@"children"];
+    NSArray* children = [self orderChildren:modelChildren ofNode:node];
+    uint32_t previousChild = NO_NODE;
+    
+    //The positions of the children in the preorder of the model, where every subtree follows its root
+    NSMutableArray* modelIndexes = [NSMutableArray arrayWithCapacity:[modelChildren count]];
+    uint32_t nextModelIndex = modelIndex + 1;
+    
+    for(NSDictionary* child in modelChildren)
+    {
+        [modelIndexes addObject:@(nextModelIndex)];
+        nextModelIndex += [self countNodes:child];
+    }
+    
+    //The first child is laid out right after its parent, followed by its whole subtree
+    for(NSDictionary* child in children)
+    {
+        uint32_t childModelIndex = [modelIndexes[[modelChildren indexOfObjectIdenticalTo:child]] unsignedIntValue];
+        uint32_t childIndex = [self appendNode:child modelIndex:childModelIndex predictions:nodePredictions];
+        
+        if(previousChild != NO_NODE)
+            nodes[previousChild].nextSibling = childIndex;
+        
+        previousChild = childIndex;
+    }
+    
+    nodes[index].hasChildren = [children count] > 0;
+    
+    return index;
+}
+
+-(void)compilePredicate:(NSObject*)predicate intoNode:(CompiledNode*)compiledNode
+{
+    compiledNode->predicateOperator = CompiledOperatorNone;
+    
+    if(![predicate isKindOfClass:[NSDictionary class]])
+        return;
+    
+    NSDictionary* predicateDict = (NSDictionary*)predicate;
+    NSString* field = predicateDict[@"field"];
+    NSString* operator = predicateDict[@"operator"];
+    id value = predicateDict[@"value"];
+    
+    if(fields[field][@"name"] == nil || ![operator isKindOfClass:[NSString class]])
+        return;
+    
+    //Text predicates compare the number of occurrences of a term, counted by the tokenizer of the field
+    NSString* term = predicateDict[@"term"];
+    
+    if(term != nil)
+    {
+        NSArray* termOperators = @[OPERATOR_LT, OPERATOR_LE, OPERATOR_GE, OPERATOR_GT, OPERATOR_EQ, OPERATOR_NE];
+        NSUInteger termOperator = [termOperators indexOfObject:[operator isEqualToString:OPERATOR_NE2] ? OPERATOR_NE : operator];
+        
+        if(![term isKindOfClass:[NSString class]] || termOperator == NSNotFound || ![value respondsToSelector:@selector(doubleValue)])
+            return;
+        
+        compiledNode->field = [self indexOfField:field kind:FIELD_KIND_TEXT];
+        compiledNode->predicateOperator = (uint8_t)(CompiledOperatorTermLT + termOperator);
+        compiledNode->threshold = [value doubleValue];
+        
+        LocalTermTokenizer* tokenizer = fieldTokenizers[compiledNode->field];
+        NSDictionary* termForms = fields[field][@"summary"][@"term_forms"];
+        
+        compiledNode->code = (int32_t)[tokenizer slotOfTerm:term forms:termForms[term] nextSlot:&termCount];
+        
+        return;
+    }
+    
+    if([operator isEqualToString:OPERATOR_EQ] || [operator isEqualToString:OPERATOR_NE] || [operator isEqualToString:OPERATOR_NE2])
+    {
+        compiledNode->field = [self indexOfField:field kind:FIELD_KIND_CATEGORICAL];
+        compiledNode->predicateOperator = [operator isEqualToString:OPERATOR_EQ] ? CompiledOperatorEQ : CompiledOperatorNE;
+        compiledNode->code = NEVER_CODE;
+        
+        //The values of every field are numbered as they are found, so equal strings get the same code
+        if([value isKindOfClass:[NSString class]])
+        {
+            NSMutableDictionary* codes = fieldCodes[compiledNode->field];
+            NSNumber* code = codes[value];
+            
+            if(code == nil)
+            {
+                code = @([codes count]);
+                codes[value] = code;
+            }
+            
+            compiledNode->code = [code intValue];
+        }
+        
+        return;
+    }
+    
+    NSArray* comparisons = @[OPERATOR_LT, OPERATOR_LE, OPERATOR_GE, OPERATOR_GT];
+    NSUInteger comparison = [comparisons indexOfObject:operator];
+    
+    if(comparison == NSNotFound)
+        return;
+    
+    //Datetime thresholds are parsed once, a threshold that isn't a valid datetime never matches
+    if([fields[field][@"optype"] isEqualToString:OPTYPE_DATETIME])
+    {
+        double threshold = [LocalDatetimeParser timeIntervalSince1970OfDatetime:value];
+        
+        if(isnan(threshold))
+            return;
+        
+        compiledNode->field = [self indexOfField:field kind:FIELD_KIND_DATETIME];
+        compiledNode->predicateOperator = (uint8_t)(CompiledOperatorLT + comparison);
+        compiledNode->threshold = threshold;
+    }
+    else if([value respondsToSelector:@selector(doubleValue)])
+    {
+        compiledNode->field = [self indexOfField:field kind:FIELD_KIND_NUMERIC];
+        compiledNode->predicateOperator = (uint8_t)(CompiledOperatorLT + comparison);
+        compiledNode->threshold = [value doubleValue];
+    }
+}
+
+-(uint32_t)indexOfField:(NSString*)field kind:(uint8_t)kind
+{
+    NSString* name = fields[field][@"name"];
+    NSUInteger index = [fieldNames indexOfObject:name];
+    
+    if(index == NSNotFound)
+    {
+        index = [fieldNames count];
+        
+        [fieldNames addObject:name];
+        [fieldCodes addObject:[NSMutableDictionary dictionary]];
+        [fieldTokenizers addObject:[NSNull null]];
+    }
+    
+    if(kind == FIELD_KIND_TEXT && fieldTokenizers[index] == [NSNull null])
+        fieldTokenizers[index] = [[LocalTermTokenizer alloc]initWithTermAnalysis:fields[field][@"term_analysis"]];
+    
+    fieldKinds[index] |= kind;
+    
+    return (uint32_t)index;
+}
 
--(LocalPredictionTree*)initWithRoot:(NSDictionary*)aRoot fields:(NSDictionary*)aFields objectiveField:(NSString*)aObjectiveField
+-(BOOL)encodeCompactNodes
 {
-    self = [super init];
+    NSUInteger fieldCount = [fieldNames count];
     
-    if(self)
+    if(nodeCount >= COMPACT_NO_NODE || fieldCount > UINT16_MAX + 1)
+        return NO;
+    
+    //Collect the thresholds compared on every field
+    NSMutableArray* thresholdSets = [NSMutableArray arrayWithCapacity:fieldCount];
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+        [thresholdSets addObject:[NSMutableSet set]];
+    
+    //The comparisons of the counts of terms are numbered, and the compact nodes reference them
+    NSMutableDictionary* testIndexes = [NSMutableDictionary dictionary];
+    NSMutableData* tests = [NSMutableData data];
+    
+    for(NSUInteger i = 0; i < nodeCount; i++)
     {
-        root = aRoot;
-        fields = aFields;
-        objectiveField = aObjectiveField;
+        const CompiledNode* node = &nodes[i];
+        
+        if(node->predicateOperator >= CompiledOperatorLT && node->predicateOperator <= CompiledOperatorGT)
+            [thresholdSets[node->field] addObject:@(node->threshold)];
+        
+        if(node->predicateOperator >= CompiledOperatorTermLT)
+        {
+            NSArray* key = @[@(node->code), @(node->threshold)];
+            
+            if(testIndexes[key] == nil)
+            {
+                TermTest test = {(uint32_t)node->code, node->threshold};
+                
+                testIndexes[key] = @([testIndexes count]);
+                [tests appendBytes:&test length:sizeof(TermTest)];
+            }
+        }
+    }
+    
+    if([testIndexes count] > UINT16_MAX + 1)
+        return NO;
+    
+    NSMutableArray* tables = [NSMutableArray arrayWithCapacity:fieldCount];
+    NSMutableArray* thresholdIndexes = [NSMutableArray arrayWithCapacity:fieldCount];
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+    {
+        NSArray* sorted = [[thresholdSets[i] allObjects] sortedArrayUsingSelector:@selector(compare:)];
+        
+        if([sorted count] > MAX_FIELD_THRESHOLDS || [fieldCodes[i] count] >= COMPACT_NO_CODE)
+            return NO;
         
-        output = root[@"output"];
-        confidence = root[@"confidence"];
+        NSMutableDictionary* indexes = [NSMutableDictionary dictionaryWithCapacity:[sorted count]];
         
-        NSObject* predicateObj = root[@"predicate"];
+        for(NSUInteger j = 0; j < [sorted count]; j++)
+            indexes[sorted[j]] = @(j);
         
-        //Generate predicate
-        if([predicateObj respondsToSelector:@selector(boolValue)] && [(NSNumber*)predicateObj boolValue] == YES)
-            isPredicate = YES;
+        [thresholdIndexes addObject:indexes];
+        
+        if(fieldKinds[i] & (FIELD_KIND_NUMERIC | FIELD_KIND_DATETIME))
+        {
+            NSMutableData* thresholds = [NSMutableData dataWithLength:[sorted count] * sizeof(double)];
+            double* values = [thresholds mutableBytes];
+            
+            for(NSUInteger j = 0; j < [sorted count]; j++)
+                values[j] = [sorted[j] doubleValue];
+            
+            [tables addObject:thresholds];
+        }
         else
+            [tables addObject:[NSNull null]];
+    }
+    
+    CompactNode* encodedNodes = calloc(nodeCount, sizeof(CompactNode));
+    
+    for(NSUInteger i = 0; i < nodeCount; i++)
+    {
+        const CompiledNode* node = &nodes[i];
+        CompactNode* compactNode = &encodedNodes[i];
+        
+        compactNode->nextSibling = node->nextSibling != NO_NODE ? node->nextSibling : COMPACT_NO_NODE;
+        compactNode->hasChildren = node->hasChildren;
+        compactNode->field = (uint16_t)node->field;
+        compactNode->predicateOperator = node->predicateOperator;
+        
+        switch(node->predicateOperator)
+        {
+            case CompiledOperatorLT:
+            case CompiledOperatorLE:
+            case CompiledOperatorGE:
+            case CompiledOperatorGT:
+                compactNode->value = (uint16_t)(2 * [thresholdIndexes[node->field][@(node->threshold)] unsignedShortValue] + 1);
+                break;
+            case CompiledOperatorEQ:
+            case CompiledOperatorNE:
+                compactNode->value = node->code != NEVER_CODE ? (uint16_t)node->code : COMPACT_NEVER_CODE;
+                break;
+            case CompiledOperatorTermLT:
+            case CompiledOperatorTermLE:
+            case CompiledOperatorTermGE:
+            case CompiledOperatorTermGT:
+            case CompiledOperatorTermEQ:
+            case CompiledOperatorTermNE:
+                compactNode->value = [testIndexes[@[@(node->code), @(node->threshold)]] unsignedShortValue];
+                break;
+        }
+    }
+    
+    compactNodes = encodedNodes;
+    fieldThresholds = tables;
+    termTests = tests;
+    
+    free(nodes);
+    nodes = NULL;
+    
+    return YES;
+}
+
+-(NSDictionary*)predictWithCompactNodes:(NSDictionary*)inputData
+{
+    NSUInteger fieldCount = [fieldNames count];
+    CompactFieldValue stackValues[MAX_STACK_FIELDS];
+    CompactFieldValue* values = fieldCount <= MAX_STACK_FIELDS ? stackValues : malloc(fieldCount * sizeof(CompactFieldValue));
+    uint32_t stackCounts[MAX_STACK_TERMS];
+    uint32_t* termCounts = termCount <= MAX_STACK_TERMS ? stackCounts : malloc(termCount * sizeof(uint32_t));
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+        values[i].loaded = NO;
+    
+    memset(termCounts, 0, termCount * sizeof(uint32_t));
+    
+    uint32_t index = [self compactLeafOfValues:values termCounts:termCounts inputData:inputData visits:[self profileCountersOfCurrentThread]];
+    
+    if(values != stackValues)
+        free(values);
+    
+    if(termCounts != stackCounts)
+        free(termCounts);
+    
+    return predictions[index];
+}
+
+-(uint32_t)leafOfValues:(FieldValue*)values termCounts:(uint32_t*)termCounts inputData:(NSDictionary*)inputData visits:(uint64_t*)visits
+{
+    uint32_t index = 0;
+    
+    if(visits != NULL)
+        visits[index]++;
+    
+    //The first child that matches is taken, and the prediction is the node where no child matches
+    while(nodes[index].hasChildren)
+    {
+        uint32_t child = index + 1;
+        
+        while(child != NO_NODE)
         {
-            NSDictionary* predicateDict = (NSDictionary*)predicateObj;
-            NSString* field = predicateDict[@"field"];
+            const CompiledNode* node = &nodes[child];
+            
+            if(node->predicateOperator != CompiledOperatorNone)
+            {
+                FieldValue* fieldValue = LoadFieldValue(values, node->field, inputData, fieldNames, fieldKinds, fieldCodes, fieldTokenizers, termCounts);
+                
+                if(fieldValue->present && NodeMatches(node, fieldValue, termCounts))
+                    break;
+            }
             
-            self.predicate = [[Predicate alloc]init];
-            [self.predicate setOpType:fields[field][@"optype"]];
-            [self.predicate setPredicateOperator:predicateDict[@"operator"]];
-            [self.predicate setField:field];
-            [self.predicate setValue:predicateDict[@"value"]];
+            child = node->nextSibling;
         }
         
-        //Generate children array
-        children = [[NSMutableArray alloc]init];
-        NSArray* childrenObj = root[@"children"];
+        if(child == NO_NODE)
+            break;
+        
+        index = child;
+        
+        if(visits != NULL)
+            visits[index]++;
+    }
+    
+    return index;
+}
+
+-(uint32_t)compactLeafOfValues:(CompactFieldValue*)values termCounts:(uint32_t*)termCounts inputData:(NSDictionary*)inputData visits:(uint64_t*)visits
+{
+    const TermTest* tests = [termTests bytes];
+    uint32_t index = 0;
+    
+    if(visits != NULL)
+        visits[index]++;
+    
+    while(compactNodes[index].hasChildren)
+    {
+        uint32_t child = index + 1;
         
-        if(childrenObj != nil)
+        while(child != COMPACT_NO_NODE)
         {
-            for(NSInteger i = 0; i < [childrenObj count]; i++)
+            const CompactNode* node = &compactNodes[child];
+            
+            if(node->predicateOperator != CompiledOperatorNone)
             {
-                NSDictionary* child = childrenObj[i];
+                CompactFieldValue* fieldValue = LoadCompactFieldValue(values, node->field, inputData, fieldNames, fieldKinds, fieldCodes, fieldThresholds, fieldTokenizers, termCounts);
                 
-                LocalPredictionTree* childTree = [[LocalPredictionTree alloc]initWithRoot:child fields:fields objectiveField:objectiveField];
-                [children addObject:childTree];
+                if(fieldValue->present && CompactNodeMatches(node, fieldValue, tests, termCounts))
+                    break;
             }
+            
+            child = node->nextSibling;
         }
+        
+        if(child == COMPACT_NO_NODE)
+            break;
+        
+        index = child;
+        
+        if(visits != NULL)
+            visits[index]++;
     }
     
-    return self;
+    return index;
 }
 
+-(uint32_t)firstChildOfNode:(uint32_t)index
+{
+    BOOL hasChildren = compactNodes != NULL ? compactNodes[index].hasChildren : nodes[index].hasChildren;
+    
+    return hasChildren ? index + 1 : NO_NODE;
+}
 
--(NSDictionary*)predict:(NSDictionary*)inputData
+-(uint32_t)nextSiblingOfNode:(uint32_t)index
+{
+    if(compactNodes != NULL)
+        return compactNodes[index].nextSibling != COMPACT_NO_NODE ? compactNodes[index].nextSibling : NO_NODE;
+    
+    return nodes[index].nextSibling;
+}
+
+-(uint64_t*)profileCountersOfCurrentThread
+{
+    uint64_t generation = profileGeneration;
+    
+    if(generation == 0)
+        return NULL;
+    
+    //Every thread counts in its own counters, so the walks don't need any lock or atomic operation
+    NSMutableDictionary* threadDictionary = [[NSThread currentThread] threadDictionary];
+    NSMapTable* threadCounters = threadDictionary[PROFILE_THREAD_KEY];
+    
+    if(threadCounters == nil)
+    {
+        threadCounters = [NSMapTable weakToStrongObjectsMapTable];
+        threadDictionary[PROFILE_THREAD_KEY] = threadCounters;
+    }
+    
+    NSMutableData* counters = [threadCounters objectForKey:self];
+    
+    //The first counter is the generation of the profile they belong to
+    if(counters == nil || ((uint64_t*)[counters mutableBytes])[0] != generation)
+    {
+        counters = [NSMutableData dataWithLength:(nodeCount + 1) * sizeof(uint64_t)];
+        ((uint64_t*)[counters mutableBytes])[0] = generation;
+        
+        @synchronized(self)
+        {
+            if(generation != profileGeneration)
+                return NULL;
+            
+            [profileCounters addObject:counters];
+        }
+        
+        [threadCounters setObject:counters forKey:self];
+    }
+    
+    return (uint64_t*)[counters mutableBytes] + 1;
+}
+
++(NSDictionary*)profiledNode:(NSDictionary*)node visits:(NSArray*)visits position:(NSUInteger*)position
 {
+    if(*position >= [visits count])
+        return nil;
+    
+    NSMutableDictionary* copy = [node mutableCopy];
+    copy[@"count"] = visits[(*position)++];
+    
+    NSArray* children = node[@"children"];
+    
     if([children count] > 0)
     {
-        for(NSInteger i = 0; i < [children count]; i++)
+        NSMutableArray* copiedChildren = [NSMutableArray arrayWithCapacity:[children count]];
+        
+        for(NSDictionary* child in children)
         {
-            LocalPredictionTree* child = children[i];
+            NSDictionary* copiedChild = [LocalPredictionTree profiledNode:child visits:visits position:position];
             
-            NSString* field = child.predicate.field;
-            NSString* inputValue = inputData[fields[field][@"name"]];
+            if(copiedChild == nil)
+                return nil;
             
-            if(inputValue == nil)
-                continue;
+            [copiedChildren addObject:copiedChild];
+        }
+        
+        copy[@"children"] = copiedChildren;
+    }
+    
+    return copy;
+}
+
+-(void)buildArgumentTables
+{
+    NSUInteger fieldCount = [fieldNames count];
+    NSMutableData* bytes = [NSMutableData data];
+    NSMutableDictionary* ids = [NSMutableDictionary dictionaryWithCapacity:fieldCount];
+    NSMutableDictionary* names = [NSMutableDictionary dictionaryWithCapacity:fieldCount];
+    
+    //The arguments can be keyed by field id or by field name
+    for(NSString* field in fields)
+    {
+        NSUInteger index = [fieldNames indexOfObject:fields[field][@"name"]];
+        
+        if(index != NSNotFound)
+        {
+            ids[field] = @(index);
+            names[fields[field][@"name"]] = @(index);
+        }
+    }
+    
+    argumentIds = BuildArgumentTable(ids, bytes, &argumentIdMask);
+    argumentNames = BuildArgumentTable(names, bytes, &argumentNameMask);
+    argumentCodes = calloc(fieldCount + 1, sizeof(ArgumentEntry*));
+    argumentCodeMasks = calloc(fieldCount + 1, sizeof(NSUInteger));
+    
+    for(NSUInteger i = 0; i < fieldCount; i++)
+    {
+        if([fieldCodes[i] count] > 0)
+            argumentCodes[i] = BuildArgumentTable(fieldCodes[i], bytes, &argumentCodeMasks[i]);
+    }
+    
+    argumentBytes = bytes;
+}
+
+-(BOOL)parseArguments:(const char*)bytes length:(NSUInteger)length byName:(BOOL)byName values:(FieldValue*)values termCounts:(uint32_t*)termCounts
+{
+    const char* keyBytes = [argumentBytes bytes];
+    const char* end = bytes + length;
+    const char* p = SkipWhitespace(bytes, end);
+    
+    if(p == end || *p != '{')
+        return NO;
+    
+    p = SkipWhitespace(p + 1, end);
+    
+    //Only whitespace can follow the object
+    if(p < end && *p == '}')
+        return SkipWhitespace(p + 1, end) == end;
+    
+    //The arguments are only looked up by the kind of key of the caller, as in predict:
+    ArgumentEntry* keys = byName ? argumentNames : argumentIds;
+    NSUInteger keyMask = byName ? argumentNameMask : argumentIdMask;
+    
+    while(p < end && *p == '"')
+    {
+        const char* key;
+        NSUInteger keyLength;
+        BOOL escaped;
+        
+        p = ScanString(p + 1, end, &key, &keyLength, &escaped);
+        
+        if(p == NULL)
+            return NO;
+        
+        int32_t field;
+        
+        if(escaped)
+        {
+            char stackKey[MAX_STACK_STRING];
+            char* decodedKey = keyLength < MAX_STACK_STRING ? stackKey : malloc(keyLength + 1);
+            NSUInteger decodedLength = UnescapeString(key, keyLength, decodedKey);
             
-            NSString* opType = child.predicate.opType;
-            NSString* operator = child.predicate.predicateOperator;
-            NSString* value = child.predicate.value;
+            field = decodedLength != NSNotFound ? LookupArgument(keys, keyMask, keyBytes, decodedKey, decodedLength, -1) : -1;
             
+            if(decodedKey != stackKey)
+                free(decodedKey);
+        }
+        else
+            field = LookupArgument(keys, keyMask, keyBytes, key, keyLength, -1);
+        
+        p = SkipWhitespace(p, end);
+        
+        if(p == end || *p != ':')
+            return NO;
+        
+        p = SkipWhitespace(p + 1, end);
+        
+        //The fields that aren't tested are skipped without reading their values
+        if(field >= 0 && !values[field].present)
+            p = [self parseValue:p end:end field:(uint32_t)field values:values termCounts:termCounts];
+        else
+            p = SkipValue(p, end);
+        
+        if(p == NULL)
+            return NO;
+        
+        p = SkipWhitespace(p, end);
+        
+        if(p == end)
+            return NO;
+        
+        if(*p == '}')
+            return SkipWhitespace(p + 1, end) == end;
+        
+        if(*p != ',')
+            return NO;
+        
+        p = SkipWhitespace(p + 1, end);
+    }
+    
+    return NO;
+}
+
+-(const char*)parseValue:(const char*)p end:(const char*)end field:(uint32_t)field values:(FieldValue*)values termCounts:(uint32_t*)termCounts
+{
+    FieldValue* value = &values[field];
+    uint8_t kind = fieldKinds[field];
+    
+    if(p >= end)
+        return NULL;
+    
+    //The values are converted as in predict:, so both kinds of input data give the same predictions
+    if(*p == '"')
+    {
+        const char* string;
+        NSUInteger length;
+        BOOL escaped;
+        const char* next = ScanString(p + 1, end, &string, &length, &escaped);
+        
+        if(next == NULL)
+            return NULL;
+        
+        char stackString[MAX_STACK_STRING];
+        char* decodedString = NULL;
+        
+        if(escaped)
+        {
+            decodedString = length < MAX_STACK_STRING ? stackString : malloc(length + 1);
+            length = UnescapeString(string, length, decodedString);
+            string = decodedString;
+        }
+        
+        if(length != NSNotFound)
+        {
+            value->present = YES;
+            value->code = NO_CODE;
             
-            if([operator isEqualToString:OPERATOR_EQ] && [inputValue isEqualToString:value]) {
-                return [child predict:inputData];
-            }
+            if(kind & FIELD_KIND_NUMERIC)
+                value->number = ParseNumber(string, length);
             
-            if(([operator isEqualToString:OPERATOR_NE] || [operator isEqualToString:OPERATOR_NE2]) && ![inputValue isEqualToString:value]){
-                return [child predict:inputData];
-            }
+            if(kind & FIELD_KIND_DATETIME)
+                value->number = [LocalDatetimeParser timeIntervalSince1970OfUTF8Datetime:string length:length];
             
-            if([operator isEqualToString:OPERATOR_LT])
-            {
-                if([opType isEqualToString:OPTYPE_DATETIME] && [inputValue compare:value] < 0){
-                    return [child predict:inputData];
-                }
-                
-                if(![opType isEqualToString:OPTYPE_DATETIME] && [inputValue doubleValue] < [value doubleValue]){
-                    return  [child predict:inputData];
-                }
-            }
+            if(kind & FIELD_KIND_CATEGORICAL)
+                value->code = LookupArgument(argumentCodes[field], argumentCodeMasks[field], [argumentBytes bytes], string, length, NO_CODE);
             
-            if([operator isEqualToString:OPERATOR_LE])
+            //The tokenizers work on strings, so only the text values are created as objects
+            if(kind & FIELD_KIND_TEXT)
             {
-                if([opType isEqualToString:OPTYPE_DATETIME] && [inputValue compare:value] <= 0){
-                    return [child predict:inputData];
-                }
-                
-                if(![opType isEqualToString:OPTYPE_DATETIME] && [inputValue doubleValue] <= [value doubleValue]){
-                    return  [child predict:inputData];
-                }
+                NSString* text = [[NSString alloc]initWithBytes:string length:length encoding:NSUTF8StringEncoding];
+                [fieldTokenizers[field] countTermsOfText:text counts:termCounts];
             }
+        }
+        
+        if(decodedString != NULL && decodedString != stackString)
+            free(decodedString);
+        
+        return length != NSNotFound ? next : NULL;
+    }
+    
+    if(end - p >= 4 && strncmp(p, "null", 4) == 0)
+        return p + 4;
+    
+    //Booleans and numbers are present, but they aren't any categorical value, datetime or text
+    BOOL boolean = (end - p >= 4 && strncmp(p, "true", 4) == 0) || (end - p >= 5 && strncmp(p, "false", 5) == 0);
+    
+    if(boolean || *p == '-' || (*p >= '0' && *p <= '9'))
+    {
+        NSUInteger numberLength = boolean ? 0 : LengthOfNumber(p, end);
+        
+        if(!boolean && numberLength == 0)
+            return NULL;
+        
+        const char* next = p + (boolean ? (*p == 't' ? 4 : 5) : numberLength);
+        double number = boolean ? (*p == 't') : ParseNumber(p, numberLength);
+        
+        value->present = YES;
+        value->code = NO_CODE;
+        value->number = (kind & FIELD_KIND_DATETIME) ? NAN : number;
+        
+        return next;
+    }
+    
+    //Objects and arrays are skipped as missing values
+    return SkipValue(p, end);
+}
+
+-(NSArray*)orderChildren:(NSArray*)children ofNode:(NSDictionary*)node
+{
+    NSArray* ordered = children;
+    BOOL exclusive = YES;
+    
+    for(NSUInteger i = 0; i < [children count] && exclusive; i++)
+        for(NSUInteger j = i + 1; j < [children count] && exclusive; j++)
+            exclusive = [self predicate:children[i][@"predicate"] excludesPredicate:children[j][@"predicate"]];
+    
+    //At most one child matches, so the order only changes how many predicates are tested
+    if(exclusive && [children count] > 1)
+    {
+        ordered = [children sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(NSDictionary* child, NSDictionary* other) {
+            double count = [child[@"count"]doubleValue];
+            double otherCount = [other[@"count"]doubleValue];
             
-            if([operator isEqualToString:OPERATOR_GE])
+            return count > otherCount ? NSOrderedAscending : (count < otherCount ? NSOrderedDescending : NSOrderedSame);
+        }];
+        
+        for(NSUInteger i = 0; i < [children count]; i++)
+        {
+            if(ordered[i] != children[i])
             {
-                if([opType isEqualToString:OPTYPE_DATETIME] && [inputValue compare:value] >= 0){
-                    return [child predict:inputData];
-                }
-                
-                if(![opType isEqualToString:OPTYPE_DATETIME] && [inputValue doubleValue] >= [value doubleValue]){
-                    return  [child predict:inputData];
-                }
+                reorderedNodes++;
+                break;
             }
-            
-            if([operator isEqualToString:OPERATOR_GT])
-            {
-                if([opType isEqualToString:OPTYPE_DATETIME] && [inputValue compare:value] > 0){
-                    return [child predict:inputData];
-                }
-                
-                if(![opType isEqualToString:OPTYPE_DATETIME] && [inputValue doubleValue] > [value doubleValue]){
-                    return  [child predict:inputData];
-                }
-            }            
         }
-	}
+    }
     
-    //The result of a prediction is the output of the node and the confidence
-    NSMutableDictionary* prediction = [[NSMutableDictionary alloc]initWithCapacity:2];
+    double count = [node[@"count"]doubleValue];
+    
+    testsPerPrediction += [LocalPredictionTree testsToChooseAmongChildren:ordered count:count];
+    testsPerPredictionInModelOrder += [LocalPredictionTree testsToChooseAmongChildren:children count:count];
+    
+    return ordered;
+}
+
+-(BOOL)predicate:(NSDictionary*)predicate excludesPredicate:(NSDictionary*)other
+{
+    if(![predicate isKindOfClass:[NSDictionary class]] || ![other isKindOfClass:[NSDictionary class]])
+        return NO;
+    
+    NSString* field = predicate[@"field"];
+    
+    if(field == nil || ![field isEqual:other[@"field"]])
+        return NO;
+    
+    //The counts of different terms are independent
+    id term = predicate[@"term"];
+    
+    if((term != nil || other[@"term"] != nil) && ![term isEqual:other[@"term"]])
+        return NO;
+    
+    NSString* operator = predicate[@"operator"];
+    NSString* otherOperator = other[@"operator"];
+    id value = predicate[@"value"];
+    id otherValue = other[@"value"];
+    
+    if(![operator isKindOfClass:[NSString class]] || ![otherOperator isKindOfClass:[NSString class]])
+        return NO;
+    
+    NSSet* equalities = [NSSet setWithObjects:OPERATOR_EQ, OPERATOR_NE, OPERATOR_NE2, nil];
+    
+    //A value can't be equal to two different values, or equal and different to the same value
+    if([equalities containsObject:operator] && [equalities containsObject:otherOperator])
+    {
+        if(![value isKindOfClass:[NSString class]] || ![otherValue isKindOfClass:[NSString class]])
+            return NO;
+        
+        BOOL equal = [operator isEqualToString:OPERATOR_EQ];
+        BOOL otherEqual = [otherOperator isEqualToString:OPERATOR_EQ];
+        
+        if(equal && otherEqual)
+            return ![value isEqualToString:otherValue];
+        
+        return equal != otherEqual && [value isEqualToString:otherValue];
+    }
     
-    if(output != nil)
-        [prediction setValue:output forKey:@"value"];
+    //A value can't be below an upper bound and above a lower bound that don't overlap
+    BOOL datetime = [fields[field][@"optype"] isEqualToString:OPTYPE_DATETIME];
     
-    if(confidence != nil)
-        [prediction setValue:confidence forKey:@"confidence"];
+    if(!datetime && (![value respondsToSelector:@selector(doubleValue)] || ![otherValue respondsToSelector:@selector(doubleValue)]))
+        return NO;
+    
+    NSDictionary* upper = nil;
+    NSDictionary* lower = nil;
+    
+    for(NSDictionary* bound in @[predicate, other])
+    {
+        if([bound[@"operator"] isEqualToString:OPERATOR_LT] || [bound[@"operator"] isEqualToString:OPERATOR_LE])
+            upper = bound;
+        else if([bound[@"operator"] isEqualToString:OPERATOR_GT] || [bound[@"operator"] isEqualToString:OPERATOR_GE])
+            lower = bound;
+    }
+    
+    if(upper == nil || lower == nil)
+        return NO;
+    
+    double upperValue = datetime ? [LocalDatetimeParser timeIntervalSince1970OfDatetime:upper[@"value"]] : [upper[@"value"]doubleValue];
+    double lowerValue = datetime ? [LocalDatetimeParser timeIntervalSince1970OfDatetime:lower[@"value"]] : [lower[@"value"]doubleValue];
+    
+    if(isnan(upperValue) || isnan(lowerValue))
+        return NO;
+    
+    if(upperValue != lowerValue)
+        return upperValue < lowerValue;
+    
+    return [upper[@"operator"] isEqualToString:OPERATOR_LT] || [lower[@"operator"] isEqualToString:OPERATOR_GT];
+}
+
++(double)testsToChooseAmongChildren:(NSArray*)children count:(double)count
+{
+    double tests = 0;
+    double matched = 0;
+    
+    for(NSUInteger i = 0; i < [children count]; i++)
+    {
+        double childCount = [children[i][@"count"]doubleValue];
+        
+        tests += (i + 1) * childCount;
+        matched += childCount;
+    }
     
-    return prediction;
+    //The instances that don't match any child test all of them
+    return tests + [children count] * MAX(count - matched, 0);
 }
 
 @end
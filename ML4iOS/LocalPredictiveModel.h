@@ -20,14 +20,94 @@
  */
 #import <Foundation/Foundation.h>
 
+@class LocalPredictionTree;
+
 /**
- * Utility class to handle local predictions
+ * Utility class to handle local predictions.
+ * An instance keeps the tree of a model built once, so it can create many predictions without parsing the model again.
+ * The instances are immutable and can be used from several threads at the same time.
  */
 @interface LocalPredictiveModel : NSObject
 {
+    NSDictionary* fields;
+    LocalPredictionTree* tree;
     
+    /**
+     * The statistics of the compaction of the tree
+     */
+    NSDictionary* compactionStatistics;
 }
 
+/**
+ * Builds the tree of the model passed as parameter, compacted with LocalTreeCompactor and laid out by frequency
+ * @param jsonModel The model to use to create the predictions
+ * @return The created LocalPredictiveModel object, nil if jsonModel is not a valid model
+ */
+-(LocalPredictiveModel*)initWithJSONModel:(NSDictionary*)jsonModel;
+
+/**
+ * Builds the tree of the model passed as parameter, compacted with LocalTreeCompactor and laid out by frequency
+ * @param jsonModel The model to use to create the predictions
+ * @param compact true to encode the nodes of the tree in 8 bytes, recommended for trees too large for the processor
+ * caches, else false
+ * @return The created LocalPredictiveModel object, nil if jsonModel is not a valid model
+ * @see LocalPredictionTree initWithRoot:fields:objectiveField:compactEncoding:
+ */
+-(LocalPredictiveModel*)initWithJSONModel:(NSDictionary*)jsonModel compactEncoding:(BOOL)compact;
+
+/**
+ * Builds the tree of the model passed as parameter, compacted with LocalTreeCompactor and laid out by the frequency of
+ * the branches in a profile of previous predictions
+ * @param jsonModel The model to use to create the predictions
+ * @param compact true to encode the nodes of the tree in 8 bytes, else false
+ * @param profile The profile of a LocalPredictiveModel of the same model, nil to lay out the tree by the frequency of
+ * the branches in the training data. Its nodes are those of the compacted tree.
+ * @return The created LocalPredictiveModel object, nil if jsonModel is not a valid model or the profile doesn't have
+ * the nodes of its compacted tree
+ * @see LocalPredictionTree root:withProfile:
+ */
+-(LocalPredictiveModel*)initWithJSONModel:(NSDictionary*)jsonModel compactEncoding:(BOOL)compact profile:(NSDictionary*)profile;
+
+/**
+ * Creates a local prediction using the args passed as parameter
+ * @param args The arguments to create the prediction
+ * @param byName The arguments passed in args parameter are passed by name, else they are passed by field id
+ * @return The result of the prediction
+ * @see LocalPredictionTree predictWithArguments:argsByName:
+ */
+-(NSDictionary*)predictWithArguments:(NSString*)args argsByName:(BOOL)byName;
+
+/**
+ * @return The statistics of the compaction of the tree, with the reduction of the number of nodes
+ * @see LocalTreeCompactor statistics
+ */
+-(NSDictionary*)compactionStatistics;
+
+/**
+ * @return The statistics of the layout of the compiled tree, with the predicates tested per prediction
+ * @see LocalPredictionTree layoutStatistics
+ */
+-(NSDictionary*)layoutStatistics;
+
+/**
+ * @return The estimated bytes taken by the compiled tree
+ * @see LocalPredictionTree footprint
+ */
+-(NSUInteger)footprint;
+
+/**
+ * Enables or disables the profiling of the predictions
+ * @param enabled true to count the visits of the nodes of the tree, else false
+ * @see LocalPredictionTree setProfilingEnabled:
+ */
+-(void)setProfilingEnabled:(BOOL)enabled;
+
+/**
+ * @return The profile of the predictions done while profiling, with the hot path, average depth and dead branches
+ * @see LocalPredictionTree profile
+ */
+-(NSDictionary*)profile;
+
 /**
  * Creates a local prediction using the model and args passed as parameters
  * @param jsonModel The model to use to create the prediction
@@ -20,31 +20,95 @@
  */
 #import "LocalPredictiveModel.h"
 #import "LocalPredictionTree.h"
+#import "LocalTreeCompactor.h"
 
 @implementation LocalPredictiveModel
     
-+(NSDictionary*)predictWithJSONModel:(NSDictionary*)jsonModel arguments:(NSString*)args argsByName:(BOOL)byName
+-(LocalPredictiveModel*)initWithJSONModel:(NSDictionary*)jsonModel
 {
-    NSDictionary* prediction = nil;
+    return [self initWithJSONModel:jsonModel compactEncoding:NO];
+}
+
+-(LocalPredictiveModel*)initWithJSONModel:(NSDictionary*)jsonModel compactEncoding:(BOOL)compact
+{
+    return [self initWithJSONModel:jsonModel compactEncoding:compact profile:nil];
+}
+
+-(LocalPredictiveModel*)initWithJSONModel:(NSDictionary*)jsonModel compactEncoding:(BOOL)compact profile:(NSDictionary*)profile
+{
+    NSDictionary* root = jsonModel[@"model"][@"root"];
     
-    if(jsonModel != nil && args != nil)
-    {
-        NSString* objectiveField = jsonModel[@"objective_field"];
+    if(root == nil)
+        return nil;
     
-        NSDictionary* fields = jsonModel[@"model"][@"fields"];
-        NSDictionary* root = jsonModel[@"model"][@"root"];
+    self = [super init];
     
-        NSError *error = nil;
-        NSDictionary* inputData = [NSJSONSerialization JSONObjectWithData:[args dataUsingEncoding:NSUTF8StringEncoding] options:NSJSONReadingMutableContainers error:&error];
+    if(self)
+    {
+        NSString* objectiveField = jsonModel[@"objective_field"];
+        
+        fields = jsonModel[@"model"][@"fields"];
         
-        if(!byName)
-            inputData = [LocalPredictiveModel createInputDataByNameFromInputDataByFieldId:inputData fields:fields];
+        LocalTreeCompactor* compactor = [[LocalTreeCompactor alloc]initWithFields:fields];
+        NSDictionary* compactedRoot = [compactor compactRoot:root];
+        compactionStatistics = [compactor statistics];
         
-        //Explore the predictive model tree recursively
-        LocalPredictionTree* tree = [[LocalPredictionTree alloc]initWithRoot:root fields:fields objectiveField:objectiveField];
-        prediction = [tree predict:inputData];
+        //The ids of the profile are positions in the compacted tree, so it can only be applied to the same one
+        if(profile != nil)
+        {
+            compactedRoot = [LocalPredictionTree root:compactedRoot withProfile:profile];
+            
+            if(compactedRoot == nil)
+                return nil;
+        }
+        
+        tree = [[LocalPredictionTree alloc]initWithRoot:compactedRoot fields:fields objectiveField:objectiveField compactEncoding:compact];
     }
     
+    return self;
+}
+
+-(NSDictionary*)predictWithArguments:(NSString*)args argsByName:(BOOL)byName
+{
+    if(args == nil)
+        return nil;
+    
+    //The arguments are parsed straight into the values of the tested fields, keyed by id or by name
+    return [tree predictWithArguments:args argsByName:byName];
+}
+
+-(NSDictionary*)compactionStatistics
+{
+    return compactionStatistics;
+}
+
+-(NSDictionary*)layoutStatistics
+{
+    return [tree layoutStatistics];
+}
+
+-(NSUInteger)footprint
+{
+    return [tree footprint];
+}
+
+-(void)setProfilingEnabled:(BOOL)enabled
+{
+    [tree setProfilingEnabled:enabled];
+}
+
+-(NSDictionary*)profile
+{
+    return [tree profile];
+}
+
++(NSDictionary*)predictWithJSONModel:(NSDictionary*)jsonModel arguments:(NSString*)args argsByName:(BOOL)byName
+{
+    NSDictionary* prediction = nil;
+    
+    if(jsonModel != nil && args != nil)
+        prediction = [[[LocalPredictiveModel alloc]initWithJSONModel:jsonModel]predictWithArguments:args argsByName:byName];
+    
     return prediction;
 }
 
@@ -0,0 +1,92 @@
+/**
+ *
+ * LocalTermTokenizer.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * An entry of the hash table of the forms counted as tokens
+ */
+typedef struct
+{
+    uint64_t hash;
+    uint32_t slot;
+    uint32_t offset;          //Position of the form in the characters of the table
+    uint32_t length;
+} TermEntry;
+
+/**
+ * Counts the terms of a text field tested by a tree, following the term analysis of the field.
+ * The forms of every term (ej: stems, plurals, etc) are kept in an open addressing hash table, so a text is tokenized
+ * once and every token is counted with a single lookup, and the count of every term is read by its slot afterwards.
+ * The words of the forms are separated by a single space in the table, as the tokens of the texts when they are counted.
+ */
+@interface LocalTermTokenizer : NSObject
+{
+    BOOL caseSensitive;
+    NSString* tokenMode;
+    
+    /**
+     * The slots of every form, counted when found as a token or when it is the whole text
+     */
+    NSMutableDictionary* tokenForms;
+    NSMutableDictionary* fullTermForms;
+    NSMutableDictionary* termSlots;
+    
+    TermEntry* entries;
+    NSUInteger entryMask;
+    unichar* characters;
+    NSUInteger characterCount;
+    NSUInteger maximumWords;
+}
+
+/**
+ * Initializes a LocalTermTokenizer object
+ * @param termAnalysis The term analysis of the field: "case_sensitive" and "token_mode" ("tokens_only",
+ * "full_terms_only" or "all")
+ */
+-(LocalTermTokenizer*)initWithTermAnalysis:(NSDictionary*)termAnalysis;
+
+/**
+ * Adds a term to be counted, if it wasn't added yet
+ * @param term The term
+ * @param forms The forms of the term in the texts, as in the "term_forms" of the summary of the field
+ * @param nextSlot The slot given to the term if it is new, incremented in that case
+ * @return The slot where the term is counted
+ */
+-(uint32_t)slotOfTerm:(NSString*)term forms:(NSArray*)forms nextSlot:(uint32_t*)nextSlot;
+
+/**
+ * Builds the hash table of the forms. Must be called once all the terms are added and before counting any text.
+ */
+-(void)buildTermTable;
+
+/**
+ * Counts the terms in a text
+ * @param text The value of the field
+ * @param counts The counts of the terms, indexed by slot, where the occurrences of the terms of this field are added
+ */
+-(void)countTermsOfText:(NSString*)text counts:(uint32_t*)counts;
+
+/**
+ * @return The bytes taken by the hash table of the forms
+ */
+-(NSUInteger)footprint;
+
+@end
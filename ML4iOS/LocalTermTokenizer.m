@@ -0,0 +1,369 @@
+/**
+ *
+ * LocalTermTokenizer.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalTermTokenizer.h"
+
+// Token modes
+#define TOKEN_MODE_TOKENS @"tokens_only"
+#define TOKEN_MODE_FULL_TERMS @"full_terms_only"
+#define TOKEN_MODE_ALL @"all"
+
+//Maximum number of words of a form counted in the tokens of a text
+#define MAX_TERM_WORDS 8
+
+//Texts up to this length are tokenized in the stack
+#define MAX_STACK_CHARACTERS 512
+
+//FNV-1a hash
+#define HASH_OFFSET 14695981039346656037ULL
+#define HASH_PRIME 1099511628211ULL
+
+static inline uint64_t HashCharacters(const unichar* characters, NSUInteger length)
+{
+    uint64_t hash = HASH_OFFSET;
+    
+    for(NSUInteger i = 0; i < length; i++)
+        hash = (hash ^ characters[i]) * HASH_PRIME;
+    
+    return hash;
+}
+
+/**
+ * Letters and digits form the tokens, anything else (including the underscore) separates them
+ */
+static inline BOOL IsTokenCharacter(unichar character, NSCharacterSet* alphanumerics)
+{
+    if(character < 128)
+        return (character >= '0' && character <= '9') || (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z');
+    
+    return [alphanumerics characterIsMember:character];
+}
+
+/**
+ * Writes the tokens of a text separated by a single space, so a form of several words matches whatever separates its
+ * words in the text (ej: "new york" matches "new-york" and "new  york"). The target can be the text itself.
+ * @param words The number of tokens written
+ * @return The length of the normalized text
+ */
+static NSUInteger NormalizeTokens(const unichar* source, NSUInteger length, unichar* target, NSCharacterSet* alphanumerics, NSUInteger* words)
+{
+    NSUInteger written = 0;
+    NSUInteger tokens = 0;
+    NSUInteger i = 0;
+    
+    while(i < length)
+    {
+        if(!IsTokenCharacter(source[i], alphanumerics))
+        {
+            i++;
+            continue;
+        }
+        
+        if(tokens++ > 0)
+            target[written++] = ' ';
+        
+        while(i < length && IsTokenCharacter(source[i], alphanumerics))
+            target[written++] = source[i++];
+    }
+    
+    *words = tokens;
+    
+    return written;
+}
+
+/**
+ * Adds one to the count of every term that has the form, if any
+ */
+static inline void CountForm(const TermEntry* entries, NSUInteger mask, const unichar* characters, const unichar* form, NSUInteger length, uint32_t* counts)
+{
+    uint64_t hash = HashCharacters(form, length);
+    
+    //The same form can belong to several terms, so the probe goes on until an empty entry
+    for(NSUInteger i = hash & mask; entries[i].length != 0; i = (i + 1) & mask)
+    {
+        const TermEntry* entry = &entries[i];
+        
+        if(entry->hash == hash && entry->length == length && memcmp(characters + entry->offset, form, length * sizeof(unichar)) == 0)
+            counts[entry->slot]++;
+    }
+}
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalTermTokenizer()
+
+/**
+ * Adds the slot of a term to a form
+ * @param form The form
+ * @param slot The slot of the term
+ * @param forms The forms where it is added
+ */
+-(void)addForm:(NSString*)form slot:(uint32_t)slot toForms:(NSMutableDictionary*)forms;
+
+@end
+
+#pragma mark -
+
+@implementation LocalTermTokenizer
+
+-(LocalTermTokenizer*)initWithTermAnalysis:(NSDictionary*)termAnalysis
+{
+    self = [super init];
+    
+    if(self)
+    {
+        caseSensitive = [termAnalysis[@"case_sensitive"]boolValue];
+        tokenMode = [termAnalysis[@"token_mode"] isKindOfClass:[NSString class]] ? termAnalysis[@"token_mode"] : TOKEN_MODE_ALL;
+        
+        tokenForms = [NSMutableDictionary dictionary];
+        fullTermForms = [NSMutableDictionary dictionary];
+        termSlots = [NSMutableDictionary dictionary];
+    }
+    
+    return self;
+}
+
+-(void)dealloc
+{
+    free(entries);
+    free(characters);
+}
+
+-(uint32_t)slotOfTerm:(NSString*)term forms:(NSArray*)forms nextSlot:(uint32_t*)nextSlot
+{
+    NSNumber* slot = termSlots[term];
+    
+    if(slot != nil)
+        return [slot unsignedIntValue];
+    
+    slot = @((*nextSlot)++);
+    termSlots[term] = slot;
+    
+    NSMutableOrderedSet* termForms = [NSMutableOrderedSet orderedSetWithObject:term];
+    
+    if([forms isKindOfClass:[NSArray class]])
+    {
+        for(NSString* form in forms)
+            if([form isKindOfClass:[NSString class]])
+                [termForms addObject:form];
+    }
+    
+    //In the "all" mode, a term of several words without other forms is matched against the whole text
+    BOOL fullTerms = [tokenMode isEqualToString:TOKEN_MODE_FULL_TERMS];
+    
+    if([tokenMode isEqualToString:TOKEN_MODE_ALL] && [termForms count] == 1)
+    {
+        NSRange separator = [term rangeOfCharacterFromSet:[[NSCharacterSet alphanumericCharacterSet] invertedSet]];
+        fullTerms = separator.location != NSNotFound && separator.location > 0 && NSMaxRange(separator) < [term length];
+    }
+    
+    for(NSString* form in termForms)
+        [self addForm:form slot:[slot unsignedIntValue] toForms:fullTerms ? fullTermForms : tokenForms];
+    
+    return [slot unsignedIntValue];
+}
+
+-(void)addForm:(NSString*)form slot:(uint32_t)slot toForms:(NSMutableDictionary*)forms
+{
+    if([form length] == 0)
+        return;
+    
+    NSString* key = caseSensitive ? form : [form lowercaseString];
+    NSMutableIndexSet* slots = forms[key];
+    
+    if(slots == nil)
+    {
+        slots = [NSMutableIndexSet indexSet];
+        forms[key] = slots;
+    }
+    
+    [slots addIndex:slot];
+}
+
+-(void)buildTermTable
+{
+    NSCharacterSet* alphanumerics = [NSCharacterSet alphanumericCharacterSet];
+    
+    //The forms that only differ in their separators are the same once normalized, so their slots are merged
+    NSMutableDictionary* normalizedForms = [NSMutableDictionary dictionaryWithCapacity:[tokenForms count]];
+    
+    for(NSString* form in tokenForms)
+    {
+        NSUInteger length = [form length];
+        unichar* formCharacters = malloc(MAX(length, 1) * sizeof(unichar));
+        NSUInteger words = 0;
+        
+        [form getCharacters:formCharacters range:NSMakeRange(0, length)];
+        length = NormalizeTokens(formCharacters, length, formCharacters, alphanumerics, &words);
+        
+        if(words > 0 && words <= MAX_TERM_WORDS)
+        {
+            NSString* normalizedForm = [NSString stringWithCharacters:formCharacters length:length];
+            NSMutableIndexSet* slots = normalizedForms[normalizedForm];
+            
+            if(slots == nil)
+            {
+                slots = [NSMutableIndexSet indexSet];
+                normalizedForms[normalizedForm] = slots;
+            }
+            
+            [slots addIndexes:tokenForms[form]];
+        }
+        
+        free(formCharacters);
+    }
+    
+    NSUInteger entryCount = 0;
+    
+    free(entries);
+    free(characters);
+    
+    entries = NULL;
+    characters = NULL;
+    characterCount = 0;
+    maximumWords = 0;
+    
+    for(NSString* form in normalizedForms)
+    {
+        entryCount += [normalizedForms[form] count];
+        characterCount += [form length];
+    }
+    
+    if(entryCount == 0)
+        return;
+    
+    //The table is at most half full, so the probes are short
+    NSUInteger capacity = 8;
+    
+    while(capacity < 2 * entryCount)
+        capacity *= 2;
+    
+    entries = calloc(capacity, sizeof(TermEntry));
+    entryMask = capacity - 1;
+    characters = malloc(characterCount * sizeof(unichar));
+    
+    NSUInteger offset = 0;
+    
+    for(NSString* form in normalizedForms)
+    {
+        NSUInteger length = [form length];
+        unichar* formCharacters = characters + offset;
+        NSUInteger words = 0;
+        
+        [form getCharacters:formCharacters range:NSMakeRange(0, length)];
+        NormalizeTokens(formCharacters, length, formCharacters, alphanumerics, &words);
+        
+        maximumWords = MAX(maximumWords, words);
+        
+        uint64_t hash = HashCharacters(formCharacters, length);
+        NSIndexSet* slots = normalizedForms[form];
+        
+        for(NSUInteger slot = [slots firstIndex]; slot != NSNotFound; slot = [slots indexGreaterThanIndex:slot])
+        {
+            NSUInteger i = hash & entryMask;
+            
+            while(entries[i].length != 0)
+                i = (i + 1) & entryMask;
+            
+            entries[i].hash = hash;
+            entries[i].slot = (uint32_t)slot;
+            entries[i].offset = (uint32_t)offset;
+            entries[i].length = (uint32_t)length;
+        }
+        
+        offset += length;
+    }
+}
+
+-(void)countTermsOfText:(NSString*)text counts:(uint32_t*)counts
+{
+    if(![text isKindOfClass:[NSString class]])
+        return;
+    
+    NSString* folded = caseSensitive ? text : [text lowercaseString];
+    
+    if([fullTermForms count] > 0)
+    {
+        NSIndexSet* slots = fullTermForms[folded];
+        
+        for(NSUInteger slot = [slots firstIndex]; slot != NSNotFound; slot = [slots indexGreaterThanIndex:slot])
+            counts[slot]++;
+    }
+    
+    if(maximumWords == 0)
+        return;
+    
+    NSCharacterSet* alphanumerics = [NSCharacterSet alphanumericCharacterSet];
+    NSUInteger length = [folded length];
+    unichar stackCharacters[MAX_STACK_CHARACTERS];
+    unichar* buffer = length <= MAX_STACK_CHARACTERS ? stackCharacters : malloc(length * sizeof(unichar));
+    
+    [folded getCharacters:buffer range:NSMakeRange(0, length)];
+    
+    //The tokens are moved back in the buffer separated by a single space, as the forms of the table, and the starts of
+    //the last ones are kept, so the forms of several words are looked up ending at every token
+    NSUInteger starts[MAX_TERM_WORDS];
+    NSUInteger tokens = 0;
+    NSUInteger written = 0;
+    NSUInteger i = 0;
+    
+    while(i < length)
+    {
+        if(!IsTokenCharacter(buffer[i], alphanumerics))
+        {
+            i++;
+            continue;
+        }
+        
+        NSUInteger start = i;
+        
+        while(i < length && IsTokenCharacter(buffer[i], alphanumerics))
+            i++;
+        
+        if(tokens > 0)
+            buffer[written++] = ' ';
+        
+        memmove(buffer + written, buffer + start, (i - start) * sizeof(unichar));
+        
+        starts[tokens % maximumWords] = written;
+        written += i - start;
+        tokens++;
+        
+        for(NSUInteger words = 1; words <= MIN(tokens, maximumWords); words++)
+        {
+            NSUInteger first = starts[(tokens - words) % maximumWords];
+            CountForm(entries, entryMask, characters, buffer + first, written - first, counts);
+        }
+    }
+    
+    if(buffer != stackCharacters)
+        free(buffer);
+}
+
+-(NSUInteger)footprint
+{
+    if(entries == NULL)
+        return 0;
+    
+    return (entryMask + 1) * sizeof(TermEntry) + characterCount * sizeof(unichar);
+}
+
+@end
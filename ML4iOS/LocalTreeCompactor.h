@@ -0,0 +1,65 @@
+/**
+ *
+ * LocalTreeCompactor.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * Optimization pass applied to the tree of a model when it is compiled. The compacted tree returns the same
+ * prediction, value and confidence, as the original one for every input:
+ * - Children whose predicate can never be true given the predicates of their ancestors are pruned, and so are the
+ *   siblings after a child whose predicate is always true.
+ * - A node whose only reachable child is always taken is folded into it.
+ * - Trailing leaves with the same output and confidence as their parent are collapsed into it, so subtrees whose
+ *   nodes all predict the same become a single leaf.
+ * Only constraints that the predictions evaluate the same way are derived: intervals of numeric comparisons and
+ * equalities of categorical values, both on fields tested by an ancestor.
+ */
+@interface LocalTreeCompactor : NSObject
+{
+    NSDictionary* fields;
+    
+    //Statistics
+    NSUInteger nodes;
+    NSUInteger compactedNodes;
+    NSUInteger prunedNodes;
+    NSUInteger foldedNodes;
+    NSUInteger collapsedNodes;
+}
+
+/**
+ * Initializes the compactor
+ * @param aFields The fields of the model
+ */
+-(LocalTreeCompactor*)initWithFields:(NSDictionary*)aFields;
+
+/**
+ * Compacts a tree
+ * @param root The root node of the tree, as in the JSON of the model
+ * @return The root node of the compacted tree, with the same format
+ */
+-(NSDictionary*)compactRoot:(NSDictionary*)root;
+
+/**
+ * @return The statistics of the last tree compacted: number of "nodes" before and after ("compactedNodes") the
+ * compaction, and number of nodes removed by every pass ("prunedNodes", "foldedNodes" and "collapsedNodes")
+ */
+-(NSDictionary*)statistics;
+
+@end
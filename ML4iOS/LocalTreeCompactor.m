@@ -0,0 +1,385 @@
+/**
+ *
+ * LocalTreeCompactor.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#import "LocalTreeCompactor.h"
+
+#define OPTYPE_NUMERIC @"numeric"
+
+#define OPERATOR_LT @"<"
+#define OPERATOR_LE @"<="
+#define OPERATOR_EQ @"="
+#define OPERATOR_NE @"!="
+#define OPERATOR_NE2 @"/="
+#define OPERATOR_GE @">="
+#define OPERATOR_GT @">"
+
+/**
+ * The outcome of a predicate given the constraints of the path that reaches it
+ */
+typedef enum
+{
+    PredicateOutcomeUnknown,
+    PredicateOutcomeAlways,
+    PredicateOutcomeNever
+} PredicateOutcome;
+
+#pragma mark -
+
+/**
+ * The values a field can take in a path of the tree. A constraint only exists for the fields tested by an ancestor,
+ * so the value of the field is present in every input that follows the path.
+ */
+@interface FieldConstraint : NSObject <NSCopying>
+
+//Interval of the numeric value, open or closed at every end
+@property (nonatomic, assign) double low;
+@property (nonatomic, assign) double high;
+@property (nonatomic, assign) BOOL lowOpen;
+@property (nonatomic, assign) BOOL highOpen;
+
+//Categorical value, nil if it is unknown, and values it can't take
+@property (nonatomic, strong) NSString* equal;
+@property (nonatomic, strong) NSSet* excluded;
+
+@end
+
+@implementation FieldConstraint
+
+-(id)init
+{
+    self = [super init];
+    
+    if(self)
+    {
+        _low = -INFINITY;
+        _high = INFINITY;
+        _lowOpen = YES;
+        _highOpen = YES;
+        _excluded = [NSSet set];
+    }
+    
+    return self;
+}
+
+-(id)copyWithZone:(NSZone*)zone
+{
+    FieldConstraint* copy = [[FieldConstraint alloc]init];
+    copy.low = _low;
+    copy.high = _high;
+    copy.lowOpen = _lowOpen;
+    copy.highOpen = _highOpen;
+    copy.equal = _equal;
+    copy.excluded = _excluded;
+    
+    return copy;
+}
+
+@end
+
+#pragma mark -
+
+/**
+ * Interface that contains private methods
+ */
+@interface LocalTreeCompactor()
+
+/**
+ * Compacts a node reached by a path
+ * @param node The node
+ * @param constraints The constraints of the path keyed by field
+ * @return The compacted node
+ */
+-(NSDictionary*)compactNode:(NSDictionary*)node constraints:(NSDictionary*)constraints;
+
+/**
+ * @return The outcome of a predicate given the constraints of the path that reaches it
+ */
+-(PredicateOutcome)outcomeOfPredicate:(NSObject*)predicate constraints:(NSDictionary*)constraints;
+
+/**
+ * @return The constraints of the path extended with a predicate that is true
+ */
+-(NSDictionary*)constraints:(NSDictionary*)constraints byApplyingPredicate:(NSObject*)predicate;
+
+/**
+ * @return true if the predicate is a comparison of the value of a numeric field, else false
+ */
+-(BOOL)isNumericComparison:(NSDictionary*)predicate;
+
+/**
+ * @return The number of nodes of a tree
+ */
+-(NSUInteger)countNodes:(NSDictionary*)node;
+
+@end
+
+#pragma mark -
+
+@implementation LocalTreeCompactor
+
+-(LocalTreeCompactor*)initWithFields:(NSDictionary*)aFields
+{
+    self = [super init];
+    
+    if(self)
+    {
+        fields = aFields;
+    }
+    
+    return self;
+}
+
+-(NSDictionary*)compactRoot:(NSDictionary*)root
+{
+    prunedNodes = 0;
+    foldedNodes = 0;
+    collapsedNodes = 0;
+    
+    nodes = [self countNodes:root];
+    
+    NSDictionary* compactedRoot = [self compactNode:root constraints:[self constraints:@{} byApplyingPredicate:root[@"predicate"]]];
+    
+    compactedNodes = [self countNodes:compactedRoot];
+    
+    return compactedRoot;
+}
+
+-(NSDictionary*)statistics
+{
+    return @{@"nodes": @(nodes),
+             @"compactedNodes": @(compactedNodes),
+             @"prunedNodes": @(prunedNodes),
+             @"foldedNodes": @(foldedNodes),
+             @"collapsedNodes": @(collapsedNodes)};
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(NSDictionary*)compactNode:(NSDictionary*)node constraints:(NSDictionary*)constraints
+{
+    NSArray* children = node[@"children"];
+    NSMutableArray* reachableChildren = [NSMutableArray arrayWithCapacity:[children count]];
+    BOOL alwaysTaken = NO;
+    
+    //The children are tested in order and the first one that matches is taken
+    for(NSUInteger i = 0; i < [children count]; i++)
+    {
+        NSDictionary* child = children[i];
+        PredicateOutcome outcome = [self outcomeOfPredicate:child[@"predicate"] constraints:constraints];
+        
+        if(outcome == PredicateOutcomeNever)
+        {
+            prunedNodes += [self countNodes:child];
+            continue;
+        }
+        
+        [reachableChildren addObject:[self compactNode:child constraints:[self constraints:constraints byApplyingPredicate:child[@"predicate"]]]];
+        
+        if(outcome == PredicateOutcomeAlways)
+        {
+            for(NSUInteger j = i + 1; j < [children count]; j++)
+                prunedNodes += [self countNodes:children[j]];
+            
+            alwaysTaken = YES;
+            break;
+        }
+    }
+    
+    //The output of the node is never returned if its only child is always taken
+    if(alwaysTaken && [reachableChildren count] == 1)
+    {
+        NSMutableDictionary* folded = [reachableChildren[0] mutableCopy];
+        folded[@"predicate"] = node[@"predicate"];
+        
+        foldedNodes++;
+        
+        return folded;
+    }
+    
+    //A trailing leaf that predicts the same as its parent changes nothing, whether it matches or not
+    while([reachableChildren count] > 0)
+    {
+        NSDictionary* last = [reachableChildren lastObject];
+        
+        if([last[@"children"] count] > 0 || ![last[@"output"] isEqual:node[@"output"]] || !(last[@"confidence"] == node[@"confidence"] || [last[@"confidence"] isEqual:node[@"confidence"]]))
+            break;
+        
+        [reachableChildren removeLastObject];
+        collapsedNodes++;
+    }
+    
+    NSMutableDictionary* compacted = [node mutableCopy];
+    
+    if([reachableChildren count] > 0)
+        compacted[@"children"] = reachableChildren;
+    else
+        [compacted removeObjectForKey:@"children"];
+    
+    return compacted;
+}
+
+-(PredicateOutcome)outcomeOfPredicate:(NSObject*)predicate constraints:(NSDictionary*)constraints
+{
+    if(![predicate isKindOfClass:[NSDictionary class]])
+        return PredicateOutcomeUnknown;
+    
+    NSDictionary* predicateDict = (NSDictionary*)predicate;
+    FieldConstraint* constraint = constraints[predicateDict[@"field"]];
+    
+    //Without constraint the value of the field may be missing, and then no predicate is true
+    if(constraint == nil)
+        return PredicateOutcomeUnknown;
+    
+    NSString* operator = predicateDict[@"operator"];
+    NSObject* value = predicateDict[@"value"];
+    
+    if([self isNumericComparison:predicateDict])
+    {
+        double threshold = [(NSNumber*)value doubleValue];
+        double low = constraint.low, high = constraint.high;
+        
+        if([operator isEqualToString:OPERATOR_LT])
+        {
+            if(high < threshold || (high == threshold && constraint.highOpen))
+                return PredicateOutcomeAlways;
+            if(low >= threshold)
+                return PredicateOutcomeNever;
+        }
+        else if([operator isEqualToString:OPERATOR_LE])
+        {
+            if(high <= threshold)
+                return PredicateOutcomeAlways;
+            if(low > threshold || (low == threshold && constraint.lowOpen))
+                return PredicateOutcomeNever;
+        }
+        else if([operator isEqualToString:OPERATOR_GT])
+        {
+            if(low > threshold || (low == threshold && constraint.lowOpen))
+                return PredicateOutcomeAlways;
+            if(high <= threshold)
+                return PredicateOutcomeNever;
+        }
+        else if([operator isEqualToString:OPERATOR_GE])
+        {
+            if(low >= threshold)
+                return PredicateOutcomeAlways;
+            if(high < threshold || (high == threshold && constraint.highOpen))
+                return PredicateOutcomeNever;
+        }
+        
+        return PredicateOutcomeUnknown;
+    }
+    
+    if(![value isKindOfClass:[NSString class]])
+        return PredicateOutcomeUnknown;
+    
+    BOOL equal = [operator isEqualToString:OPERATOR_EQ];
+    BOOL notEqual = [operator isEqualToString:OPERATOR_NE] || [operator isEqualToString:OPERATOR_NE2];
+    
+    if(!equal && !notEqual)
+        return PredicateOutcomeUnknown;
+    
+    if(constraint.equal != nil)
+        return ([constraint.equal isEqualToString:(NSString*)value] == equal) ? PredicateOutcomeAlways : PredicateOutcomeNever;
+    
+    if([constraint.excluded containsObject:value])
+        return equal ? PredicateOutcomeNever : PredicateOutcomeAlways;
+    
+    return PredicateOutcomeUnknown;
+}
+
+-(NSDictionary*)constraints:(NSDictionary*)constraints byApplyingPredicate:(NSObject*)predicate
+{
+    if(![predicate isKindOfClass:[NSDictionary class]])
+        return constraints;
+    
+    NSDictionary* predicateDict = (NSDictionary*)predicate;
+    NSString* field = predicateDict[@"field"];
+    
+    if(field == nil)
+        return constraints;
+    
+    NSMutableDictionary* extended = [constraints mutableCopy];
+    FieldConstraint* constraint = [constraints[field] copy] ?: [[FieldConstraint alloc]init];
+    extended[field] = constraint;
+    
+    NSString* operator = predicateDict[@"operator"];
+    NSObject* value = predicateDict[@"value"];
+    
+    if([self isNumericComparison:predicateDict])
+    {
+        double threshold = [(NSNumber*)value doubleValue];
+        
+        if([operator isEqualToString:OPERATOR_LT] || [operator isEqualToString:OPERATOR_LE])
+        {
+            BOOL open = [operator isEqualToString:OPERATOR_LT];
+            
+            if(threshold < constraint.high || (threshold == constraint.high && open))
+            {
+                constraint.high = threshold;
+                constraint.highOpen = open;
+            }
+        }
+        else
+        {
+            BOOL open = [operator isEqualToString:OPERATOR_GT];
+            
+            if(threshold > constraint.low || (threshold == constraint.low && open))
+            {
+                constraint.low = threshold;
+                constraint.lowOpen = open;
+            }
+        }
+    }
+    else if([value isKindOfClass:[NSString class]])
+    {
+        if([operator isEqualToString:OPERATOR_EQ])
+            constraint.equal = (NSString*)value;
+        else if([operator isEqualToString:OPERATOR_NE] || [operator isEqualToString:OPERATOR_NE2])
+            constraint.excluded = [constraint.excluded setByAddingObject:value];
+    }
+    
+    return extended;
+}
+
+-(BOOL)isNumericComparison:(NSDictionary*)predicate
+{
+    NSString* operator = predicate[@"operator"];
+    
+    //Datetime thresholds are only parsed when the tree is compiled, and text fields are compared by term, so only
+    //numeric fields have intervals
+    return [fields[predicate[@"field"]][@"optype"] isEqualToString:OPTYPE_NUMERIC] &&
+           [predicate[@"value"] respondsToSelector:@selector(doubleValue)] &&
+           ([operator isEqualToString:OPERATOR_LT] || [operator isEqualToString:OPERATOR_LE] ||
+            [operator isEqualToString:OPERATOR_GT] || [operator isEqualToString:OPERATOR_GE]);
+}
+
+-(NSUInteger)countNodes:(NSDictionary*)node
+{
+    NSUInteger count = 1;
+    
+    for(NSDictionary* child in node[@"children"])
+        count += [self countNodes:child];
+    
+    return count;
+}
+
+@end
@@ -23,6 +23,21 @@
 #import "HTTPCommsManager.h"
 #import "Constants.h"
 #import "LocalPredictiveModel.h"
+#import "LocalDataSet.h"
+#import "LocalModelTrainer.h"
+#import "LocalClusterTrainer.h"
+#import "ReadinessScheduler.h"
+#import "WorkflowOperation.h"
+#import "ResourceEnumerator.h"
+#import "PredictionRouter.h"
+#import "ModelRegistry.h"
+#import "TraceRecorder.h"
+#import "TracingDelegateProxy.h"
+#import <objc/runtime.h>
+#import <stdatomic.h>
+
+//Identifier of the traced asynchronous operations
+static _Atomic uint64_t tracedOperations = 0;
 
 /**
  * Interface that contains private methods
@@ -38,6 +53,48 @@
  */
 -(NSOperation*)launchOperationWithSelector:(SEL)selector params:(NSObject*)params;
 
+/**
+ * Creates an asynchronous operation that runs a block, adding it to the queue
+ * @param name The name of the operation in the traces, a string literal or a selector name
+ * @param block The block to run, it receives the operation to check if it is cancelled
+ * @return The created NSOperation
+ */
+-(NSOperation*)launchOperationWithName:(const char*)name block:(void (^)(NSOperation* operation))block;
+
+/**
+ * Creates an asynchronous operation that makes a request and calls a completion handler with its result, unless the
+ * operation is cancelled
+ * @param request The block that makes the request
+ * @param name The name of the operation in the traces
+ * @param completion The completion handler
+ * @return The created NSOperation
+ */
+-(NSOperation*)launchRequest:(NSDictionary* (^)(NSInteger* code))request name:(const char*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Creates a readiness wait that calls a completion handler when it ends, unless it is cancelled
+ * @param probe The block that retrieves the current state of the resource
+ * @param timeout The maximum time to wait in seconds
+ * @param completion The completion handler
+ * @return The created wait
+ */
+-(NSOperation*)launchWaitWithProbe:(ReadinessProbe)probe timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion;
+
+/**
+ * Creates a readiness wait, adding it to the queue. The wait doesn't block any thread of the queue while waiting.
+ * @param probe The block that retrieves the current state of the resource
+ * @param timeout The maximum time to wait in seconds
+ */
+-(ReadinessWaitOperation*)launchWaitWithProbe:(ReadinessProbe)probe timeout:(NSTimeInterval)timeout;
+
+/**
+ * Creates a readiness wait with a block called when it ends, adding it to the queue once the block is set
+ * @param probe The block that retrieves the current state of the resource
+ * @param timeout The maximum time to wait in seconds
+ * @param completionBlock The block called with the wait when it ends, nil if none
+ */
+-(ReadinessWaitOperation*)launchWaitWithProbe:(ReadinessProbe)probe timeout:(NSTimeInterval)timeout completionBlock:(void (^)(ReadinessWaitOperation* wait))completionBlock;
+
 //*******************************************************************************
 //*****************************  ASYNC CALLBACKS  *******************************
 //*******************************************************************************
@@ -51,6 +108,7 @@
 #pragma mark DataSources Async Callbacks
 
 -(void)createDataSourceAction:(NSDictionary*)params;
+-(void)createDataSourcesWithUploadAction:(NSDictionary*)params;
 -(void)updateDataSourceAction:(NSDictionary*)params;
 -(void)deleteDataSourceAction:(NSDictionary*)params;
 -(void)getAllDataSourcesAction:(NSDictionary*)params;
@@ -91,12 +149,18 @@
 #pragma mark Predictions Async Callbacks
 
 -(void)createPredictionAction:(NSDictionary*)params;
+-(void)createPredictionsAction:(NSDictionary*)params;
 -(void)updatePredictionAction:(NSDictionary*)params;
 -(void)deletePredictionAction:(NSDictionary*)params;
 -(void)getAllPredictionsAction:(NSDictionary*)params;
 -(void)getPredictionAction:(NSDictionary*)params;
 -(void)checkPredictionIsReadyAction:(NSDictionary*)params;
 
+#pragma mark -
+#pragma mark Hybrid Predictions Async Callbacks
+
+-(void)predictAction:(NSDictionary*)params;
+
 @end
 
 #pragma mark -
@@ -106,17 +170,31 @@
 #pragma mark -
 
 @synthesize delegate;
+@synthesize metrics;
 
 #pragma mark -
 
 -(ML4iOS*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode
+{
+    return [self initWithUsername:username key:key developmentMode:devMode transport:nil];
+}
+
+-(ML4iOS*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode transport:(id<ML4iOSTransport>)transport
 {
     self = [super init];
     
     if(self)
     {
         operationQueue = [[NSOperationQueue alloc]init];
-        commsManager = [[HTTPCommsManager alloc]initWithUsername:username key:key developmentMode:devMode];
+        commsManager = [[HTTPCommsManager alloc]initWithUsername:username key:key developmentMode:devMode transport:transport];
+        readinessScheduler = [[ReadinessScheduler alloc]init];
+        NSString* cachesDirectory = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+        
+        //Without a username the models are kept only in memory
+        NSString* modelsDirectory = [username length] > 0 ? [[[cachesDirectory stringByAppendingPathComponent:@"ML4iOS"] stringByAppendingPathComponent:username] stringByAppendingPathComponent:@"Models"] : nil;
+        
+        modelRegistry = [[ModelRegistry alloc]initWithCommsManager:commsManager queue:operationQueue directory:modelsDirectory];
+        predictionRouter = [[PredictionRouter alloc]initWithCommsManager:commsManager modelRegistry:modelRegistry];
     }
     
     return self;
@@ -129,11 +207,174 @@
 
 -(NSOperation*)launchOperationWithSelector:(SEL)selector params:(NSObject*)params
 {
-    NSInvocationOperation *operation = [[NSInvocationOperation alloc] initWithTarget:self selector:selector object:params];
+    void (*action)(id, SEL, NSObject*) = (void (*)(id, SEL, NSObject*))[self methodForSelector:selector];
+    
+    return [self launchOperationWithName:sel_getName(selector) block:^(NSOperation* operation) {
+        action(self, selector, params);
+    }];
+}
+
+-(NSOperation*)launchOperationWithName:(const char*)name block:(void (^)(NSOperation* operation))block
+{
+    id<ML4iOSMetrics> queueMetrics = metrics;
+    BOOL tracing = TraceIsEnabled();
+    
+    //Measured operations record their wait in the queue before running the block
+    NSTimeInterval enqueued = queueMetrics != nil ? [[NSProcessInfo processInfo] systemUptime] : 0;
+    NSUInteger depth = 0;
+    
+    if(queueMetrics != nil)
+    {
+        @synchronized(self)
+        {
+            depth = ++pendingOperations;
+        }
+    }
+    
+    //Traced operations record their enqueue and their execution, correlated by identifier
+    uint64_t identifier = tracing ? atomic_fetch_add(&tracedOperations, 1) + 1 : 0;
+    
+    if(tracing)
+        TraceInstant("enqueue", "operation", identifier);
+    
+    NSBlockOperation* operation = [[NSBlockOperation alloc]init];
+    NSBlockOperation* __weak weakOperation = operation;
+    
+    [operation addExecutionBlock:^{
+        if(queueMetrics != nil)
+        {
+            @synchronized(self)
+            {
+                self->pendingOperations--;
+            }
+            
+            [queueMetrics recordQueueWait:[[NSProcessInfo processInfo] systemUptime] - enqueued queueDepth:depth];
+        }
+        
+        uint64_t start = TraceTimestamp();
+        
+        //The requests of the block are cancelled in flight when the operation is cancelled
+        [HTTPCommsManager performRequestsOfOperation:weakOperation block:^{
+            block(weakOperation);
+        }];
+        
+        TraceSpan(name, "operation", start, identifier);
+    }];
+    
     [operationQueue addOperation:operation];
+    
     return operation;
 }
 
+-(NSOperation*)launchRequest:(NSDictionary* (^)(NSInteger* code))request name:(const char*)name completion:(ResourceCompletion)completion
+{
+    return [self launchOperationWithName:name block:^(NSOperation* operation) {
+        if([operation isCancelled])
+            return;
+        
+        NSInteger statusCode = 0;
+        NSDictionary* resource = request(&statusCode);
+        
+        //A request cancelled while in flight doesn't call its completion
+        if(![operation isCancelled] && completion != nil)
+            completion(resource, statusCode);
+    }];
+}
+
+-(NSOperation*)launchWaitWithProbe:(ReadinessProbe)probe timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion
+{
+    return [self launchWaitWithProbe:probe timeout:timeout completionBlock:^(ReadinessWaitOperation* wait) {
+        if(![wait isCancelled] && completion != nil)
+            completion([wait ready], [wait resource]);
+    }];
+}
+
+-(id<ML4iOSDelegate>)delegate
+{
+    @synchronized(self)
+    {
+        return tracingProxy != nil ? [tracingProxy target] : delegate;
+    }
+}
+
+-(void)setDelegate:(id<ML4iOSDelegate>)aDelegate
+{
+    //Serialized with the swaps of the proxy, so a delegate set while tracing starts or stops is never lost
+    @synchronized(self)
+    {
+        if(tracingProxy != nil)
+            [tracingProxy setTarget:aDelegate];
+        else
+            delegate = aDelegate;
+    }
+}
+
+-(void)startTracingWithBufferCapacity:(NSUInteger)capacity
+{
+    //The responses reach the delegate through the proxy while tracing
+    @synchronized(self)
+    {
+        if(tracingProxy == nil)
+        {
+            tracingProxy = [[TracingDelegateProxy alloc]initWithTarget:delegate];
+            delegate = (id<ML4iOSDelegate>)tracingProxy;
+        }
+    }
+    
+    [TraceRecorder startTracingWithBufferCapacity:capacity];
+}
+
+-(BOOL)stopTracingAndWriteToFile:(NSString*)path
+{
+    [TraceRecorder stopTracing];
+    
+    @synchronized(self)
+    {
+        if(tracingProxy != nil)
+        {
+            delegate = [tracingProxy target];
+            tracingProxy = nil;
+        }
+    }
+    
+    return [TraceRecorder writeTraceToFile:path];
+}
+
+-(void)setMetrics:(id<ML4iOSMetrics>)aMetrics
+{
+    metrics = aMetrics;
+    
+    [commsManager setMetrics:aMetrics];
+    [modelRegistry setMetrics:aMetrics];
+    [predictionRouter setMetrics:aMetrics];
+}
+
+-(ReadinessWaitOperation*)launchWaitWithProbe:(ReadinessProbe)probe timeout:(NSTimeInterval)timeout
+{
+    return [self launchWaitWithProbe:probe timeout:timeout completionBlock:nil];
+}
+
+-(ReadinessWaitOperation*)launchWaitWithProbe:(ReadinessProbe)probe timeout:(NSTimeInterval)timeout completionBlock:(void (^)(ReadinessWaitOperation* wait))completionBlock
+{
+    ReadinessWaitOperation* wait = [[ReadinessWaitOperation alloc]initWithScheduler:readinessScheduler probe:probe timeout:timeout];
+    
+    //Set before the wait is enqueued, a wait that ends with its first probe could finish before
+    if(completionBlock != nil)
+    {
+        ReadinessWaitOperation* __weak weakWait = wait;
+        
+        [wait setCompletionBlock:^{
+            ReadinessWaitOperation* strongWait = weakWait;
+            
+            if(strongWait != nil)
+                completionBlock(strongWait);
+        }];
+    }
+    
+    [operationQueue addOperation:wait];
+    return wait;
+}
+
 -(void)dealloc
 {
     [operationQueue cancelAllOperations];
@@ -152,6 +393,31 @@
     return identifier;
 }
 
+-(void)enableResourceCacheWithTimeToLive:(NSTimeInterval)timeToLive
+{
+    [commsManager enableResourceCacheWithTimeToLive:timeToLive];
+}
+
+-(NSDictionary*)resourceCacheStatistics
+{
+    return [commsManager resourceCacheStatistics];
+}
+
+-(void)setRetryPolicyWithMaxRetries:(NSUInteger)maxRetries baseDelay:(NSTimeInterval)baseDelay maxDelay:(NSTimeInterval)maxDelay
+{
+    [commsManager setRetryPolicyWithMaxRetries:maxRetries baseDelay:baseDelay maxDelay:maxDelay];
+}
+
+-(void)setCircuitBreakerWithFailureThreshold:(NSUInteger)failureThreshold openInterval:(NSTimeInterval)openInterval
+{
+    [commsManager setCircuitBreakerWithFailureThreshold:failureThreshold openInterval:openInterval];
+}
+
+-(NSDictionary*)reliabilityStatistics
+{
+    return [commsManager reliabilityStatistics];
+}
+
 //*******************************************************************************
 //********************************  SOURCES  ************************************
 //****************** https://bigml.com/developers/sources ***********************
@@ -185,6 +451,28 @@
     [delegate dataSourceCreated:dataSource statusCode:statusCode];
 }
 
+-(NSArray*)createDataSourcesWithUploadSync:(ChunkedUpload*)upload statusCode:(NSInteger*)code
+{
+    return [commsManager createDataSourcesWithUpload:upload statusCode:code];
+}
+
+-(NSOperation*)createDataSourcesWithUpload:(ChunkedUpload*)upload
+{
+    NSMutableDictionary* params = [NSMutableDictionary dictionaryWithCapacity:1];
+    params[@"upload"] = upload;
+    
+    return [self launchOperationWithSelector:@selector(createDataSourcesWithUploadAction:) params:params];
+}
+
+-(void)createDataSourcesWithUploadAction:(NSDictionary*)params
+{
+    NSInteger statusCode = 0;
+    NSArray* dataSources = [commsManager createDataSourcesWithUpload:params[@"upload"] statusCode:&statusCode];
+    
+    if([delegate respondsToSelector:@selector(dataSourcesCreated:statusCode:)])
+        [delegate dataSourcesCreated:dataSources statusCode:statusCode];
+}
+
 -(NSDictionary*)updateDataSourceNameWithIdSync:(NSString*)identifier name:(NSString*)name statusCode:(NSInteger*)code
 {
     return [commsManager updateDataSourceNameWithId:identifier name:name statusCode:code];
@@ -257,6 +545,15 @@
     [delegate dataSourcesRetrieved:dataSources statusCode:statusCode];
 }
 
+-(ResourceEnumerator*)enumerateAllDataSourcesWithName:(NSString*)name pageSize:(NSInteger)pageSize
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+        return [manager getAllDataSourcesWithName:name offset:offset limit:limit statusCode:code];
+    } pageSize:pageSize queue:operationQueue];
+}
+
 -(NSDictionary*)getDataSourceWithIdSync:(NSString*)identifier statusCode:(NSInteger*)code
 {
     return [commsManager getDataSourceWithId:identifier statusCode:code];
@@ -312,6 +609,33 @@
     [delegate dataSourceIsReady:ready];
 }
 
+-(BOOL)waitUntilDataSourceIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ReadinessWaitOperation* wait = [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSourceWithId:identifier statusCode:code];
+    } timeout:timeout];
+    
+    [wait waitUntilFinished];
+    
+    return [wait ready];
+}
+
+-(NSOperation*)waitUntilDataSourceIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ML4iOS* __weak weakSelf = self;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSourceWithId:identifier statusCode:code];
+    } timeout:timeout completionBlock:^(ReadinessWaitOperation* wait) {
+        if(![wait isCancelled])
+            [[weakSelf delegate] dataSourceIsReady:[wait ready]];
+    }];
+}
+
 //*******************************************************************************
 //*********************************  DATASETS  **********************************
 //******************* https://bigml.com/developers/datasets *********************
@@ -417,6 +741,15 @@
     [delegate dataSetsRetrieved:dataSources statusCode:statusCode];
 }
 
+-(ResourceEnumerator*)enumerateAllDataSetsWithName:(NSString*)name pageSize:(NSInteger)pageSize
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+        return [manager getAllDataSetsWithName:name offset:offset limit:limit statusCode:code];
+    } pageSize:pageSize queue:operationQueue];
+}
+
 -(NSDictionary*)getDataSetWithIdSync:(NSString*)identifier statusCode:(NSInteger*)code
 {
     return [commsManager getDataSetWithId:identifier statusCode:code];
@@ -472,6 +805,33 @@
     [delegate dataSetIsReady:ready];
 }
 
+-(BOOL)waitUntilDataSetIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ReadinessWaitOperation* wait = [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSetWithId:identifier statusCode:code];
+    } timeout:timeout];
+    
+    [wait waitUntilFinished];
+    
+    return [wait ready];
+}
+
+-(NSOperation*)waitUntilDataSetIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ML4iOS* __weak weakSelf = self;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSetWithId:identifier statusCode:code];
+    } timeout:timeout completionBlock:^(ReadinessWaitOperation* wait) {
+        if(![wait isCancelled])
+            [[weakSelf delegate] dataSetIsReady:[wait ready]];
+    }];
+}
+
 //*******************************************************************************
 //*********************************  MODELS  ************************************
 //******************* https://bigml.com/developers/models ***********************
@@ -577,6 +937,15 @@
     [delegate modelsRetrieved:models statusCode:statusCode];
 }
 
+-(ResourceEnumerator*)enumerateAllModelsWithName:(NSString*)name pageSize:(NSInteger)pageSize
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+        return [manager getAllModelsWithName:name offset:offset limit:limit statusCode:code];
+    } pageSize:pageSize queue:operationQueue];
+}
+
 -(NSDictionary*)getModelWithIdSync:(NSString*)identifier statusCode:(NSInteger*)code
 {
     return [commsManager getModelWithId:identifier statusCode:code];
@@ -632,6 +1001,33 @@
     [delegate modelIsReady:ready];
 }
 
+-(BOOL)waitUntilModelIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ReadinessWaitOperation* wait = [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getModelWithId:identifier statusCode:code];
+    } timeout:timeout];
+    
+    [wait waitUntilFinished];
+    
+    return [wait ready];
+}
+
+-(NSOperation*)waitUntilModelIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ML4iOS* __weak weakSelf = self;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getModelWithId:identifier statusCode:code];
+    } timeout:timeout completionBlock:^(ReadinessWaitOperation* wait) {
+        if(![wait isCancelled])
+            [[weakSelf delegate] modelIsReady:[wait ready]];
+    }];
+}
+
 //*******************************************************************************
 //*********************************  CLUSTERS  **********************************
 //******************* https://bigml.com/developers/clusters *********************
@@ -739,6 +1135,15 @@
     [delegate clustersRetrieved:clusters statusCode:statusCode];
 }
 
+-(ResourceEnumerator*)enumerateAllClustersWithName:(NSString*)name pageSize:(NSInteger)pageSize
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+        return [manager getAllClustersWithName:name offset:offset limit:limit statusCode:code];
+    } pageSize:pageSize queue:operationQueue];
+}
+
 -(NSDictionary*)getClusterWithIdSync:(NSString*)identifier statusCode:(NSInteger*)code
 {
     return [commsManager getClusterWithId:identifier statusCode:code];
@@ -794,6 +1199,33 @@
     [delegate clusterIsReady:ready];
 }
 
+-(BOOL)waitUntilClusterIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ReadinessWaitOperation* wait = [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getClusterWithId:identifier statusCode:code];
+    } timeout:timeout];
+    
+    [wait waitUntilFinished];
+    
+    return [wait ready];
+}
+
+-(NSOperation*)waitUntilClusterIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ML4iOS* __weak weakSelf = self;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getClusterWithId:identifier statusCode:code];
+    } timeout:timeout completionBlock:^(ReadinessWaitOperation* wait) {
+        if(![wait isCancelled])
+            [[weakSelf delegate] clusterIsReady:[wait ready]];
+    }];
+}
+
 //*******************************************************************************
 //******************************  PREDICTIONS  **********************************
 //****************** https://bigml.com/developers/predictions *******************
@@ -829,6 +1261,36 @@
     [delegate predictionCreated:prediction statusCode:statusCode];
 }
 
+-(NSArray*)createPredictionsWithModelIdSync:(NSString*)modelId name:(NSString*)name inputDataList:(NSArray*)inputDataList maxConcurrentRequests:(NSInteger)maxConcurrentRequests statusCodes:(NSArray**)codes
+{
+    return [commsManager createPredictionsWithModelId:modelId name:name inputDataList:inputDataList maxConcurrentRequests:maxConcurrentRequests statusCodes:codes];
+}
+
+-(NSOperation*)createPredictionsWithModelId:(NSString*)modelId name:(NSString*)name inputDataList:(NSArray*)inputDataList maxConcurrentRequests:(NSInteger)maxConcurrentRequests
+{
+    NSMutableDictionary* params = [NSMutableDictionary dictionaryWithCapacity:4];
+    params[@"identifier"] = modelId;
+    params[@"name"] = name;
+    params[@"inputDataList"] = inputDataList;
+    params[@"maxConcurrentRequests"] = @(maxConcurrentRequests);
+    
+    return [self launchOperationWithSelector:@selector(createPredictionsAction:) params:params];
+}
+
+-(void)createPredictionsAction:(NSDictionary*)params
+{
+    NSArray* statusCodes = nil;
+    NSString* identifier = params[@"identifier"];
+    NSString* name = params[@"name"];
+    NSArray* inputDataList = params[@"inputDataList"];
+    NSInteger maxConcurrentRequests = [params[@"maxConcurrentRequests"]integerValue];
+    
+    NSArray* predictions = [commsManager createPredictionsWithModelId:identifier name:name inputDataList:inputDataList maxConcurrentRequests:maxConcurrentRequests statusCodes:&statusCodes];
+    
+    if([delegate respondsToSelector:@selector(predictionsCreated:statusCodes:)])
+        [delegate predictionsCreated:predictions statusCodes:statusCodes];
+}
+
 -(NSDictionary*)updatePredictionWithIdSync:(NSString*)identifier name:(NSString*)name statusCode:(NSInteger*)code
 {
     return [commsManager updatePredictionWithId:identifier name:name statusCode:code];
@@ -901,6 +1363,15 @@
     [delegate predictionsRetrieved:predictions statusCode:statusCode];
 }
 
+-(ResourceEnumerator*)enumerateAllPredictionsWithName:(NSString*)name pageSize:(NSInteger)pageSize
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+        return [manager getAllPredictionsWithName:name offset:offset limit:limit statusCode:code];
+    } pageSize:pageSize queue:operationQueue];
+}
+
 -(NSDictionary*)getPredictionWithIdSync:(NSString*)identifier statusCode:(NSInteger*)code
 {
     return [commsManager getPredictionWithId:identifier statusCode:code];
@@ -956,6 +1427,33 @@
     [delegate predictionIsReady:ready];
 }
 
+-(BOOL)waitUntilPredictionIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ReadinessWaitOperation* wait = [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getPredictionWithId:identifier statusCode:code];
+    } timeout:timeout];
+    
+    [wait waitUntilFinished];
+    
+    return [wait ready];
+}
+
+-(NSOperation*)waitUntilPredictionIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    ML4iOS* __weak weakSelf = self;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getPredictionWithId:identifier statusCode:code];
+    } timeout:timeout completionBlock:^(ReadinessWaitOperation* wait) {
+        if(![wait isCancelled])
+            [[weakSelf delegate] predictionIsReady:[wait ready]];
+    }];
+}
+
 //*******************************************************************************
 //***************************  LOCAL PREDICTIONS  *******************************
 //*******************************************************************************
@@ -965,7 +1463,461 @@
 
 -(NSDictionary*)createLocalPredictionWithJSONModelSync:(NSDictionary*)jsonModel arguments:(NSString*)args argsByName:(BOOL)byName
 {
-    return [LocalPredictiveModel predictWithJSONModel:jsonModel arguments:args argsByName:NO];
+    id<ML4iOSMetrics> predictionMetrics = metrics;
+    
+    if(predictionMetrics == nil)
+        return [LocalPredictiveModel predictWithJSONModel:jsonModel arguments:args argsByName:byName];
+    
+    //The model is compiled on every call, so both measures are taken
+    NSTimeInterval start = [[NSProcessInfo processInfo] systemUptime];
+    LocalPredictiveModel* localModel = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    NSTimeInterval compiled = [[NSProcessInfo processInfo] systemUptime];
+    
+    NSDictionary* prediction = [localModel predictWithArguments:args argsByName:byName];
+    
+    [predictionMetrics recordModelCompilationWithId:[ML4iOS getResourceIdentifierFromJSONObject:jsonModel] duration:compiled - start];
+    [predictionMetrics recordLocalPredictionWithDuration:[[NSProcessInfo processInfo] systemUptime] - compiled];
+    
+    return prediction;
+}
+
+//*******************************************************************************
+//*****************************  LOCAL TRAINING  ********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Local Training
+
+-(NSDictionary*)createLocalModelWithFilePathSync:(NSString*)filePath name:(NSString*)name
+{
+    LocalDataSet* dataSet = [[LocalDataSet alloc]initWithContentsOfCSVFile:filePath];
+    
+    if(dataSet == nil)
+        return nil;
+    
+    return [[[LocalModelTrainer alloc]initWithDataSet:dataSet]trainModelWithName:name objectiveFieldId:nil];
+}
+
+-(NSDictionary*)createLocalClusterWithFilePathSync:(NSString*)filePath name:(NSString*)name numberOfClusters:(NSInteger)k
+{
+    LocalDataSet* dataSet = [[LocalDataSet alloc]initWithContentsOfCSVFile:filePath];
+    
+    if(dataSet == nil)
+        return nil;
+    
+    return [[[LocalClusterTrainer alloc]initWithDataSet:dataSet]trainClusterWithName:name numberOfClusters:k];
+}
+
+//*******************************************************************************
+//***************************  HYBRID PREDICTIONS  ******************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Hybrid Predictions
+
+-(NSDictionary*)predictWithModelIdSync:(NSString*)modelId input:(NSString*)input statusCode:(NSInteger*)code
+{
+    return [predictionRouter predictWithModelId:modelId inputData:input statusCode:code];
+}
+
+-(NSOperation*)predictWithModelId:(NSString*)modelId input:(NSString*)input
+{
+    NSMutableDictionary* params = [NSMutableDictionary dictionaryWithCapacity:2];
+    params[@"identifier"] = modelId;
+    params[@"input"] = input;
+    
+    return [self launchOperationWithSelector:@selector(predictAction:) params:params];
+}
+
+-(void)predictAction:(NSDictionary*)params
+{
+    NSInteger statusCode = 0;
+    NSString* identifier = params[@"identifier"];
+    NSString* input = params[@"input"];
+    
+    NSDictionary* prediction = [predictionRouter predictWithModelId:identifier inputData:input statusCode:&statusCode];
+    
+    if([delegate respondsToSelector:@selector(hybridPredictionCreated:statusCode:)])
+        [delegate hybridPredictionCreated:prediction statusCode:statusCode];
+}
+
+-(NSDictionary*)hybridPredictionStatistics
+{
+    return [predictionRouter statistics];
+}
+
+-(void)startModelRefreshWithInterval:(NSTimeInterval)interval
+{
+    [modelRegistry startRefreshingWithInterval:interval];
+}
+
+-(void)stopModelRefresh
+{
+    [modelRegistry stopRefreshing];
+}
+
+-(void)setModelMemoryBudget:(NSUInteger)budget
+{
+    [modelRegistry setMemoryBudget:budget];
+}
+
+-(void)setModelDiskBudget:(NSUInteger)budget
+{
+    [modelRegistry setDiskBudget:budget];
+}
+
+//*******************************************************************************
+//*******************************  WORKFLOWS  ***********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Workflows
+
+-(NSDictionary*)runWorkflowWithNameSync:(NSString*)name filePath:(NSString*)filePath inputData:(NSString*)inputData timeout:(NSTimeInterval)timeout statusCode:(NSInteger*)code
+{
+    WorkflowOperation* workflow = [[WorkflowOperation alloc]initWithName:name filePath:filePath inputData:inputData timeout:timeout queue:operationQueue commsManager:commsManager readinessScheduler:readinessScheduler];
+    
+    [operationQueue addOperation:workflow];
+    [workflow waitUntilFinished];
+    
+    *code = [workflow statusCode];
+    
+    return [workflow result];
+}
+
+-(NSOperation*)runWorkflowWithName:(NSString*)name filePath:(NSString*)filePath inputData:(NSString*)inputData timeout:(NSTimeInterval)timeout
+{
+    WorkflowOperation* workflow = [[WorkflowOperation alloc]initWithName:name filePath:filePath inputData:inputData timeout:timeout queue:operationQueue commsManager:commsManager readinessScheduler:readinessScheduler];
+    
+    WorkflowOperation* __weak weakWorkflow = workflow;
+    ML4iOS* __weak weakSelf = self;
+    
+    [workflow setCompletionBlock:^{
+        id<ML4iOSDelegate> workflowDelegate = [weakSelf delegate];
+        
+        if(![weakWorkflow isCancelled] && [workflowDelegate respondsToSelector:@selector(workflowFinishedWithModel:prediction:statusCode:)])
+            [workflowDelegate workflowFinishedWithModel:[weakWorkflow model] prediction:[weakWorkflow prediction] statusCode:[weakWorkflow statusCode]];
+    }];
+    
+    [operationQueue addOperation:workflow];
+    
+    return workflow;
+}
+
+//*******************************************************************************
+//***************************  COMPLETION HANDLERS  *****************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark DataSources
+
+-(NSOperation*)createDataSourceWithName:(NSString*)name filePath:(NSString*)filePath completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager createDataSourceWithName:name filePath:filePath statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)updateDataSourceNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager updateDataSourceNameWithId:identifier name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)deleteDataSourceWithId:(NSString*)identifier completion:(StatusCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        *code = [manager deleteDataSourceWithId:identifier];
+        return nil;
+    } name:sel_getName(_cmd) completion:^(NSDictionary* resource, NSInteger statusCode) {
+        if(completion != nil)
+            completion(statusCode);
+    }];
+}
+
+-(NSOperation*)getAllDataSourcesWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getAllDataSourcesWithName:name offset:offset limit:limit statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)getDataSourceWithId:(NSString*)identifier completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSourceWithId:identifier statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)waitUntilDataSourceIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSourceWithId:identifier statusCode:code];
+    } timeout:timeout completion:completion];
+}
+
+#pragma mark DataSets
+
+-(NSOperation*)createDataSetWithDataSourceId:(NSString*)sourceId name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager createDataSetWithDataSourceId:sourceId name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)updateDataSetNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager updateDataSetNameWithId:identifier name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)deleteDataSetWithId:(NSString*)identifier completion:(StatusCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        *code = [manager deleteDataSetWithId:identifier];
+        return nil;
+    } name:sel_getName(_cmd) completion:^(NSDictionary* resource, NSInteger statusCode) {
+        if(completion != nil)
+            completion(statusCode);
+    }];
+}
+
+-(NSOperation*)getAllDataSetsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getAllDataSetsWithName:name offset:offset limit:limit statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)getDataSetWithId:(NSString*)identifier completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSetWithId:identifier statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)waitUntilDataSetIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getDataSetWithId:identifier statusCode:code];
+    } timeout:timeout completion:completion];
+}
+
+#pragma mark Models
+
+-(NSOperation*)createModelWithDataSetId:(NSString*)dataSetId name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager createModelWithDataSetId:dataSetId name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)updateModelNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager updateModelNameWithId:identifier name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)deleteModelWithId:(NSString*)identifier completion:(StatusCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        *code = [manager deleteModelWithId:identifier];
+        return nil;
+    } name:sel_getName(_cmd) completion:^(NSDictionary* resource, NSInteger statusCode) {
+        if(completion != nil)
+            completion(statusCode);
+    }];
+}
+
+-(NSOperation*)getAllModelsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getAllModelsWithName:name offset:offset limit:limit statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)getModelWithId:(NSString*)identifier completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getModelWithId:identifier statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)waitUntilModelIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getModelWithId:identifier statusCode:code];
+    } timeout:timeout completion:completion];
+}
+
+#pragma mark Clusters
+
+-(NSOperation*)createClusterWithDataSetId:(NSString*)dataSetId name:(NSString*)name numberOfClusters:(NSInteger)k completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager createClusterWithDataSetId:dataSetId name:name numberOfClusters:k statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)updateClusterNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager updateClusterNameWithId:identifier name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)deleteClusterWithId:(NSString*)identifier completion:(StatusCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        *code = [manager deleteClusterWithId:identifier];
+        return nil;
+    } name:sel_getName(_cmd) completion:^(NSDictionary* resource, NSInteger statusCode) {
+        if(completion != nil)
+            completion(statusCode);
+    }];
+}
+
+-(NSOperation*)getAllClustersWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getAllClustersWithName:name offset:offset limit:limit statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)getClusterWithId:(NSString*)identifier completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getClusterWithId:identifier statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)waitUntilClusterIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getClusterWithId:identifier statusCode:code];
+    } timeout:timeout completion:completion];
+}
+
+#pragma mark Predictions
+
+-(NSOperation*)createPredictionWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager createPredictionWithModelId:modelId name:name inputData:inputData statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)updatePredictionWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager updatePredictionWithId:identifier name:name statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)deletePredictionWithId:(NSString*)identifier completion:(StatusCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        *code = [manager deletePredictionWithId:identifier];
+        return nil;
+    } name:sel_getName(_cmd) completion:^(NSDictionary* resource, NSInteger statusCode) {
+        if(completion != nil)
+            completion(statusCode);
+    }];
+}
+
+-(NSOperation*)getAllPredictionsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getAllPredictionsWithName:name offset:offset limit:limit statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)getPredictionWithId:(NSString*)identifier completion:(ResourceCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [manager getPredictionWithId:identifier statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
+}
+
+-(NSOperation*)waitUntilPredictionIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion
+{
+    HTTPCommsManager* manager = commsManager;
+    
+    return [self launchWaitWithProbe:^NSDictionary*(NSInteger* code) {
+        return [manager getPredictionWithId:identifier statusCode:code];
+    } timeout:timeout completion:completion];
+}
+
+#pragma mark Hybrid Predictions
+
+-(NSOperation*)predictWithModelId:(NSString*)modelId input:(NSString*)input completion:(ResourceCompletion)completion
+{
+    PredictionRouter* router = predictionRouter;
+    
+    return [self launchRequest:^NSDictionary*(NSInteger* code) {
+        return [router predictWithModelId:modelId inputData:input statusCode:code];
+    } name:sel_getName(_cmd) completion:completion];
 }
 
 @end
@@ -0,0 +1,225 @@
+/**
+ *
+ * MetricsRecorder.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "MetricsRecorder.h"
+
+//Buckets of the histograms, the bucket i contains the durations up to 2^i microseconds
+#define HISTOGRAM_BUCKETS 32
+
+/**
+ * Histogram of durations with logarithmic buckets
+ */
+@interface MetricsHistogram : NSObject
+{
+@public
+    uint64_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t count;
+    double sum;
+    double min;
+    double max;
+}
+
+-(void)recordDuration:(NSTimeInterval)duration;
+-(NSTimeInterval)percentile:(double)percentile;
+-(NSDictionary*)summary;
+
+@end
+
+@implementation MetricsHistogram
+
+-(void)recordDuration:(NSTimeInterval)duration
+{
+    uint64_t micros = (uint64_t)MAX(duration * 1e6, 1);
+    NSUInteger bucket = MIN((NSUInteger)(64 - __builtin_clzll(micros)), HISTOGRAM_BUCKETS - 1);
+    
+    buckets[bucket]++;
+    
+    min = count == 0 ? duration : MIN(min, duration);
+    max = count == 0 ? duration : MAX(max, duration);
+    sum += duration;
+    count++;
+}
+
+-(NSTimeInterval)percentile:(double)percentile
+{
+    uint64_t rank = (uint64_t)ceil(percentile * count);
+    uint64_t accumulated = 0;
+    
+    for(NSUInteger i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        accumulated += buckets[i];
+        
+        if(accumulated >= rank)
+            return MIN((double)(1ULL << i) / 1e6, max);
+    }
+    
+    return max;
+}
+
+-(NSDictionary*)summary
+{
+    return @{@"count": @(count),
+             @"mean": @(count > 0 ? sum / count : 0),
+             @"min": @(min),
+             @"max": @(max),
+             @"p50": @([self percentile:0.5]),
+             @"p90": @([self percentile:0.9]),
+             @"p99": @([self percentile:0.99])};
+}
+
+@end
+
+#pragma mark -
+
+/**
+ * Interface that contains private methods
+ */
+@interface MetricsRecorder()
+
+/**
+ * Adds a duration to a histogram, creating it if needed. Must be called holding the lock.
+ */
+-(void)recordDuration:(NSTimeInterval)duration inHistogram:(NSString*)name;
+
+/**
+ * Adds a value to a counter, creating it if needed. Must be called holding the lock.
+ */
+-(void)addValue:(int64_t)value toCounter:(NSString*)name;
+
+@end
+
+#pragma mark -
+
+@implementation MetricsRecorder
+
+-(MetricsRecorder*)init
+{
+    self = [super init];
+    
+    if(self)
+    {
+        histograms = [[NSMutableDictionary alloc]init];
+        counters = [[NSMutableDictionary alloc]init];
+    }
+    
+    return self;
+}
+
+-(void)recordDuration:(NSTimeInterval)duration inHistogram:(NSString*)name
+{
+    MetricsHistogram* histogram = histograms[name];
+    
+    if(histogram == nil)
+    {
+        histogram = [[MetricsHistogram alloc]init];
+        histograms[name] = histogram;
+    }
+    
+    [histogram recordDuration:duration];
+}
+
+-(void)addValue:(int64_t)value toCounter:(NSString*)name
+{
+    counters[name] = @([counters[name]longLongValue] + value);
+}
+
+#pragma mark -
+#pragma mark ML4iOSMetrics
+
+-(void)recordRequestWithEndpoint:(NSString*)endpoint method:(NSString*)method statusCode:(NSInteger)code phases:(NSDictionary*)phases bytesSent:(int64_t)bytesSent bytesReceived:(int64_t)bytesReceived
+{
+    NSString* name = endpoint ?: @"other";
+    
+    @synchronized(self)
+    {
+        for(NSString* phase in phases)
+            [self recordDuration:[phases[phase]doubleValue] inHistogram:[NSString stringWithFormat:@"%@.%@", name, phase]];
+        
+        [self addValue:1 toCounter:[name stringByAppendingString:@".requests"]];
+        [self addValue:bytesSent toCounter:[name stringByAppendingString:@".bytesSent"]];
+        [self addValue:bytesReceived toCounter:[name stringByAppendingString:@".bytesReceived"]];
+        
+        if(code == 0 || code >= 400)
+            [self addValue:1 toCounter:[name stringByAppendingString:@".errors"]];
+    }
+}
+
+-(void)recordParsingWithEndpoint:(NSString*)endpoint duration:(NSTimeInterval)duration bytes:(NSUInteger)bytes
+{
+    @synchronized(self)
+    {
+        [self recordDuration:duration inHistogram:[NSString stringWithFormat:@"%@.parse", endpoint ?: @"other"]];
+    }
+}
+
+-(void)recordQueueWait:(NSTimeInterval)wait queueDepth:(NSUInteger)depth
+{
+    @synchronized(self)
+    {
+        [self recordDuration:wait inHistogram:@"queueWait"];
+        
+        counters[@"maxQueueDepth"] = @(MAX([counters[@"maxQueueDepth"]unsignedIntegerValue], depth));
+    }
+}
+
+-(void)recordLocalPredictionWithDuration:(NSTimeInterval)duration
+{
+    @synchronized(self)
+    {
+        [self recordDuration:duration inHistogram:@"localPrediction"];
+    }
+}
+
+-(void)recordModelCompilationWithId:(NSString*)modelId duration:(NSTimeInterval)duration
+{
+    @synchronized(self)
+    {
+        [self recordDuration:duration inHistogram:@"modelCompilation"];
+    }
+}
+
+#pragma mark -
+
+-(NSDictionary*)snapshot
+{
+    @synchronized(self)
+    {
+        NSMutableDictionary* summaries = [NSMutableDictionary dictionaryWithCapacity:[histograms count]];
+        
+        for(NSString* name in histograms)
+            summaries[name] = [histograms[name] summary];
+        
+        return @{@"histograms": summaries,
+                 @"counters": [counters copy]};
+    }
+}
+
+-(void)reset
+{
+    @synchronized(self)
+    {
+        [histograms removeAllObjects];
+        [counters removeAllObjects];
+    }
+}
+
+@end
@@ -0,0 +1,162 @@
+/**
+ *
+ * ModelRegistry.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+@class HTTPCommsManager;
+@class LocalPredictiveModel;
+@protocol ML4iOSMetrics;
+
+/**
+ * Registry of compiled local models keyed by model identifier.
+ * The models are downloaded and compiled in background, and can be refreshed periodically to pick up the new versions
+ * of models updated in BigML under the same identifier. A new version is compiled off the prediction path and swapped in
+ * atomically: the registry publishes a new immutable snapshot of the models, so the predictions in flight finish with the
+ * old tree they already hold and no lookup ever waits for a reload.
+ * The compiled models can be bounded by a memory budget. When it is exceeded the least recently used models are
+ * evicted, keeping the copy of their JSON on disk, and compiled again from that copy the next time they are used.
+ * The copies are named after the version of the model, so an evicted model is only compiled again from the version
+ * it had in memory. Every registry keeps its copies in a directory of its own, created with the first copy and deleted
+ * with the registry, so registries of the same user never delete the copies of each other. The copies of other
+ * versions are deleted, and the copies of the least recently used models are deleted once the disk budget is exceeded.
+ */
+@interface ModelRegistry : NSObject
+{
+    HTTPCommsManager* commsManager;
+    NSOperationQueue* queue;
+    NSString* directory;
+    
+    /**
+     * Immutable snapshot of the entries keyed by model identifier, replaced on every change
+     */
+    NSDictionary* entries;
+    
+    /**
+     * Identifiers of the models being downloaded and compiled
+     */
+    NSMutableSet* loadingModels;
+    
+    /**
+     * Serial queue and timer of the periodic refresh
+     */
+    dispatch_queue_t refreshQueue;
+    dispatch_source_t refreshTimer;
+    BOOL refreshing;
+    
+    /**
+     * Maximum bytes of the compiled models, 0 if unlimited, and clock that orders the lookups of the models
+     */
+    NSUInteger memoryBudget;
+    uint64_t useClock;
+    
+    /**
+     * Maximum bytes of the copies of the models on disk, 0 if unlimited, and the lock that keeps the writes and the
+     * deletions of the copies in order
+     */
+    NSUInteger diskBudget;
+    NSObject* diskLock;
+    BOOL directoryCreated;
+    
+    //Statistics
+    NSUInteger reloads;
+    NSUInteger evictions;
+    NSUInteger residentLookups;
+    NSUInteger evictedLookups;
+    NSUInteger diskReloads;
+    NSTimeInterval diskReloadLatency;
+    NSTimeInterval maximumDiskReloadLatency;
+    NSUInteger diskModels;
+    NSUInteger diskBytes;
+    
+    id<ML4iOSMetrics> metrics;
+}
+
+/**
+ * Receives the duration of the compilations, nil if the metrics are disabled
+ */
+@property (nonatomic, strong) id<ML4iOSMetrics> metrics;
+
+/**
+ * Maximum bytes of the compiled models, as estimated by their footprint, 0 if unlimited (default). Setting a lower
+ * budget evicts the least recently used models right away. The last model loaded is never evicted, so a single model
+ * bigger than the budget is still served locally.
+ */
+@property (nonatomic) NSUInteger memoryBudget;
+
+/**
+ * Maximum bytes of the copies of the models on disk, 0 if unlimited (default 64 MB). Setting a lower budget deletes
+ * the copies of the least recently used models in background. An evicted model without copy is downloaded again.
+ */
+@property (nonatomic) NSUInteger diskBudget;
+
+/**
+ * Initializes the registry
+ * @param aCommsManager The comms manager used to download the models
+ * @param aQueue The queue where the models are downloaded and compiled
+ * @param aDirectory The directory where the registry creates its own directory to keep the JSON of the models and
+ * compile them again after an eviction, nil to keep no copies. Nothing is written until a model is compiled.
+ */
+-(ModelRegistry*)initWithCommsManager:(HTTPCommsManager*)aCommsManager queue:(NSOperationQueue*)aQueue directory:(NSString*)aDirectory;
+
+/**
+ * Looks for a compiled model without blocking
+ * @param modelId The identifier of the model
+ * @return The compiled model, nil if it isn't loaded yet or it was evicted
+ */
+-(LocalPredictiveModel*)localModelWithId:(NSString*)modelId;
+
+/**
+ * Launches in background the download and compilation of a model, unless it is already loaded or being loaded.
+ * If the model is not FINISHED yet it is not compiled, so it can be loaded again later. An evicted model is compiled
+ * from its copy on disk, and downloaded only if the copy can't be read.
+ * @param modelId The identifier of the model
+ */
+-(void)loadModelWithId:(NSString*)modelId;
+
+/**
+ * Starts checking periodically for new versions of the loaded models
+ * @param interval The time in seconds between checks
+ */
+-(void)startRefreshingWithInterval:(NSTimeInterval)interval;
+
+/**
+ * Stops the periodic checks
+ */
+-(void)stopRefreshing;
+
+/**
+ * Checks once for new versions of the loaded models that aren't evicted, blocking the caller thread until all of them are checked
+ * and the new versions swapped in
+ */
+-(void)refreshModels;
+
+/**
+ * @return The statistics of the registry: number of "compiledModels" in memory and "evictedModels", "reloads" of new
+ * versions, "nodes" of the trees of the compiled models before and after ("compactedNodes") their compaction, the
+ * "residentBytes" of the compiled models and the "memoryBudget", the number of "evictions", the lookups of models in
+ * memory ("residentLookups") and evicted ("evictedLookups") and the "residencyRatio" between them, and the number of
+ * "diskReloads" of evicted models with their "averageDiskReloadLatency" and "maximumDiskReloadLatency" in seconds,
+ * and the number of copies of models on disk ("diskModels") with their "diskBytes" and the "diskBudget"
+ */
+-(NSDictionary*)statistics;
+
+@end
@@ -0,0 +1,625 @@
+/**
+ *
+ * ModelRegistry.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "ModelRegistry.h"
+#import "HTTPCommsManager.h"
+#import "LocalPredictiveModel.h"
+#import "ML4iOSMetrics.h"
+#import "Constants.h"
+
+//Disk
+#define DEFAULT_DISK_BUDGET (64 * 1024 * 1024)
+
+/**
+ * @return The string with the characters that aren't letters, digits, '-' or '.' replaced with '_', so it can be part
+ * of a file name
+ */
+static NSString* FileNameComponent(NSString* string)
+{
+    static NSCharacterSet* invalidCharacters = nil;
+    static dispatch_once_t once;
+    
+    dispatch_once(&once, ^{
+        NSMutableCharacterSet* validCharacters = [NSMutableCharacterSet alphanumericCharacterSet];
+        [validCharacters addCharactersInString:@"-."];
+        invalidCharacters = [validCharacters invertedSet];
+    });
+    
+    return [[string componentsSeparatedByCharactersInSet:invalidCharacters] componentsJoinedByString:@"_"];
+}
+
+/**
+ * A compiled model and the version it was compiled from. An evicted model keeps its entry without the compiled model.
+ */
+@interface ModelRegistryEntry : NSObject
+
+@property (nonatomic, strong) LocalPredictiveModel* model;
+@property (nonatomic, copy) NSString* updated;
+@property (nonatomic) NSUInteger footprint;
+@property (nonatomic) uint64_t lastUse;
+
+@end
+
+@implementation ModelRegistryEntry
+
+@end
+
+#pragma mark -
+
+/**
+ * Interface that contains private methods
+ */
+@interface ModelRegistry()
+
+/**
+ * Downloads a model and, if it is FINISHED and newer than the loaded version, compiles it and swaps it in
+ * @param modelId The identifier of the model
+ * @param revalidate If true the server is asked for a new version even if the resource cache holds a fresh copy
+ * @return true if a new version was swapped in, else false
+ */
+-(BOOL)compileModelWithId:(NSString*)modelId revalidate:(BOOL)revalidate;
+
+/**
+ * Compiles an evicted model from its copy on disk and swaps it in
+ * @param modelId The identifier of the model
+ * @return true if the model was swapped in, else false
+ */
+-(BOOL)reloadModelWithId:(NSString*)modelId;
+
+/**
+ * Publishes a new snapshot of the entries with the entry passed as parameter, evicting the least recently used models
+ * if the memory budget is exceeded. The entry is only swapped in if the model in memory is still the version it was
+ * compiled to replace, so a slow compilation never replaces the newer version swapped in by another one.
+ * @param entry The new entry of the model
+ * @param modelId The identifier of the model
+ * @param loadedVersion The version in memory when the compilation started, nil if the model wasn't in memory
+ * @return true if the entry was swapped in, else false
+ */
+-(BOOL)swapEntry:(ModelRegistryEntry*)entry forModelId:(NSString*)modelId replacingVersion:(NSString*)loadedVersion;
+
+/**
+ * Replaces the least recently used compiled models with evicted entries until they fit in the memory budget, keeping
+ * at least the most recently used one. Must be called inside the lock.
+ * @param snapshot The entries keyed by model identifier
+ */
+-(void)evictModelsOfSnapshot:(NSMutableDictionary*)snapshot;
+
+/**
+ * @param modelId The identifier of the model
+ * @param version The "updated" date of the version of the model
+ * @return The path of the file that stores the JSON of that version of the model
+ */
+-(NSString*)pathOfModelWithId:(NSString*)modelId version:(NSString*)version;
+
+/**
+ * Creates the directory of the copies the first time a copy is written. Must be called inside the lock of the disk.
+ * @return true if the directory exists, false if the registry keeps no copies or it can't be created
+ */
+-(BOOL)prepareDirectory;
+
+/**
+ * Deletes the copies on disk of the models that aren't in the registry or of other versions than the one in the
+ * registry, and then the copies of the least recently used models until they fit in the disk budget
+ */
+-(void)pruneModelFiles;
+
+@end
+
+#pragma mark -
+
+@implementation ModelRegistry
+
+@synthesize metrics;
+
+-(ModelRegistry*)initWithCommsManager:(HTTPCommsManager*)aCommsManager queue:(NSOperationQueue*)aQueue directory:(NSString*)aDirectory
+{
+    self = [super init];
+    
+    if(self)
+    {
+        commsManager = aCommsManager;
+        queue = aQueue;
+        
+        //A directory of its own, so the registry only ever deletes the copies it wrote
+        directory = aDirectory != nil ? [aDirectory stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]] : nil;
+        entries = [NSDictionary dictionary];
+        loadingModels = [[NSMutableSet alloc]init];
+        refreshQueue = dispatch_queue_create("ml4ios.registry", DISPATCH_QUEUE_SERIAL);
+        diskBudget = DEFAULT_DISK_BUDGET;
+        diskLock = [[NSObject alloc]init];
+    }
+    
+    return self;
+}
+
+-(void)dealloc
+{
+    if(refreshTimer != nil)
+        dispatch_source_cancel(refreshTimer);
+    
+    if(directoryCreated)
+        [[NSFileManager defaultManager] removeItemAtPath:directory error:nil];
+}
+
+-(NSUInteger)memoryBudget
+{
+    @synchronized(self)
+    {
+        return memoryBudget;
+    }
+}
+
+-(void)setMemoryBudget:(NSUInteger)aMemoryBudget
+{
+    @synchronized(self)
+    {
+        memoryBudget = aMemoryBudget;
+        
+        NSMutableDictionary* snapshot = [entries mutableCopy];
+        [self evictModelsOfSnapshot:snapshot];
+        
+        entries = [snapshot copy];
+    }
+}
+
+-(NSUInteger)diskBudget
+{
+    @synchronized(self)
+    {
+        return diskBudget;
+    }
+}
+
+-(void)setDiskBudget:(NSUInteger)aDiskBudget
+{
+    @synchronized(self)
+    {
+        diskBudget = aDiskBudget;
+    }
+    
+    ModelRegistry* __weak weakSelf = self;
+    
+    [queue addOperationWithBlock:^{
+        [weakSelf pruneModelFiles];
+    }];
+}
+
+-(LocalPredictiveModel*)localModelWithId:(NSString*)modelId
+{
+    //Only the entry is looked up and stamped inside the lock, the model it holds is immutable
+    @synchronized(self)
+    {
+        ModelRegistryEntry* entry = entries[modelId];
+        
+        if(entry.model != nil)
+        {
+            entry.lastUse = ++useClock;
+            residentLookups++;
+        }
+        else if(entry != nil)
+            evictedLookups++;
+        
+        return entry.model;
+    }
+}
+
+-(void)loadModelWithId:(NSString*)modelId
+{
+    BOOL evicted = NO;
+    
+    @synchronized(self)
+    {
+        ModelRegistryEntry* entry = entries[modelId];
+        
+        if([loadingModels containsObject:modelId] || entry.model != nil)
+            return;
+        
+        evicted = entry != nil;
+        [loadingModels addObject:modelId];
+    }
+    
+    //An evicted model is downloaded again only if its copy can't be compiled
+    [queue addOperationWithBlock:^{
+        if(!evicted || ![self reloadModelWithId:modelId])
+            [self compileModelWithId:modelId revalidate:NO];
+    }];
+}
+
+-(BOOL)compileModelWithId:(NSString*)modelId revalidate:(BOOL)revalidate
+{
+    NSInteger statusCode = 0;
+    NSDictionary* jsonModel = [commsManager getModelWithId:modelId revalidate:revalidate statusCode:&statusCode];
+    
+    NSString* updated = jsonModel[@"updated"];
+    BOOL swapped = NO;
+    
+    NSString* loadedVersion = nil;
+    
+    //An evicted model is compiled again even if the version didn't change
+    @synchronized(self)
+    {
+        ModelRegistryEntry* loadedEntry = entries[modelId];
+        loadedVersion = loadedEntry.model != nil ? loadedEntry.updated : nil;
+    }
+    
+    //Compiled outside any lock, the loaded version keeps serving predictions meanwhile
+    if(jsonModel != nil && [jsonModel[@"status"][@"code"]intValue] == FINISHED && (loadedVersion == nil || ![loadedVersion isEqualToString:updated]))
+    {
+        id<ML4iOSMetrics> compilationMetrics = metrics;
+        NSTimeInterval start = compilationMetrics != nil ? [[NSProcessInfo processInfo] systemUptime] : 0;
+        
+        LocalPredictiveModel* localModel = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+        
+        if(compilationMetrics != nil)
+            [compilationMetrics recordModelCompilationWithId:modelId duration:[[NSProcessInfo processInfo] systemUptime] - start];
+        
+        if(localModel != nil)
+        {
+            ModelRegistryEntry* entry = [[ModelRegistryEntry alloc]init];
+            entry.model = localModel;
+            entry.updated = updated;
+            
+            //The copy is written before the swap, so the model can be compiled again once it is evicted, and both are
+            //done inside the lock of the disk, so the copy isn't pruned before its version is in the registry
+            @synchronized(diskLock)
+            {
+                if([self prepareDirectory])
+                    [[NSJSONSerialization dataWithJSONObject:jsonModel options:0 error:nil] writeToFile:[self pathOfModelWithId:modelId version:updated] atomically:YES];
+                
+                swapped = [self swapEntry:entry forModelId:modelId replacingVersion:loadedVersion];
+            }
+            
+            //The copy of the previous version, or of this one if a newer version was swapped in meanwhile
+            [self pruneModelFiles];
+        }
+    }
+    
+    @synchronized(self)
+    {
+        [loadingModels removeObject:modelId];
+        
+        if(swapped && loadedVersion != nil)
+            reloads++;
+    }
+    
+    return swapped;
+}
+
+-(BOOL)reloadModelWithId:(NSString*)modelId
+{
+    NSTimeInterval start = [[NSProcessInfo processInfo] systemUptime];
+    NSString* version = nil;
+    
+    @synchronized(self)
+    {
+        version = [entries[modelId] updated];
+    }
+    
+    if(directory == nil)
+        return NO;
+    
+    //Only the version the model had in memory is read, an older copy left on disk is never swapped in again
+    NSData* data = [NSData dataWithContentsOfFile:[self pathOfModelWithId:modelId version:version]];
+    NSDictionary* jsonModel = data != nil ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    
+    if(![jsonModel isKindOfClass:[NSDictionary class]] || (jsonModel[@"updated"] != version && ![jsonModel[@"updated"] isEqual:version]))
+        return NO;
+    
+    //The compilation is timed on its own, as in compileModelWithId:, the latency of the reload includes the disk read
+    NSTimeInterval compilationStart = [[NSProcessInfo processInfo] systemUptime];
+    LocalPredictiveModel* localModel = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    NSTimeInterval end = [[NSProcessInfo processInfo] systemUptime];
+    
+    if(localModel == nil)
+        return NO;
+    
+    NSTimeInterval latency = end - start;
+    
+    [metrics recordModelCompilationWithId:modelId duration:end - compilationStart];
+    
+    ModelRegistryEntry* entry = [[ModelRegistryEntry alloc]init];
+    entry.model = localModel;
+    entry.updated = jsonModel[@"updated"];
+    
+    //A version compiled meanwhile by a refresh is kept
+    BOOL swapped = [self swapEntry:entry forModelId:modelId replacingVersion:nil];
+    
+    @synchronized(self)
+    {
+        [loadingModels removeObject:modelId];
+        
+        if(!swapped)
+            return YES;
+        
+        diskReloads++;
+        diskReloadLatency += latency;
+        maximumDiskReloadLatency = MAX(maximumDiskReloadLatency, latency);
+    }
+    
+    return YES;
+}
+
+-(BOOL)swapEntry:(ModelRegistryEntry*)entry forModelId:(NSString*)modelId replacingVersion:(NSString*)loadedVersion
+{
+    //Measured outside the lock, the tree doesn't change once compiled
+    entry.footprint = [entry.model footprint];
+    
+    @synchronized(self)
+    {
+        ModelRegistryEntry* current = entries[modelId];
+        NSString* currentVersion = current.model != nil ? current.updated : nil;
+        
+        if(currentVersion != loadedVersion && ![currentVersion isEqualToString:loadedVersion])
+            return NO;
+        
+        NSMutableDictionary* snapshot = [entries mutableCopy];
+        
+        entry.lastUse = ++useClock;
+        snapshot[modelId] = entry;
+        
+        [self evictModelsOfSnapshot:snapshot];
+        
+        entries = [snapshot copy];
+    }
+    
+    return YES;
+}
+
+-(void)evictModelsOfSnapshot:(NSMutableDictionary*)snapshot
+{
+    if(memoryBudget == 0)
+        return;
+    
+    NSUInteger residentBytes = 0;
+    NSUInteger residentModels = 0;
+    
+    for(ModelRegistryEntry* entry in [snapshot objectEnumerator])
+    {
+        if(entry.model != nil)
+        {
+            residentBytes += entry.footprint;
+            residentModels++;
+        }
+    }
+    
+    //The models swapped in are the most recently used, so a model just loaded is the last one to be evicted
+    while(residentBytes > memoryBudget && residentModels > 1)
+    {
+        NSString* victimId = nil;
+        uint64_t oldestUse = UINT64_MAX;
+        
+        for(NSString* candidateId in snapshot)
+        {
+            ModelRegistryEntry* candidate = snapshot[candidateId];
+            
+            if(candidate.model != nil && candidate.lastUse < oldestUse)
+            {
+                victimId = candidateId;
+                oldestUse = candidate.lastUse;
+            }
+        }
+        
+        ModelRegistryEntry* victim = snapshot[victimId];
+        
+        //The predictions in flight keep the tree they hold, it is released once they finish
+        ModelRegistryEntry* evicted = [[ModelRegistryEntry alloc]init];
+        evicted.updated = victim.updated;
+        evicted.lastUse = victim.lastUse;
+        
+        snapshot[victimId] = evicted;
+        
+        residentBytes -= victim.footprint;
+        residentModels--;
+        evictions++;
+    }
+}
+
+-(NSString*)pathOfModelWithId:(NSString*)modelId version:(NSString*)version
+{
+    //The identifier and the version can't contain '@' once escaped
+    NSString* fileName = [NSString stringWithFormat:@"%@@%@", FileNameComponent(modelId), FileNameComponent(version != nil ? version : @"")];
+    
+    return [directory stringByAppendingPathComponent:[fileName stringByAppendingPathExtension:@"json"]];
+}
+
+-(BOOL)prepareDirectory
+{
+    if(directory != nil && !directoryCreated)
+        directoryCreated = [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    
+    return directoryCreated;
+}
+
+-(void)pruneModelFiles
+{
+    NSFileManager* fileManager = [NSFileManager defaultManager];
+    
+    @synchronized(diskLock)
+    {
+        //Nothing to delete until the first copy is written
+        if(!directoryCreated)
+            return;
+        
+        NSMutableDictionary* lastUses = nil;
+        NSUInteger budget = 0;
+        
+        //The last use of the version in the registry of every model, keyed by the name of its file
+        @synchronized(self)
+        {
+            lastUses = [NSMutableDictionary dictionaryWithCapacity:[entries count]];
+            budget = diskBudget;
+            
+            for(NSString* modelId in entries)
+            {
+                ModelRegistryEntry* entry = entries[modelId];
+                lastUses[[[self pathOfModelWithId:modelId version:entry.updated] lastPathComponent]] = @(entry.lastUse);
+            }
+        }
+        
+        NSMutableArray* keptFiles = [NSMutableArray array];
+        NSUInteger keptBytes = 0;
+        
+        for(NSString* fileName in [fileManager contentsOfDirectoryAtPath:directory error:nil])
+        {
+            NSString* path = [directory stringByAppendingPathComponent:fileName];
+            
+            if(lastUses[fileName] == nil)
+            {
+                [fileManager removeItemAtPath:path error:nil];
+                continue;
+            }
+            
+            NSUInteger size = (NSUInteger)[[fileManager attributesOfItemAtPath:path error:nil] fileSize];
+            
+            [keptFiles addObject:@{@"path": path, @"size": @(size), @"lastUse": lastUses[fileName]}];
+            keptBytes += size;
+        }
+        
+        //The copies of the least recently used models are deleted first
+        if(budget > 0 && keptBytes > budget)
+        {
+            [keptFiles sortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"lastUse" ascending:YES]]];
+            
+            while(keptBytes > budget && [keptFiles count] > 0)
+            {
+                [fileManager removeItemAtPath:keptFiles[0][@"path"] error:nil];
+                
+                keptBytes -= [keptFiles[0][@"size"]unsignedIntegerValue];
+                [keptFiles removeObjectAtIndex:0];
+            }
+        }
+        
+        @synchronized(self)
+        {
+            diskModels = [keptFiles count];
+            diskBytes = keptBytes;
+        }
+    }
+}
+
+-(void)startRefreshingWithInterval:(NSTimeInterval)interval
+{
+    [self stopRefreshing];
+    
+    ModelRegistry* __weak weakSelf = self;
+    
+    dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, refreshQueue);
+    
+    dispatch_source_set_event_handler(timer, ^{
+        ModelRegistry* strongSelf = weakSelf;
+        
+        //A check is skipped if the previous one hasn't finished yet
+        if(strongSelf == nil || strongSelf->refreshing)
+            return;
+        
+        strongSelf->refreshing = YES;
+        
+        [strongSelf->queue addOperationWithBlock:^{
+            [strongSelf refreshModels];
+            
+            dispatch_async(strongSelf->refreshQueue, ^{
+                strongSelf->refreshing = NO;
+            });
+        }];
+    });
+    
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), (uint64_t)(interval * NSEC_PER_SEC), (uint64_t)(interval * NSEC_PER_SEC / 10));
+    dispatch_resume(timer);
+    
+    @synchronized(self)
+    {
+        refreshTimer = timer;
+    }
+}
+
+-(void)stopRefreshing
+{
+    @synchronized(self)
+    {
+        if(refreshTimer != nil)
+            dispatch_source_cancel(refreshTimer);
+        
+        refreshTimer = nil;
+    }
+}
+
+-(void)refreshModels
+{
+    NSArray* modelIds = nil;
+    
+    //The evicted models are checked when they are loaded again
+    @synchronized(self)
+    {
+        modelIds = [[entries keysOfEntriesPassingTest:^BOOL(NSString* modelId, ModelRegistryEntry* entry, BOOL* stop) {
+            return entry.model != nil;
+        }] allObjects];
+    }
+    
+    //With the resource cache enabled unchanged models cost a conditional request, a fresh cached copy isn't trusted
+    //because it would hide a retrained model until its time to live expires
+    for(NSString* modelId in modelIds)
+        [self compileModelWithId:modelId revalidate:YES];
+}
+
+-(NSDictionary*)statistics
+{
+    @synchronized(self)
+    {
+        NSUInteger nodes = 0;
+        NSUInteger compactedNodes = 0;
+        NSUInteger residentModels = 0;
+        NSUInteger residentBytes = 0;
+        
+        for(ModelRegistryEntry* entry in [entries objectEnumerator])
+        {
+            if(entry.model == nil)
+                continue;
+            
+            nodes += [[entry.model compactionStatistics][@"nodes"]unsignedIntegerValue];
+            compactedNodes += [[entry.model compactionStatistics][@"compactedNodes"]unsignedIntegerValue];
+            residentModels++;
+            residentBytes += entry.footprint;
+        }
+        
+        NSUInteger lookups = residentLookups + evictedLookups;
+        
+        return @{@"compiledModels": @(residentModels),
+                 @"evictedModels": @([entries count] - residentModels),
+                 @"reloads": @(reloads),
+                 @"nodes": @(nodes),
+                 @"compactedNodes": @(compactedNodes),
+                 @"residentBytes": @(residentBytes),
+                 @"memoryBudget": @(memoryBudget),
+                 @"evictions": @(evictions),
+                 @"residentLookups": @(residentLookups),
+                 @"evictedLookups": @(evictedLookups),
+                 @"residencyRatio": @(lookups > 0 ? (double)residentLookups / lookups : 0),
+                 @"diskReloads": @(diskReloads),
+                 @"averageDiskReloadLatency": @(diskReloads > 0 ? diskReloadLatency / diskReloads : 0),
+                 @"maximumDiskReloadLatency": @(maximumDiskReloadLatency),
+                 @"diskModels": @(diskModels),
+                 @"diskBytes": @(diskBytes),
+                 @"diskBudget": @(diskBudget)};
+    }
+}
+
+@end
@@ -0,0 +1,74 @@
+/**
+ *
+ * PredictionRouter.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+@class HTTPCommsManager;
+@class ModelRegistry;
+@protocol ML4iOSMetrics;
+
+/**
+ * Routes predictions of a model to the local or the remote prediction path.
+ * The first prediction of a model launches in background its load in the model registry, and the predictions are created
+ * remotely until the compiled model is available. From then on they are created locally without any request.
+ * The results of both paths have the same format: the "value" and "confidence" of the prediction, and its "source"
+ * ("local" or "remote").
+ */
+@interface PredictionRouter : NSObject
+{
+    HTTPCommsManager* commsManager;
+    ModelRegistry* modelRegistry;
+    
+    //Statistics
+    NSUInteger localPredictions;
+    NSUInteger remotePredictions;
+    
+    id<ML4iOSMetrics> metrics;
+}
+
+/**
+ * Receives the duration of the local predictions, nil if the metrics are disabled
+ */
+@property (nonatomic, strong) id<ML4iOSMetrics> metrics;
+
+/**
+ * Initializes the router
+ * @param aCommsManager The comms manager used to create the remote predictions
+ * @param aModelRegistry The registry of the compiled models
+ */
+-(PredictionRouter*)initWithCommsManager:(HTTPCommsManager*)aCommsManager modelRegistry:(ModelRegistry*)aModelRegistry;
+
+/**
+ * Creates a prediction, locally if the model is already compiled, else remotely
+ * @param modelId The identifier of the model
+ * @param inputData A JSON object that contents the pairs field_id : field_value (For instance @"{\"000001\": 1, \"000002\": 3}")
+ * @param code The HTTP status code returned. HTTP_OK for local predictions.
+ * @return The result of the prediction if success, else nil
+ */
+-(NSDictionary*)predictWithModelId:(NSString*)modelId inputData:(NSString*)inputData statusCode:(NSInteger*)code;
+
+/**
+ * @return The statistics of the router: number of "localPredictions", "remotePredictions", plus the statistics of the model registry
+ */
+-(NSDictionary*)statistics;
+
+@end
@@ -0,0 +1,134 @@
+/**
+ *
+ * PredictionRouter.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "PredictionRouter.h"
+#import "HTTPCommsManager.h"
+#import "LocalPredictiveModel.h"
+#import "ModelRegistry.h"
+#import "ML4iOSMetrics.h"
+#import "Constants.h"
+
+/**
+ * Interface that contains private methods
+ */
+@interface PredictionRouter()
+
+/**
+ * @param prediction A prediction created remotely
+ * @return The result of the prediction in the format of the local predictions
+ */
+-(NSDictionary*)resultFromRemotePrediction:(NSDictionary*)prediction;
+
+@end
+
+#pragma mark -
+
+@implementation PredictionRouter
+
+@synthesize metrics;
+
+-(PredictionRouter*)initWithCommsManager:(HTTPCommsManager*)aCommsManager modelRegistry:(ModelRegistry*)aModelRegistry
+{
+    self = [super init];
+    
+    if(self)
+    {
+        commsManager = aCommsManager;
+        modelRegistry = aModelRegistry;
+    }
+    
+    return self;
+}
+
+-(NSDictionary*)predictWithModelId:(NSString*)modelId inputData:(NSString*)inputData statusCode:(NSInteger*)code
+{
+    //The model is held until the prediction ends, even if a new version is swapped in meanwhile
+    LocalPredictiveModel* localModel = [modelRegistry localModelWithId:modelId];
+    
+    if(localModel != nil)
+    {
+        id<ML4iOSMetrics> predictionMetrics = metrics;
+        NSTimeInterval start = predictionMetrics != nil ? [[NSProcessInfo processInfo] systemUptime] : 0;
+        
+        NSMutableDictionary* result = [NSMutableDictionary dictionaryWithDictionary:[localModel predictWithArguments:inputData argsByName:NO]];
+        result[@"source"] = @"local";
+        
+        if(predictionMetrics != nil)
+            [predictionMetrics recordLocalPredictionWithDuration:[[NSProcessInfo processInfo] systemUptime] - start];
+        
+        @synchronized(self)
+        {
+            localPredictions++;
+        }
+        
+        *code = HTTP_OK;
+        return result;
+    }
+    
+    [modelRegistry loadModelWithId:modelId];
+    
+    NSDictionary* prediction = [commsManager createPredictionWithModelId:modelId name:nil inputData:inputData statusCode:code];
+    
+    if(prediction == nil || *code != HTTP_CREATED)
+        return nil;
+    
+    @synchronized(self)
+    {
+        remotePredictions++;
+    }
+    
+    return [self resultFromRemotePrediction:prediction];
+}
+
+-(NSDictionary*)resultFromRemotePrediction:(NSDictionary*)prediction
+{
+    NSMutableDictionary* result = [NSMutableDictionary dictionaryWithCapacity:3];
+    
+    //The remote prediction is keyed by the objective field id
+    NSString* objectiveField = [prediction[@"objective_fields"]firstObject];
+    NSObject* value = objectiveField != nil ? prediction[@"prediction"][objectiveField] : nil;
+    
+    if(value != nil)
+        result[@"value"] = value;
+    
+    if(prediction[@"confidence"] != nil)
+        result[@"confidence"] = prediction[@"confidence"];
+    
+    result[@"source"] = @"remote";
+    
+    return result;
+}
+
+-(NSDictionary*)statistics
+{
+    NSMutableDictionary* statistics = [NSMutableDictionary dictionaryWithDictionary:[modelRegistry statistics]];
+    
+    @synchronized(self)
+    {
+        statistics[@"localPredictions"] = @(localPredictions);
+        statistics[@"remotePredictions"] = @(remotePredictions);
+    }
+    
+    return statistics;
+}
+
+@end
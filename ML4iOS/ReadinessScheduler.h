@@ -0,0 +1,107 @@
+/**
+ *
+ * ReadinessScheduler.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class ReadinessScheduler;
+
+/**
+ * Retrieves the current state of a resource
+ * @param code The HTTP status code returned
+ * @return The resource if success, else nil
+ */
+typedef NSDictionary* (^ReadinessProbe)(NSInteger* code);
+
+/**
+ * Asynchronous operation that finishes when a resource reaches the FINISHED status, fails, or the timeout expires.
+ * The operation doesn't block any thread while it waits, the probes are scheduled by a ReadinessScheduler.
+ */
+@interface ReadinessWaitOperation : NSOperation
+{
+    ReadinessScheduler* __weak scheduler;
+    ReadinessProbe probe;
+    NSTimeInterval timeout;
+
+    BOOL ready;
+    NSDictionary* resource;
+
+    BOOL executing;
+    BOOL finished;
+}
+
+/**
+ * true if the resource reached the FINISHED status, else false
+ */
+@property (nonatomic, readonly) BOOL ready;
+
+/**
+ * The last state of the resource retrieved
+ */
+@property (nonatomic, readonly) NSDictionary* resource;
+
+/**
+ * Initializes the operation
+ * @param aScheduler The scheduler that multiplexes the probes
+ * @param aProbe The block that retrieves the current state of the resource
+ * @param aTimeout The maximum time to wait in seconds
+ */
+-(ReadinessWaitOperation*)initWithScheduler:(ReadinessScheduler*)aScheduler probe:(ReadinessProbe)aProbe timeout:(NSTimeInterval)aTimeout;
+
+@end
+
+/**
+ * Multiplexes many outstanding readiness waits in a single scheduler queue. The next probe of every wait is planned
+ * with exponential backoff, shortened using the progress reported by BigML in status.progress, so a resource close to
+ * be finished is probed sooner than one that just started.
+ */
+@interface ReadinessScheduler : NSObject
+{
+    /**
+     * Serial queue where all waits are scheduled
+     */
+    dispatch_queue_t schedulerQueue;
+
+    /**
+     * Timer armed with the next probe date of all waits
+     */
+    dispatch_source_t timer;
+
+    /**
+     * Queue where the probes (HTTP requests) are executed
+     */
+    NSOperationQueue* probeQueue;
+
+    NSMutableArray* waits;
+}
+
+/**
+ * Starts to wait for a resource. Called from the start method of ReadinessWaitOperation.
+ * @param wait The wait operation
+ */
+-(void)scheduleWait:(ReadinessWaitOperation*)wait;
+
+/**
+ * Stops to wait for a resource. Called from the cancel method of ReadinessWaitOperation.
+ * @param wait The wait operation
+ */
+-(void)cancelWait:(ReadinessWaitOperation*)wait;
+
+@end
@@ -0,0 +1,355 @@
+/**
+ *
+ * ReadinessScheduler.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ReadinessScheduler.h"
+#import "HTTPCommsManager.h"
+#import "Constants.h"
+
+//Backoff limits in seconds
+#define READINESS_MIN_DELAY 0.5
+#define READINESS_MAX_DELAY 30.0
+
+//Maximum number of probes in flight
+#define READINESS_MAX_CONCURRENT_PROBES 4
+
+#pragma mark -
+
+/**
+ * Interface that contains private methods and the state handled from the scheduler queue
+ */
+@interface ReadinessWaitOperation()
+
+@property (nonatomic, readonly) ReadinessProbe probe;
+@property (nonatomic, readonly) NSTimeInterval timeout;
+
+@property (nonatomic, strong) NSDate* deadline;
+@property (nonatomic, strong) NSDate* nextProbeDate;
+@property (nonatomic, assign) NSTimeInterval delay;
+@property (nonatomic, assign) double lastProgress;
+@property (nonatomic, assign) BOOL probing;
+
+/**
+ * Moves the operation to the finished state
+ * @param isReady true if the resource reached the FINISHED status, else false
+ * @param aResource The last state of the resource retrieved
+ */
+-(void)finishWithReady:(BOOL)isReady resource:(NSDictionary*)aResource;
+
+@end
+
+#pragma mark -
+
+@implementation ReadinessWaitOperation
+
+@synthesize ready;
+@synthesize resource;
+@synthesize probe;
+@synthesize timeout;
+
+-(ReadinessWaitOperation*)initWithScheduler:(ReadinessScheduler*)aScheduler probe:(ReadinessProbe)aProbe timeout:(NSTimeInterval)aTimeout
+{
+    self = [super init];
+
+    if(self)
+    {
+        scheduler = aScheduler;
+        probe = [aProbe copy];
+        timeout = aTimeout;
+    }
+
+    return self;
+}
+
+-(BOOL)isAsynchronous
+{
+    return YES;
+}
+
+-(BOOL)isExecuting
+{
+    @synchronized(self)
+    {
+        return executing;
+    }
+}
+
+-(BOOL)isFinished
+{
+    @synchronized(self)
+    {
+        return finished;
+    }
+}
+
+-(void)start
+{
+    if([self isCancelled] || scheduler == nil)
+    {
+        [self finishWithReady:NO resource:nil];
+        return;
+    }
+
+    [self willChangeValueForKey:@"isExecuting"];
+
+    @synchronized(self)
+    {
+        executing = YES;
+    }
+
+    [self didChangeValueForKey:@"isExecuting"];
+
+    //The operation returns right away, releasing the thread of the queue while it waits
+    [scheduler scheduleWait:self];
+}
+
+-(void)cancel
+{
+    [super cancel];
+
+    if([self isExecuting])
+        [scheduler cancelWait:self];
+}
+
+-(void)finishWithReady:(BOOL)isReady resource:(NSDictionary*)aResource
+{
+    @synchronized(self)
+    {
+        if(finished)
+            return;
+
+        ready = isReady;
+        resource = aResource;
+    }
+
+    [self willChangeValueForKey:@"isExecuting"];
+    [self willChangeValueForKey:@"isFinished"];
+
+    @synchronized(self)
+    {
+        executing = NO;
+        finished = YES;
+    }
+
+    [self didChangeValueForKey:@"isExecuting"];
+    [self didChangeValueForKey:@"isFinished"];
+}
+
+@end
+
+#pragma mark -
+
+/**
+ * Interface that contains private methods
+ */
+@interface ReadinessScheduler()
+
+/**
+ * Launches the probes of the waits whose next probe date has expired. Called from the scheduler queue.
+ */
+-(void)fire;
+
+/**
+ * Handles the state of a resource retrieved by a probe. Called from the scheduler queue.
+ * @param wait The wait operation
+ * @param resource The resource retrieved
+ * @param code The HTTP status code returned by the probe
+ */
+-(void)handleProbeOfWait:(ReadinessWaitOperation*)wait resource:(NSDictionary*)resource statusCode:(NSInteger)code;
+
+/**
+ * Computes the time until the next probe of a resource that is not finished yet
+ * @param wait The wait operation
+ * @param resource The resource retrieved
+ * @return The delay in seconds
+ */
+-(NSTimeInterval)nextDelayOfWait:(ReadinessWaitOperation*)wait resource:(NSDictionary*)resource;
+
+/**
+ * Arms the timer with the earliest next probe date. Called from the scheduler queue.
+ */
+-(void)rearmTimer;
+
+@end
+
+#pragma mark -
+
+@implementation ReadinessScheduler
+
+-(ReadinessScheduler*)init
+{
+    self = [super init];
+
+    if(self)
+    {
+        waits = [[NSMutableArray alloc]init];
+
+        probeQueue = [[NSOperationQueue alloc]init];
+        [probeQueue setMaxConcurrentOperationCount:READINESS_MAX_CONCURRENT_PROBES];
+
+        schedulerQueue = dispatch_queue_create("ml4ios.readiness", DISPATCH_QUEUE_SERIAL);
+        timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, schedulerQueue);
+
+        ReadinessScheduler* __weak weakSelf = self;
+
+        dispatch_source_set_event_handler(timer, ^{
+            [weakSelf fire];
+        });
+
+        dispatch_source_set_timer(timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(timer);
+    }
+
+    return self;
+}
+
+-(void)dealloc
+{
+    dispatch_source_cancel(timer);
+    [probeQueue cancelAllOperations];
+}
+
+-(void)scheduleWait:(ReadinessWaitOperation*)wait
+{
+    dispatch_async(schedulerQueue, ^{
+        //A wait cancelled between its start and this point didn't call cancelWait, so it is finished here
+        if([wait isCancelled])
+        {
+            [wait finishWithReady:NO resource:nil];
+            return;
+        }
+        
+        NSDate* now = [NSDate date];
+
+        [wait setDeadline:[now dateByAddingTimeInterval:[wait timeout]]];
+        [wait setNextProbeDate:now];
+        [wait setDelay:READINESS_MIN_DELAY];
+
+        [self->waits addObject:wait];
+        [self rearmTimer];
+    });
+}
+
+-(void)cancelWait:(ReadinessWaitOperation*)wait
+{
+    dispatch_async(schedulerQueue, ^{
+        [self->waits removeObject:wait];
+        [wait finishWithReady:NO resource:nil];
+
+        [self rearmTimer];
+    });
+}
+
+-(void)fire
+{
+    NSDate* now = [NSDate date];
+
+    for(ReadinessWaitOperation* wait in waits)
+    {
+        if([wait probing] || [[wait nextProbeDate] compare:now] == NSOrderedDescending)
+            continue;
+
+        [wait setProbing:YES];
+
+        [probeQueue addOperationWithBlock:^{
+            NSInteger __block statusCode = 0;
+            NSDictionary* __block resource = nil;
+            
+            //A probe in flight is cancelled with its wait
+            [HTTPCommsManager performRequestsOfOperation:wait block:^{
+                resource = [wait probe](&statusCode);
+            }];
+
+            dispatch_async(self->schedulerQueue, ^{
+                [self handleProbeOfWait:wait resource:resource statusCode:statusCode];
+            });
+        }];
+    }
+
+    [self rearmTimer];
+}
+
+-(void)handleProbeOfWait:(ReadinessWaitOperation*)wait resource:(NSDictionary*)resource statusCode:(NSInteger)code
+{
+    [wait setProbing:NO];
+
+    //The wait was cancelled while the probe was in flight
+    if(![waits containsObject:wait])
+        return;
+
+    NSInteger status = (resource != nil && code == HTTP_OK) ? [resource[@"status"][@"code"]integerValue] : UNKNOWN;
+    NSDate* now = [NSDate date];
+
+    if(status == FINISHED || status == FAULTY || code == HTTP_NOT_FOUND || [now compare:[wait deadline]] != NSOrderedAscending)
+    {
+        [waits removeObject:wait];
+        [wait finishWithReady:(status == FINISHED) resource:resource];
+    }
+    else
+    {
+        NSDate* nextProbeDate = [now dateByAddingTimeInterval:[self nextDelayOfWait:wait resource:resource]];
+        [wait setNextProbeDate:[nextProbeDate earlierDate:[wait deadline]]];
+    }
+
+    [self rearmTimer];
+}
+
+-(NSTimeInterval)nextDelayOfWait:(ReadinessWaitOperation*)wait resource:(NSDictionary*)resource
+{
+    NSTimeInterval delay = MIN([wait delay] * 2, READINESS_MAX_DELAY);
+
+    double progress = [resource[@"status"][@"progress"]doubleValue];
+    double elapsed = [resource[@"status"][@"elapsed"]doubleValue] / 1000.0;
+
+    //When the resource is making progress, probe again around the half of the estimated remaining time
+    if(progress > [wait lastProgress] && progress > 0 && progress < 1 && elapsed > 0)
+    {
+        NSTimeInterval remaining = elapsed * (1 - progress) / progress;
+        delay = MIN(delay, remaining / 2);
+        [wait setLastProgress:progress];
+    }
+
+    delay = MAX(delay, READINESS_MIN_DELAY);
+    [wait setDelay:delay];
+
+    return delay;
+}
+
+-(void)rearmTimer
+{
+    NSDate* earliest = nil;
+
+    for(ReadinessWaitOperation* wait in waits)
+    {
+        if(![wait probing])
+            earliest = earliest == nil ? [wait nextProbeDate] : [earliest earlierDate:[wait nextProbeDate]];
+    }
+
+    if(earliest == nil)
+    {
+        dispatch_source_set_timer(timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        return;
+    }
+
+    NSTimeInterval interval = MAX([earliest timeIntervalSinceNow], 0);
+    dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(interval * NSEC_PER_SEC)), DISPATCH_TIME_FOREVER, 10 * NSEC_PER_MSEC);
+}
+
+@end
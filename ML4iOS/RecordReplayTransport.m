@@ -0,0 +1,293 @@
+/**
+ *
+ * RecordReplayTransport.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "RecordReplayTransport.h"
+#import "URLSessionTransport.h"
+#import <CommonCrypto/CommonDigest.h>
+
+//Granularity of the replayed latency, the cancellation of the operation is checked between slices
+#define LATENCY_SLICE 0.01
+
+/**
+ * Interface that contains private methods
+ */
+@interface RecordReplayTransport()
+
+/**
+ * @param request The request
+ * @return The key that matches the request in a recording: method, path, query without credentials and body digest
+ */
+-(NSString*)keyForRequest:(NSURLRequest*)request;
+
+/**
+ * Adds an exchange to the index of exchanges by key
+ */
+-(void)indexExchange:(NSDictionary*)exchange;
+
+/**
+ * Waits the duration of a recorded request
+ * @return false if the operation was cancelled while waiting, else true
+ */
+-(BOOL)waitDuration:(NSTimeInterval)duration ofOperation:(NSOperation*)operation;
+
+@end
+
+#pragma mark -
+
+@implementation RecordReplayTransport
+
+@synthesize replaysLatency;
+
+-(RecordReplayTransport*)initRecordingWithTransport:(id<ML4iOSTransport>)aTransport
+{
+    self = [super init];
+    
+    if(self)
+    {
+        transport = aTransport != nil ? aTransport : [[URLSessionTransport alloc]init];
+        exchanges = [[NSMutableArray alloc]init];
+    }
+    
+    return self;
+}
+
+-(RecordReplayTransport*)initReplayingWithContentsOfFile:(NSString*)path
+{
+    NSData* data = [NSData dataWithContentsOfFile:path];
+    NSArray* recording = data != nil ? [NSJSONSerialization JSONObjectWithData:data options:0 error:nil] : nil;
+    
+    if(![recording isKindOfClass:[NSArray class]])
+        return nil;
+    
+    self = [super init];
+    
+    if(self)
+    {
+        exchanges = [recording mutableCopy];
+        exchangesByKey = [[NSMutableDictionary alloc]init];
+        replayPositions = [[NSMutableDictionary alloc]init];
+        
+        for(NSDictionary* exchange in exchanges)
+            [self indexExchange:exchange];
+    }
+    
+    return self;
+}
+
+-(BOOL)writeRecordingToFile:(NSString*)path
+{
+    NSData* data = nil;
+    
+    @synchronized(self)
+    {
+        data = [NSJSONSerialization dataWithJSONObject:exchanges options:NSJSONWritingPrettyPrinted error:nil];
+    }
+    
+    return [data writeToFile:path atomically:YES];
+}
+
+-(NSUInteger)numberOfExchanges
+{
+    @synchronized(self)
+    {
+        return [exchanges count];
+    }
+}
+
+-(NSUInteger)misses
+{
+    @synchronized(self)
+    {
+        return misses;
+    }
+}
+
+#pragma mark -
+#pragma mark ML4iOSTransport
+
+-(NSData*)sendRequest:(NSURLRequest*)request operation:(NSOperation*)operation returningResponse:(NSHTTPURLResponse**)response metrics:(NSURLSessionTaskMetrics**)taskMetrics error:(NSError**)error
+{
+    NSString* key = [self keyForRequest:request];
+    
+    if(transport != nil)
+    {
+        NSHTTPURLResponse* resp = nil;
+        NSError* err = nil;
+        
+        NSTimeInterval start = [[NSProcessInfo processInfo] systemUptime];
+        NSData* data = [transport sendRequest:request operation:operation returningResponse:&resp metrics:taskMetrics error:&err];
+        NSTimeInterval duration = [[NSProcessInfo processInfo] systemUptime] - start;
+        
+        //Cancelled requests are not part of the session
+        if(![operation isCancelled])
+        {
+            NSMutableDictionary* exchange = [NSMutableDictionary dictionaryWithCapacity:6];
+            exchange[@"key"] = key;
+            exchange[@"duration"] = @(duration);
+            
+            if(resp != nil)
+            {
+                //Only the headers the library reads are recorded, so no cookie is stored
+                NSMutableDictionary* headers = [NSMutableDictionary dictionary];
+                
+                for(NSString* header in @[@"Content-Type", @"ETag", @"Retry-After"])
+                {
+                    if([resp allHeaderFields][header] != nil)
+                        headers[header] = [resp allHeaderFields][header];
+                }
+                
+                exchange[@"status"] = @([resp statusCode]);
+                exchange[@"headers"] = headers;
+                exchange[@"body"] = [data base64EncodedStringWithOptions:0] ?: @"";
+            }
+            else
+            {
+                exchange[@"errorDomain"] = [err domain] ?: NSURLErrorDomain;
+                exchange[@"errorCode"] = @([err code]);
+            }
+            
+            @synchronized(self)
+            {
+                [exchanges addObject:exchange];
+            }
+        }
+        
+        if(response != nil)
+            *response = resp;
+        if(error != nil)
+            *error = err;
+        return data;
+    }
+    
+    if(taskMetrics != NULL)
+        *taskMetrics = nil;
+    
+    NSDictionary* exchange = nil;
+    
+    @synchronized(self)
+    {
+        NSArray* candidates = exchangesByKey[key];
+        NSUInteger position = [replayPositions[key]unsignedIntegerValue];
+        
+        if([candidates count] > 0)
+        {
+            exchange = candidates[MIN(position, [candidates count] - 1)];
+            replayPositions[key] = @(position + 1);
+        }
+        else
+            misses++;
+    }
+    
+    if(exchange == nil)
+    {
+        if(response != nil)
+            *response = nil;
+        if(error != nil)
+            *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:@{NSLocalizedDescriptionKey: [NSString stringWithFormat:@"%@ is not in the recording", key]}];
+        return nil;
+    }
+    
+    if(![self waitDuration:(self.replaysLatency ? [exchange[@"duration"]doubleValue] : 0) ofOperation:operation])
+    {
+        if(response != nil)
+            *response = nil;
+        if(error != nil)
+            *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+        return nil;
+    }
+    
+    if(exchange[@"status"] == nil)
+    {
+        if(response != nil)
+            *response = nil;
+        if(error != nil)
+            *error = [NSError errorWithDomain:exchange[@"errorDomain"] code:[exchange[@"errorCode"]integerValue] userInfo:nil];
+        return nil;
+    }
+    
+    if(response != nil)
+        *response = [[NSHTTPURLResponse alloc]initWithURL:[request URL] statusCode:[exchange[@"status"]integerValue] HTTPVersion:@"HTTP/1.1" headerFields:exchange[@"headers"]];
+    if(error != nil)
+        *error = nil;
+    return [[NSData alloc]initWithBase64EncodedString:exchange[@"body"] options:0];
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(NSString*)keyForRequest:(NSURLRequest*)request
+{
+    //The credentials are removed from the query, the rest of parameters (ej: offset, limit) tell requests apart
+    NSMutableArray* parameters = [NSMutableArray array];
+    
+    for(NSString* pair in [[[request URL] query] componentsSeparatedByCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@";&"]])
+    {
+        if([pair length] > 0 && ![pair hasPrefix:@"username="] && ![pair hasPrefix:@"api_key="])
+            [parameters addObject:pair];
+    }
+    
+    NSData* body = [request HTTPBody] ?: [NSData data];
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([body bytes], (CC_LONG)[body length], digest);
+    
+    NSMutableString* key = [NSMutableString stringWithFormat:@"%@ %@?%@ ", [request HTTPMethod], [[request URL] path], [parameters componentsJoinedByString:@";"]];
+    
+    for(NSInteger i = 0; i < CC_SHA256_DIGEST_LENGTH; i++)
+        [key appendFormat:@"%02x", digest[i]];
+    
+    return key;
+}
+
+-(void)indexExchange:(NSDictionary*)exchange
+{
+    NSString* key = exchange[@"key"];
+    
+    if(key == nil)
+        return;
+    
+    NSMutableArray* candidates = exchangesByKey[key];
+    
+    if(candidates == nil)
+    {
+        candidates = [NSMutableArray array];
+        exchangesByKey[key] = candidates;
+    }
+    
+    [candidates addObject:exchange];
+}
+
+-(BOOL)waitDuration:(NSTimeInterval)duration ofOperation:(NSOperation*)operation
+{
+    NSTimeInterval deadline = [[NSProcessInfo processInfo] systemUptime] + duration;
+    
+    for(NSTimeInterval now = [[NSProcessInfo processInfo] systemUptime]; now < deadline; now = [[NSProcessInfo processInfo] systemUptime])
+    {
+        if([operation isCancelled])
+            return NO;
+        
+        [NSThread sleepForTimeInterval:MIN(deadline - now, LATENCY_SLICE)];
+    }
+    
+    return ![operation isCancelled];
+}
+
+@end
@@ -0,0 +1,102 @@
+/**
+ *
+ * ResourceCache.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Persistent on-disk cache of resources retrieved from BigML, keyed by resource identifier.
+ * Every entry stores the JSON returned by BigML, its ETag and the date it was stored or last revalidated.
+ * Entries of FINISHED resources are fresh during the time to live and can be served without any request.
+ * The rest of entries must be revalidated with a conditional request before being served.
+ */
+@interface ResourceCache : NSObject
+{
+    NSString* directory;
+    NSTimeInterval timeToLive;
+
+    //Statistics
+    NSUInteger hits;
+    NSUInteger revalidations;
+    NSUInteger misses;
+    unsigned long long bytesSaved;
+}
+
+/**
+ * Initializes the cache
+ * @param aDirectory The directory where the entries are stored, created if it doesn't exist
+ * @param aTimeToLive The time in seconds a FINISHED resource is served without revalidating it
+ */
+-(ResourceCache*)initWithDirectory:(NSString*)aDirectory timeToLive:(NSTimeInterval)aTimeToLive;
+
+/**
+ * Looks for an entry in the cache
+ * @param key The key of the resource (ej: model_IDENTIFIER)
+ * @param etag Returns the ETag of the entry, nil if the response didn't include one
+ * @param fresh Returns true if the entry can be served without revalidating it, else false
+ * @return The JSON data of the entry, nil if there is no entry for the key
+ */
+-(NSData*)dataForKey:(NSString*)key etag:(NSString**)etag fresh:(BOOL*)fresh;
+
+/**
+ * Stores an entry in the cache, replacing the previous one
+ * @param data The JSON data of the resource
+ * @param etag The ETag of the response, nil if the response didn't include one
+ * @param finished true if the status of the resource is FINISHED, else false
+ * @param key The key of the resource
+ */
+-(void)storeData:(NSData*)data etag:(NSString*)etag finished:(BOOL)finished forKey:(NSString*)key;
+
+/**
+ * Marks an entry as revalidated after a HTTP_NOT_MODIFIED response, so its time to live starts again
+ * @param key The key of the resource
+ */
+-(void)revalidateDataForKey:(NSString*)key;
+
+/**
+ * Removes an entry from the cache
+ * @param key The key of the resource
+ */
+-(void)removeDataForKey:(NSString*)key;
+
+/**
+ * Records that an entry was served without any request
+ * @param length The length of the data served
+ */
+-(void)recordHitWithLength:(NSUInteger)length;
+
+/**
+ * Records that an entry was served after a HTTP_NOT_MODIFIED response
+ * @param length The length of the data served
+ */
+-(void)recordRevalidationWithLength:(NSUInteger)length;
+
+/**
+ * Records that a resource was downloaded because it wasn't in the cache or it was modified
+ */
+-(void)recordMiss;
+
+/**
+ * @return The statistics of the cache: number of "hits", "revalidations" and "misses", the "hitRatio"
+ * (served from disk, revalidated or not, divided by total lookups) and the "bytesSaved"
+ */
+-(NSDictionary*)statistics;
+
+@end
@@ -0,0 +1,172 @@
+/**
+ *
+ * ResourceCache.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ResourceCache.h"
+
+/**
+ * Interface that contains private methods
+ */
+@interface ResourceCache()
+
+/**
+ * @param key The key of the resource
+ * @return The path of the file that stores the JSON data of the entry
+ */
+-(NSString*)dataPathForKey:(NSString*)key;
+
+/**
+ * @param key The key of the resource
+ * @return The path of the file that stores the ETag, date and status of the entry
+ */
+-(NSString*)metadataPathForKey:(NSString*)key;
+
+@end
+
+#pragma mark -
+
+@implementation ResourceCache
+
+-(ResourceCache*)initWithDirectory:(NSString*)aDirectory timeToLive:(NSTimeInterval)aTimeToLive
+{
+    self = [super init];
+
+    if(self)
+    {
+        directory = aDirectory;
+        timeToLive = aTimeToLive;
+
+        [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:nil];
+    }
+
+    return self;
+}
+
+-(NSString*)dataPathForKey:(NSString*)key
+{
+    return [directory stringByAppendingPathComponent:[key stringByAppendingPathExtension:@"json"]];
+}
+
+-(NSString*)metadataPathForKey:(NSString*)key
+{
+    return [directory stringByAppendingPathComponent:[key stringByAppendingPathExtension:@"plist"]];
+}
+
+-(NSData*)dataForKey:(NSString*)key etag:(NSString**)etag fresh:(BOOL*)fresh
+{
+    @synchronized(self)
+    {
+        NSDictionary* metadata = [NSDictionary dictionaryWithContentsOfFile:[self metadataPathForKey:key]];
+        NSData* data = metadata != nil ? [NSData dataWithContentsOfFile:[self dataPathForKey:key]] : nil;
+
+        if(data == nil)
+            return nil;
+
+        NSDate* date = metadata[@"date"];
+
+        *etag = metadata[@"etag"];
+        *fresh = [metadata[@"finished"]boolValue] && -[date timeIntervalSinceNow] < timeToLive;
+
+        return data;
+    }
+}
+
+-(void)storeData:(NSData*)data etag:(NSString*)etag finished:(BOOL)finished forKey:(NSString*)key
+{
+    NSMutableDictionary* metadata = [NSMutableDictionary dictionaryWithCapacity:3];
+    metadata[@"date"] = [NSDate date];
+    metadata[@"finished"] = @(finished);
+
+    if(etag != nil)
+        metadata[@"etag"] = etag;
+
+    @synchronized(self)
+    {
+        //The data is written first, so an entry is never found with metadata and without data
+        [data writeToFile:[self dataPathForKey:key] atomically:YES];
+        [metadata writeToFile:[self metadataPathForKey:key] atomically:YES];
+    }
+}
+
+-(void)revalidateDataForKey:(NSString*)key
+{
+    @synchronized(self)
+    {
+        NSMutableDictionary* metadata = [NSMutableDictionary dictionaryWithContentsOfFile:[self metadataPathForKey:key]];
+
+        if(metadata != nil)
+        {
+            metadata[@"date"] = [NSDate date];
+            [metadata writeToFile:[self metadataPathForKey:key] atomically:YES];
+        }
+    }
+}
+
+-(void)removeDataForKey:(NSString*)key
+{
+    @synchronized(self)
+    {
+        [[NSFileManager defaultManager] removeItemAtPath:[self metadataPathForKey:key] error:nil];
+        [[NSFileManager defaultManager] removeItemAtPath:[self dataPathForKey:key] error:nil];
+    }
+}
+
+-(void)recordHitWithLength:(NSUInteger)length
+{
+    @synchronized(self)
+    {
+        hits++;
+        bytesSaved += length;
+    }
+}
+
+-(void)recordRevalidationWithLength:(NSUInteger)length
+{
+    @synchronized(self)
+    {
+        revalidations++;
+        bytesSaved += length;
+    }
+}
+
+-(void)recordMiss
+{
+    @synchronized(self)
+    {
+        misses++;
+    }
+}
+
+-(NSDictionary*)statistics
+{
+    @synchronized(self)
+    {
+        NSUInteger lookups = hits + revalidations + misses;
+        double hitRatio = lookups > 0 ? (double)(hits + revalidations) / lookups : 0;
+
+        return @{@"hits": @(hits),
+                 @"revalidations": @(revalidations),
+                 @"misses": @(misses),
+                 @"hitRatio": @(hitRatio),
+                 @"bytesSaved": @(bytesSaved)};
+    }
+}
+
+@end
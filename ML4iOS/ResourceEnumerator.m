@@ -0,0 +1,151 @@
+/**
+ *
+ * ResourceEnumerator.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "ResourceEnumerator.h"
+#import "Constants.h"
+#import "HTTPCommsManager.h"
+
+#define DEFAULT_PAGE_SIZE 20
+
+/**
+ * Interface that contains private methods
+ */
+@interface ResourceEnumerator()
+
+/**
+ * Launches the request of the page that starts at nextOffset
+ */
+-(void)prefetchNextPage;
+
+/**
+ * Waits for the prefetched page and makes it the current one, launching the request of the following page
+ * @return true if a page with resources was received, else false
+ */
+-(BOOL)advanceToNextPage;
+
+@end
+
+#pragma mark -
+
+@implementation ResourceEnumerator
+
+@synthesize statusCode;
+
+-(ResourceEnumerator*)initWithFetch:(ResourcePageFetch)aFetch pageSize:(NSInteger)aPageSize queue:(NSOperationQueue*)aQueue
+{
+    self = [super init];
+
+    if(self)
+    {
+        fetch = [aFetch copy];
+        pageSize = aPageSize > 0 ? aPageSize : DEFAULT_PAGE_SIZE;
+        queue = aQueue;
+
+        [self prefetchNextPage];
+    }
+
+    return self;
+}
+
+-(void)dealloc
+{
+    [prefetch cancel];
+}
+
+-(void)prefetchNextPage
+{
+    ResourcePageFetch pageFetch = fetch;
+    NSInteger offset = nextOffset;
+    NSInteger limit = pageSize;
+
+    ResourceEnumerator* __weak weakSelf = self;
+
+    NSBlockOperation* operation = [[NSBlockOperation alloc]init];
+    NSBlockOperation* __weak weakOperation = operation;
+
+    [operation addExecutionBlock:^{
+        NSInteger __block code = 0;
+        NSDictionary* __block page = nil;
+
+        //Cancelling the prefetch, for instance when the enumerator is released, aborts the request in flight
+        [HTTPCommsManager performRequestsOfOperation:weakOperation block:^{
+            page = pageFetch(offset, limit, &code);
+        }];
+
+        ResourceEnumerator* strongSelf = weakSelf;
+
+        if(strongSelf != nil)
+        {
+            strongSelf->prefetchedPage = page;
+            strongSelf->prefetchStatusCode = code;
+        }
+    }];
+
+    prefetch = operation;
+    [queue addOperation:prefetch];
+}
+
+-(BOOL)advanceToNextPage
+{
+    if(prefetch == nil)
+        return NO;
+
+    [prefetch waitUntilFinished];
+
+    NSDictionary* page = prefetchedPage;
+    statusCode = prefetchStatusCode;
+
+    prefetch = nil;
+    prefetchedPage = nil;
+
+    if(page == nil || statusCode != HTTP_OK)
+    {
+        currentPage = nil;
+        return NO;
+    }
+
+    //The previous page is released here, so only the current page and the prefetched one are kept in memory
+    currentPage = page[@"objects"];
+    currentIndex = 0;
+    nextOffset += [currentPage count];
+
+    NSDictionary* meta = page[@"meta"];
+    NSObject* next = meta[@"next"];
+    NSInteger totalCount = [meta[@"total_count"]integerValue];
+
+    //A missing "next" doesn't end the list, only an explicit null, the total count or a short page
+    lastPage = [currentPage count] < pageSize || next == [NSNull null] || (totalCount > 0 && nextOffset >= totalCount);
+
+    if(!lastPage)
+        [self prefetchNextPage];
+
+    return [currentPage count] > 0;
+}
+
+-(id)nextObject
+{
+    if(currentIndex >= [currentPage count] && ![self advanceToNextPage])
+        return nil;
+
+    return currentPage[currentIndex++];
+}
+
+@end
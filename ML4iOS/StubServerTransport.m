@@ -0,0 +1,523 @@
+/**
+ *
+ * StubServerTransport.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "StubServerTransport.h"
+#import "LocalPredictiveModel.h"
+#import "Constants.h"
+
+//Page size of the lists when the request doesn't set a limit
+#define DEFAULT_LIST_LIMIT 20
+
+//Granularity of the latency, the cancellation of the operation is checked between slices
+#define LATENCY_SLICE 0.01
+
+#pragma mark -
+
+/**
+ * A resource stored by the stub server
+ */
+@interface StubResource : NSObject
+
+@property (nonatomic, strong) NSMutableDictionary* fields;
+@property (nonatomic, strong) NSString* endpoint;
+@property (nonatomic, assign) NSTimeInterval created;
+@property (nonatomic, assign) NSUInteger version;
+
+@end
+
+@implementation StubResource
+
+@end
+
+#pragma mark -
+
+/**
+ * Interface that contains private methods
+ */
+@interface StubServerTransport()
+
+/**
+ * @return A random number uniformly distributed in [0, 1), drawn from the seeded generator
+ */
+-(double)nextRandom;
+
+/**
+ * Waits for the latency of a request
+ * @param operation The operation that owns the request
+ * @return false if the operation was cancelled while waiting, else true
+ */
+-(BOOL)waitLatencyOfOperation:(NSOperation*)operation;
+
+/**
+ * Answers a request with the stored resources
+ * @param request The request
+ * @param code Returns the HTTP status code of the response
+ * @param headers Returns the header fields of the response
+ * @return The JSON object of the response, nil if it has no body
+ */
+-(id)handleRequest:(NSURLRequest*)request statusCode:(NSInteger*)code headers:(NSMutableDictionary*)headers;
+
+/**
+ * Creates a resource from the body of a POST request
+ */
+-(NSDictionary*)createResourceWithEndpoint:(NSString*)endpoint request:(NSURLRequest*)request statusCode:(NSInteger*)code;
+
+/**
+ * @return The page of the resources of an endpoint requested by the query of a GET request
+ */
+-(NSDictionary*)listResourcesWithEndpoint:(NSString*)endpoint query:(NSDictionary*)query;
+
+/**
+ * @return The JSON object of a stored resource, with its status at the current time
+ */
+-(NSDictionary*)JSONObjectOfResource:(StubResource*)resource;
+
+/**
+ * @param model The JSON object of the model
+ * @param inputData The input data of the prediction
+ * @return The fields of the prediction of the model, empty if the model has no tree
+ */
+-(NSDictionary*)predictionFieldsWithModel:(NSDictionary*)model inputData:(NSDictionary*)inputData;
+
+@end
+
+#pragma mark -
+
+@implementation StubServerTransport
+
+@synthesize latency;
+@synthesize latencyJitter;
+@synthesize processingTime;
+@synthesize failureRate;
+@synthesize failureStatusCode;
+@synthesize failureInjector;
+
+-(StubServerTransport*)init
+{
+    return [self initWithSeed:1];
+}
+
+-(StubServerTransport*)initWithSeed:(uint64_t)seed
+{
+    self = [super init];
+    
+    if(self)
+    {
+        resources = [[NSMutableDictionary alloc]init];
+        resourceIdentifiers = [[NSMutableArray alloc]init];
+        requestsByEndpoint = [[NSMutableDictionary alloc]init];
+        
+        //The generator can't be seeded with 0
+        randomState = seed != 0 ? seed : 0x9E3779B97F4A7C15ULL;
+        failureStatusCode = HTTP_SERVICE_UNAVAILABLE;
+    }
+    
+    return self;
+}
+
+-(void)addResource:(NSDictionary*)resource
+{
+    NSString* identifier = resource[@"resource"];
+    NSArray* components = [identifier componentsSeparatedByString:@"/"];
+    
+    if([components count] != 2)
+        return;
+    
+    StubResource* stored = [[StubResource alloc]init];
+    stored.fields = [resource mutableCopy];
+    stored.endpoint = components[0];
+    
+    //Added resources keep their own status, or are FINISHED if they have none
+    stored.created = -DBL_MAX;
+    
+    @synchronized(self)
+    {
+        StubResource* previous = resources[identifier];
+        
+        //A replaced resource gets a new version, so its ETag changes
+        stored.version = previous != nil ? previous.version + 1 : 1;
+        
+        if(previous == nil)
+            [resourceIdentifiers addObject:identifier];
+        
+        resources[identifier] = stored;
+    }
+}
+
+-(NSDictionary*)statistics
+{
+    @synchronized(self)
+    {
+        return @{@"requests": [requestsByEndpoint copy],
+                 @"resources": @([resources count]),
+                 @"injectedFailures": @(injectedFailures)};
+    }
+}
+
+#pragma mark -
+#pragma mark ML4iOSTransport
+
+-(NSData*)sendRequest:(NSURLRequest*)request operation:(NSOperation*)operation returningResponse:(NSHTTPURLResponse**)response metrics:(NSURLSessionTaskMetrics**)taskMetrics error:(NSError**)error
+{
+    if(taskMetrics != NULL)
+        *taskMetrics = nil;
+    
+    if(![self waitLatencyOfOperation:operation])
+    {
+        if(response != nil)
+            *response = nil;
+        if(error != nil)
+            *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil];
+        return nil;
+    }
+    
+    NSInteger statusCode = 0;
+    NSMutableDictionary* headers = [NSMutableDictionary dictionaryWithObject:@"application/json" forKey:@"Content-Type"];
+    
+    StubFailureInjector injector = self.failureInjector;
+    NSInteger failure = injector != nil ? injector(request) : 0;
+    
+    if(failure == 0 && self.failureRate > 0 && [self nextRandom] < self.failureRate)
+        failure = self.failureStatusCode;
+    
+    id body = nil;
+    
+    if(failure != 0)
+    {
+        @synchronized(self)
+        {
+            injectedFailures++;
+        }
+        
+        statusCode = failure;
+        body = @{@"code": @(failure), @"status": @{@"message": @"Failure injected by the stub server"}};
+    }
+    else
+        body = [self handleRequest:request statusCode:&statusCode headers:headers];
+    
+    if(response != nil)
+        *response = [[NSHTTPURLResponse alloc]initWithURL:[request URL] statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:headers];
+    if(error != nil)
+        *error = nil;
+    
+    return body != nil ? [NSJSONSerialization dataWithJSONObject:body options:0 error:nil] : [NSData data];
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(double)nextRandom
+{
+    uint64_t value = 0;
+    
+    @synchronized(self)
+    {
+        //xorshift64*
+        randomState ^= randomState >> 12;
+        randomState ^= randomState << 25;
+        randomState ^= randomState >> 27;
+        value = randomState * 2685821657736338717ULL;
+    }
+    
+    return (value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+-(BOOL)waitLatencyOfOperation:(NSOperation*)operation
+{
+    NSTimeInterval wait = self.latency;
+    
+    if(self.latencyJitter > 0)
+        wait += self.latencyJitter * [self nextRandom];
+    
+    NSTimeInterval deadline = [[NSProcessInfo processInfo] systemUptime] + wait;
+    
+    for(NSTimeInterval now = [[NSProcessInfo processInfo] systemUptime]; now < deadline; now = [[NSProcessInfo processInfo] systemUptime])
+    {
+        if([operation isCancelled])
+            return NO;
+        
+        [NSThread sleepForTimeInterval:MIN(deadline - now, LATENCY_SLICE)];
+    }
+    
+    return ![operation isCancelled];
+}
+
+-(id)handleRequest:(NSURLRequest*)request statusCode:(NSInteger*)code headers:(NSMutableDictionary*)headers
+{
+    static NSSet* endpoints = nil;
+    static dispatch_once_t once;
+    
+    dispatch_once(&once, ^{
+        endpoints = [NSSet setWithObjects:@"source", @"dataset", @"model", @"cluster", @"prediction", nil];
+    });
+    
+    //The path is [/dev]/andromeda/ENDPOINT[/IDENTIFIER]
+    NSArray* components = [[[request URL] path] pathComponents];
+    NSUInteger index = [components indexOfObjectPassingTest:^BOOL(NSString* component, NSUInteger i, BOOL* stop) {
+        return [endpoints containsObject:component];
+    }];
+    
+    if(index == NSNotFound || [components count] > index + 2)
+    {
+        *code = HTTP_NOT_FOUND;
+        return nil;
+    }
+    
+    NSString* endpoint = components[index];
+    NSString* identifier = [components count] > index + 1 ? [NSString stringWithFormat:@"%@/%@", endpoint, components[index + 1]] : nil;
+    NSString* method = [request HTTPMethod];
+    
+    //The query is a list of key=value pairs separated by semicolons (ej: ?username=USER;api_key=KEY;limit=20;)
+    NSMutableDictionary* query = [NSMutableDictionary dictionary];
+    
+    for(NSString* pair in [[[request URL] query] componentsSeparatedByCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@";&"]])
+    {
+        NSRange separator = [pair rangeOfString:@"="];
+        
+        if(separator.location != NSNotFound)
+            query[[pair substringToIndex:separator.location]] = [[pair substringFromIndex:NSMaxRange(separator)] stringByRemovingPercentEncoding];
+    }
+    
+    @synchronized(self)
+    {
+        requestsByEndpoint[endpoint] = @([requestsByEndpoint[endpoint]integerValue] + 1);
+    }
+    
+    if(identifier == nil)
+    {
+        if([method isEqualToString:@"POST"])
+            return [self createResourceWithEndpoint:endpoint request:request statusCode:code];
+        
+        if([method isEqualToString:@"GET"])
+        {
+            *code = HTTP_OK;
+            return [self listResourcesWithEndpoint:endpoint query:query];
+        }
+        
+        *code = HTTP_METHOD_NOT_ALLOWED;
+        return nil;
+    }
+    
+    @synchronized(self)
+    {
+        StubResource* resource = resources[identifier];
+        
+        if(resource == nil)
+        {
+            *code = HTTP_NOT_FOUND;
+            return @{@"code": @(HTTP_NOT_FOUND), @"status": @{@"message": @"The resource couldn't be found"}};
+        }
+        
+        if([method isEqualToString:@"GET"])
+        {
+            NSDictionary* json = [self JSONObjectOfResource:resource];
+            
+            //The ETag changes when the resource is updated or finished, as in BigML
+            NSString* etag = [NSString stringWithFormat:@"\"%lu-%ld\"", (unsigned long)resource.version, (long)[json[@"status"][@"code"]integerValue]];
+            headers[@"ETag"] = etag;
+            
+            if([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:etag])
+            {
+                *code = HTTP_NOT_MODIFIED;
+                return nil;
+            }
+            
+            *code = HTTP_OK;
+            return json;
+        }
+        
+        if([method isEqualToString:@"PUT"])
+        {
+            NSDictionary* body = [request HTTPBody] != nil ? [NSJSONSerialization JSONObjectWithData:[request HTTPBody] options:0 error:nil] : nil;
+            
+            if(![body isKindOfClass:[NSDictionary class]])
+            {
+                *code = HTTP_BAD_REQUEST;
+                return nil;
+            }
+            
+            [resource.fields addEntriesFromDictionary:body];
+            resource.version++;
+            
+            *code = HTTP_ACCEPTED;
+            return [self JSONObjectOfResource:resource];
+        }
+        
+        if([method isEqualToString:@"DELETE"])
+        {
+            [resources removeObjectForKey:identifier];
+            [resourceIdentifiers removeObject:identifier];
+            
+            *code = HTTP_NO_CONTENT;
+            return nil;
+        }
+    }
+    
+    *code = HTTP_METHOD_NOT_ALLOWED;
+    return nil;
+}
+
+-(NSDictionary*)createResourceWithEndpoint:(NSString*)endpoint request:(NSURLRequest*)request statusCode:(NSInteger*)code
+{
+    NSData* requestBody = [request HTTPBody];
+    NSMutableDictionary* fields = [NSMutableDictionary dictionary];
+    
+    if([endpoint isEqualToString:@"source"])
+    {
+        //Sources are uploaded as multipart forms, named after the file name of the form
+        NSString* form = [[NSString alloc]initWithData:requestBody encoding:NSUTF8StringEncoding];
+        NSRange start = [form rangeOfString:@"filename=\""];
+        NSRange end = start.location != NSNotFound ? [form rangeOfString:@"\"" options:0 range:NSMakeRange(NSMaxRange(start), [form length] - NSMaxRange(start))] : start;
+        
+        fields[@"name"] = end.location != NSNotFound ? [form substringWithRange:NSMakeRange(NSMaxRange(start), end.location - NSMaxRange(start))] : @"Source";
+        fields[@"size"] = @([requestBody length]);
+    }
+    else
+    {
+        NSDictionary* body = requestBody != nil ? [NSJSONSerialization JSONObjectWithData:requestBody options:0 error:nil] : nil;
+        
+        if(![body isKindOfClass:[NSDictionary class]])
+        {
+            *code = HTTP_BAD_REQUEST;
+            return nil;
+        }
+        
+        [fields addEntriesFromDictionary:body];
+    }
+    
+    //Every resource, except the sources, is created from a parent that must exist
+    NSDictionary* parents = @{@"dataset": @"source", @"model": @"dataset", @"cluster": @"dataset", @"prediction": @"model"};
+    NSString* parentKey = parents[endpoint];
+    NSDictionary* parent = nil;
+    
+    @synchronized(self)
+    {
+        if(parentKey != nil)
+        {
+            StubResource* parentResource = resources[fields[parentKey]];
+            
+            if(parentResource == nil)
+            {
+                *code = HTTP_BAD_REQUEST;
+                return @{@"code": @(HTTP_BAD_REQUEST), @"status": @{@"message": [NSString stringWithFormat:@"The %@ doesn't exist", parentKey]}};
+            }
+            
+            parent = [parentResource.fields copy];
+        }
+    }
+    
+    if([endpoint isEqualToString:@"prediction"])
+        [fields addEntriesFromDictionary:[self predictionFieldsWithModel:parent inputData:fields[@"input_data"]]];
+    
+    if(fields[@"name"] == nil)
+        fields[@"name"] = parent[@"name"] != nil ? parent[@"name"] : [endpoint capitalizedString];
+    
+    StubResource* resource = [[StubResource alloc]init];
+    resource.fields = fields;
+    resource.endpoint = endpoint;
+    resource.created = [[NSProcessInfo processInfo] systemUptime];
+    resource.version = 1;
+    
+    @synchronized(self)
+    {
+        NSString* identifier = [NSString stringWithFormat:@"%@/%024lx", endpoint, (unsigned long)++lastIdentifier];
+        
+        fields[@"resource"] = identifier;
+        resources[identifier] = resource;
+        [resourceIdentifiers addObject:identifier];
+        
+        *code = HTTP_CREATED;
+        return [self JSONObjectOfResource:resource];
+    }
+}
+
+-(NSDictionary*)listResourcesWithEndpoint:(NSString*)endpoint query:(NSDictionary*)query
+{
+    NSInteger offset = MAX([query[@"offset"]integerValue], 0);
+    NSInteger limit = query[@"limit"] != nil ? MAX([query[@"limit"]integerValue], 0) : DEFAULT_LIST_LIMIT;
+    NSString* name = query[@"name"];
+    
+    NSMutableArray* objects = [NSMutableArray array];
+    NSInteger totalCount = 0;
+    
+    @synchronized(self)
+    {
+        //The newest resources first, as in BigML
+        for(NSString* identifier in [resourceIdentifiers reverseObjectEnumerator])
+        {
+            StubResource* resource = resources[identifier];
+            
+            if(![resource.endpoint isEqualToString:endpoint] || (name != nil && ![resource.fields[@"name"] isEqual:name]))
+                continue;
+            
+            if(totalCount >= offset && totalCount < offset + limit)
+                [objects addObject:[self JSONObjectOfResource:resource]];
+            
+            totalCount++;
+        }
+    }
+    
+    NSObject* next = [NSNull null];
+    
+    if(offset + limit < totalCount)
+        next = [NSString stringWithFormat:@"/andromeda/%@?offset=%ld;limit=%ld;", endpoint, (long)(offset + limit), (long)limit];
+    
+    return @{@"meta": @{@"limit": @(limit), @"offset": @(offset), @"total_count": @(totalCount), @"next": next},
+             @"objects": objects};
+}
+
+-(NSDictionary*)JSONObjectOfResource:(StubResource*)resource
+{
+    NSMutableDictionary* json = [resource.fields mutableCopy];
+    
+    //Predictions are created synchronously, the rest of resources are processed during the processing time
+    BOOL finished = [resource.endpoint isEqualToString:@"prediction"] || [[NSProcessInfo processInfo] systemUptime] - resource.created >= self.processingTime;
+    
+    if(resource.created != -DBL_MAX || json[@"status"] == nil)
+        json[@"status"] = finished ? @{@"code": @(FINISHED), @"message": @"The resource has been created"} : @{@"code": @(IN_PROGRESS), @"message": @"The resource is being processed"};
+    
+    return json;
+}
+
+-(NSDictionary*)predictionFieldsWithModel:(NSDictionary*)model inputData:(NSDictionary*)inputData
+{
+    NSString* objectiveField = model[@"objective_field"] != nil ? model[@"objective_field"] : [model[@"objective_fields"]firstObject];
+    
+    if(model[@"model"][@"root"] == nil || objectiveField == nil)
+        return @{};
+    
+    NSData* arguments = [NSJSONSerialization dataWithJSONObject:(inputData != nil ? inputData : @{}) options:0 error:nil];
+    NSDictionary* result = [LocalPredictiveModel predictWithJSONModel:model arguments:[[NSString alloc]initWithData:arguments encoding:NSUTF8StringEncoding] argsByName:NO];
+    
+    NSMutableDictionary* fields = [NSMutableDictionary dictionaryWithCapacity:3];
+    fields[@"objective_fields"] = @[objectiveField];
+    
+    if(result[@"value"] != nil)
+        fields[@"prediction"] = @{objectiveField: result[@"value"]};
+    
+    if(result[@"confidence"] != nil)
+        fields[@"confidence"] = result[@"confidence"];
+    
+    return fields;
+}
+
+@end
@@ -0,0 +1,319 @@
+/**
+ *
+ * TraceRecorder.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "TraceRecorder.h"
+#import <mach/mach_time.h>
+#import <pthread.h>
+#import <stdatomic.h>
+
+#define DEFAULT_BUFFER_CAPACITY 65536
+
+/**
+ * An event of the trace. Spans have an end time, instant events have end equal to start. The thread is kept in the
+ * event because a buffer can be reused by another thread once its thread exits.
+ */
+typedef struct
+{
+    const char* name;
+    const char* category;
+    uint64_t start;
+    uint64_t end;
+    uint64_t identifier;
+    uint64_t threadId;
+    BOOL instant;
+} TraceEvent;
+
+/**
+ * The events of a thread. Only the thread that owns the buffer writes the events, the number of events is published
+ * with release semantics so the exporter only reads complete events. The events are reset or reallocated for a new
+ * trace inside the recorder lock, so the exporter never reads a buffer that is being freed.
+ */
+typedef struct TraceBuffer
+{
+    TraceEvent* events;
+    size_t capacity;
+    _Atomic size_t count;
+    _Atomic size_t dropped;
+    _Atomic BOOL owned;
+    uint64_t generation;
+    struct TraceBuffer* next;
+} TraceBuffer;
+
+//Buffers of all threads that recorded events. Buffers are never freed, the buffer of a thread that exits is released
+//and claimed by the next thread that records its first event, so the list only grows with the threads alive at once.
+static _Atomic(TraceBuffer*) traceBuffers = NULL;
+
+//The generation of the current trace, buffers of older generations are emptied by their thread on the next event
+static _Atomic uint64_t traceGeneration = 0;
+static _Atomic size_t traceCapacity = DEFAULT_BUFFER_CAPACITY;
+static _Atomic BOOL traceEnabled = NO;
+
+//Taken by a thread when its buffer moves to a new trace and by the exporter while it copies the events
+static pthread_mutex_t traceLock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread TraceBuffer* threadBuffer = NULL;
+static __thread uint64_t threadId = 0;
+
+//Its destructor releases the buffer of a thread when the thread exits
+static pthread_key_t threadBufferKey;
+static pthread_once_t threadBufferKeyOnce = PTHREAD_ONCE_INIT;
+
+/**
+ * Releases the buffer of an exiting thread, its events are kept for the exporter until another thread claims it
+ */
+static void TraceReleaseBuffer(void* value)
+{
+    TraceBuffer* buffer = value;
+    
+    //An event recorded later by another destructor of the thread claims a buffer again
+    threadBuffer = NULL;
+    atomic_store_explicit(&buffer->owned, NO, memory_order_release);
+}
+
+static void TraceCreateBufferKey(void)
+{
+    pthread_key_create(&threadBufferKey, TraceReleaseBuffer);
+}
+
+/**
+ * @return A buffer released by a thread that exited, or a new buffer added to the list
+ */
+static TraceBuffer* TraceClaimBuffer(void)
+{
+    for(TraceBuffer* buffer = atomic_load(&traceBuffers); buffer != NULL; buffer = buffer->next)
+    {
+        BOOL owned = NO;
+        
+        if(!atomic_load_explicit(&buffer->owned, memory_order_relaxed) && atomic_compare_exchange_strong_explicit(&buffer->owned, &owned, YES, memory_order_acquire, memory_order_relaxed))
+            return buffer;
+    }
+    
+    TraceBuffer* buffer = calloc(1, sizeof(TraceBuffer));
+    buffer->generation = UINT64_MAX;
+    atomic_init(&buffer->owned, YES);
+    
+    //Lock free push, only contended by threads that record their first event at the same time
+    TraceBuffer* head = atomic_load(&traceBuffers);
+    
+    do
+    {
+        buffer->next = head;
+    }
+    while(!atomic_compare_exchange_weak(&traceBuffers, &head, buffer));
+    
+    return buffer;
+}
+
+/**
+ * @return The buffer of the current thread for the current trace, claiming one the first time
+ */
+static TraceBuffer* TraceCurrentBuffer(void)
+{
+    uint64_t generation = atomic_load_explicit(&traceGeneration, memory_order_acquire);
+    TraceBuffer* buffer = threadBuffer;
+    
+    if(buffer == NULL)
+    {
+        pthread_once(&threadBufferKeyOnce, TraceCreateBufferKey);
+        
+        buffer = TraceClaimBuffer();
+        pthread_setspecific(threadBufferKey, buffer);
+        
+        if(threadId == 0)
+            pthread_threadid_np(NULL, &threadId);
+        
+        threadBuffer = buffer;
+    }
+    
+    //Once per thread and trace, the only path of the recording that takes the lock
+    if(buffer->generation != generation)
+    {
+        size_t capacity = atomic_load(&traceCapacity);
+        
+        pthread_mutex_lock(&traceLock);
+        
+        if(buffer->capacity != capacity)
+        {
+            free(buffer->events);
+            buffer->events = malloc(capacity * sizeof(TraceEvent));
+            buffer->capacity = buffer->events != NULL ? capacity : 0;
+        }
+        
+        atomic_store_explicit(&buffer->count, 0, memory_order_relaxed);
+        atomic_store_explicit(&buffer->dropped, 0, memory_order_relaxed);
+        buffer->generation = generation;
+        
+        pthread_mutex_unlock(&traceLock);
+    }
+    
+    return buffer;
+}
+
+/**
+ * Appends an event to the buffer of the current thread
+ */
+static void TraceRecord(const char* name, const char* category, uint64_t start, uint64_t end, uint64_t identifier, BOOL instant)
+{
+    TraceBuffer* buffer = TraceCurrentBuffer();
+    size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    
+    if(count >= buffer->capacity)
+    {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    
+    buffer->events[count] = (TraceEvent){name, category, start, end, identifier, threadId, instant};
+    atomic_store_explicit(&buffer->count, count + 1, memory_order_release);
+}
+
+BOOL TraceIsEnabled(void)
+{
+    return atomic_load_explicit(&traceEnabled, memory_order_relaxed);
+}
+
+uint64_t TraceTimestamp(void)
+{
+    return mach_absolute_time();
+}
+
+void TraceSpan(const char* name, const char* category, uint64_t start, uint64_t identifier)
+{
+    if(TraceIsEnabled())
+        TraceRecord(name, category, start, mach_absolute_time(), identifier, NO);
+}
+
+void TraceInstant(const char* name, const char* category, uint64_t identifier)
+{
+    if(TraceIsEnabled())
+    {
+        uint64_t now = mach_absolute_time();
+        TraceRecord(name, category, now, now, identifier, YES);
+    }
+}
+
+#pragma mark -
+
+@implementation TraceRecorder
+
++(void)startTracingWithBufferCapacity:(NSUInteger)capacity
+{
+    atomic_store(&traceCapacity, capacity > 0 ? capacity : DEFAULT_BUFFER_CAPACITY);
+    atomic_fetch_add_explicit(&traceGeneration, 1, memory_order_release);
+    atomic_store(&traceEnabled, YES);
+}
+
++(void)stopTracing
+{
+    atomic_store(&traceEnabled, NO);
+}
+
++(BOOL)isTracing
+{
+    return TraceIsEnabled();
+}
+
++(NSUInteger)droppedEvents
+{
+    uint64_t generation = atomic_load(&traceGeneration);
+    NSUInteger dropped = 0;
+    
+    pthread_mutex_lock(&traceLock);
+    
+    for(TraceBuffer* buffer = atomic_load(&traceBuffers); buffer != NULL; buffer = buffer->next)
+    {
+        if(buffer->generation == generation)
+            dropped += atomic_load(&buffer->dropped);
+    }
+    
+    pthread_mutex_unlock(&traceLock);
+    
+    return dropped;
+}
+
++(BOOL)writeTraceToFile:(NSString*)path
+{
+    mach_timebase_info_data_t timebase;
+    mach_timebase_info(&timebase);
+    
+    uint64_t generation = atomic_load(&traceGeneration);
+    pid_t pid = [[NSProcessInfo processInfo] processIdentifier];
+    
+    //The events are copied inside the lock and converted outside it, so a thread moving to a new trace waits only the copy
+    NSMutableData* copiedEvents = [NSMutableData data];
+    
+    pthread_mutex_lock(&traceLock);
+    
+    for(TraceBuffer* buffer = atomic_load(&traceBuffers); buffer != NULL; buffer = buffer->next)
+    {
+        if(buffer->generation != generation)
+            continue;
+        
+        size_t count = atomic_load_explicit(&buffer->count, memory_order_acquire);
+        
+        [copiedEvents appendBytes:buffer->events length:count * sizeof(TraceEvent)];
+    }
+    
+    pthread_mutex_unlock(&traceLock);
+    
+    NSMutableArray* traceEvents = [NSMutableArray array];
+    const TraceEvent* events = [copiedEvents bytes];
+    size_t count = [copiedEvents length] / sizeof(TraceEvent);
+    
+    for(size_t i = 0; i < count; i++)
+    {
+        const TraceEvent* event = &events[i];
+        
+        //Timestamps in microseconds, as expected by the trace viewers
+        double start = (double)event->start * timebase.numer / timebase.denom / 1000.0;
+        double end = (double)event->end * timebase.numer / timebase.denom / 1000.0;
+        
+        NSMutableDictionary* traceEvent = [NSMutableDictionary dictionaryWithCapacity:8];
+        traceEvent[@"name"] = @(event->name);
+        traceEvent[@"cat"] = @(event->category);
+        traceEvent[@"ts"] = @(start);
+        traceEvent[@"pid"] = @(pid);
+        traceEvent[@"tid"] = @(event->threadId);
+        
+        if(event->instant)
+        {
+            traceEvent[@"ph"] = @"i";
+            traceEvent[@"s"] = @"t";
+        }
+        else
+        {
+            traceEvent[@"ph"] = @"X";
+            traceEvent[@"dur"] = @(end - start);
+        }
+        
+        if(event->identifier != 0)
+            traceEvent[@"args"] = @{@"operation": @(event->identifier)};
+        
+        [traceEvents addObject:traceEvent];
+    }
+    
+    NSData* data = [NSJSONSerialization dataWithJSONObject:@{@"traceEvents": traceEvents, @"displayTimeUnit": @"ms"} options:0 error:nil];
+    
+    return data != nil && [data writeToFile:path atomically:YES];
+}
+
+@end
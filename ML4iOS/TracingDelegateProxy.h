@@ -1,10 +1,10 @@
 /**
  *
- * Predicate.h
+ * TracingDelegateProxy.h
  * ML4iOS
  *
- * Created by Felix Garcia Lainez on April 21, 2013
- * Copyright 2013 Felix Garcia Lainez
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -18,22 +18,27 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+
+
 #import <Foundation/Foundation.h>
 
 /**
- * A predicate to be evaluated in a tree's node.
+ * Proxy of the delegate of ML4iOS used while tracing, that records a span for every response delivered to the delegate
  */
-@interface Predicate : NSObject
+@interface TracingDelegateProxy : NSProxy
 {
-    NSString* opType;
-    NSString* predicateOperator;
-    NSString* field;
-    NSString* value;
+    id __weak target;
 }
 
-@property (nonatomic, strong) NSString* opType;
-@property (nonatomic, strong) NSString* predicateOperator;
-@property (nonatomic, strong) NSString* field;
-@property (nonatomic, strong) NSString* value;
+/**
+ * The delegate that receives the responses
+ */
+@property (nonatomic, weak) id target;
+
+/**
+ * Initializes the proxy
+ * @param aTarget The delegate that receives the responses
+ */
+-(TracingDelegateProxy*)initWithTarget:(id)aTarget;
 
 @end
@@ -0,0 +1,69 @@
+/**
+ *
+ * TracingDelegateProxy.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "TracingDelegateProxy.h"
+#import "TraceRecorder.h"
+
+@implementation TracingDelegateProxy
+
+@synthesize target;
+
+-(TracingDelegateProxy*)initWithTarget:(id)aTarget
+{
+    target = aTarget;
+    
+    return self;
+}
+
+-(BOOL)respondsToSelector:(SEL)selector
+{
+    return [target respondsToSelector:selector];
+}
+
+-(BOOL)conformsToProtocol:(Protocol*)protocol
+{
+    return [target conformsToProtocol:protocol];
+}
+
+-(NSMethodSignature*)methodSignatureForSelector:(SEL)selector
+{
+    id strongTarget = target;
+    
+    //Without delegate the responses are discarded, as messages to a nil delegate
+    return strongTarget != nil ? [strongTarget methodSignatureForSelector:selector] : [NSObject instanceMethodSignatureForSelector:@selector(init)];
+}
+
+-(void)forwardInvocation:(NSInvocation*)invocation
+{
+    id strongTarget = target;
+    
+    if(strongTarget == nil)
+        return;
+    
+    uint64_t start = TraceTimestamp();
+    
+    [invocation invokeWithTarget:strongTarget];
+    
+    TraceSpan(sel_getName([invocation selector]), "delegate", start, 0);
+}
+
+@end
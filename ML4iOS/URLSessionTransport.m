@@ -0,0 +1,126 @@
+/**
+ *
+ * URLSessionTransport.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import "URLSessionTransport.h"
+
+//Interval between the checks of the cancellation of the operation while the response is awaited
+#define CANCELLATION_CHECK_INTERVAL 0.02
+
+//Maximum time to wait for the metrics of a request once its response is received
+#define METRICS_WAIT_ATTEMPTS 20
+#define METRICS_WAIT_INTERVAL 0.005
+
+#pragma mark -
+
+/**
+ * Task delegate that keeps the metrics of a request, only attached to the requests whose metrics are requested
+ */
+@interface RequestMetricsCollector : NSObject <NSURLSessionTaskDelegate>
+
+@property (atomic, strong) NSURLSessionTaskMetrics* taskMetrics;
+
+@end
+
+@implementation RequestMetricsCollector
+
+-(void)URLSession:(NSURLSession*)session task:(NSURLSessionTask*)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics*)metrics
+{
+    self.taskMetrics = metrics;
+}
+
+@end
+
+#pragma mark -
+
+@implementation URLSessionTransport
+
+-(URLSessionTransport*)init
+{
+    return [self initWithSession:[NSURLSession sharedSession]];
+}
+
+-(URLSessionTransport*)initWithSession:(NSURLSession*)aSession
+{
+    self = [super init];
+    
+    if(self)
+    {
+        session = aSession;
+    }
+    
+    return self;
+}
+
+-(NSData*)sendRequest:(NSURLRequest*)request operation:(NSOperation*)operation returningResponse:(NSHTTPURLResponse**)response metrics:(NSURLSessionTaskMetrics**)taskMetrics error:(NSError**)error
+{
+    NSError __block *err = nil;
+    NSData __block *data = nil;
+    NSURLResponse __block *resp = nil;
+    
+    dispatch_semaphore_t processed = dispatch_semaphore_create(0);
+    
+    NSURLSessionDataTask* task = [session dataTaskWithRequest:request completionHandler:^(NSData * _Nullable _data, NSURLResponse * _Nullable _response, NSError * _Nullable _error) {
+        resp = _response;
+        err = _error;
+        data = _data;
+        dispatch_semaphore_signal(processed);
+    }];
+    
+    RequestMetricsCollector* collector = nil;
+    
+    if(taskMetrics != NULL)
+    {
+        collector = [[RequestMetricsCollector alloc]init];
+        [task setDelegate:collector];
+    }
+    
+    [task resume];
+    
+    //The operation is checked while waiting, so its cancellation aborts the transfer and releases the connection
+    BOOL cancelled = NO;
+    
+    while(dispatch_semaphore_wait(processed, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(CANCELLATION_CHECK_INTERVAL * NSEC_PER_SEC))) != 0)
+    {
+        if(!cancelled && [operation isCancelled])
+        {
+            [task cancel];
+            cancelled = YES;
+        }
+    }
+    
+    if(taskMetrics != NULL)
+    {
+        //The metrics are delivered around the completion of the task, they are waited for a short time at most
+        for(NSInteger i = 0; i < METRICS_WAIT_ATTEMPTS && collector.taskMetrics == nil; i++)
+            [NSThread sleepForTimeInterval:METRICS_WAIT_INTERVAL];
+        
+        *taskMetrics = collector.taskMetrics;
+    }
+    
+    if(response != nil)
+        *response = [resp isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse*)resp : nil;
+    if(error != nil)
+        *error = err;
+    return data;
+}
+
+@end
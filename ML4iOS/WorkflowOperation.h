@@ -0,0 +1,86 @@
+/**
+ *
+ * WorkflowOperation.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+@class HTTPCommsManager;
+@class ReadinessScheduler;
+
+/**
+ * Asynchronous operation that chains the creation of a data source, a dataset, a model and optionally a prediction,
+ * waiting for every resource to be ready before creating the next one. Every step is launched in the async queue as
+ * an independent operation, so the workflow only holds a thread of the queue while a create request is in flight.
+ */
+@interface WorkflowOperation : NSOperation
+{
+    NSString* name;
+    NSString* filePath;
+    NSString* inputData;
+    NSTimeInterval timeout;
+
+    NSOperationQueue* queue;
+    HTTPCommsManager* commsManager;
+    ReadinessScheduler* readinessScheduler;
+
+    /**
+     * The step currently in the queue, cancelled if the workflow is cancelled
+     */
+    NSOperation* currentStep;
+
+    NSDictionary* dataSource;
+    NSDictionary* dataSet;
+    NSDictionary* model;
+    NSDictionary* prediction;
+    NSInteger statusCode;
+
+    BOOL executing;
+    BOOL finished;
+}
+
+@property (nonatomic, readonly) NSDictionary* dataSource;
+@property (nonatomic, readonly) NSDictionary* dataSet;
+@property (nonatomic, readonly) NSDictionary* model;
+@property (nonatomic, readonly) NSDictionary* prediction;
+
+/**
+ * HTTP_CREATED if all steps succeeded, else the HTTP status code of the failed request, or 0 if a resource failed
+ * or the timeout expired before it was ready
+ */
+@property (nonatomic, readonly) NSInteger statusCode;
+
+/**
+ * Initializes the workflow
+ * @param aName This optional parameter provides the name of the resources to be created
+ * @param aFilePath The full path of the csv in the filesystem
+ * @param aInputData This optional parameter provides the input data of the prediction. If it is nil the workflow ends with the model.
+ * @param aTimeout The maximum time to wait for every resource to be ready in seconds
+ * @param aQueue The queue where the steps are launched
+ * @param aCommsManager The object that handles the HTTP requests
+ * @param aReadinessScheduler The scheduler that multiplexes the readiness waits
+ */
+-(WorkflowOperation*)initWithName:(NSString*)aName filePath:(NSString*)aFilePath inputData:(NSString*)aInputData timeout:(NSTimeInterval)aTimeout queue:(NSOperationQueue*)aQueue commsManager:(HTTPCommsManager*)aCommsManager readinessScheduler:(ReadinessScheduler*)aReadinessScheduler;
+
+/**
+ * @return The last resource created: the prediction if input data was provided, else the model. nil if the workflow failed.
+ */
+-(NSDictionary*)result;
+
+@end
@@ -0,0 +1,316 @@
+/**
+ *
+ * WorkflowOperation.m
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import "WorkflowOperation.h"
+#import "HTTPCommsManager.h"
+#import "ReadinessScheduler.h"
+#import "ML4iOS.h"
+#import "Constants.h"
+
+/**
+ * Creates a resource
+ * @param code The HTTP status code returned
+ * @return The resource created if success, else nil
+ */
+typedef NSDictionary* (^WorkflowCreateStep)(NSInteger* code);
+
+/**
+ * Retrieves a resource
+ * @param identifier The identifier of the resource
+ * @param code The HTTP status code returned
+ * @return The resource if success, else nil
+ */
+typedef NSDictionary* (^WorkflowGetStep)(NSString* identifier, NSInteger* code);
+
+/**
+ * Interface that contains private methods
+ */
+@interface WorkflowOperation()
+
+#pragma mark -
+#pragma mark Steps
+
+-(void)createDataSource;
+-(void)createDataSetFromDataSource:(NSDictionary*)aDataSource;
+-(void)createModelFromDataSet:(NSDictionary*)aDataSet;
+-(void)createPredictionFromModel:(NSDictionary*)aModel;
+
+#pragma mark -
+#pragma mark Helper Methods
+
+/**
+ * Launches the creation of a resource in the queue and, once it is created, the wait until it is ready
+ * @param create The block that creates the resource
+ * @param get The block that retrieves the resource to check its status
+ * @param next The block called with the resource when it is ready
+ */
+-(void)launchStepWithCreate:(WorkflowCreateStep)create get:(WorkflowGetStep)get next:(void (^)(NSDictionary* resource))next;
+
+/**
+ * Moves the operation to the finished state
+ * @param code The status code of the workflow
+ */
+-(void)finishWithStatusCode:(NSInteger)code;
+
+@end
+
+#pragma mark -
+
+@implementation WorkflowOperation
+
+@synthesize dataSource;
+@synthesize dataSet;
+@synthesize model;
+@synthesize prediction;
+@synthesize statusCode;
+
+-(WorkflowOperation*)initWithName:(NSString*)aName filePath:(NSString*)aFilePath inputData:(NSString*)aInputData timeout:(NSTimeInterval)aTimeout queue:(NSOperationQueue*)aQueue commsManager:(HTTPCommsManager*)aCommsManager readinessScheduler:(ReadinessScheduler*)aReadinessScheduler
+{
+    self = [super init];
+
+    if(self)
+    {
+        name = aName;
+        filePath = aFilePath;
+        inputData = aInputData;
+        timeout = aTimeout;
+        queue = aQueue;
+        commsManager = aCommsManager;
+        readinessScheduler = aReadinessScheduler;
+    }
+
+    return self;
+}
+
+-(NSDictionary*)result
+{
+    return inputData != nil ? prediction : model;
+}
+
+-(BOOL)isAsynchronous
+{
+    return YES;
+}
+
+-(BOOL)isExecuting
+{
+    @synchronized(self)
+    {
+        return executing;
+    }
+}
+
+-(BOOL)isFinished
+{
+    @synchronized(self)
+    {
+        return finished;
+    }
+}
+
+-(void)start
+{
+    if([self isCancelled])
+    {
+        [self finishWithStatusCode:0];
+        return;
+    }
+
+    [self willChangeValueForKey:@"isExecuting"];
+
+    @synchronized(self)
+    {
+        executing = YES;
+    }
+
+    [self didChangeValueForKey:@"isExecuting"];
+
+    [self createDataSource];
+}
+
+-(void)cancel
+{
+    [super cancel];
+
+    @synchronized(self)
+    {
+        [currentStep cancel];
+    }
+
+    if([self isExecuting])
+        [self finishWithStatusCode:0];
+}
+
+#pragma mark -
+#pragma mark Steps
+
+-(void)createDataSource
+{
+    HTTPCommsManager* manager = commsManager;
+    NSString* resourceName = name;
+    NSString* resourcePath = filePath;
+
+    [self launchStepWithCreate:^NSDictionary*(NSInteger* code) {
+        return [manager createDataSourceWithName:resourceName filePath:resourcePath statusCode:code];
+    } get:^NSDictionary*(NSString* identifier, NSInteger* code) {
+        return [manager getDataSourceWithId:identifier statusCode:code];
+    } next:^(NSDictionary* resource) {
+        self->dataSource = resource;
+        [self createDataSetFromDataSource:resource];
+    }];
+}
+
+-(void)createDataSetFromDataSource:(NSDictionary*)aDataSource
+{
+    HTTPCommsManager* manager = commsManager;
+    NSString* resourceName = name;
+    NSString* sourceId = [ML4iOS getResourceIdentifierFromJSONObject:aDataSource];
+
+    [self launchStepWithCreate:^NSDictionary*(NSInteger* code) {
+        return [manager createDataSetWithDataSourceId:sourceId name:resourceName statusCode:code];
+    } get:^NSDictionary*(NSString* identifier, NSInteger* code) {
+        return [manager getDataSetWithId:identifier statusCode:code];
+    } next:^(NSDictionary* resource) {
+        self->dataSet = resource;
+        [self createModelFromDataSet:resource];
+    }];
+}
+
+-(void)createModelFromDataSet:(NSDictionary*)aDataSet
+{
+    HTTPCommsManager* manager = commsManager;
+    NSString* resourceName = name;
+    NSString* dataSetId = [ML4iOS getResourceIdentifierFromJSONObject:aDataSet];
+
+    [self launchStepWithCreate:^NSDictionary*(NSInteger* code) {
+        return [manager createModelWithDataSetId:dataSetId name:resourceName statusCode:code];
+    } get:^NSDictionary*(NSString* identifier, NSInteger* code) {
+        return [manager getModelWithId:identifier statusCode:code];
+    } next:^(NSDictionary* resource) {
+        self->model = resource;
+
+        if(self->inputData != nil)
+            [self createPredictionFromModel:resource];
+        else
+            [self finishWithStatusCode:HTTP_CREATED];
+    }];
+}
+
+-(void)createPredictionFromModel:(NSDictionary*)aModel
+{
+    HTTPCommsManager* manager = commsManager;
+    NSString* resourceName = name;
+    NSString* resourceInputData = inputData;
+    NSString* modelId = [ML4iOS getResourceIdentifierFromJSONObject:aModel];
+
+    [self launchStepWithCreate:^NSDictionary*(NSInteger* code) {
+        return [manager createPredictionWithModelId:modelId name:resourceName inputData:resourceInputData statusCode:code];
+    } get:^NSDictionary*(NSString* identifier, NSInteger* code) {
+        return [manager getPredictionWithId:identifier statusCode:code];
+    } next:^(NSDictionary* resource) {
+        self->prediction = resource;
+        [self finishWithStatusCode:HTTP_CREATED];
+    }];
+}
+
+#pragma mark -
+#pragma mark Helper Methods
+
+-(void)launchStepWithCreate:(WorkflowCreateStep)create get:(WorkflowGetStep)get next:(void (^)(NSDictionary* resource))next
+{
+    NSBlockOperation* step = [NSBlockOperation blockOperationWithBlock:^{
+        if([self isCancelled])
+            return;
+
+        NSInteger __block code = 0;
+        NSDictionary* __block resource = nil;
+        
+        //Cancelling the workflow cancels the creation in flight, including the upload of the file
+        [HTTPCommsManager performRequestsOfOperation:self block:^{
+            resource = create(&code);
+        }];
+
+        if(resource == nil || code != HTTP_CREATED)
+        {
+            [self finishWithStatusCode:code];
+            return;
+        }
+
+        //Wait for the resource without holding the thread of the queue
+        NSString* identifier = [ML4iOS getResourceIdentifierFromJSONObject:resource];
+
+        ReadinessWaitOperation* wait = [[ReadinessWaitOperation alloc]initWithScheduler:self->readinessScheduler probe:^NSDictionary*(NSInteger* probeCode) {
+            return get(identifier, probeCode);
+        } timeout:self->timeout];
+
+        ReadinessWaitOperation* __weak weakWait = wait;
+
+        [wait setCompletionBlock:^{
+            if([self isCancelled])
+                return;
+
+            if([weakWait ready])
+                next([weakWait resource]);
+            else
+                [self finishWithStatusCode:0];
+        }];
+
+        @synchronized(self)
+        {
+            self->currentStep = wait;
+        }
+
+        [self->queue addOperation:wait];
+    }];
+
+    @synchronized(self)
+    {
+        currentStep = step;
+    }
+
+    [queue addOperation:step];
+}
+
+-(void)finishWithStatusCode:(NSInteger)code
+{
+    @synchronized(self)
+    {
+        if(finished)
+            return;
+
+        statusCode = code;
+        currentStep = nil;
+    }
+
+    [self willChangeValueForKey:@"isExecuting"];
+    [self willChangeValueForKey:@"isFinished"];
+
+    @synchronized(self)
+    {
+        executing = NO;
+        finished = YES;
+    }
+
+    [self didChangeValueForKey:@"isExecuting"];
+    [self didChangeValueForKey:@"isFinished"];
+}
+
+@end
@@ -0,0 +1,127 @@
+/**
+ *
+ * ChunkedUpload.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Keeps the state of a chunked upload of a big .csv file.
+ * The file is split in chunks aligned to row boundaries, and every chunk is uploaded as an independent data source
+ * that repeats the header row of the file. The chunks acknowledged by BigML are recorded, so a failed upload can be
+ * resumed passing the same object again, only uploading the chunks that are still pending.
+ */
+@interface ChunkedUpload : NSObject
+{
+    NSString* name;
+    NSString* filePath;
+    NSUInteger chunkSize;
+
+    NSInteger maxConcurrentUploads;
+    NSInteger maxAttemptsPerChunk;
+
+    /**
+     * The header row of the file, including the line break
+     */
+    NSData* headerRow;
+
+    /**
+     * NSRange values (wrapped in NSValue) with the byte range of every chunk in the file, header row excluded
+     */
+    NSArray* chunkRanges;
+
+    /**
+     * The data source created for every chunk, NSNull if the chunk is still pending
+     */
+    NSMutableArray* dataSources;
+}
+
+/**
+ * Maximum number of chunks uploaded in parallel. Default value is 4.
+ */
+@property (nonatomic, assign) NSInteger maxConcurrentUploads;
+
+/**
+ * Number of attempts made for every chunk before giving up on the current upload pass. Default value is 3.
+ * A chunk is only sent again if it was rejected with 429 or 503, or if it never reached BigML, waiting the Retry-After
+ * delay or the backoff of the retry policy. Any other failure ends the pass for that chunk: a creation that timed out
+ * may have created the data source anyway, and sending it again could create a duplicate.
+ */
+@property (nonatomic, assign) NSInteger maxAttemptsPerChunk;
+
+@property (nonatomic, readonly) NSString* name;
+@property (nonatomic, readonly) NSString* filePath;
+
+/**
+ * Initializes the upload, splitting the file in chunks
+ * @param aName This optional parameter provides the base name of the data sources to be created. Every chunk is named
+ * appending its index to this name.
+ * @param aFilePath The full path of the csv in the filesystem
+ * @param aChunkSize The approximate size in bytes of every chunk
+ * @return The created ChunkedUpload object, nil if the file can't be read
+ */
+-(ChunkedUpload*)initWithName:(NSString*)aName filePath:(NSString*)aFilePath chunkSize:(NSUInteger)aChunkSize;
+
+/**
+ * @return The number of chunks the file was split in
+ */
+-(NSUInteger)numberOfChunks;
+
+/**
+ * @return The number of chunks already acknowledged by BigML
+ */
+-(NSUInteger)numberOfAcknowledgedChunks;
+
+/**
+ * @return true if all chunks have been acknowledged, else false
+ */
+-(BOOL)isComplete;
+
+/**
+ * @return The data sources created, sorted by chunk index. Pending chunks are represented with NSNull.
+ */
+-(NSArray*)dataSources;
+
+/**
+ * @param index The index of the chunk
+ * @return true if the chunk has been acknowledged, else false
+ */
+-(BOOL)isChunkAcknowledgedAtIndex:(NSUInteger)index;
+
+/**
+ * Builds the .csv content of a chunk, header row included
+ * @param index The index of the chunk
+ * @return The content of the chunk, nil if the file can't be read
+ */
+-(NSData*)dataForChunkAtIndex:(NSUInteger)index;
+
+/**
+ * @param index The index of the chunk
+ * @return The name of the data source created for the chunk
+ */
+-(NSString*)nameForChunkAtIndex:(NSUInteger)index;
+
+/**
+ * Records the data source created for a chunk
+ * @param dataSource The data source created
+ * @param index The index of the chunk
+ */
+-(void)acknowledgeChunkAtIndex:(NSUInteger)index dataSource:(NSDictionary*)dataSource;
+
+@end
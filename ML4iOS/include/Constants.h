@@ -28,6 +28,7 @@
 #define HTTP_CREATED 201
 #define HTTP_ACCEPTED 202
 #define HTTP_NO_CONTENT 204
+#define HTTP_NOT_MODIFIED 304
 #define HTTP_BAD_REQUEST 400
 #define HTTP_UNAUTHORIZED 401
 #define HTTP_PAYMENT_REQUIRED 402
@@ -35,7 +36,11 @@
 #define HTTP_NOT_FOUND 404
 #define HTTP_METHOD_NOT_ALLOWED 405
 #define HTTP_LENGTH_REQUIRED 411
+#define HTTP_TOO_MANY_REQUESTS 429
+#define HTTP_CLIENT_CLOSED_REQUEST 499
 #define HTTP_INTERNAL_SERVER_ERROR 500
+#define HTTP_NOT_IMPLEMENTED 501
+#define HTTP_SERVICE_UNAVAILABLE 503
 
 //RESOURCE Status Codes (A resource can be a data source, dataset, model, prediction, etc)
 #define WAITING 0
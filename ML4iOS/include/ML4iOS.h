@@ -21,8 +21,37 @@
 
 #import <Foundation/Foundation.h>
 #import "ML4iOSDelegate.h"
+#import "ML4iOSMetrics.h"
+#import "ML4iOSTransport.h"
+
+@class ChunkedUpload;
+@class ResourceEnumerator;
 
 @class HTTPCommsManager;
+@class ReadinessScheduler;
+@class PredictionRouter;
+@class ModelRegistry;
+@class TracingDelegateProxy;
+
+/**
+ * Completion handler of a request that returns a resource or a list of resources
+ * @param resource The resource if success, else nil
+ * @param statusCode The HTTP status code
+ */
+typedef void (^ResourceCompletion)(NSDictionary* resource, NSInteger statusCode);
+
+/**
+ * Completion handler of a request that only returns a HTTP status code
+ * @param statusCode The HTTP status code
+ */
+typedef void (^StatusCompletion)(NSInteger statusCode);
+
+/**
+ * Completion handler of a readiness wait
+ * @param ready true if the status of the resource is FINISHED, else false
+ * @param resource The last state of the resource retrieved
+ */
+typedef void (^ReadyCompletion)(BOOL ready, NSDictionary* resource);
 
 /**
  * Main class of the library that implements methods that access BigML.io API.
@@ -43,10 +72,40 @@
      */
     HTTPCommsManager* commsManager;
     
+    /**
+     * Multiplexes the readiness waits of all resources
+     */
+    ReadinessScheduler* readinessScheduler;
+    
+    /**
+     * Compiled local models used by the hybrid predictions
+     */
+    ModelRegistry* modelRegistry;
+    
+    /**
+     * Routes the hybrid predictions to the local or the remote prediction path
+     */
+    PredictionRouter* predictionRouter;
+    
     /**
      * Delegate used for asynchronous responses
      */
     id<ML4iOSDelegate> __weak delegate;
+    
+    /**
+     * Receives the measures of requests, operations and local predictions, nil if the metrics are disabled
+     */
+    id<ML4iOSMetrics> metrics;
+    
+    /**
+     * Number of asynchronous operations waiting to start, only counted while the metrics are enabled
+     */
+    NSUInteger pendingOperations;
+    
+    /**
+     * Proxy that traces the responses delivered to the delegate, only set while tracing
+     */
+    TracingDelegateProxy* tracingProxy;
 }
 
 #pragma mark -
@@ -56,6 +115,13 @@
  */
 @property(nonatomic, weak) id<ML4iOSDelegate> delegate;
 
+/**
+ * Property used to enable the instrumentation of the library, assigning an object that receives the measures
+ * (MetricsRecorder is the default implementation). nil disables it, then no measure is taken.
+ * It should be assigned before launching requests.
+ */
+@property(nonatomic, strong) id<ML4iOSMetrics> metrics;
+
 #pragma mark -
 
 /**
@@ -68,15 +134,83 @@
 -(ML4iOS*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode;
 
 /**
- * Cancel all asynchronous operations in the queue
+ * Initializes the library with the BigML username and API key and the transport that sends the requests. Use a
+ * StubServerTransport or a RecordReplayTransport to run the library without network access.
+ * @param username The BigML username
+ * @param key The BigML.io API key
+ * @param devMode true if we want to use the library on development mode, else false
+ * @param transport The transport that sends the requests, nil to send them to BigML
+ * @return The created BigMLAPILibrary object
+ */
+-(ML4iOS*)initWithUsername:(NSString*)username key:(NSString*)key developmentMode:(BOOL)devMode transport:(id<ML4iOSTransport>)transport;
+
+/**
+ * Cancel all asynchronous operations in the queue. The requests in flight are cancelled too, releasing their
+ * connections: the delegate receives their responses with HTTP_CLIENT_CLOSED_REQUEST status code, while the completion
+ * handlers of cancelled operations are not called.
  */
 -(void)cancelAllAsynchronousOperations;
 
+/**
+ * Starts recording a trace of the library: asynchronous operations enqueued and executed, HTTP requests, JSON parsing
+ * and responses delivered to the delegate, on the thread where they happen.
+ * @param capacity The maximum number of events kept per thread, 0 for the default capacity
+ */
+-(void)startTracingWithBufferCapacity:(NSUInteger)capacity;
+
+/**
+ * Stops recording the trace and writes it to a file in the Chrome trace event format, that can be loaded in
+ * chrome://tracing or Perfetto
+ * @param path The full path of the file
+ * @return true if the file was written, else false
+ */
+-(BOOL)stopTracingAndWriteToFile:(NSString*)path;
+
 /**
  * Extract the identifier from resource strings like source/IDENTIFIER, model/IDENTIFIER, etc
  */
 +(NSString*) getResourceIdentifierFromJSONObject:(NSDictionary*)resouce;
 
+/**
+ * Enables the persistent on-disk cache of models, datasets and clusters retrieved with the get methods.
+ * @param timeToLive The time in seconds a FINISHED resource is served from disk without any request. Once expired,
+ * or if the resource is not FINISHED, the cached copy is revalidated with a conditional request and only downloaded again if modified.
+ */
+-(void)enableResourceCacheWithTimeToLive:(NSTimeInterval)timeToLive;
+
+/**
+ * Get the statistics of the resource cache.
+ * @return A NSDictionary with the number of "hits" (served without request), "revalidations" (served after a conditional
+ * request) and "misses" (downloaded), the "hitRatio" and the "bytesSaved". nil if the cache is disabled.
+ */
+-(NSDictionary*)resourceCacheStatistics;
+
+/**
+ * Sets the retry policy of idempotent requests (get, update and delete). Requests that fail because of a network error,
+ * a timeout, a server error or a rate limit are retried after a random delay up to an exponential backoff.
+ * Create requests are never retried. By default 2 retries are made with a base delay of 0.25 seconds and a maximum of 8 seconds.
+ * @param maxRetries The maximum number of retries per request, 0 disables the retries
+ * @param baseDelay The backoff of the first retry in seconds, doubled on every retry
+ * @param maxDelay The maximum backoff in seconds
+ */
+-(void)setRetryPolicyWithMaxRetries:(NSUInteger)maxRetries baseDelay:(NSTimeInterval)baseDelay maxDelay:(NSTimeInterval)maxDelay;
+
+/**
+ * Sets the circuit breaker applied to every endpoint. After a number of consecutive failures the requests to the endpoint
+ * fail fast with HTTP_SERVICE_UNAVAILABLE, until a trial request succeeds. By default the circuit opens after 5 failures
+ * and allows a trial every 30 seconds.
+ * @param failureThreshold The number of consecutive failures that opens the circuit, 0 disables the breaker
+ * @param openInterval The time in seconds before allowing a trial request to an open endpoint
+ */
+-(void)setCircuitBreakerWithFailureThreshold:(NSUInteger)failureThreshold openInterval:(NSTimeInterval)openInterval;
+
+/**
+ * Get the statistics of the retry policy and the circuit breaker.
+ * @return A NSDictionary with the number of "retries", the names of the "openEndpoints", the number of "rejectedRequests"
+ * and the number of "coalescedRequests" (concurrent identical get requests served by a single request)
+ */
+-(NSDictionary*)reliabilityStatistics;
+
 //*******************************************************************************
 //********************************  SOURCES  ************************************
 //****************** https://bigml.com/developers/sources ***********************
@@ -103,6 +237,23 @@
  */
 -(NSOperation*)createDataSourceWithName:(NSString*)name filePath:(NSString*)filePath;
 
+/**
+ * Creates a data source per chunk of a big .csv file, uploading the chunks in parallel. If some chunks fail the
+ * upload can be resumed calling this method again with the same ChunkedUpload object, only the pending chunks are uploaded.
+ * @param upload The chunked upload, created with the .csv file path and the size of the chunks
+ * @param code The HTTP status code returned
+ * @return The data sources created sorted by chunk index if all chunks are acknowledged, else nil
+ */
+-(NSArray*)createDataSourcesWithUploadSync:(ChunkedUpload*)upload statusCode:(NSInteger*)code;
+
+/**
+ * Creates a data source per chunk of a big .csv file, uploading the chunks in parallel. The response is provided
+ * in the method dataSourcesCreated of the delegate.
+ * @param upload The chunked upload, created with the .csv file path and the size of the chunks
+ * @return The async NSOperation created
+ */
+-(NSOperation*)createDataSourcesWithUpload:(ChunkedUpload*)upload;
+
 /**
  * Updates the name of a given data source. 
  * @param identifier The identifier of the data source to update 
@@ -155,6 +306,16 @@
  */
 -(NSOperation*)getAllDataSourcesWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit;
 
+/**
+ * Get a lazy enumerator over all data sources filtered by name. The pages are requested on demand and the next page is
+ * prefetched while the current one is consumed, so at most two pages are kept in memory.
+ * @param name This optional parameter provides the name of the data sources to be enumerated. If it is nil then will be
+ * enumerated all data sources without any filtering
+ * @param pageSize The number of data sources requested per page
+ * @return The enumerator. Its statusCode property contains the HTTP status code of the last page requested.
+ */
+-(ResourceEnumerator*)enumerateAllDataSourcesWithName:(NSString*)name pageSize:(NSInteger)pageSize;
+
 /**
  * Get a data source.
  * @param identifier The identifier of the data source to get 
@@ -184,6 +345,24 @@
  */
 -(NSOperation*)checkDataSourceIsReadyWithId:(NSString*)identifier;
 
+/**
+ * Waits until the status of the data source is FINISHED, blocking the caller thread. The status is probed with exponential
+ * backoff adapted to the progress reported by BigML, without blocking any other thread while waiting.
+ * @param identifier The identifier of the data source to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return true if the status of the data source is FINISHED before the timeout, else false
+ */
+-(BOOL)waitUntilDataSourceIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
+/**
+ * Waits until the status of the data source is FINISHED. The response is provided in the method dataSourceIsReady of the delegate
+ * once the data source is finished, failed or the timeout expires. Cancel the returned operation to stop waiting.
+ * @param identifier The identifier of the data source to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return The async NSOperation created
+ */
+-(NSOperation*)waitUntilDataSourceIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
 //*******************************************************************************
 //*********************************  DATASETS  **********************************
 //******************* https://bigml.com/developers/datasets *********************
@@ -261,6 +440,16 @@
  */
 -(NSOperation*)getAllDataSetsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit;
 
+/**
+ * Get a lazy enumerator over all datasets filtered by name. The pages are requested on demand and the next page is
+ * prefetched while the current one is consumed, so at most two pages are kept in memory.
+ * @param name This optional parameter provides the name of the datasets to be enumerated. If it is nil then will be
+ * enumerated all datasets without any filtering
+ * @param pageSize The number of datasets requested per page
+ * @return The enumerator. Its statusCode property contains the HTTP status code of the last page requested.
+ */
+-(ResourceEnumerator*)enumerateAllDataSetsWithName:(NSString*)name pageSize:(NSInteger)pageSize;
+
 /**
  * Get a dataset.
  * @param identifier The identifier of the dataset to get 
@@ -290,6 +479,24 @@
  */
 -(NSOperation*)checkDataSetIsReadyWithId:(NSString*)identifier;
 
+/**
+ * Waits until the status of the dataset is FINISHED, blocking the caller thread. The status is probed with exponential
+ * backoff adapted to the progress reported by BigML, without blocking any other thread while waiting.
+ * @param identifier The identifier of the dataset to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return true if the status of the dataset is FINISHED before the timeout, else false
+ */
+-(BOOL)waitUntilDataSetIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
+/**
+ * Waits until the status of the dataset is FINISHED. The response is provided in the method dataSetIsReady of the delegate
+ * once the dataset is finished, failed or the timeout expires. Cancel the returned operation to stop waiting.
+ * @param identifier The identifier of the dataset to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return The async NSOperation created
+ */
+-(NSOperation*)waitUntilDataSetIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
 //*******************************************************************************
 //*********************************  MODELS  ************************************
 //******************* https://bigml.com/developers/models ***********************
@@ -367,6 +574,16 @@
  */
 -(NSOperation*)getAllModelsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit;
 
+/**
+ * Get a lazy enumerator over all models filtered by name. The pages are requested on demand and the next page is
+ * prefetched while the current one is consumed, so at most two pages are kept in memory.
+ * @param name This optional parameter provides the name of the models to be enumerated. If it is nil then will be
+ * enumerated all models without any filtering
+ * @param pageSize The number of models requested per page
+ * @return The enumerator. Its statusCode property contains the HTTP status code of the last page requested.
+ */
+-(ResourceEnumerator*)enumerateAllModelsWithName:(NSString*)name pageSize:(NSInteger)pageSize;
+
 /**
  * Get a model.
  * @param identifier The identifier of the model to get 
@@ -396,6 +613,24 @@
  */
 -(NSOperation*)checkModelIsReadyWithId:(NSString*)identifier;
 
+/**
+ * Waits until the status of the model is FINISHED, blocking the caller thread. The status is probed with exponential
+ * backoff adapted to the progress reported by BigML, without blocking any other thread while waiting.
+ * @param identifier The identifier of the model to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return true if the status of the model is FINISHED before the timeout, else false
+ */
+-(BOOL)waitUntilModelIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
+/**
+ * Waits until the status of the model is FINISHED. The response is provided in the method modelIsReady of the delegate
+ * once the model is finished, failed or the timeout expires. Cancel the returned operation to stop waiting.
+ * @param identifier The identifier of the model to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return The async NSOperation created
+ */
+-(NSOperation*)waitUntilModelIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
 //*******************************************************************************
 //*********************************  CLUSTERS  **********************************
 //******************* https://bigml.com/developers/clusters *********************
@@ -475,6 +710,16 @@
  */
 -(NSOperation*)getAllClustersWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit;
 
+/**
+ * Get a lazy enumerator over all clusters filtered by name. The pages are requested on demand and the next page is
+ * prefetched while the current one is consumed, so at most two pages are kept in memory.
+ * @param name This optional parameter provides the name of the clusters to be enumerated. If it is nil then will be
+ * enumerated all clusters without any filtering
+ * @param pageSize The number of clusters requested per page
+ * @return The enumerator. Its statusCode property contains the HTTP status code of the last page requested.
+ */
+-(ResourceEnumerator*)enumerateAllClustersWithName:(NSString*)name pageSize:(NSInteger)pageSize;
+
 /**
  * Get a cluster.
  * @param identifier The identifier of the cluster to get
@@ -504,6 +749,24 @@
  */
 -(NSOperation*)checkClusterIsReadyWithId:(NSString*)identifier;
 
+/**
+ * Waits until the status of the cluster is FINISHED, blocking the caller thread. The status is probed with exponential
+ * backoff adapted to the progress reported by BigML, without blocking any other thread while waiting.
+ * @param identifier The identifier of the cluster to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return true if the status of the cluster is FINISHED before the timeout, else false
+ */
+-(BOOL)waitUntilClusterIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
+/**
+ * Waits until the status of the cluster is FINISHED. The response is provided in the method clusterIsReady of the delegate
+ * once the cluster is finished, failed or the timeout expires. Cancel the returned operation to stop waiting.
+ * @param identifier The identifier of the cluster to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return The async NSOperation created
+ */
+-(NSOperation*)waitUntilClusterIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
 //*******************************************************************************
 //******************************  PREDICTIONS  **********************************
 //****************** https://bigml.com/developers/predictions *******************
@@ -533,6 +796,29 @@
  */
 -(NSOperation*)createPredictionWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData;
 
+/**
+ * Creates a prediction per input row from a given model, sending up to maxConcurrentRequests requests in parallel.
+ * Rows rejected by the rate limit of BigML are retried after the delay requested by the server.
+ * @param modelId The identifier of the model
+ * @param name This optional parameter provides the name of the predictions to be created
+ * @param inputDataList The input data of every prediction, a JSON object per row as in createPredictionWithModelIdSync
+ * @param maxConcurrentRequests The maximum number of requests in flight
+ * @param codes Returns the HTTP status code of every row, in the same order than inputDataList
+ * @return The predictions created in the same order than inputDataList, NSNull for the rows that failed
+ */
+-(NSArray*)createPredictionsWithModelIdSync:(NSString*)modelId name:(NSString*)name inputDataList:(NSArray*)inputDataList maxConcurrentRequests:(NSInteger)maxConcurrentRequests statusCodes:(NSArray**)codes;
+
+/**
+ * Creates a prediction per input row from a given model, sending up to maxConcurrentRequests requests in parallel.
+ * The response is provided in the method predictionsCreated of the delegate.
+ * @param modelId The identifier of the model
+ * @param name This optional parameter provides the name of the predictions to be created
+ * @param inputDataList The input data of every prediction, a JSON object per row as in createPredictionWithModelId
+ * @param maxConcurrentRequests The maximum number of requests in flight
+ * @return The async NSOperation created
+ */
+-(NSOperation*)createPredictionsWithModelId:(NSString*)modelId name:(NSString*)name inputDataList:(NSArray*)inputDataList maxConcurrentRequests:(NSInteger)maxConcurrentRequests;
+
 /**
  * Updates the name of a given prediction. 
  * @param identifier The identifier of the prediction to update 
@@ -585,6 +871,16 @@
  */
 -(NSOperation*)getAllPredictionsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit;
 
+/**
+ * Get a lazy enumerator over all predictions filtered by name. The pages are requested on demand and the next page is
+ * prefetched while the current one is consumed, so at most two pages are kept in memory.
+ * @param name This optional parameter provides the name of the predictions to be enumerated. If it is nil then will be
+ * enumerated all predictions without any filtering
+ * @param pageSize The number of predictions requested per page
+ * @return The enumerator. Its statusCode property contains the HTTP status code of the last page requested.
+ */
+-(ResourceEnumerator*)enumerateAllPredictionsWithName:(NSString*)name pageSize:(NSInteger)pageSize;
+
 /**
  * Get a prediction.
  * @param identifier The identifier of the prediction to get 
@@ -614,6 +910,24 @@
  */
 -(NSOperation*)checkPredictionIsReadyWithId:(NSString*)identifier;
 
+/**
+ * Waits until the status of the prediction is FINISHED, blocking the caller thread. The status is probed with exponential
+ * backoff adapted to the progress reported by BigML, without blocking any other thread while waiting.
+ * @param identifier The identifier of the prediction to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return true if the status of the prediction is FINISHED before the timeout, else false
+ */
+-(BOOL)waitUntilPredictionIsReadyWithIdSync:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
+/**
+ * Waits until the status of the prediction is FINISHED. The response is provided in the method predictionIsReady of the delegate
+ * once the prediction is finished, failed or the timeout expires. Cancel the returned operation to stop waiting.
+ * @param identifier The identifier of the prediction to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @return The async NSOperation created
+ */
+-(NSOperation*)waitUntilPredictionIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout;
+
 
 //*******************************************************************************
 //***************************  LOCAL PREDICTIONS  *******************************
@@ -631,5 +945,439 @@
  */
 -(NSDictionary*)createLocalPredictionWithJSONModelSync:(NSDictionary*)jsonModel arguments:(NSString*)args argsByName:(BOOL)byName;
 
+//*******************************************************************************
+//*****************************  LOCAL TRAINING  ********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Local Training
+
+/**
+ * Creates a model locally from a .csv file, without uploading the data to BigML. The last field is the objective field.
+ * @param filePath The path of the .csv file. The first row must contain the names of the fields
+ * @param name The name of the model
+ * @return The model created in the same format as the models created by BigML, so it can be used to create local
+ * predictions, nil if the file can't be read
+ */
+-(NSDictionary*)createLocalModelWithFilePathSync:(NSString*)filePath name:(NSString*)name;
+
+/**
+ * Creates a k-means cluster locally from a .csv file, without uploading the data to BigML. The numeric fields are used.
+ * @param filePath The path of the .csv file. The first row must contain the names of the fields
+ * @param name The name of the cluster
+ * @param k Number of clusters to create
+ * @return The cluster created in the same format as the clusters created by BigML, nil if the file can't be read or it
+ * has no numeric fields
+ */
+-(NSDictionary*)createLocalClusterWithFilePathSync:(NSString*)filePath name:(NSString*)name numberOfClusters:(NSInteger)k;
+
+//*******************************************************************************
+//***************************  HYBRID PREDICTIONS  ******************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Hybrid Predictions
+
+/**
+ * Creates a prediction from a given model, locally if the model is already compiled, else remotely. The first prediction
+ * of a model launches in background the download and compilation of the model, so the following ones are created
+ * locally once it is FINISHED and compiled.
+ * @param modelId The identifier of the model
+ * @param input A JSON object that contents the pairs field_id : field_value (For instance @"{\"000001\": 1, \"000002\": 3}")
+ * @param code The HTTP status code returned. HTTP_OK if the prediction is created locally.
+ * @return A NSDictionary with the result of the prediction keyed with "value", the confidence keyed with "confidence" and
+ * the path used keyed with "source" ("local" or "remote") if success, else nil
+ */
+-(NSDictionary*)predictWithModelIdSync:(NSString*)modelId input:(NSString*)input statusCode:(NSInteger*)code;
+
+/**
+ * Creates a prediction from a given model, locally if the model is already compiled, else remotely. The response is
+ * provided in the method hybridPredictionCreated of the delegate.
+ * @param modelId The identifier of the model
+ * @param input A JSON object that contents the pairs field_id : field_value (For instance @"{\"000001\": 1, \"000002\": 3}")
+ * @return The async NSOperation created
+ */
+-(NSOperation*)predictWithModelId:(NSString*)modelId input:(NSString*)input;
+
+/**
+ * @return The number of hybrid predictions created locally ("localPredictions") and remotely ("remotePredictions"),
+ * the number of models compiled ("compiledModels") and the number of new versions swapped in ("reloads"), plus the
+ * residency statistics of the compiled models described in ModelRegistry statistics
+ */
+-(NSDictionary*)hybridPredictionStatistics;
+
+/**
+ * Starts checking periodically for new versions of the models compiled for hybrid predictions. A new version is
+ * compiled in background and swapped in atomically, the predictions in flight finish with the previous version.
+ * @param interval The time in seconds between checks
+ */
+-(void)startModelRefreshWithInterval:(NSTimeInterval)interval;
+
+/**
+ * Stops the periodic checks for new versions of the models
+ */
+-(void)stopModelRefresh;
+
+/**
+ * Bounds the memory of the models compiled for hybrid predictions. When the budget is exceeded the least recently used
+ * models are evicted, and compiled again from their copy on disk the next time they are used.
+ * @param budget The maximum bytes of the compiled models, 0 if unlimited (default)
+ */
+-(void)setModelMemoryBudget:(NSUInteger)budget;
+
+/**
+ * Bounds the disk taken by the copies of the models compiled for hybrid predictions. When the budget is exceeded the
+ * copies of the least recently used models are deleted, and those models are downloaded again once evicted.
+ * @param budget The maximum bytes of the copies, 0 if unlimited (default 64 MB)
+ */
+-(void)setModelDiskBudget:(NSUInteger)budget;
+
+//*******************************************************************************
+//*******************************  WORKFLOWS  ***********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Workflows
+
+/**
+ * Creates a data source from a given .csv file, a dataset from the data source, a model from the dataset and, if
+ * input data is provided, a prediction from the model. Every resource is created once the previous one is ready.
+ * @param name This optional parameter provides the name of the resources to be created
+ * @param filePath The full path of the csv in the filesystem
+ * @param inputData This optional parameter provides the input data of the prediction in the format used by
+ * createPredictionWithModelIdSync. If it is nil then the workflow ends when the model is ready.
+ * @param timeout The maximum time to wait for every resource to be ready in seconds
+ * @param code HTTP_CREATED if all resources are created and ready, else the HTTP status code of the failed request,
+ * or 0 if a resource failed or the timeout expired before it was ready
+ * @return The prediction if input data is provided, else the model. nil if the workflow failed.
+ */
+-(NSDictionary*)runWorkflowWithNameSync:(NSString*)name filePath:(NSString*)filePath inputData:(NSString*)inputData timeout:(NSTimeInterval)timeout statusCode:(NSInteger*)code;
+
+/**
+ * Creates a data source from a given .csv file, a dataset from the data source, a model from the dataset and, if
+ * input data is provided, a prediction from the model. The response is provided in the method workflowFinished of the delegate.
+ * Many workflows can run at the same time, a workflow only holds a thread of the queue while a create request is in flight.
+ * @param name This optional parameter provides the name of the resources to be created
+ * @param filePath The full path of the csv in the filesystem
+ * @param inputData This optional parameter provides the input data of the prediction in the format used by
+ * createPredictionWithModelId. If it is nil then the workflow ends when the model is ready.
+ * @param timeout The maximum time to wait for every resource to be ready in seconds
+ * @return The async NSOperation created
+ */
+-(NSOperation*)runWorkflowWithName:(NSString*)name filePath:(NSString*)filePath inputData:(NSString*)inputData timeout:(NSTimeInterval)timeout;
+
+
+//*******************************************************************************
+//***************************  COMPLETION HANDLERS  *****************************
+//*******************************************************************************
+
+#pragma mark -
+
+/**
+ * The following methods deliver the response of every request to its own completion handler instead of the delegate,
+ * so many requests of the same kind can run at the same time. The completion handlers are called in a thread of the
+ * operations queue. Every method returns its NSOperation as cancellation token: a cancelled request doesn't call its
+ * completion handler, and if it has not started yet its HTTP request is not sent.
+ */
+
+#pragma mark DataSources
+
+/**
+ * Creates a data source. The completion handler is called with the data source created if success, else nil.
+ * @param name This optional parameter provides the name of the data source to be created. If it is nil then the data source
+ * will be named using the .csv file name.
+ * @param filePath The full path of the csv in the filesystem
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)createDataSourceWithName:(NSString*)name filePath:(NSString*)filePath completion:(ResourceCompletion)completion;
+
+/**
+ * Updates the name of a given data source. The completion handler is called with the data source updated if success, else nil.
+ * @param identifier The identifier of the data source to update
+ * @param name The new name of the data source
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)updateDataSourceNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Deletes a given data source. The completion handler is called with the HTTP status code.
+ * @param identifier The identifier of the data source to delete
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)deleteDataSourceWithId:(NSString*)identifier completion:(StatusCompletion)completion;
+
+/**
+ * Get a list of data sources filtered by name. The completion handler is called with the list of data sources found if success, else nil.
+ * @param name This optional parameter provides the name of the data sources to be retrieved. If it is nil then will be
+ * retrieved all data sources without any filtering
+ * @param offset The offset to paginate the results
+ * @param limit The maximum number of results
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getAllDataSourcesWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion;
+
+/**
+ * Get a data source. The completion handler is called with the data source if success, else nil.
+ * @param identifier The identifier of the data source to get
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getDataSourceWithId:(NSString*)identifier completion:(ResourceCompletion)completion;
+
+/**
+ * Waits until the status of the data source is FINISHED. The completion handler is called once the data source is finished, failed
+ * or the timeout expires.
+ * @param identifier The identifier of the data source to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to stop waiting
+ */
+-(NSOperation*)waitUntilDataSourceIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion;
+
+#pragma mark DataSets
+
+/**
+ * Creates a dataset. The completion handler is called with the dataset created if success, else nil.
+ * @param sourceId The identifier of the data source
+ * @param name This optional parameter provides the name of the dataset to be created
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)createDataSetWithDataSourceId:(NSString*)sourceId name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Updates the name of a given dataset. The completion handler is called with the dataset updated if success, else nil.
+ * @param identifier The identifier of the dataset to update
+ * @param name The new name of the dataset
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)updateDataSetNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Deletes a given dataset. The completion handler is called with the HTTP status code.
+ * @param identifier The identifier of the dataset to delete
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)deleteDataSetWithId:(NSString*)identifier completion:(StatusCompletion)completion;
+
+/**
+ * Get a list of datasets filtered by name. The completion handler is called with the list of datasets found if success, else nil.
+ * @param name This optional parameter provides the name of the datasets to be retrieved. If it is nil then will be
+ * retrieved all datasets without any filtering
+ * @param offset The offset to paginate the results
+ * @param limit The maximum number of results
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getAllDataSetsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion;
+
+/**
+ * Get a dataset. The completion handler is called with the dataset if success, else nil.
+ * @param identifier The identifier of the dataset to get
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getDataSetWithId:(NSString*)identifier completion:(ResourceCompletion)completion;
+
+/**
+ * Waits until the status of the dataset is FINISHED. The completion handler is called once the dataset is finished, failed
+ * or the timeout expires.
+ * @param identifier The identifier of the dataset to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to stop waiting
+ */
+-(NSOperation*)waitUntilDataSetIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion;
+
+#pragma mark Models
+
+/**
+ * Creates a model. The completion handler is called with the model created if success, else nil.
+ * @param dataSetId The identifier of the dataset
+ * @param name This optional parameter provides the name of the model to be created
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)createModelWithDataSetId:(NSString*)dataSetId name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Updates the name of a given model. The completion handler is called with the model updated if success, else nil.
+ * @param identifier The identifier of the model to update
+ * @param name The new name of the model
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)updateModelNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Deletes a given model. The completion handler is called with the HTTP status code.
+ * @param identifier The identifier of the model to delete
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)deleteModelWithId:(NSString*)identifier completion:(StatusCompletion)completion;
+
+/**
+ * Get a list of models filtered by name. The completion handler is called with the list of models found if success, else nil.
+ * @param name This optional parameter provides the name of the models to be retrieved. If it is nil then will be
+ * retrieved all models without any filtering
+ * @param offset The offset to paginate the results
+ * @param limit The maximum number of results
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getAllModelsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion;
+
+/**
+ * Get a model. The completion handler is called with the model if success, else nil.
+ * @param identifier The identifier of the model to get
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getModelWithId:(NSString*)identifier completion:(ResourceCompletion)completion;
+
+/**
+ * Waits until the status of the model is FINISHED. The completion handler is called once the model is finished, failed
+ * or the timeout expires.
+ * @param identifier The identifier of the model to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to stop waiting
+ */
+-(NSOperation*)waitUntilModelIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion;
+
+#pragma mark Clusters
+
+/**
+ * Creates a cluster. The completion handler is called with the cluster created if success, else nil.
+ * @param dataSetId The identifier of the dataset
+ * @param name This optional parameter provides the name of the cluster to be created
+ * @param k Number of clusters to create
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)createClusterWithDataSetId:(NSString*)dataSetId name:(NSString*)name numberOfClusters:(NSInteger)k completion:(ResourceCompletion)completion;
+
+/**
+ * Updates the name of a given cluster. The completion handler is called with the cluster updated if success, else nil.
+ * @param identifier The identifier of the cluster to update
+ * @param name The new name of the cluster
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)updateClusterNameWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Deletes a given cluster. The completion handler is called with the HTTP status code.
+ * @param identifier The identifier of the cluster to delete
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)deleteClusterWithId:(NSString*)identifier completion:(StatusCompletion)completion;
+
+/**
+ * Get a list of clusters filtered by name. The completion handler is called with the list of clusters found if success, else nil.
+ * @param name This optional parameter provides the name of the clusters to be retrieved. If it is nil then will be
+ * retrieved all clusters without any filtering
+ * @param offset The offset to paginate the results
+ * @param limit The maximum number of results
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getAllClustersWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion;
+
+/**
+ * Get a cluster. The completion handler is called with the cluster if success, else nil.
+ * @param identifier The identifier of the cluster to get
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getClusterWithId:(NSString*)identifier completion:(ResourceCompletion)completion;
+
+/**
+ * Waits until the status of the cluster is FINISHED. The completion handler is called once the cluster is finished, failed
+ * or the timeout expires.
+ * @param identifier The identifier of the cluster to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to stop waiting
+ */
+-(NSOperation*)waitUntilClusterIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion;
+
+#pragma mark Predictions
+
+/**
+ * Creates a prediction. The completion handler is called with the prediction created if success, else nil.
+ * @param modelId The identifier of the model
+ * @param name This optional parameter provides the name of the prediction to be created
+ * @param inputData This optional parameter must be a JSON object that contents the pairs field_id : field_value (For instance @"{\"000001\": 1, \"000002\": 3}").
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)createPredictionWithModelId:(NSString*)modelId name:(NSString*)name inputData:(NSString*)inputData completion:(ResourceCompletion)completion;
+
+/**
+ * Updates the name of a given prediction. The completion handler is called with the prediction updated if success, else nil.
+ * @param identifier The identifier of the prediction to update
+ * @param name The new name of the prediction
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)updatePredictionWithId:(NSString*)identifier name:(NSString*)name completion:(ResourceCompletion)completion;
+
+/**
+ * Deletes a given prediction. The completion handler is called with the HTTP status code.
+ * @param identifier The identifier of the prediction to delete
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)deletePredictionWithId:(NSString*)identifier completion:(StatusCompletion)completion;
+
+/**
+ * Get a list of predictions filtered by name. The completion handler is called with the list of predictions found if success, else nil.
+ * @param name This optional parameter provides the name of the predictions to be retrieved. If it is nil then will be
+ * retrieved all predictions without any filtering
+ * @param offset The offset to paginate the results
+ * @param limit The maximum number of results
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getAllPredictionsWithName:(NSString*)name offset:(NSInteger)offset limit:(NSInteger)limit completion:(ResourceCompletion)completion;
+
+/**
+ * Get a prediction. The completion handler is called with the prediction if success, else nil.
+ * @param identifier The identifier of the prediction to get
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)getPredictionWithId:(NSString*)identifier completion:(ResourceCompletion)completion;
+
+/**
+ * Waits until the status of the prediction is FINISHED. The completion handler is called once the prediction is finished, failed
+ * or the timeout expires.
+ * @param identifier The identifier of the prediction to wait for
+ * @param timeout The maximum time to wait in seconds
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to stop waiting
+ */
+-(NSOperation*)waitUntilPredictionIsReadyWithId:(NSString*)identifier timeout:(NSTimeInterval)timeout completion:(ReadyCompletion)completion;
+
+#pragma mark Hybrid Predictions
+
+/**
+ * Creates a prediction from a given model, locally if the model is already compiled, else remotely. The completion
+ * handler is called with the result of the prediction if success, else nil.
+ * @param modelId The identifier of the model
+ * @param input A JSON object that contents the pairs field_id : field_value (For instance @"{\"000001\": 1, \"000002\": 3}")
+ * @param completion The completion handler
+ * @return The async NSOperation created, cancel it to discard the response
+ */
+-(NSOperation*)predictWithModelId:(NSString*)modelId input:(NSString*)input completion:(ResourceCompletion)completion;
 
 @end
\ No newline at end of file
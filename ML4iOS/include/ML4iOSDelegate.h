@@ -267,4 +267,48 @@
  */
 -(void)predictionIsReady:(BOOL)ready;
 
+//*******************************************************************************
+//**************************  OPTIONAL RESPONSES  *******************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Optional Responses
+
+/**
+ * The following responses belong to requests added after the first version of the protocol, so they are optional
+ * in order to keep existing delegates compiling.
+ */
+
+@optional
+
+/**
+ * Async response to createDataSourcesWithUpload
+ * @param dataSources The data sources created sorted by chunk index if all chunks are acknowledged, else nil
+ * @param code The HTTP status code
+ */
+-(void)dataSourcesCreated:(NSArray*)dataSources statusCode:(NSInteger)code;
+
+/**
+ * Async response to createPredictionsWithModelId
+ * @param predictions The predictions created in the same order than the input rows, NSNull for the rows that failed
+ * @param codes The HTTP status code of every row
+ */
+-(void)predictionsCreated:(NSArray*)predictions statusCodes:(NSArray*)codes;
+
+/**
+ * Async response to predictWithModelId
+ * @param prediction The result of the prediction if success, else nil
+ * @param code The HTTP status code
+ */
+-(void)hybridPredictionCreated:(NSDictionary*)prediction statusCode:(NSInteger)code;
+
+/**
+ * Async response to runWorkflowWithName
+ * @param model The model created if success, else nil
+ * @param prediction The prediction created if input data was provided and success, else nil
+ * @param code HTTP_CREATED if all resources are created and ready, else the HTTP status code of the failed request,
+ * or 0 if a resource failed or the timeout expired before it was ready
+ */
+-(void)workflowFinishedWithModel:(NSDictionary*)model prediction:(NSDictionary*)prediction statusCode:(NSInteger)code;
+
 @end
\ No newline at end of file
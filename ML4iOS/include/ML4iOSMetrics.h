@@ -0,0 +1,74 @@
+/**
+ *
+ * ML4iOSMetrics.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Receives the measures taken by the library. Assign an object that implements this protocol to the metrics property of
+ * ML4iOS to enable the instrumentation, MetricsRecorder is the default implementation. While no metrics object is
+ * assigned no measure is taken.
+ * The methods are called from the threads that make the requests and predictions, so they must be thread safe and fast.
+ */
+@protocol ML4iOSMetrics <NSObject>
+
+/**
+ * Records a HTTP request sent to BigML. Every attempt of a retried request is recorded.
+ * @param endpoint The endpoint of the request (ej: model)
+ * @param method The HTTP method of the request
+ * @param code The HTTP status code returned, 0 if the request failed without response
+ * @param phases The duration in seconds of every phase of the request: "dns", "connect", "tls", "send", "server"
+ * (until the first byte of the response), "receive" and "total". Phases that didn't happen, like the connection of a
+ * reused connection, are not included.
+ * @param bytesSent The bytes of the request body sent
+ * @param bytesReceived The bytes of the response body received
+ */
+-(void)recordRequestWithEndpoint:(NSString*)endpoint method:(NSString*)method statusCode:(NSInteger)code phases:(NSDictionary*)phases bytesSent:(int64_t)bytesSent bytesReceived:(int64_t)bytesReceived;
+
+/**
+ * Records the parsing of a JSON response
+ * @param endpoint The endpoint of the request (ej: model)
+ * @param duration The duration of the parsing in seconds
+ * @param bytes The length of the JSON data parsed
+ */
+-(void)recordParsingWithEndpoint:(NSString*)endpoint duration:(NSTimeInterval)duration bytes:(NSUInteger)bytes;
+
+/**
+ * Records the time an asynchronous operation waited in the queue before starting
+ * @param wait The wait in seconds
+ * @param depth The number of operations in the queue when the operation was added
+ */
+-(void)recordQueueWait:(NSTimeInterval)wait queueDepth:(NSUInteger)depth;
+
+/**
+ * Records a local prediction
+ * @param duration The duration of the prediction in seconds, including the parsing of the arguments
+ */
+-(void)recordLocalPredictionWithDuration:(NSTimeInterval)duration;
+
+/**
+ * Records the compilation of a local model
+ * @param modelId The identifier of the model, nil if unknown
+ * @param duration The duration of the compilation in seconds
+ */
+-(void)recordModelCompilationWithId:(NSString*)modelId duration:(NSTimeInterval)duration;
+
+@end
@@ -0,0 +1,48 @@
+/**
+ *
+ * ML4iOSTransport.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Sends the HTTP requests of the library. URLSessionTransport, the default implementation, sends them to BigML;
+ * StubServerTransport answers them with an in-process mock of BigML and RecordReplayTransport records and replays
+ * sessions, so the library can run without network access.
+ * The retry policy, the circuit breaker, the coalescing of requests and the resource cache work on top of the
+ * transport, so they behave the same whatever transport is used.
+ * The methods are called from many threads at the same time, so they must be thread safe.
+ */
+@protocol ML4iOSTransport <NSObject>
+
+/**
+ * Sends a request, blocking the caller thread until the response is received
+ * @param request The request to send
+ * @param operation The operation that owns the request, nil if there is none. When it is cancelled the transport must
+ * return as soon as possible with a NSURLErrorCancelled error.
+ * @param response Returns the HTTP response, nil if the request failed without response
+ * @param taskMetrics Returns the metrics collected by the URL loading system if the pointer is not NULL, nil if the
+ * transport doesn't use it
+ * @param error Returns the error of the request, nil if a response was received
+ * @return The body of the response
+ */
+-(NSData*)sendRequest:(NSURLRequest*)request operation:(NSOperation*)operation returningResponse:(NSHTTPURLResponse**)response metrics:(NSURLSessionTaskMetrics**)taskMetrics error:(NSError**)error;
+
+@end
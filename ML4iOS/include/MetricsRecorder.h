@@ -0,0 +1,57 @@
+/**
+ *
+ * MetricsRecorder.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import "ML4iOSMetrics.h"
+
+/**
+ * Default implementation of ML4iOSMetrics that aggregates the measures in memory.
+ * Durations are aggregated in histograms with logarithmic buckets, so recording a measure takes constant time and memory
+ * regardless of the number of measures. Bytes and requests are aggregated in counters.
+ */
+@interface MetricsRecorder : NSObject <ML4iOSMetrics>
+{
+    /**
+     * Histograms keyed by name (ej: model.server, localPrediction)
+     */
+    NSMutableDictionary* histograms;
+    
+    /**
+     * Counters keyed by name (ej: model.requests, model.bytesReceived)
+     */
+    NSMutableDictionary* counters;
+}
+
+/**
+ * @return A snapshot of the measures. The "histograms" are keyed by name and contain the "count", "mean", "min", "max",
+ * "p50", "p90" and "p99" in seconds, percentiles rounded up to the bound of their bucket. The "counters" are keyed by name.
+ * Requests are recorded as ENDPOINT.PHASE histograms and ENDPOINT.requests, ENDPOINT.errors, ENDPOINT.bytesSent and
+ * ENDPOINT.bytesReceived counters.
+ */
+-(NSDictionary*)snapshot;
+
+/**
+ * Discards all the measures
+ */
+-(void)reset;
+
+@end
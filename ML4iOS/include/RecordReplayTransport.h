@@ -0,0 +1,90 @@
+/**
+ *
+ * RecordReplayTransport.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import "ML4iOSTransport.h"
+
+/**
+ * Transport that records the requests sent through another transport and the responses received, and replays them
+ * later without network access, so the async machinery of the library can be benchmarked deterministically.
+ * The requests are matched by method, path, query without credentials and digest of the body. Identical requests
+ * are replayed in the order they were recorded, repeating the last response once all of them were replayed, so a
+ * readiness wait sees the same sequence of states. The credentials are never stored in the recordings.
+ * Requests not found in the recording fail with a NSURLErrorResourceUnavailable error.
+ */
+@interface RecordReplayTransport : NSObject <ML4iOSTransport>
+{
+    /**
+     * The transport that sends the recorded requests, nil when replaying
+     */
+    id<ML4iOSTransport> transport;
+    
+    /**
+     * The exchanges recorded or loaded, in order
+     */
+    NSMutableArray* exchanges;
+    
+    /**
+     * The exchanges to replay keyed by request, and the position of the next one to replay of every key
+     */
+    NSMutableDictionary* exchangesByKey;
+    NSMutableDictionary* replayPositions;
+    
+    NSUInteger misses;
+}
+
+/**
+ * true to wait, before every replayed response, the duration of the recorded request, else false. Default false.
+ */
+@property (atomic, assign) BOOL replaysLatency;
+
+/**
+ * Initializes the transport to record a session
+ * @param aTransport The transport that sends the requests, nil to send them to BigML with URLSessionTransport
+ */
+-(RecordReplayTransport*)initRecordingWithTransport:(id<ML4iOSTransport>)aTransport;
+
+/**
+ * Initializes the transport to replay a recorded session
+ * @param path The path of the recording, written by writeRecordingToFile:
+ * @return The created transport, nil if the file is not a valid recording
+ */
+-(RecordReplayTransport*)initReplayingWithContentsOfFile:(NSString*)path;
+
+/**
+ * Writes the exchanges recorded to a JSON file
+ * @param path The path of the file
+ * @return true if the file was written, else false
+ */
+-(BOOL)writeRecordingToFile:(NSString*)path;
+
+/**
+ * @return The number of exchanges recorded or loaded
+ */
+-(NSUInteger)numberOfExchanges;
+
+/**
+ * @return The number of requests replayed that were not found in the recording
+ */
+-(NSUInteger)misses;
+
+@end
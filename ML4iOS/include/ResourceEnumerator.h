@@ -0,0 +1,80 @@
+/**
+ *
+ * ResourceEnumerator.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Retrieves a page of a list of resources
+ * @param offset The offset of the page
+ * @param limit The maximum number of resources of the page
+ * @param code The HTTP status code returned
+ * @return The page retrieved if success, else nil
+ */
+typedef NSDictionary* (^ResourcePageFetch)(NSInteger offset, NSInteger limit, NSInteger* code);
+
+/**
+ * Lazy enumerator over all resources of a list, requesting the pages on demand.
+ * The next page is prefetched in background while the current one is being consumed, so at most two pages are kept
+ * in memory regardless of the number of resources in the list. Every page is parsed as a whole when it is received,
+ * the list is never materialized at once.
+ */
+@interface ResourceEnumerator : NSEnumerator
+{
+    ResourcePageFetch fetch;
+    NSInteger pageSize;
+    NSOperationQueue* queue;
+
+    NSArray* currentPage;
+    NSUInteger currentIndex;
+    NSInteger nextOffset;
+    BOOL lastPage;
+
+    /**
+     * Operation that retrieves the next page, nil if there are no more pages
+     */
+    NSOperation* prefetch;
+    NSDictionary* prefetchedPage;
+    NSInteger prefetchStatusCode;
+
+    NSInteger statusCode;
+}
+
+/**
+ * The HTTP status code of the last page retrieved. If the enumeration ends because a page can't be retrieved, it
+ * contains the status code of the failed request.
+ */
+@property (nonatomic, readonly) NSInteger statusCode;
+
+/**
+ * Initializes the enumerator, launching the request of the first page
+ * @param aFetch The block that retrieves a page of the list
+ * @param aPageSize The number of resources requested per page
+ * @param aQueue The queue where the pages are requested
+ */
+-(ResourceEnumerator*)initWithFetch:(ResourcePageFetch)aFetch pageSize:(NSInteger)aPageSize queue:(NSOperationQueue*)aQueue;
+
+/**
+ * @return The next resource of the list, nil when there are no more resources. Blocks the caller thread only if the
+ * next page hasn't been received yet.
+ */
+-(id)nextObject;
+
+@end
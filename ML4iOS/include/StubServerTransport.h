@@ -0,0 +1,114 @@
+/**
+ *
+ * StubServerTransport.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import "ML4iOSTransport.h"
+
+/**
+ * Decides if a request of the stub server fails
+ * @param request The request received by the stub server
+ * @return The HTTP status code of the failure, 0 to process the request
+ */
+typedef NSInteger (^StubFailureInjector)(NSURLRequest* request);
+
+/**
+ * Transport that answers the requests with an in-process mock of BigML, so the library can be run and load tested
+ * without credentials nor network access.
+ * It implements the source, dataset, model, cluster and prediction endpoints: creation, retrieval (with ETag and
+ * conditional requests), listing with name filter and pagination, update of the name and deletion. The resources
+ * are kept in memory and every resource is FINISHED once its processing time has elapsed since its creation.
+ * Predictions are computed with LocalPredictiveModel when their model contains a tree, for instance a real model
+ * added with addResource:.
+ * The latency and the random failures are drawn from a generator seeded at initialization, so a sequence of
+ * requests behaves the same in every run.
+ */
+@interface StubServerTransport : NSObject <ML4iOSTransport>
+{
+    /**
+     * The resources keyed by resource identifier (ej: model/IDENTIFIER), in creation order
+     */
+    NSMutableDictionary* resources;
+    NSMutableArray* resourceIdentifiers;
+    NSUInteger lastIdentifier;
+    
+    uint64_t randomState;
+    
+    //Statistics
+    NSMutableDictionary* requestsByEndpoint;
+    NSUInteger injectedFailures;
+}
+
+/**
+ * The time in seconds every request takes before being answered. Default 0.
+ */
+@property (atomic, assign) NSTimeInterval latency;
+
+/**
+ * The maximum random time in seconds added to the latency of every request. Default 0.
+ */
+@property (atomic, assign) NSTimeInterval latencyJitter;
+
+/**
+ * The time in seconds since its creation a resource takes to be FINISHED. Default 0.
+ */
+@property (atomic, assign) NSTimeInterval processingTime;
+
+/**
+ * The probability between 0 and 1 of a request to fail with failureStatusCode. Default 0.
+ */
+@property (atomic, assign) double failureRate;
+
+/**
+ * The HTTP status code of the random failures. Default HTTP_SERVICE_UNAVAILABLE.
+ */
+@property (atomic, assign) NSInteger failureStatusCode;
+
+/**
+ * Decides the failure of every request before the random failures are applied, nil to only apply random failures
+ */
+@property (atomic, copy) StubFailureInjector failureInjector;
+
+/**
+ * Initializes the stub server with seed 1
+ */
+-(StubServerTransport*)init;
+
+/**
+ * Initializes the stub server
+ * @param seed The seed of the generator of the latency and the random failures
+ */
+-(StubServerTransport*)initWithSeed:(uint64_t)seed;
+
+/**
+ * Adds a resource to the stub server, for instance a model retrieved from BigML to compute predictions
+ * @param resource The JSON object of the resource, its resource field (ej: model/IDENTIFIER) identifies it. Adding
+ * a resource that already exists replaces it with a new version, so its ETag changes
+ */
+-(void)addResource:(NSDictionary*)resource;
+
+/**
+ * @return The statistics of the stub server: the number of "requests" by endpoint, the "resources" stored and the
+ * "injectedFailures"
+ */
+-(NSDictionary*)statistics;
+
+@end
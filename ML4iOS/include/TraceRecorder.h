@@ -0,0 +1,101 @@
+/**
+ *
+ * TraceRecorder.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Records spans of the library in per thread buffers and exports them in the Chrome trace event format, that can be
+ * loaded in chrome://tracing, Perfetto and other viewers compatible with it.
+ * Every thread appends its events to its own buffer without locks, so tracing doesn't serialize the threads it measures.
+ * A buffer that gets full drops the new events of its thread until tracing starts again.
+ * While tracing is stopped recording an event costs a single check.
+ */
+@interface TraceRecorder : NSObject
+
+/**
+ * Starts recording events, discarding the events of the previous trace
+ * @param capacity The maximum number of events kept per thread
+ */
++(void)startTracingWithBufferCapacity:(NSUInteger)capacity;
+
+/**
+ * Stops recording events, keeping the recorded ones until they are written or tracing starts again
+ */
++(void)stopTracing;
+
+/**
+ * @return true if events are being recorded, else false
+ */
++(BOOL)isTracing;
+
+/**
+ * Writes the recorded events to a file in the Chrome trace event format
+ * @param path The full path of the file
+ * @return true if the file was written, else false
+ */
++(BOOL)writeTraceToFile:(NSString*)path;
+
+/**
+ * @return The number of events dropped because the buffer of their thread was full
+ */
++(NSUInteger)droppedEvents;
+
+@end
+
+//*******************************************************************************
+//*******************************  RECORDING  ***********************************
+//*******************************************************************************
+
+#pragma mark -
+#pragma mark Recording
+
+/**
+ * The names and categories of the events must be string literals or other strings that live while the trace is kept.
+ * They are stored by pointer, so recording an event doesn't copy nor allocate.
+ */
+
+/**
+ * @return true if events are being recorded, else false
+ */
+BOOL TraceIsEnabled(void);
+
+/**
+ * @return The current time in the units used by the trace events
+ */
+uint64_t TraceTimestamp(void);
+
+/**
+ * Records a span that started at the given time and ends now
+ * @param name The name of the span
+ * @param category The category of the span
+ * @param start The start of the span, obtained with TraceTimestamp
+ * @param identifier An identifier that correlates events of the same operation, 0 if none
+ */
+void TraceSpan(const char* name, const char* category, uint64_t start, uint64_t identifier);
+
+/**
+ * Records an instant event
+ * @param name The name of the event
+ * @param category The category of the event
+ * @param identifier An identifier that correlates events of the same operation, 0 if none
+ */
+void TraceInstant(const char* name, const char* category, uint64_t identifier);
@@ -0,0 +1,45 @@
+/**
+ *
+ * URLSessionTransport.h
+ * ML4iOS
+ *
+ * Created by Felix Garcia Lainez on October 18, 2026
+ * Copyright 2026 Felix Garcia Lainez
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#import <Foundation/Foundation.h>
+#import "ML4iOSTransport.h"
+
+/**
+ * Transport that sends the requests to BigML with NSURLSession, the default transport of the library
+ */
+@interface URLSessionTransport : NSObject <ML4iOSTransport>
+{
+    NSURLSession* session;
+}
+
+/**
+ * Initializes the transport with the shared session
+ */
+-(URLSessionTransport*)init;
+
+/**
+ * Initializes the transport
+ * @param aSession The session that sends the requests
+ */
+-(URLSessionTransport*)initWithSession:(NSURLSession*)aSession;
+
+@end
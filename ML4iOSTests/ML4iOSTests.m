@@ -22,6 +22,90 @@
 #import "ML4iOSTests.h"
 #import "ML4iOS.h"
 #import "Constants.h"
+#import "ChunkedUpload.h"
+#import "ResourceEnumerator.h"
+#import "MetricsRecorder.h"
+#import "StubServerTransport.h"
+#import "RecordReplayTransport.h"
+#import "LocalPredictiveModel.h"
+#import "LocalDataSet.h"
+#import "TraceRecorder.h"
+
+//Maximum time to wait for a resource to be ready in seconds
+#define READY_TIMEOUT 300
+
+#pragma mark -
+
+/**
+ * Local mock of the BigML model endpoint that never answers, so its requests stay in flight until they are cancelled
+ */
+@interface StallingURLProtocol : NSURLProtocol
+
++(void)reset;
++(BOOL)isLoading;
++(BOOL)wasStopped;
+
+@end
+
+static BOOL stallingLoading = NO;
+static BOOL stallingStopped = NO;
+
+@implementation StallingURLProtocol
+
++(void)reset
+{
+    @synchronized(self)
+    {
+        stallingLoading = NO;
+        stallingStopped = NO;
+    }
+}
+
++(BOOL)isLoading
+{
+    @synchronized(self)
+    {
+        return stallingLoading;
+    }
+}
+
++(BOOL)wasStopped
+{
+    @synchronized(self)
+    {
+        return stallingStopped;
+    }
+}
+
++(BOOL)canInitWithRequest:(NSURLRequest*)request
+{
+    return [[[request URL] path] rangeOfString:@"/model/"].location != NSNotFound;
+}
+
++(NSURLRequest*)canonicalRequestForRequest:(NSURLRequest*)request
+{
+    return request;
+}
+
+-(void)startLoading
+{
+    @synchronized([StallingURLProtocol class])
+    {
+        stallingLoading = YES;
+    }
+}
+
+-(void)stopLoading
+{
+    @synchronized([StallingURLProtocol class])
+    {
+        stallingStopped = YES;
+    }
+}
+
+@end
+
+#pragma mark -
 
 @implementation ML4iOSTests
 
@@ -61,9 +145,7 @@
         NSString* sourceId = [ML4iOS getResourceIdentifierFromJSONObject:dataSource];
         
         //WAIT UNTIL DATA SOURCE IS READY
-        while (![apiLibrary checkDataSourceIsReadyWithIdSync:sourceId]) {
-            sleep(1);
-        }
+        XCTAssertTrue([apiLibrary waitUntilDataSourceIsReadyWithIdSync:sourceId timeout:READY_TIMEOUT], @"Timeout waiting for datasource iris_datasource");
         
         NSLog(@"Datasource iris_source created and ready");
         
@@ -77,9 +159,7 @@
             NSString* dataSetId = [ML4iOS getResourceIdentifierFromJSONObject:dataSet];
             
             //WAIT UNTIL DATA SET IS READY
-            while (![apiLibrary checkDataSetIsReadyWithIdSync:dataSetId]) {
-                sleep(3);
-            }
+            XCTAssertTrue([apiLibrary waitUntilDataSetIsReadyWithIdSync:dataSetId timeout:READY_TIMEOUT], @"Timeout waiting for dataset iris_dataset");
             
             NSLog(@"Dataset iris_dataset created and ready");
             
@@ -93,9 +173,7 @@
                 modelId = [ML4iOS getResourceIdentifierFromJSONObject:model];
                 
                 //WAIT UNTIL MODEL IS READY
-                while (![apiLibrary checkModelIsReadyWithIdSync:modelId]) {
-                    sleep(3);
-                }
+                XCTAssertTrue([apiLibrary waitUntilModelIsReadyWithIdSync:modelId timeout:READY_TIMEOUT], @"Timeout waiting for model iris_model");
                 
                 NSLog(@"Model iris_model created and ready");
                 
@@ -108,9 +186,7 @@
                     NSString* predictionId = [ML4iOS getResourceIdentifierFromJSONObject:prediction];
                     
                     //WAIT UNTIL PREDICTION IS READY
-                    while (![apiLibrary checkPredictionIsReadyWithIdSync:predictionId]) {
-                        sleep(1);
-                    }
+                    XCTAssertTrue([apiLibrary waitUntilPredictionIsReadyWithIdSync:predictionId timeout:READY_TIMEOUT], @"Timeout waiting for prediction iris_prediction");
                     
                     NSLog(@"Prediction iris_prediction created and ready");
                     
@@ -131,9 +207,7 @@
                 NSString* clusterId = [ML4iOS getResourceIdentifierFromJSONObject:cluster];
                 
                 //WAIT UNTIL CLUSTER IS READY
-                while (![apiLibrary checkClusterIsReadyWithIdSync:clusterId]) {
-                    sleep(3);
-                }
+                XCTAssertTrue([apiLibrary waitUntilClusterIsReadyWithIdSync:clusterId timeout:READY_TIMEOUT], @"Timeout waiting for cluster iris_cluster");
                 
                 NSLog(@"Cluster iris_cluster created and ready");
                 
@@ -177,6 +251,1558 @@
     NSLog(@"Model iris_model deleted");
 }
 
+- (void)testChunkedUploadResumesFailedChunks
+{
+    //THE FIRST ATTEMPT TO UPLOAD EVERY ODD CHUNK FAILS
+    NSMutableArray* uploadedBodies = [NSMutableArray array];
+    NSMutableSet* failedChunks = [NSMutableSet set];
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setFailureInjector:^NSInteger(NSURLRequest* request) {
+        NSString* body = [[NSString alloc]initWithData:[request HTTPBody] encoding:NSUTF8StringEncoding];
+        NSRange nameRange = [body rangeOfString:@"filename=\"chunks_"];
+        NSInteger chunkIndex = [[body substringFromIndex:NSMaxRange(nameRange)]integerValue];
+        
+        @synchronized(uploadedBodies)
+        {
+            [uploadedBodies addObject:body];
+            
+            if(chunkIndex % 2 == 1 && ![failedChunks containsObject:@(chunkIndex)])
+            {
+                [failedChunks addObject:@(chunkIndex)];
+                return HTTP_INTERNAL_SERVER_ERROR;
+            }
+        }
+        
+        return 0;
+    }];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    
+    NSString *path = [[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"];
+    
+    ChunkedUpload* upload = [[ChunkedUpload alloc]initWithName:@"chunks" filePath:path chunkSize:512];
+    [upload setMaxAttemptsPerChunk:1];
+    
+    NSUInteger chunks = [upload numberOfChunks];
+    NSUInteger oddChunks = chunks / 2;
+    
+    XCTAssertTrue(chunks > 1, @"The file must be split in several chunks");
+    
+    //FIRST PASS, THE ODD CHUNKS FAIL
+    NSInteger httpStatusCode = 0;
+    NSArray* dataSources = [offlineLibrary createDataSourcesWithUploadSync:upload statusCode:&httpStatusCode];
+    
+    XCTAssertNil(dataSources, @"An upload with failed chunks can't return data sources");
+    XCTAssertEqual(httpStatusCode, HTTP_INTERNAL_SERVER_ERROR, @"The status code of the failed chunks must be returned");
+    XCTAssertEqual([upload numberOfAcknowledgedChunks], chunks - oddChunks, @"Only the even chunks must be acknowledged");
+    
+    //SECOND PASS, ONLY THE FAILED CHUNKS ARE UPLOADED AGAIN
+    dataSources = [offlineLibrary createDataSourcesWithUploadSync:upload statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_CREATED, @"Error resuming chunked upload");
+    XCTAssertEqual([dataSources count], chunks, @"A data source must be created per chunk");
+    XCTAssertEqual([uploadedBodies count], chunks + oddChunks, @"Acknowledged chunks can't be uploaded again");
+    
+    for(NSString* body in uploadedBodies)
+        XCTAssertTrue([body rangeOfString:@"sepal length,sepal width,petal length,petal width,species"].location != NSNotFound, @"Every chunk must include the header row");
+}
+
+- (void)testStubServerRunsResourceLifecycle
+{
+    StubServerTransport* server = [[StubServerTransport alloc]initWithSeed:7];
+    [server setProcessingTime:0.2];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    
+    NSInteger httpStatusCode = 0;
+    NSString *path = [[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"];
+    
+    NSDictionary* dataSource = [offlineLibrary createDataSourceWithNameSync:@"iris_datasource" filePath:path statusCode:&httpStatusCode];
+    NSString* sourceId = [ML4iOS getResourceIdentifierFromJSONObject:dataSource];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_CREATED, @"Error creating datasource from iris.csv");
+    XCTAssertTrue([offlineLibrary waitUntilDataSourceIsReadyWithIdSync:sourceId timeout:5], @"The datasource must be finished after the processing time");
+    
+    NSDictionary* dataSet = [offlineLibrary createDataSetWithDataSourceIdSync:sourceId name:@"iris_dataset" statusCode:&httpStatusCode];
+    NSString* dataSetId = [ML4iOS getResourceIdentifierFromJSONObject:dataSet];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_CREATED, @"Error creating dataset from iris_datasource");
+    
+    //A RESOURCE CAN'T BE CREATED FROM A PARENT THAT DOESN'T EXIST
+    [offlineLibrary createModelWithDataSetIdSync:@"000000000000000000000000" name:@"orphan" statusCode:&httpStatusCode];
+    XCTAssertEqual(httpStatusCode, HTTP_BAD_REQUEST, @"The dataset of a model must exist");
+    
+    for(NSInteger i = 0; i < 3; i++)
+        [offlineLibrary createModelWithDataSetIdSync:dataSetId name:@"iris_model" statusCode:&httpStatusCode];
+    
+    NSDictionary* models = [offlineLibrary getAllModelsWithNameSync:@"iris_model" offset:1 limit:1 statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"Error listing models");
+    XCTAssertEqual([models[@"objects"] count], 1, @"The list must be paginated");
+    XCTAssertEqual([models[@"meta"][@"total_count"]integerValue], 3, @"The list must count all models with the name");
+    
+    XCTAssertEqual([offlineLibrary deleteDataSetWithIdSync:dataSetId], HTTP_NO_CONTENT, @"Error deleting dataset iris_dataset");
+    [offlineLibrary getDataSetWithIdSync:dataSetId statusCode:&httpStatusCode];
+    XCTAssertEqual(httpStatusCode, HTTP_NOT_FOUND, @"A deleted dataset can't be retrieved");
+    
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], 5, @"Every request must be counted by endpoint");
+}
+
+- (void)testRecordReplayReproducesSession
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    RecordReplayTransport* recorder = [[RecordReplayTransport alloc]initRecordingWithTransport:server];
+    
+    ML4iOS* recordingLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:recorder];
+    
+    NSInteger httpStatusCode = 0;
+    NSString *path = [[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"];
+    
+    NSDictionary* dataSource = [recordingLibrary createDataSourceWithNameSync:@"iris_datasource" filePath:path statusCode:&httpStatusCode];
+    NSString* sourceId = [ML4iOS getResourceIdentifierFromJSONObject:dataSource];
+    NSDictionary* recordedSource = [recordingLibrary getDataSourceWithIdSync:sourceId statusCode:&httpStatusCode];
+    
+    NSString* recordingPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"ml4ios_recording.json"];
+    XCTAssertTrue([recorder writeRecordingToFile:recordingPath], @"Error writing the recording");
+    
+    NSString* recording = [NSString stringWithContentsOfFile:recordingPath encoding:NSUTF8StringEncoding error:nil];
+    XCTAssertTrue([recording rangeOfString:@"BIGML_API_KEY"].location == NSNotFound, @"The credentials can't be recorded");
+    
+    //THE SAME REQUESTS ARE ANSWERED FROM THE RECORDING, WITH OTHER CREDENTIALS AND WITHOUT SERVER
+    RecordReplayTransport* player = [[RecordReplayTransport alloc]initReplayingWithContentsOfFile:recordingPath];
+    ML4iOS* replayingLibrary = [[ML4iOS alloc]initWithUsername:@"OTHER_USERNAME" key:@"OTHER_KEY" developmentMode:NO transport:player];
+    
+    NSDictionary* replayedSource = [replayingLibrary createDataSourceWithNameSync:@"iris_datasource" filePath:path statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_CREATED, @"Error replaying the creation of the datasource");
+    XCTAssertEqualObjects([ML4iOS getResourceIdentifierFromJSONObject:replayedSource], sourceId, @"The recorded datasource must be replayed");
+    XCTAssertEqualObjects([replayingLibrary getDataSourceWithIdSync:sourceId statusCode:&httpStatusCode], recordedSource, @"The recorded datasource must be replayed");
+    XCTAssertEqual([player misses], 0, @"Every request must be found in the recording");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:recordingPath error:nil];
+}
+
+- (void)testResourceEnumeratorRequestsAllPages
+{
+    NSInteger totalCount = 45;
+    NSMutableArray* requestedOffsets = [NSMutableArray array];
+    NSOperationQueue* queue = [[NSOperationQueue alloc]init];
+    
+    //FAKE LIST OF 45 MODELS SERVED IN PAGES
+    ResourceEnumerator* enumerator = [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+        @synchronized(requestedOffsets)
+        {
+            [requestedOffsets addObject:@(offset)];
+        }
+        
+        NSMutableArray* objects = [NSMutableArray array];
+        
+        for(NSInteger i = offset; i < MIN(offset + limit, totalCount); i++)
+            [objects addObject:@{@"resource": [NSString stringWithFormat:@"model/%ld", (long)i]}];
+        
+        *code = HTTP_OK;
+        
+        NSObject* next = offset + limit < totalCount ? [NSString stringWithFormat:@"/andromeda/model?offset=%ld&limit=%ld", (long)(offset + limit), (long)limit] : [NSNull null];
+        
+        return @{@"meta": @{@"offset": @(offset), @"limit": @(limit), @"total_count": @(totalCount), @"next": next}, @"objects": objects};
+    } pageSize:20 queue:queue];
+    
+    NSInteger count = 0;
+    
+    for(NSDictionary* model in enumerator)
+    {
+        XCTAssertEqualObjects([ML4iOS getResourceIdentifierFromJSONObject:model], ([NSString stringWithFormat:@"%ld", (long)count]), @"Resources must be enumerated in order");
+        count++;
+    }
+    
+    XCTAssertEqual(count, totalCount, @"All resources must be enumerated");
+    XCTAssertEqualObjects(requestedOffsets, (@[@0, @20, @40]), @"Every page must be requested once");
+    XCTAssertEqual([enumerator statusCode], HTTP_OK, @"Error enumerating resources");
+}
+
+- (void)testMetricsRecorderAggregatesMeasures
+{
+    MetricsRecorder* recorder = [[MetricsRecorder alloc]init];
+    
+    for(NSInteger i = 1; i <= 100; i++)
+        [recorder recordLocalPredictionWithDuration:i / 1000.0];
+    
+    [recorder recordRequestWithEndpoint:@"model" method:@"GET" statusCode:HTTP_OK phases:@{@"server": @0.2, @"total": @0.25} bytesSent:0 bytesReceived:2048];
+    [recorder recordRequestWithEndpoint:@"model" method:@"GET" statusCode:HTTP_INTERNAL_SERVER_ERROR phases:@{@"total": @0.05} bytesSent:0 bytesReceived:10];
+    
+    NSDictionary* snapshot = [recorder snapshot];
+    NSDictionary* predictions = snapshot[@"histograms"][@"localPrediction"];
+    
+    XCTAssertEqual([predictions[@"count"]integerValue], 100, @"All predictions must be recorded");
+    XCTAssertEqualWithAccuracy([predictions[@"mean"]doubleValue], 0.0505, 1e-9, @"Wrong mean");
+    XCTAssertTrue([predictions[@"p50"]doubleValue] >= 0.05 && [predictions[@"p50"]doubleValue] <= 0.1, @"The p50 must be rounded up to its bucket");
+    XCTAssertEqualWithAccuracy([predictions[@"p99"]doubleValue], 0.1, 1e-9, @"Percentiles can't exceed the max");
+    
+    XCTAssertEqual([snapshot[@"histograms"][@"model.total"][@"count"]integerValue], 2, @"Every request must be recorded");
+    XCTAssertEqual([snapshot[@"counters"][@"model.requests"]integerValue], 2, @"Wrong number of requests");
+    XCTAssertEqual([snapshot[@"counters"][@"model.errors"]integerValue], 1, @"Wrong number of errors");
+    XCTAssertEqual([snapshot[@"counters"][@"model.bytesReceived"]integerValue], 2058, @"Wrong number of bytes");
+}
+
+- (void)testCancellationAbortsRequestInFlight
+{
+    [StallingURLProtocol reset];
+    [NSURLProtocol registerClass:[StallingURLProtocol class]];
+    
+    BOOL __block completed = NO;
+    
+    NSOperation* operation = [apiLibrary getModelWithId:@"stalled" completion:^(NSDictionary* resource, NSInteger statusCode) {
+        completed = YES;
+    }];
+    
+    //WAIT UNTIL THE REQUEST IS IN FLIGHT
+    for(NSInteger i = 0; i < 100 && ![StallingURLProtocol isLoading]; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertTrue([StallingURLProtocol isLoading], @"The request must be in flight");
+    
+    //THE CANCELLATION MUST REACH THE TASK, OTHERWISE THE OPERATION NEVER FINISHES
+    [operation cancel];
+    [operation waitUntilFinished];
+    
+    for(NSInteger i = 0; i < 20 && ![StallingURLProtocol wasStopped]; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertTrue([StallingURLProtocol wasStopped], @"The transfer of a cancelled request must be stopped");
+    XCTAssertFalse(completed, @"The completion of a cancelled request can't be called");
+    
+    [NSURLProtocol unregisterClass:[StallingURLProtocol class]];
+}
+
+- (void)testTreeCompactionKeepsPredictions
+{
+    //THE CHILD x > 7 IS UNREACHABLE, x < 10 IS ALWAYS TAKEN AND THE LEAVES c = red AND x >= 5 PREDICT AS THEIR PARENTS
+    NSDictionary* jsonModel = @{@"objective_field": @"000002",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"},
+                                                         @"000001": @{@"name": @"c", @"optype": @"categorical"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"B", @"confidence": @0.6, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @7}, @"output": @"C", @"confidence": @0.9},
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @10}, @"output": @"D", @"confidence": @0.7, @"children": @[
+                                                        @{@"predicate": @{@"field": @"000001", @"operator": @"=", @"value": @"red"}, @"output": @"D", @"confidence": @0.7}]}]},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"A", @"confidence": @0.5}]}}};
+    
+    LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    NSDictionary* statistics = [model compactionStatistics];
+    
+    XCTAssertEqual([statistics[@"nodes"]integerValue], 6, @"Every node of the model must be counted");
+    XCTAssertEqual([statistics[@"compactedNodes"]integerValue], 2, @"The compacted tree must only keep the root and the leaf D");
+    XCTAssertEqual([statistics[@"prunedNodes"]integerValue], 1, @"The unreachable child must be pruned");
+    XCTAssertEqual([statistics[@"foldedNodes"]integerValue], 1, @"The node B must be folded into D");
+    XCTAssertEqual([statistics[@"collapsedNodes"]integerValue], 2, @"The redundant leaves must be collapsed");
+    
+    //THE PREDICTIONS OF THE ORIGINAL TREE
+    NSDictionary* expected = @{@"{\"x\": \"3\", \"c\": \"red\"}": @[@"D", @0.7],
+                               @"{\"x\": \"3\", \"c\": \"blue\"}": @[@"D", @0.7],
+                               @"{\"x\": \"6\", \"c\": \"red\"}": @[@"A", @0.5],
+                               @"{\"c\": \"red\"}": @[@"A", @0.5]};
+    
+    for(NSString* arguments in expected)
+    {
+        NSDictionary* prediction = [model predictWithArguments:arguments argsByName:YES];
+        
+        XCTAssertEqualObjects(prediction[@"value"], expected[arguments][0], @"Wrong value for %@", arguments);
+        XCTAssertEqualObjects(prediction[@"confidence"], expected[arguments][1], @"Wrong confidence for %@", arguments);
+    }
+}
+
+- (void)testTreeLayoutTestsMostProbableChildFirst
+{
+    //THE CHILDREN OF THE ROOT ARE EXCLUSIVE AND x > 5 IS THE MOST PROBABLE ONE, c != red AND c = blue OVERLAP AND KEEP THEIR ORDER
+    NSDictionary* jsonModel = @{@"objective_field": @"000002",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"},
+                                                         @"000001": @{@"name": @"c", @"optype": @"categorical"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"count": @100, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @5}, @"output": @"low", @"confidence": @0.8, @"count": @10},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @5}, @"output": @"high", @"confidence": @0.9, @"count": @90, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"!=", @"value": @"red"}, @"output": @"other", @"confidence": @0.6, @"count": @20},
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"=", @"value": @"blue"}, @"output": @"blue", @"confidence": @0.7, @"count": @70}]}]}}};
+    
+    LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    NSDictionary* statistics = [model layoutStatistics];
+    
+    XCTAssertEqual([statistics[@"nodes"]integerValue], 5, @"Every node must be compiled");
+    XCTAssertEqual([statistics[@"reorderedNodes"]integerValue], 1, @"Only the children of the root can be reordered");
+    XCTAssertEqualWithAccuracy([statistics[@"testsPerPrediction"]doubleValue], 2.7, 0.0001, @"The most probable child must be tested first");
+    XCTAssertEqualWithAccuracy([statistics[@"testsPerPredictionInModelOrder"]doubleValue], 3.5, 0.0001, @"Wrong tests in the order of the model");
+    
+    //THE PREDICTIONS OF THE TREE IN THE ORDER OF THE MODEL
+    NSDictionary* expected = @{@"{\"x\": \"3\", \"c\": \"blue\"}": @[@"low", @0.8],
+                               @"{\"x\": \"7\", \"c\": \"blue\"}": @[@"other", @0.6],
+                               @"{\"x\": \"7\", \"c\": \"red\"}": @[@"high", @0.9],
+                               @"{\"x\": 7}": @[@"high", @0.9],
+                               @"{\"c\": \"blue\"}": @[@"A", @0.5]};
+    
+    for(NSString* arguments in expected)
+    {
+        NSDictionary* prediction = [model predictWithArguments:arguments argsByName:YES];
+        
+        XCTAssertEqualObjects(prediction[@"value"], expected[arguments][0], @"Wrong value for %@", arguments);
+        XCTAssertEqualObjects(prediction[@"confidence"], expected[arguments][1], @"Wrong confidence for %@", arguments);
+    }
+}
+
+- (void)testCompactEncodingKeepsPredictions
+{
+    NSDictionary* jsonModel = @{@"objective_field": @"000003",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"},
+                                                         @"000001": @{@"name": @"c", @"optype": @"categorical"},
+                                                         @"000002": @{@"name": @"d", @"optype": @"datetime"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"count": @100, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @5}, @"output": @"low", @"confidence": @0.8, @"count": @30, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000002", @"operator": @"<", @"value": @"2020-01-01"}, @"output": @"old", @"confidence": @0.6, @"count": @10},
+                                                    @{@"predicate": @{@"field": @"000002", @"operator": @">=", @"value": @"2020-01-01"}, @"output": @"new", @"confidence": @0.7, @"count": @20}]},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @5}, @"output": @"high", @"confidence": @0.9, @"count": @70, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"=", @"value": @"red"}, @"output": @"red", @"confidence": @0.75, @"count": @40},
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @8}, @"output": @"big", @"confidence": @0.85, @"count": @20}]}]}}};
+    
+    LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    LocalPredictiveModel* compactModel = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:YES];
+    NSDictionary* statistics = [compactModel layoutStatistics];
+    
+    XCTAssertTrue([statistics[@"compactEncoding"]boolValue], @"The tree must use the compact encoding");
+    XCTAssertEqual([statistics[@"bytesPerNode"]integerValue], 8, @"Every node must take 8 bytes");
+    
+    //THE VALUES ON, BELOW AND ABOVE EVERY THRESHOLD, AND MISSING
+    NSArray* xs = @[@3, @5, @5.5, @8, @9, [NSNull null]];
+    NSArray* cs = @[@"red", @"blue", [NSNull null]];
+    NSArray* ds = @[@"2019-12-31", @"2020-01-01", @"2021-05-05", [NSNull null]];
+    
+    for(id x in xs)
+    {
+        for(id c in cs)
+        {
+            for(id d in ds)
+            {
+                NSMutableDictionary* input = [NSMutableDictionary dictionary];
+                
+                if(x != [NSNull null])
+                    input[@"x"] = x;
+                
+                if(c != [NSNull null])
+                    input[@"c"] = c;
+                
+                if(d != [NSNull null])
+                    input[@"d"] = d;
+                
+                NSString* arguments = [[NSString alloc]initWithData:[NSJSONSerialization dataWithJSONObject:input options:0 error:nil] encoding:NSUTF8StringEncoding];
+                
+                XCTAssertEqualObjects([compactModel predictWithArguments:arguments argsByName:YES], [model predictWithArguments:arguments argsByName:YES], @"Different prediction for %@", arguments);
+            }
+        }
+    }
+    
+    XCTAssertEqualObjects([compactModel predictWithArguments:@"{\"x\": 5, \"d\": \"2020-01-01\"}" argsByName:YES][@"value"], @"new", @"Wrong value on the thresholds");
+    XCTAssertEqualObjects([compactModel predictWithArguments:@"{\"x\": 8, \"c\": \"blue\"}" argsByName:YES][@"value"], @"big", @"Wrong value on the thresholds");
+}
+
+- (void)testLocalModelTrainingPredictsIris
+{
+    NSString *path = [[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"];
+    NSDictionary* jsonModel = [apiLibrary createLocalModelWithFilePathSync:path name:@"iris_local_model"];
+    
+    XCTAssertNotNil(jsonModel, @"Error training the model locally");
+    XCTAssertEqualObjects(jsonModel[@"objective_field"], @"000004", @"The last field must be the objective field");
+    XCTAssertEqual([jsonModel[@"status"][@"code"]integerValue], FINISHED, @"The model must be FINISHED");
+    XCTAssertEqualObjects(jsonModel[@"model"][@"fields"][@"000000"][@"optype"], @"numeric", @"Wrong optype of sepal length");
+    XCTAssertEqualObjects(jsonModel[@"model"][@"fields"][@"000004"][@"optype"], @"categorical", @"Wrong optype of species");
+    
+    //THE TREE MUST FIT THE TRAINING DATA
+    LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    NSArray* lines = [[NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil] componentsSeparatedByCharactersInSet:[NSCharacterSet newlineCharacterSet]];
+    NSArray* names = [lines[0] componentsSeparatedByString:@","];
+    NSInteger rows = 0;
+    NSInteger hits = 0;
+    
+    for(NSString* line in [lines subarrayWithRange:NSMakeRange(1, [lines count] - 1)])
+    {
+        NSArray* values = [line componentsSeparatedByString:@","];
+        
+        if([values count] != [names count])
+            continue;
+        
+        NSMutableDictionary* input = [NSMutableDictionary dictionary];
+        
+        for(NSUInteger i = 0; i < 4; i++)
+            input[names[i]] = @([values[i] doubleValue]);
+        
+        NSString* arguments = [[NSString alloc]initWithData:[NSJSONSerialization dataWithJSONObject:input options:0 error:nil] encoding:NSUTF8StringEncoding];
+        NSDictionary* prediction = [model predictWithArguments:arguments argsByName:YES];
+        
+        rows++;
+        hits += [prediction[@"value"] isEqualToString:values[4]] ? 1 : 0;
+    }
+    
+    XCTAssertEqual(rows, 150, @"Every row must be predicted");
+    XCTAssertGreaterThanOrEqual((double)hits / rows, 0.95, @"The accuracy on the training data is too low");
+}
+
+- (void)testLocalClusterTrainingFindsBlobs
+{
+    //THREE SEPARATED BLOBS OF 30 INSTANCES, AND A CATEGORICAL FIELD THAT IS NOT USED
+    NSArray* blobs = @[@[@0, @0], @[@10, @10], @[@20, @0]];
+    NSMutableString* csv = [NSMutableString stringWithString:@"x,y,tag\n"];
+    
+    for(NSUInteger i = 0; i < 90; i++)
+    {
+        NSArray* blob = blobs[i % 3];
+        [csv appendFormat:@"%f,%f,%@\n", [blob[0]doubleValue] + (i % 5) * 0.1 - 0.2, [blob[1]doubleValue] + (i % 7) * 0.1 - 0.3, i % 2 == 0 ? @"even" : @"odd"];
+    }
+    
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"blobs.csv"];
+    [csv writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    
+    NSDictionary* cluster = [apiLibrary createLocalClusterWithFilePathSync:path name:@"blobs_cluster" numberOfClusters:3];
+    NSArray* clusters = cluster[@"clusters"][@"clusters"];
+    
+    XCTAssertEqual([cluster[@"status"][@"code"]integerValue], FINISHED, @"The cluster must be FINISHED");
+    XCTAssertEqualObjects(cluster[@"input_fields"], (@[@"000000", @"000001"]), @"Only the numeric fields must be used");
+    XCTAssertEqual([clusters count], 3, @"Wrong number of clusters");
+    
+    //EVERY BLOB MUST BE A CLUSTER
+    for(NSArray* blob in blobs)
+    {
+        BOOL found = NO;
+        
+        for(NSDictionary* localCluster in clusters)
+        {
+            NSDictionary* center = localCluster[@"center"];
+            
+            if(fabs([center[@"000000"]doubleValue] - [blob[0]doubleValue]) < 0.5 && fabs([center[@"000001"]doubleValue] - [blob[1]doubleValue]) < 0.5)
+            {
+                found = YES;
+                XCTAssertEqual([localCluster[@"count"]integerValue], 30, @"Wrong number of instances of the cluster");
+            }
+        }
+        
+        XCTAssertTrue(found, @"No cluster found for the blob %@", blob);
+    }
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testDatetimePredicatesCompareInstants
+{
+    NSDictionary* jsonModel = @{@"objective_field": @"000001",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"date", @"optype": @"datetime"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @"2020-01-01T00:00:00Z"}, @"output": @"before", @"confidence": @0.8},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @"2020-01-01T00:00:00Z"}, @"output": @"after", @"confidence": @0.9}]}}};
+    
+    //THE SAME INSTANTS IN OTHER FORMATS AND TIME ZONES, WHERE COMPARING STRINGS FAILS
+    NSDictionary* expected = @{@"2019-12-31T23:00:00-02:00": @"after",
+                               @"2019-12-31 23:59:59.500": @"before",
+                               @"2020-01-01": @"after",
+                               @"2020-01-01T01:00:00+01:00": @"after",
+                               @"12/31/2019": @"before",
+                               @"Jan 02, 2020": @"after",
+                               @"not a date": @"A"};
+    
+    for(NSNumber* compact in @[@NO, @YES])
+    {
+        LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:[compact boolValue]];
+        
+        for(NSString* date in expected)
+        {
+            NSString* arguments = [NSString stringWithFormat:@"{\"date\": \"%@\"}", date];
+            XCTAssertEqualObjects([model predictWithArguments:arguments argsByName:YES][@"value"], expected[date], @"Wrong value for %@", date);
+        }
+    }
+}
+
+- (void)testTextPredicatesCountTerms
+{
+    NSDictionary* review = @{@"name": @"review", @"optype": @"text",
+                             @"term_analysis": @{@"case_sensitive": @NO, @"token_mode": @"all"},
+                             @"summary": @{@"term_forms": @{@"cheap": @[@"cheaper"]}}};
+    NSDictionary* jsonModel = @{@"objective_field": @"000001",
+                                @"model": @{@"fields": @{@"000000": review},
+                                            @"root": @{@"predicate": @YES, @"output": @"none", @"confidence": @0.5, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @0, @"term": @"cheap"}, @"output": @"cheap", @"confidence": @0.8, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @1, @"term": @"cheap"}, @"output": @"very cheap", @"confidence": @0.9},
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @1, @"term": @"cheap"}, @"output": @"cheap", @"confidence": @0.7}]},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @0, @"term": @"cheap"}, @"output": @"other", @"confidence": @0.6, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @0, @"term": @"new york"}, @"output": @"new york", @"confidence": @0.9},
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @0, @"term": @"new york"}, @"output": @"other", @"confidence": @0.6}]}]}}};
+    
+    //TERMS ARE COUNTED WITH THEIR FORMS AND WITHOUT CASE, AND A TERM OF SEVERAL WORDS MUST BE THE WHOLE TEXT
+    NSDictionary* expected = @{@"Cheaper than ever": @"cheap",
+                               @"CHEAP, cheap!": @"very cheap",
+                               @"cheapest": @"other",
+                               @"New York": @"new york",
+                               @"I love new york": @"other",
+                               @"": @"other"};
+    
+    for(NSNumber* compact in @[@NO, @YES])
+    {
+        LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:[compact boolValue]];
+        
+        for(NSString* text in expected)
+        {
+            NSString* arguments = [NSString stringWithFormat:@"{\"review\": \"%@\"}", text];
+            XCTAssertEqualObjects([model predictWithArguments:arguments argsByName:YES][@"value"], expected[text], @"Wrong value for %@", text);
+        }
+        
+        XCTAssertEqualObjects([model predictWithArguments:@"{}" argsByName:YES][@"value"], @"none");
+    }
+}
+
+- (void)testArgumentsParsedByIdAndByName
+{
+    NSDictionary* jsonModel = @{@"objective_field": @"000002",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"},
+                                                         @"000001": @{@"name": @"colour", @"optype": @"categorical"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"root", @"confidence": @0.5, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"small", @"confidence": @0.8},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"big", @"confidence": @0.7, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"=", @"value": @"r\u00e9d"}, @"output": @"red big", @"confidence": @0.9},
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"!=", @"value": @"r\u00e9d"}, @"output": @"big", @"confidence": @0.6}]}]}}};
+    
+    //ESCAPE SEQUENCES, SKIPPED FIELDS, REPEATED FIELDS, INVALID JSON, TRAILING BYTES, NUMBERS OUT OF THE JSON GRAMMAR AND
+    //NUMBERS IN STRINGS, READ AS NSString doubleValue
+    NSDictionary* expected = @{@"{\"x\": 3}": @"small",
+                               @"{\"x\": 7, \"colour\": \"r\\u00e9d\"}": @"red big",
+                               @"{\"colour\": \"r\u00e9d\", \"x\": 7.5e0}": @"red big",
+                               @"{ \"x\" : 8 , \"colour\" : \"blue\", \"other\": {\"a\": [1, \"}\", null]} }": @"big",
+                               @"{\"x\": \"6\"}": @"big",
+                               @"{\"x\": \"07\"}": @"big",
+                               @"{\"x\": \"0012\"}": @"big",
+                               @"{\"x\": \"+1\"}": @"small",
+                               @"{\"x\": \"+6\"}": @"big",
+                               @"{\"x\": \".5\"}": @"small",
+                               @"{\"x\": \"-.5e2\"}": @"small",
+                               @"{\"x\": \".5e1\"}": @"big",
+                               @"{\"x\": 3, \"x\": 9}": @"small",
+                               @"{\"x\": null}": @"root",
+                               @"{\"x\": 3": @"root",
+                               @"{\"x\": 3} \n": @"small",
+                               @"{\"x\": 3} trailing": @"root",
+                               @"{\"x\": 3}}": @"root",
+                               @"{\"x\": 0x10}": @"root",
+                               @"{\"x\": -inf}": @"root",
+                               @"{\"x\": 8, \"other\": nan}": @"root",
+                               @"{\"x\": 07}": @"root",
+                               @"{\"x\": \"0x10\"}": @"small",
+                               @"{\"x\": \"inf\"}": @"small",
+                               @"[1, 2]": @"root",
+                               @"not json": @"root"};
+    
+    for(NSNumber* compact in @[@NO, @YES])
+    {
+        LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:[compact boolValue]];
+        
+        for(NSString* arguments in expected)
+        {
+            //THE SAME ARGUMENTS KEYED BY ID
+            NSString* argumentsById = [[arguments stringByReplacingOccurrencesOfString:@"\"x\"" withString:@"\"000000\""] stringByReplacingOccurrencesOfString:@"\"colour\"" withString:@"\"000001\""];
+            
+            XCTAssertEqualObjects([model predictWithArguments:arguments argsByName:YES][@"value"], expected[arguments], @"Wrong value for %@", arguments);
+            XCTAssertEqualObjects([model predictWithArguments:argumentsById argsByName:NO][@"value"], expected[arguments], @"Wrong value for %@", argumentsById);
+        }
+        
+        //THE KEYS OF THE OTHER KIND ARE SKIPPED
+        XCTAssertEqualObjects([model predictWithArguments:@"{\"x\": 3}" argsByName:NO][@"value"], @"root", @"A name can't be used by id");
+        XCTAssertEqualObjects([model predictWithArguments:@"{\"000000\": 3}" argsByName:YES][@"value"], @"root", @"An id can't be used by name");
+    }
+}
+
+- (void)testProfileFeedsTheLayout
+{
+    NSDictionary* jsonModel = @{@"objective_field": @"000002",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"},
+                                                         @"000001": @{@"name": @"c", @"optype": @"categorical"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"small", @"confidence": @0.5, @"count": @100, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"small", @"confidence": @0.8, @"count": @90},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"big", @"confidence": @0.7, @"count": @10, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"=", @"value": @"red"}, @"output": @"red", @"confidence": @0.9, @"count": @6},
+                                                    @{@"predicate": @{@"field": @"000001", @"operator": @"!=", @"value": @"red"}, @"output": @"other", @"confidence": @0.6, @"count": @4}]}]}}};
+    
+    LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel];
+    [model setProfilingEnabled:YES];
+    
+    //THE PREDICTIONS ARE DONE FROM SEVERAL THREADS, EACH ONE WITH ITS OWN COUNTERS
+    dispatch_apply(20, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t i) {
+        [model predictWithArguments:i % 5 == 0 ? @"{\"x\": 3}" : @"{\"x\": 8, \"c\": \"blue\"}" argsByName:YES];
+    });
+    
+    [model setProfilingEnabled:NO];
+    [model predictWithArguments:@"{\"x\": 8, \"c\": \"red\"}" argsByName:YES];
+    
+    NSDictionary* profile = [model profile];
+    NSArray* hotPath = profile[@"hotPath"];
+    
+    XCTAssertEqual([profile[@"predictions"]integerValue], 20, @"Wrong number of predictions");
+    XCTAssertEqualWithAccuracy([profile[@"averageDepth"]doubleValue], 1.8, 0.0001, @"Wrong average depth");
+    XCTAssertEqualObjects(profile[@"visits"], (@[@20, @4, @16, @0, @16]), @"Wrong visits");
+    XCTAssertEqualObjects(profile[@"deadBranches"], @[@3], @"Wrong dead branches");
+    XCTAssertEqual([hotPath count], 2, @"Wrong hot path");
+    XCTAssertEqualObjects([hotPath lastObject][@"output"], @"other", @"Wrong hot path");
+    
+    //THE PROFILE SURVIVES SERIALIZATION AND LAYS OUT THE HOT BRANCHES FIRST
+    NSData* exported = [NSJSONSerialization dataWithJSONObject:profile options:0 error:nil];
+    NSDictionary* imported = [NSJSONSerialization JSONObjectWithData:exported options:0 error:nil];
+    LocalPredictiveModel* profiledModel = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:NO profile:imported];
+    NSDictionary* statistics = [profiledModel layoutStatistics];
+    
+    XCTAssertEqual([statistics[@"reorderedNodes"]integerValue], 2, @"The hot branches must be tested first");
+    XCTAssertEqualWithAccuracy([statistics[@"testsPerPrediction"]doubleValue], 2.0, 0.0001, @"Wrong tests per prediction");
+    XCTAssertEqualWithAccuracy([statistics[@"testsPerPredictionInModelOrder"]doubleValue], 3.4, 0.0001, @"Wrong tests per prediction");
+    XCTAssertEqualObjects([profiledModel predictWithArguments:@"{\"x\": 8, \"c\": \"red\"}" argsByName:YES][@"value"], @"red", @"The profile can't change the predictions");
+    
+    //A PROFILE WITH OTHER NODES IS REJECTED, ITS IDS WOULD POINT TO OTHER NODES OF THE COMPACTED TREE
+    NSMutableDictionary* otherProfile = [imported mutableCopy];
+    otherProfile[@"visits"] = [imported[@"visits"] subarrayWithRange:NSMakeRange(0, 4)];
+    otherProfile[@"nodes"] = @4;
+    
+    XCTAssertNil([[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:NO profile:otherProfile], @"A profile of another tree must be rejected");
+    
+    otherProfile[@"visits"] = [imported[@"visits"] arrayByAddingObject:@0];
+    otherProfile[@"nodes"] = @6;
+    
+    XCTAssertNil([[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:NO profile:otherProfile], @"A profile of another tree must be rejected");
+}
+
+- (void)testModelRegistryEvictsLeastRecentlyUsedModels
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    
+    for(NSString* modelId in @[@"model/000000000000000000000001", @"model/000000000000000000000002"])
+    {
+        [server addResource:@{@"resource": modelId,
+                              @"updated": @"2026-10-18T00:00:00.000000",
+                              @"objective_field": @"000001",
+                              @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                                          @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"children": @[
+                                              @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"B", @"confidence": @0.6},
+                                              @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"C", @"confidence": @0.7}]}}}];
+    }
+    
+    //THE COPIES OF ANOTHER REGISTRY OF THE SAME USER ARE NEVER DELETED
+    NSFileManager* fileManager = [NSFileManager defaultManager];
+    NSString* cachesDirectory = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    NSString* modelsDirectory = [cachesDirectory stringByAppendingPathComponent:@"ML4iOS/BIGML_REGISTRY_USERNAME/Models"];
+    NSString* otherCopy = [modelsDirectory stringByAppendingPathComponent:@"OTHER_REGISTRY/000000000000000000000001@2026-10-18T00_00_00.000000.json"];
+    
+    [fileManager removeItemAtPath:modelsDirectory error:nil];
+    [fileManager createDirectoryAtPath:[otherCopy stringByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+    [[@"{}" dataUsingEncoding:NSUTF8StringEncoding] writeToFile:otherCopy atomically:YES];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_REGISTRY_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    NSInteger httpStatusCode = 0;
+    
+    XCTAssertEqual([[fileManager contentsOfDirectoryAtPath:modelsDirectory error:nil] count], 1, @"Nothing can be written before a model is compiled");
+    
+    //A BUDGET OF A SINGLE BYTE ONLY KEEPS THE MOST RECENTLY USED MODEL
+    [offlineLibrary setModelMemoryBudget:1];
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"compiledModels"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000002" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"evictions"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    NSDictionary* statistics = [offlineLibrary hybridPredictionStatistics];
+    
+    XCTAssertEqual([statistics[@"compiledModels"]integerValue], 1, @"Only one model fits in the budget");
+    XCTAssertEqual([statistics[@"evictedModels"]integerValue], 1, @"The least recently used model must be evicted");
+    
+    //THE EVICTED MODEL IS COMPILED AGAIN FROM ITS COPY ON DISK, WITHOUT DOWNLOADING IT
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"diskReloads"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    NSDictionary* prediction = [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    statistics = [offlineLibrary hybridPredictionStatistics];
+    
+    XCTAssertEqualObjects(prediction[@"source"], @"local", @"The reloaded model must predict locally");
+    XCTAssertEqualObjects(prediction[@"value"], @"B", @"Wrong value");
+    XCTAssertEqual([statistics[@"diskReloads"]integerValue], 1, @"The evicted model must be reloaded from disk");
+    XCTAssertEqual([statistics[@"evictions"]integerValue], 2, @"The reload must evict the other model");
+    XCTAssertEqual([statistics[@"evictedLookups"]integerValue], 1, @"Wrong evicted lookups");
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], 2, @"Every model must be downloaded once");
+    XCTAssertTrue([fileManager fileExistsAtPath:otherCopy], @"The copies of another registry can't be deleted");
+    XCTAssertEqual([statistics[@"diskModels"]integerValue], 2, @"Every model must keep a single copy");
+    
+    //A NEW VERSION REPLACES THE COPY OF THE OLD ONE, AND IS THE ONE COMPILED AGAIN AFTER AN EVICTION
+    [server addResource:@{@"resource": @"model/000000000000000000000001",
+                          @"updated": @"2026-10-19T00:00:00.000000",
+                          @"objective_field": @"000001",
+                          @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                                      @"root": @{@"predicate": @YES, @"output": @"N", @"confidence": @0.5}}}];
+    
+    [offlineLibrary startModelRefreshWithInterval:0.1];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"reloads"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    [offlineLibrary stopModelRefresh];
+    
+    XCTAssertEqual([[offlineLibrary hybridPredictionStatistics][@"diskModels"]integerValue], 2, @"The copy of the old version must be deleted");
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000002" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"diskReloads"]integerValue] < 2; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"diskReloads"]integerValue] < 3; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    prediction = [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    XCTAssertEqualObjects(prediction[@"source"], @"local", @"The reloaded model must predict locally");
+    XCTAssertEqualObjects(prediction[@"value"], @"N", @"The evicted model must come back with its last version");
+    
+    //WITHOUT ROOM ON DISK AN EVICTED MODEL IS DOWNLOADED AGAIN
+    NSInteger modelRequests = [[server statistics][@"requests"][@"model"]integerValue];
+    
+    [offlineLibrary setModelDiskBudget:1];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"diskModels"]integerValue] > 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertEqual([[offlineLibrary hybridPredictionStatistics][@"diskModels"]integerValue], 0, @"No copy fits in the disk budget");
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000002" input:@"{\"000000\": 3}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[server statistics][@"requests"][@"model"]integerValue] == modelRequests; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], modelRequests + 1, @"An evicted model without copy must be downloaded again");
+    
+    //THE DIRECTORY OF THE REGISTRY IS DELETED WITH IT, THE ONE OF THE OTHER REGISTRY IS KEPT
+    offlineLibrary = nil;
+    
+    for(NSInteger i = 0; i < 100 && [[fileManager contentsOfDirectoryAtPath:modelsDirectory error:nil] count] > 1; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertEqualObjects([fileManager contentsOfDirectoryAtPath:modelsDirectory error:nil], @[@"OTHER_REGISTRY"], @"The directory of a released registry must be deleted");
+    XCTAssertTrue([fileManager fileExistsAtPath:otherCopy], @"The copies of another registry can't be deleted");
+    
+    [fileManager removeItemAtPath:modelsDirectory error:nil];
+}
+
+- (void)testLibraryWithoutUsernameCanBeCreated
+{
+    //WITHOUT USERNAME THERE IS NO DIRECTORY FOR THE COPIES OF THE MODELS, WHICH ARE ONLY KEPT IN MEMORY
+    XCTAssertNoThrow([[ML4iOS alloc]initWithUsername:nil key:@"BIGML_API_KEY" developmentMode:NO transport:[[StubServerTransport alloc]init]], @"A library without username can't raise");
+    XCTAssertEqual([[[[ML4iOS alloc]initWithUsername:nil key:@"BIGML_API_KEY" developmentMode:NO] hybridPredictionStatistics][@"diskModels"]integerValue], 0, @"No copy can be kept without username");
+}
+
+- (void)testWorkflowChainsResourcesUntilPrediction
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setProcessingTime:0.2];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    
+    NSInteger httpStatusCode = 0;
+    NSString *path = [[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"];
+    
+    NSDictionary* prediction = [offlineLibrary runWorkflowWithNameSync:@"iris_workflow" filePath:path inputData:@"{\"000001\": 3}" timeout:10 statusCode:&httpStatusCode];
+    NSDictionary* requests = [server statistics][@"requests"];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_CREATED, @"Error running the workflow");
+    XCTAssertTrue([prediction[@"resource"] hasPrefix:@"prediction/"], @"The workflow must end with the prediction");
+    XCTAssertTrue([prediction[@"model"] hasPrefix:@"model/"], @"The prediction must be created from the model of the workflow");
+    
+    //EVERY RESOURCE IS CREATED ONCE AND PROBED UNTIL IT IS READY
+    for(NSString* endpoint in @[@"source", @"dataset", @"model"])
+        XCTAssertTrue([requests[endpoint]integerValue] >= 2, @"The %@ must be created and probed", endpoint);
+    
+    //A FAILED STEP ENDS THE WORKFLOW WITH ITS STATUS CODE, THE NEXT RESOURCES ARE NOT CREATED
+    [server setFailureInjector:^NSInteger(NSURLRequest* request) {
+        return [[request HTTPMethod] isEqualToString:@"POST"] && [[[request URL] path] hasSuffix:@"/dataset"] ? HTTP_BAD_REQUEST : 0;
+    }];
+    
+    NSInteger modelRequests = [[server statistics][@"requests"][@"model"]integerValue];
+    
+    prediction = [offlineLibrary runWorkflowWithNameSync:@"iris_workflow" filePath:path inputData:@"{\"000001\": 3}" timeout:10 statusCode:&httpStatusCode];
+    
+    XCTAssertNil(prediction, @"A failed workflow can't return a resource");
+    XCTAssertEqual(httpStatusCode, HTTP_BAD_REQUEST, @"The status code of the failed step must be returned");
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], modelRequests, @"No model can be created after a failed step");
+}
+
+- (void)testResourceCacheServesAndRevalidatesResources
+{
+    NSString* cachesDirectory = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    [[NSFileManager defaultManager] removeItemAtPath:[[cachesDirectory stringByAppendingPathComponent:@"ML4iOS"] stringByAppendingPathComponent:@"BIGML_CACHE_USERNAME"] error:nil];
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setProcessingTime:60];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"cached_model"}];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_CACHE_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    [offlineLibrary enableResourceCacheWithTimeToLive:60];
+    
+    NSInteger httpStatusCode = 0;
+    
+    //A FINISHED MODEL IS DOWNLOADED ONCE AND THEN SERVED FROM DISK WITHOUT ANY REQUEST
+    for(NSInteger i = 0; i < 3; i++)
+    {
+        NSDictionary* model = [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+        
+        XCTAssertEqual(httpStatusCode, HTTP_OK, @"Error retrieving the model");
+        XCTAssertEqualObjects(model[@"name"], @"cached_model", @"Wrong model");
+    }
+    
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], 1, @"A fresh model can't be requested again");
+    
+    //A DATASET IN PROGRESS IS REVALIDATED WITH A CONDITIONAL REQUEST
+    NSDictionary* dataSource = [offlineLibrary createDataSourceWithNameSync:@"iris_datasource" filePath:[[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"] statusCode:&httpStatusCode];
+    NSDictionary* dataSet = [offlineLibrary createDataSetWithDataSourceIdSync:[ML4iOS getResourceIdentifierFromJSONObject:dataSource] name:@"iris_dataset" statusCode:&httpStatusCode];
+    NSString* dataSetId = [ML4iOS getResourceIdentifierFromJSONObject:dataSet];
+    
+    [offlineLibrary getDataSetWithIdSync:dataSetId statusCode:&httpStatusCode];
+    [offlineLibrary getDataSetWithIdSync:dataSetId statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"A revalidated dataset must be served with HTTP_OK");
+    XCTAssertEqual([[server statistics][@"requests"][@"dataset"]integerValue], 3, @"A dataset in progress must be revalidated");
+    
+    //AN UPDATE DROPS THE CACHED COPY
+    [offlineLibrary updateModelNameWithIdSync:@"000000000000000000000001" name:@"renamed_model" statusCode:&httpStatusCode];
+    NSDictionary* model = [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqualObjects(model[@"name"], @"renamed_model", @"An updated model can't be served from the cache");
+    
+    NSDictionary* statistics = [offlineLibrary resourceCacheStatistics];
+    
+    XCTAssertEqual([statistics[@"hits"]integerValue], 2, @"Wrong number of hits");
+    XCTAssertEqual([statistics[@"revalidations"]integerValue], 1, @"Wrong number of revalidations");
+    XCTAssertEqual([statistics[@"misses"]integerValue], 3, @"Wrong number of misses");
+}
+
+- (void)testBatchPredictionsKeepOrderAndBoundParallelism
+{
+    NSInteger __block inFlight = 0;
+    NSInteger __block maxInFlight = 0;
+    BOOL __block throttled = NO;
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:@{@"resource": @"model/000000000000000000000001",
+                          @"objective_field": @"000001",
+                          @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                                      @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"children": @[
+                                          @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"B", @"confidence": @0.6},
+                                          @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"C", @"confidence": @0.7}]}}}];
+    
+    //EVERY REQUEST TAKES A WHILE SO THE REQUESTS IN FLIGHT OVERLAP, AND THE FIRST ONE IS THROTTLED
+    [server setFailureInjector:^NSInteger(NSURLRequest* request) {
+        @synchronized(server)
+        {
+            maxInFlight = MAX(maxInFlight, ++inFlight);
+        }
+        
+        [NSThread sleepForTimeInterval:0.05];
+        
+        @synchronized(server)
+        {
+            inFlight--;
+            
+            if(!throttled)
+            {
+                throttled = YES;
+                return HTTP_TOO_MANY_REQUESTS;
+            }
+        }
+        
+        return 0;
+    }];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    
+    NSMutableArray* inputDataList = [NSMutableArray array];
+    
+    for(NSInteger i = 0; i < 10; i++)
+        [inputDataList addObject:[NSString stringWithFormat:@"{\"000000\": %ld}", (long)i]];
+    
+    NSArray* codes = nil;
+    NSArray* predictions = [offlineLibrary createPredictionsWithModelIdSync:@"000000000000000000000001" name:nil inputDataList:inputDataList maxConcurrentRequests:3 statusCodes:&codes];
+    
+    XCTAssertEqual([predictions count], 10, @"A prediction must be returned per row");
+    XCTAssertTrue(maxInFlight > 1 && maxInFlight <= 3, @"The requests in flight must be bounded, found %ld", (long)maxInFlight);
+    
+    //THE THROTTLED ROW IS RETRIED AND EVERY RESULT KEEPS THE ORDER OF THE INPUT
+    for(NSInteger i = 0; i < 10; i++)
+    {
+        XCTAssertEqual([codes[i]integerValue], HTTP_CREATED, @"Wrong status code of row %ld", (long)i);
+        XCTAssertEqualObjects(predictions[i][@"prediction"][@"000001"], i < 5 ? @"B" : @"C", @"Wrong prediction of row %ld", (long)i);
+    }
+}
+
+- (void)testHybridPredictionsMoveToLocalOnceCompiled
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setLatency:0.05];
+    [server addResource:@{@"resource": @"model/000000000000000000000001",
+                          @"objective_field": @"000001",
+                          @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                                      @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"children": @[
+                                          @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"B", @"confidence": @0.6},
+                                          @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"C", @"confidence": @0.7}]}}}];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    NSInteger httpStatusCode = 0;
+    
+    //THE FIRST PREDICTION IS REMOTE AND LAUNCHES THE COMPILATION OF THE MODEL
+    NSDictionary* prediction = [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 7}" statusCode:&httpStatusCode];
+    
+    XCTAssertEqualObjects(prediction[@"source"], @"remote", @"A model not compiled yet must predict remotely");
+    XCTAssertEqualObjects(prediction[@"value"], @"C", @"Wrong remote value");
+    XCTAssertEqualObjects(prediction[@"confidence"], @0.7, @"Wrong remote confidence");
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"compiledModels"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    //ONCE COMPILED THE PREDICTIONS ARE LOCAL, WITH THE SAME SHAPE AND WITHOUT ANY REQUEST
+    NSInteger predictionRequests = [[server statistics][@"requests"][@"prediction"]integerValue];
+    prediction = [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{\"000000\": 7}" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"A local prediction must return HTTP_OK");
+    XCTAssertEqualObjects(prediction[@"source"], @"local", @"A compiled model must predict locally");
+    XCTAssertEqualObjects(prediction[@"value"], @"C", @"Wrong local value");
+    XCTAssertEqualObjects(prediction[@"confidence"], @0.7, @"Wrong local confidence");
+    XCTAssertEqual([[server statistics][@"requests"][@"prediction"]integerValue], predictionRequests, @"A local prediction can't send requests");
+    
+    NSDictionary* statistics = [offlineLibrary hybridPredictionStatistics];
+    
+    XCTAssertEqual([statistics[@"localPredictions"]integerValue], 1, @"Wrong number of local predictions");
+    XCTAssertEqual([statistics[@"remotePredictions"]integerValue], 1, @"Wrong number of remote predictions");
+}
+
+- (void)testModelRefreshSwapsInNewVersions
+{
+    NSDictionary* (^modelWithOutput)(NSString*, NSString*) = ^NSDictionary*(NSString* updated, NSString* output) {
+        return @{@"resource": @"model/000000000000000000000001",
+                 @"updated": updated,
+                 @"objective_field": @"000001",
+                 @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                             @"root": @{@"predicate": @YES, @"output": output, @"confidence": @0.5}}};
+    };
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:modelWithOutput(@"2026-10-18T00:00:00.000000", @"old")];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    NSInteger httpStatusCode = 0;
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"compiledModels"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertEqualObjects([offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{}" statusCode:&httpStatusCode][@"value"], @"old", @"Wrong value of the first version");
+    
+    //A NEW VERSION UNDER THE SAME IDENTIFIER IS SWAPPED IN BY THE REFRESH
+    [server addResource:modelWithOutput(@"2026-10-19T00:00:00.000000", @"new")];
+    [offlineLibrary startModelRefreshWithInterval:0.1];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"reloads"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    [offlineLibrary stopModelRefresh];
+    
+    NSDictionary* prediction = [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{}" statusCode:&httpStatusCode];
+    NSDictionary* statistics = [offlineLibrary hybridPredictionStatistics];
+    
+    XCTAssertEqualObjects(prediction[@"source"], @"local", @"The new version must predict locally");
+    XCTAssertEqualObjects(prediction[@"value"], @"new", @"The new version must be swapped in");
+    XCTAssertEqual([statistics[@"reloads"]integerValue], 1, @"An unchanged version can't be swapped in again");
+    XCTAssertEqual([statistics[@"compiledModels"]integerValue], 1, @"The new version must replace the old one");
+}
+
+- (void)testRetriesAndCircuitBreakerProtectEndpoints
+{
+    NSMutableDictionary* failuresByEndpoint = [NSMutableDictionary dictionary];
+    NSMutableDictionary* attemptsByEndpoint = [NSMutableDictionary dictionary];
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"flaky_model"}];
+    [server addResource:@{@"resource": @"cluster/000000000000000000000001", @"name": @"broken_cluster"}];
+    
+    //EVERY ENDPOINT FAILS WITH A SERVER ERROR THE NUMBER OF TIMES SET IN failuresByEndpoint
+    [server setFailureInjector:^NSInteger(NSURLRequest* request) {
+        NSString* endpoint = [[[request URL] path] pathComponents][2];
+        
+        @synchronized(failuresByEndpoint)
+        {
+            attemptsByEndpoint[endpoint] = @([attemptsByEndpoint[endpoint]integerValue] + 1);
+            
+            NSInteger failures = [failuresByEndpoint[endpoint]integerValue];
+            
+            if(failures == 0)
+                return 0;
+            
+            failuresByEndpoint[endpoint] = @(failures - 1);
+        }
+        
+        return HTTP_INTERNAL_SERVER_ERROR;
+    }];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    [offlineLibrary setRetryPolicyWithMaxRetries:2 baseDelay:0.01 maxDelay:0.05];
+    [offlineLibrary setCircuitBreakerWithFailureThreshold:3 openInterval:0.3];
+    
+    NSInteger httpStatusCode = 0;
+    
+    //AN IDEMPOTENT REQUEST IS RETRIED UNTIL IT SUCCEEDS
+    failuresByEndpoint[@"model"] = @2;
+    NSDictionary* model = [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"The retries must hide the transient failures");
+    XCTAssertEqualObjects(model[@"name"], @"flaky_model", @"Wrong model");
+    XCTAssertEqual([attemptsByEndpoint[@"model"]integerValue], 3, @"The request must be retried twice");
+    XCTAssertEqual([[offlineLibrary reliabilityStatistics][@"retries"]integerValue], 2, @"Wrong number of retries");
+    
+    //A CREATION IS NEVER RETRIED
+    failuresByEndpoint[@"source"] = @1;
+    [offlineLibrary createDataSourceWithNameSync:@"iris_datasource" filePath:[[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"] statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_INTERNAL_SERVER_ERROR, @"A failed creation must return its status code");
+    XCTAssertEqual([attemptsByEndpoint[@"source"]integerValue], 1, @"A creation can't be retried");
+    
+    //THE CIRCUIT OPENS AFTER 3 CONSECUTIVE FAILURES AND THE REQUESTS FAIL FAST WITHOUT REACHING THE SERVER
+    failuresByEndpoint[@"cluster"] = @3;
+    [offlineLibrary getClusterWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_INTERNAL_SERVER_ERROR, @"The last failure must be returned once the retries are exhausted");
+    
+    [offlineLibrary getClusterWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_SERVICE_UNAVAILABLE, @"An open circuit must fail fast");
+    XCTAssertEqual([attemptsByEndpoint[@"cluster"]integerValue], 3, @"An open circuit can't reach the server");
+    XCTAssertEqualObjects([offlineLibrary reliabilityStatistics][@"openEndpoints"], @[@"cluster"], @"Only the failing endpoint must be open");
+    
+    [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"The other endpoints must keep working");
+    
+    //ONCE THE OPEN INTERVAL ELAPSES A SUCCESSFUL TRIAL CLOSES THE CIRCUIT
+    [NSThread sleepForTimeInterval:0.4];
+    [offlineLibrary getClusterWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"The trial request must reach the server");
+    XCTAssertEqual([[offlineLibrary reliabilityStatistics][@"openEndpoints"] count], 0, @"A successful trial must close the circuit");
+}
+
+- (void)testConcurrentIdenticalRequestsAreCoalesced
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setLatency:0.3];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"shared_model", @"tags": @[@"iris"]}];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    NSMutableArray* models = [NSMutableArray array];
+    
+    NSOperationQueue* queue = [[NSOperationQueue alloc]init];
+    [queue setMaxConcurrentOperationCount:5];
+    
+    //THE IDENTICAL REQUESTS ARRIVE WHILE THE FIRST ONE IS IN FLIGHT
+    for(NSInteger i = 0; i < 5; i++)
+    {
+        [queue addOperationWithBlock:^{
+            NSInteger httpStatusCode = 0;
+            NSDictionary* model = [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+            
+            //EVERY CALLER MODIFIES ITS OWN COPY
+            [(NSMutableArray*)model[@"tags"] addObject:[NSString stringWithFormat:@"caller_%ld", (long)i]];
+            
+            @synchronized(models)
+            {
+                [models addObject:model];
+            }
+        }];
+    }
+    
+    [queue waitUntilAllOperationsAreFinished];
+    
+    XCTAssertEqual([models count], 5, @"Every caller must receive the model");
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], 1, @"The identical requests must share a single request");
+    XCTAssertEqual([[offlineLibrary reliabilityStatistics][@"coalescedRequests"]integerValue], 4, @"Wrong number of coalesced requests");
+    
+    for(NSDictionary* model in models)
+        XCTAssertEqual([model[@"tags"] count], 2, @"The changes of a caller can't be seen by the others");
+}
+
+- (void)testLocalPredictionsHonourArgumentsByName
+{
+    NSDictionary* jsonModel = @{@"resource": @"model/000000000000000000000001",
+                                @"objective_field": @"000001",
+                                @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                                            @"root": @{@"predicate": @YES, @"output": @"A", @"confidence": @0.5, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<", @"value": @5}, @"output": @"B", @"confidence": @0.6},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">=", @"value": @5}, @"output": @"C", @"confidence": @0.7}]}}};
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:[[StubServerTransport alloc]init]];
+    
+    //THE FLAG OF THE CALLER IS HONOURED WITH AND WITHOUT METRICS
+    for(id<ML4iOSMetrics> recorder in @[[NSNull null], [[MetricsRecorder alloc]init]])
+    {
+        [offlineLibrary setMetrics:(recorder != (id)[NSNull null] ? recorder : nil)];
+        
+        XCTAssertEqualObjects([offlineLibrary createLocalPredictionWithJSONModelSync:jsonModel arguments:@"{\"x\": 7}" argsByName:YES][@"value"], @"C", @"Wrong value by name");
+        XCTAssertEqualObjects([offlineLibrary createLocalPredictionWithJSONModelSync:jsonModel arguments:@"{\"000000\": 3}" argsByName:NO][@"value"], @"B", @"Wrong value by id");
+    }
+}
+
+- (void)testTraceRecordsOperationsRequestsAndCallbacks
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"traced_model"}];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    [offlineLibrary setDelegate:self];
+    
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"ml4ios_trace.json"];
+    
+    [offlineLibrary startTracingWithBufferCapacity:0];
+    
+    XCTAssertEqualObjects([offlineLibrary delegate], self, @"The delegate can't change while tracing");
+    
+    [[offlineLibrary getModelWithId:@"000000000000000000000001"] waitUntilFinished];
+    
+    XCTAssertTrue([offlineLibrary stopTracingAndWriteToFile:path], @"Error writing the trace");
+    XCTAssertEqualObjects([offlineLibrary delegate], self, @"The delegate must be restored once the trace stops");
+    
+    NSDictionary* trace = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:0 error:nil];
+    NSSet* names = [NSSet setWithArray:[trace[@"traceEvents"] valueForKey:@"name"]];
+    
+    for(NSString* name in @[@"enqueue", @"http.request", @"json.parse", @"modelRetrieved:statusCode:"])
+        XCTAssertTrue([names containsObject:name], @"The trace must contain %@", name);
+    
+    //NEW TRACES ARE STARTED AND WRITTEN WHILE OTHER THREADS KEEP RECORDING
+    NSOperationQueue* queue = [[NSOperationQueue alloc]init];
+    BOOL __block recording = YES;
+    
+    for(NSInteger i = 0; i < 4; i++)
+    {
+        [queue addOperationWithBlock:^{
+            while(recording)
+                TraceInstant("stress", "test", 0);
+        }];
+    }
+    
+    for(NSInteger i = 0; i < 20; i++)
+    {
+        [TraceRecorder startTracingWithBufferCapacity:(i % 2 == 0 ? 1024 : 4096)];
+        [NSThread sleepForTimeInterval:0.005];
+        
+        XCTAssertTrue([TraceRecorder writeTraceToFile:path], @"Error writing the trace %ld", (long)i);
+        XCTAssertNotNil([NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:0 error:nil], @"The trace %ld must be valid JSON", (long)i);
+    }
+    
+    [TraceRecorder stopTracing];
+    recording = NO;
+    [queue waitUntilAllOperationsAreFinished];
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+- (void)testWaitsDeliverTheirCompletionUnlessCancelled
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"ready_model"}];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    
+    //A WAIT THAT ENDS WITH ITS FIRST PROBE STILL CALLS ITS COMPLETION
+    __block BOOL completed = NO;
+    __block BOOL modelReady = NO;
+    __block NSDictionary* readyModel = nil;
+    
+    NSOperation* wait = [offlineLibrary waitUntilModelIsReadyWithId:@"000000000000000000000001" timeout:5 completion:^(BOOL ready, NSDictionary* resource) {
+        modelReady = ready;
+        readyModel = resource;
+        completed = YES;
+    }];
+    
+    [wait waitUntilFinished];
+    
+    for(NSInteger i = 0; i < 100 && !completed; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    XCTAssertTrue(completed, @"The completion of a finished wait must be called");
+    XCTAssertTrue(modelReady, @"The model must be ready");
+    XCTAssertEqualObjects(readyModel[@"name"], @"ready_model", @"The ready model must be delivered");
+    
+    //A CANCELLED WAIT ABORTS ITS PROBE IN FLIGHT AND DOESN'T CALL ITS COMPLETION
+    NSInteger modelRequests = [[server statistics][@"requests"][@"model"]integerValue];
+    __block BOOL cancelledCompleted = NO;
+    
+    [server setLatency:2.0];
+    
+    wait = [offlineLibrary waitUntilModelIsReadyWithId:@"000000000000000000000001" timeout:5 completion:^(BOOL ready, NSDictionary* resource) {
+        cancelledCompleted = YES;
+    }];
+    
+    [NSThread sleepForTimeInterval:0.2];
+    
+    [wait cancel];
+    [wait waitUntilFinished];
+    
+    //PAST THE LATENCY, A PROBE THAT KEPT RUNNING WOULD HAVE REACHED THE SERVER
+    [NSThread sleepForTimeInterval:2.5];
+    
+    XCTAssertEqual([[server statistics][@"requests"][@"model"]integerValue], modelRequests, @"The probe in flight must be aborted by the cancellation");
+    XCTAssertFalse(cancelledCompleted, @"The completion of a cancelled wait can't be called");
+}
+
+
+- (void)testCancellationInterruptsBackoffsTrialsAndSharedRequests
+{
+    __block BOOL failing = YES;
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"slow_model"}];
+    [server setFailureInjector:^NSInteger(NSURLRequest* request) {
+        return failing ? HTTP_INTERNAL_SERVER_ERROR : 0;
+    }];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    [offlineLibrary setRetryPolicyWithMaxRetries:1000 baseDelay:2.0 maxDelay:2.0];
+    [offlineLibrary setCircuitBreakerWithFailureThreshold:0 openInterval:0];
+    
+    //A REQUEST WAITING TO BE RETRIED WAKES UP AS SOON AS IT IS CANCELLED
+    NSOperation* request = [offlineLibrary getModelWithId:@"000000000000000000000001" completion:nil];
+    
+    [NSThread sleepForTimeInterval:0.2];
+    
+    NSTimeInterval cancelledAt = [[NSProcessInfo processInfo] systemUptime];
+    [request cancel];
+    [request waitUntilFinished];
+    
+    XCTAssertTrue([[NSProcessInfo processInfo] systemUptime] - cancelledAt < 0.5, @"The backoff of a cancelled request must be interrupted");
+    
+    //A CANCELLED TRIAL DOESN'T KEEP THE CIRCUIT OPEN FOREVER
+    [offlineLibrary setRetryPolicyWithMaxRetries:0 baseDelay:0.01 maxDelay:0.05];
+    [offlineLibrary setCircuitBreakerWithFailureThreshold:1 openInterval:0.2];
+    
+    NSInteger httpStatusCode = 0;
+    [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqualObjects([offlineLibrary reliabilityStatistics][@"openEndpoints"], @[@"model"], @"The failure must open the circuit");
+    
+    [NSThread sleepForTimeInterval:0.3];
+    [server setLatency:1.0];
+    
+    request = [offlineLibrary getModelWithId:@"000000000000000000000001" completion:nil];
+    
+    [NSThread sleepForTimeInterval:0.2];
+    [request cancel];
+    [request waitUntilFinished];
+    
+    failing = NO;
+    [server setLatency:0];
+    
+    NSDictionary* model = [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_OK, @"The trial of a cancelled request must be released");
+    XCTAssertEqualObjects(model[@"name"], @"slow_model", @"Wrong model");
+    
+    //A CANCELLED FOLLOWER STOPS WAITING, THE FIRST CALLER STILL GETS THE SHARED RESPONSE
+    [server setLatency:1.0];
+    
+    __block NSInteger leaderStatusCode = 0;
+    NSOperationQueue* queue = [[NSOperationQueue alloc]init];
+    
+    [queue addOperationWithBlock:^{
+        NSInteger statusCode = 0;
+        [offlineLibrary getModelWithIdSync:@"000000000000000000000001" statusCode:&statusCode];
+        leaderStatusCode = statusCode;
+    }];
+    
+    [NSThread sleepForTimeInterval:0.1];
+    
+    __block BOOL followerCompleted = NO;
+    NSOperation* follower = [offlineLibrary getModelWithId:@"000000000000000000000001" completion:^(NSDictionary* resource, NSInteger statusCode) {
+        followerCompleted = YES;
+    }];
+    
+    [NSThread sleepForTimeInterval:0.2];
+    
+    cancelledAt = [[NSProcessInfo processInfo] systemUptime];
+    [follower cancel];
+    [follower waitUntilFinished];
+    
+    XCTAssertTrue([[NSProcessInfo processInfo] systemUptime] - cancelledAt < 0.5, @"A cancelled follower can't wait for the first caller");
+    XCTAssertFalse(followerCompleted, @"The completion of a cancelled follower can't be called");
+    
+    [queue waitUntilAllOperationsAreFinished];
+    
+    XCTAssertEqual(leaderStatusCode, HTTP_OK, @"The first caller must receive the response");
+}
+
+
+- (void)testTermsOfSeveralWordsIgnoreTheirSeparators
+{
+    NSDictionary* city = @{@"name": @"city", @"optype": @"text",
+                           @"term_analysis": @{@"case_sensitive": @NO, @"token_mode": @"tokens_only"},
+                           @"summary": @{@"term_forms": @{@"new york": @[@"big-apple"]}}};
+    NSDictionary* jsonModel = @{@"objective_field": @"000001",
+                                @"model": @{@"fields": @{@"000000": city},
+                                            @"root": @{@"predicate": @YES, @"output": @"none", @"confidence": @0.5, @"children": @[
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @0, @"term": @"new york"}, @"output": @"new york", @"confidence": @0.9, @"children": @[
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @">", @"value": @1, @"term": @"new york"}, @"output": @"twice", @"confidence": @0.9},
+                                                    @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @1, @"term": @"new york"}, @"output": @"new york", @"confidence": @0.9}]},
+                                                @{@"predicate": @{@"field": @"000000", @"operator": @"<=", @"value": @0, @"term": @"new york"}, @"output": @"other", @"confidence": @0.6}]}}};
+    
+    //THE WORDS OF A FORM MATCH WHATEVER SEPARATES THEM IN THE TEXT, BUT NOT A SINGLE WORD OR ANOTHER ORDER
+    NSDictionary* expected = @{@"I love new-york": @"new york",
+                               @"New  York city": @"new york",
+                               @"new\\tyork": @"new york",
+                               @"the big apple": @"new york",
+                               @"new york, NEW_YORK": @"twice",
+                               @"newyork": @"other",
+                               @"york new": @"other",
+                               @"new": @"other"};
+    
+    for(NSNumber* compact in @[@NO, @YES])
+    {
+        LocalPredictiveModel* model = [[LocalPredictiveModel alloc]initWithJSONModel:jsonModel compactEncoding:[compact boolValue]];
+        
+        for(NSString* text in expected)
+        {
+            NSString* arguments = [NSString stringWithFormat:@"{\"city\": \"%@\"}", text];
+            XCTAssertEqualObjects([model predictWithArguments:arguments argsByName:YES][@"value"], expected[text], @"Wrong value for %@", text);
+        }
+    }
+}
+
+
+- (void)testChunkedUploadOnlyRetriesChunksThatWereNotCreated
+{
+    NSMutableDictionary* attemptsByChunk = [NSMutableDictionary dictionary];
+    
+    //EVERY CHUNK OF "throttled" IS REJECTED WITH 429 ONCE, THE FIRST CHUNK OF "failing" FAILS WITH 500 ONCE
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setFailureInjector:^NSInteger(NSURLRequest* request) {
+        NSString* body = [[NSString alloc]initWithData:[request HTTPBody] encoding:NSUTF8StringEncoding];
+        NSRange nameRange = [body rangeOfString:@"filename=\""];
+        NSString* chunkName = [[body substringFromIndex:NSMaxRange(nameRange)] componentsSeparatedByString:@"\""][0];
+        NSInteger attempts = 0;
+        
+        @synchronized(attemptsByChunk)
+        {
+            attempts = [attemptsByChunk[chunkName]integerValue] + 1;
+            attemptsByChunk[chunkName] = @(attempts);
+        }
+        
+        if(attempts > 1)
+            return 0;
+        
+        if([chunkName hasPrefix:@"throttled"])
+            return HTTP_TOO_MANY_REQUESTS;
+        
+        return [chunkName isEqualToString:@"failing_0"] ? HTTP_INTERNAL_SERVER_ERROR : 0;
+    }];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    [offlineLibrary setRetryPolicyWithMaxRetries:2 baseDelay:0.01 maxDelay:0.05];
+    [offlineLibrary setCircuitBreakerWithFailureThreshold:0 openInterval:0];
+    
+    NSString *path = [[NSBundle bundleForClass:[ML4iOSTests class]] pathForResource:@"iris" ofType:@"csv"];
+    NSInteger httpStatusCode = 0;
+    
+    //A THROTTLED CHUNK IS SENT AGAIN AFTER THE BACKOFF
+    ChunkedUpload* upload = [[ChunkedUpload alloc]initWithName:@"throttled" filePath:path chunkSize:512];
+    NSArray* dataSources = [offlineLibrary createDataSourcesWithUploadSync:upload statusCode:&httpStatusCode];
+    
+    XCTAssertEqual(httpStatusCode, HTTP_CREATED, @"The throttled chunks must be retried");
+    XCTAssertEqual([dataSources count], [upload numberOfChunks], @"A data source must be created per chunk");
+    
+    for(NSUInteger i = 0; i < [upload numberOfChunks]; i++)
+        XCTAssertEqual([attemptsByChunk[[upload nameForChunkAtIndex:i]]integerValue], 2, @"Every throttled chunk must be sent twice");
+    
+    //A CHUNK THAT FAILED ON THE SERVER ISN'T SENT AGAIN IN THE SAME PASS, IT COULD CREATE A DUPLICATE
+    upload = [[ChunkedUpload alloc]initWithName:@"failing" filePath:path chunkSize:512];
+    dataSources = [offlineLibrary createDataSourcesWithUploadSync:upload statusCode:&httpStatusCode];
+    
+    XCTAssertNil(dataSources, @"An upload with a failed chunk can't return data sources");
+    XCTAssertEqual(httpStatusCode, HTTP_INTERNAL_SERVER_ERROR, @"The status code of the failed chunk must be returned");
+    XCTAssertEqual([attemptsByChunk[@"failing_0"]integerValue], 1, @"A creation that failed on the server can't be retried");
+}
+
+
+- (void)testStubServerChangesETagOfReplacedResources
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"old_model"}];
+    
+    NSURLRequest* request = [NSURLRequest requestWithURL:[NSURL URLWithString:@"https://bigml.io/andromeda/model/000000000000000000000001"]];
+    NSHTTPURLResponse* response = nil;
+    
+    [server sendRequest:request operation:nil returningResponse:&response metrics:NULL error:NULL];
+    NSString* etag = [response allHeaderFields][@"ETag"];
+    
+    XCTAssertNotNil(etag, @"A GET must return the ETag of the resource");
+    
+    //A REPLACED RESOURCE ISN'T NOT MODIFIED FOR THE ETAG OF THE OLD ONE
+    [server addResource:@{@"resource": @"model/000000000000000000000001", @"name": @"new_model"}];
+    
+    NSMutableURLRequest* conditionalRequest = [request mutableCopy];
+    [conditionalRequest setValue:etag forHTTPHeaderField:@"If-None-Match"];
+    
+    NSData* data = [server sendRequest:conditionalRequest operation:nil returningResponse:&response metrics:NULL error:NULL];
+    NSDictionary* model = [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+    
+    XCTAssertEqual([response statusCode], HTTP_OK, @"A replaced resource must be sent again");
+    XCTAssertNotEqualObjects([response allHeaderFields][@"ETag"], etag, @"A replaced resource must have a new ETag");
+    XCTAssertEqualObjects(model[@"name"], @"new_model", @"The replacement must be returned");
+}
+
+
+- (void)testReleasingResourceEnumeratorCancelsPrefetch
+{
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server setLatency:10];
+    
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_API_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    NSOperationQueue* queue = [[NSOperationQueue alloc]init];
+    
+    NSInteger __block prefetchStatusCode = 0;
+    NSTimeInterval start = [[NSProcessInfo processInfo] systemUptime];
+    
+    //THE FIRST PAGE IS PREFETCHED AS SOON AS THE ENUMERATOR IS CREATED
+    @autoreleasepool
+    {
+        ResourceEnumerator* enumerator = [[ResourceEnumerator alloc]initWithFetch:^NSDictionary*(NSInteger offset, NSInteger limit, NSInteger* code) {
+            NSDictionary* page = [offlineLibrary getAllModelsWithNameSync:@"iris_model" offset:offset limit:limit statusCode:code];
+            prefetchStatusCode = *code;
+            
+            return page;
+        } pageSize:20 queue:queue];
+        
+        [NSThread sleepForTimeInterval:0.2];
+        enumerator = nil;
+    }
+    
+    [queue waitUntilAllOperationsAreFinished];
+    
+    XCTAssertTrue([[NSProcessInfo processInfo] systemUptime] - start < 5, @"Releasing the enumerator must abort the request in flight");
+    XCTAssertEqual(prefetchStatusCode, HTTP_CLIENT_CLOSED_REQUEST, @"The aborted prefetch must be reported as cancelled");
+}
+
+
+- (void)testTraceKeepsEventsOfThreadsThatExited
+{
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"ml4ios_exited_threads_trace.json"];
+    NSInteger threads = 8;
+    
+    [TraceRecorder startTracingWithBufferCapacity:0];
+    
+    //EVERY THREAD RECORDS AN EVENT AND EXITS, SO THE NEXT ONE CAN REUSE ITS BUFFER
+    for(NSInteger i = 0; i < threads; i++)
+    {
+        NSThread* thread = [[NSThread alloc]initWithBlock:^{
+            TraceInstant("exited", "test", 0);
+        }];
+        
+        [thread start];
+        
+        for(NSInteger j = 0; j < 100 && ![thread isFinished]; j++)
+            [NSThread sleepForTimeInterval:0.05];
+        
+        [NSThread sleepForTimeInterval:0.05];
+    }
+    
+    XCTAssertTrue([TraceRecorder writeTraceToFile:path], @"Error writing the trace");
+    [TraceRecorder stopTracing];
+    
+    NSDictionary* trace = [NSJSONSerialization JSONObjectWithData:[NSData dataWithContentsOfFile:path] options:0 error:nil];
+    NSArray* events = [trace[@"traceEvents"] filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name == %@", @"exited"]];
+    
+    XCTAssertEqual([events count], threads, @"The events of a thread must be kept once it exits");
+    XCTAssertEqual([[NSSet setWithArray:[events valueForKey:@"tid"]] count], threads, @"Every event must keep the thread that recorded it");
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testLocalDataSetOnlyTypesDecimalNumbersAsNumeric
+{
+    //EVERY COLUMN BUT THE FIRST ONE HAS A VALUE THAT STRTOD WOULD READ AS A NUMBER
+    NSString* csv = @"decimal,hexadecimal,infinite,nan,overflow\n"
+                    @"07,1,1,1,1\n"
+                    @"+1,2,2,2,2\n"
+                    @".5,0x1A,inf,nan,1e999\n"
+                    @"-2.5e1,3,3,3,3\n";
+    
+    NSString* path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"numbers.csv"];
+    [csv writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    
+    LocalDataSet* dataSet = [[LocalDataSet alloc]initWithContentsOfCSVFile:path];
+    
+    XCTAssertTrue([dataSet isNumericColumn:0], @"A column of decimal numbers must be numeric");
+    
+    const double* decimals = [dataSet numericColumn:0];
+    XCTAssertEqual(decimals[0], 7, @"Leading zeros are allowed");
+    XCTAssertEqual(decimals[1], 1, @"A leading sign is allowed");
+    XCTAssertEqual(decimals[2], 0.5, @"A leading point is allowed");
+    XCTAssertEqual(decimals[3], -25, @"Exponents are allowed");
+    
+    for(NSUInteger column = 1; column < 5; column++)
+        XCTAssertFalse([dataSet isNumericColumn:column], @"The column %@ can't be numeric", [dataSet fields][[dataSet fieldIds][column]][@"name"]);
+    
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testModelRefreshRevalidatesCachedModels
+{
+    NSString* cachesDirectory = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) firstObject];
+    [[NSFileManager defaultManager] removeItemAtPath:[[cachesDirectory stringByAppendingPathComponent:@"ML4iOS"] stringByAppendingPathComponent:@"BIGML_REFRESH_USERNAME"] error:nil];
+    
+    NSDictionary* (^modelWithOutput)(NSString*, NSString*) = ^NSDictionary*(NSString* updated, NSString* output) {
+        return @{@"resource": @"model/000000000000000000000001",
+                 @"updated": updated,
+                 @"objective_field": @"000001",
+                 @"model": @{@"fields": @{@"000000": @{@"name": @"x", @"optype": @"numeric"}},
+                             @"root": @{@"predicate": @YES, @"output": output, @"confidence": @0.5}}};
+    };
+    
+    StubServerTransport* server = [[StubServerTransport alloc]init];
+    [server addResource:modelWithOutput(@"2026-10-18T00:00:00.000000", @"old")];
+    
+    //THE CACHED COPY OF THE MODEL IS STILL FRESH WHEN THE MODEL IS RETRAINED
+    ML4iOS* offlineLibrary = [[ML4iOS alloc]initWithUsername:@"BIGML_REFRESH_USERNAME" key:@"BIGML_API_KEY" developmentMode:NO transport:server];
+    [offlineLibrary enableResourceCacheWithTimeToLive:3600];
+    
+    NSInteger httpStatusCode = 0;
+    
+    [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{}" statusCode:&httpStatusCode];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"compiledModels"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    [server addResource:modelWithOutput(@"2026-10-19T00:00:00.000000", @"new")];
+    [offlineLibrary startModelRefreshWithInterval:0.1];
+    
+    for(NSInteger i = 0; i < 100 && [[offlineLibrary hybridPredictionStatistics][@"reloads"]integerValue] == 0; i++)
+        [NSThread sleepForTimeInterval:0.05];
+    
+    [offlineLibrary stopModelRefresh];
+    
+    NSDictionary* prediction = [offlineLibrary predictWithModelIdSync:@"000000000000000000000001" input:@"{}" statusCode:&httpStatusCode];
+    
+    XCTAssertEqualObjects(prediction[@"value"], @"new", @"The refresh must ask the server for a new version of a fresh cached model");
+    XCTAssertEqual([[offlineLibrary hybridPredictionStatistics][@"reloads"]integerValue], 1, @"The new version must be swapped in once");
+    XCTAssertEqual([[offlineLibrary resourceCacheStatistics][@"hits"]integerValue], 0, @"The refresh can't be served from the cache");
+}
+
+
 #pragma mark -
 #pragma mark ML4iOSDelegate
 